@@ -0,0 +1,57 @@
+import QtQuick 2.0
+import QtQuick.Layouts 1.0
+import QtQuick.Window 2.0
+import QtQuick.Controls 1.2
+import Qt.example.computer 1.0
+import Qt.example.accessheatmapview 1.0
+
+Window {
+    id: heatmap_window
+    width: 532
+    height: 580
+    title: qsTr("Memory Heatmap")
+
+    ColumnLayout {
+        anchors.fill: parent
+        anchors.margins: 10
+
+        RowLayout {
+            Label { text: qsTr("Half life (s):") }
+            SpinBox {
+                id: half_life
+                decimals: 1
+                minimumValue: 0.1
+                maximumValue: 10.0
+                stepSize: 0.1
+                value: 0.5
+            }
+            Label {
+                text: qsTr("Writes red, reads green, executing blue")
+                Layout.fillWidth: true
+            }
+        }
+
+        // A row for each page, twice the size
+        AccessHeatmapView {
+            id: heatmap
+            // The accesses are only counted while they are on screen
+            cpu: heatmap_window.visible ? Computer.cpu : null
+            halfLife: half_life.value
+            Layout.preferredWidth: 512
+            Layout.preferredHeight: 512
+
+            MouseArea {
+                id: heatmap_mouse
+                anchors.fill: parent
+                hoverEnabled: true
+            }
+        }
+
+        Label {
+            property int address: heatmap_mouse.containsMouse ? heatmap.addressAt(heatmap_mouse.mouseX, heatmap_mouse.mouseY) : -1
+
+            text: address < 0 ? "" : "$" + ("000" + address.toString(16).toUpperCase()).slice(-4)
+            font.family: "Courier"
+        }
+    }
+}
@@ -0,0 +1,76 @@
+import QtQuick 2.0
+import QtQuick.Layouts 1.0
+import QtQuick.Window 2.0
+import QtQuick.Controls 1.2
+import Qt.example.computer 1.0
+import Qt.example.executionstatisticsmodel 1.0
+
+Window {
+    id: statistics_window
+    width: 500
+    height: 700
+    title: qsTr("Statistics")
+
+    ExecutionStatisticsModel {
+        id: statistics_model
+        cpu: Computer.cpu
+    }
+
+    // The counters are only copied while they are on screen
+    Timer {
+        interval: 500
+        repeat: true
+        running: statistics_window.visible
+        triggeredOnStart: true
+        onTriggered: statistics_model.refresh()
+    }
+
+    ColumnLayout {
+        id: totals_column
+        anchors.left: parent.left
+        anchors.right: parent.right
+        anchors.top: parent.top
+        anchors.margins: 10
+
+        RowLayout {
+            CheckBox {
+                text: qsTr("By addressing mode")
+                checked: statistics_model.byAddressMode
+                onClicked: statistics_model.byAddressMode = checked
+            }
+            Button {
+                text: qsTr("Reset")
+                onClicked: statistics_model.reset()
+            }
+        }
+        Label { text: qsTr("Instructions: ") + statistics_model.instructions }
+        Label { text: qsTr("Page crossing cycles: ") + statistics_model.pageCrossings }
+        Label {
+            text: qsTr("Branches taken: ") + statistics_model.branchesTaken +
+                  qsTr(" (to another page: ") + statistics_model.branchPageCrossings + ")" +
+                  qsTr(", not taken: ") + statistics_model.branchesNotTaken
+        }
+        Label {
+            text: qsTr("Decimal ADC: ") + statistics_model.decimalAdditions +
+                  qsTr(", SBC: ") + statistics_model.decimalSubtractions
+        }
+    }
+
+    ListView {
+        anchors.left: parent.left
+        anchors.right: parent.right
+        anchors.top: totals_column.bottom
+        anchors.bottom: parent.bottom
+        anchors.margins: 10
+        clip: true
+        model: statistics_model
+
+        delegate: Row {
+            spacing: 20
+
+            Text { text: model.name; width: 150; font.family: "Courier" }
+            Text { text: model.count; width: 120; horizontalAlignment: Text.AlignRight; font.family: "Courier" }
+            Text { text: model.share.toFixed(2) + "%"; width: 70; horizontalAlignment: Text.AlignRight; font.family: "Courier" }
+        }
+    }
+}
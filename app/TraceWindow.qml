@@ -0,0 +1,100 @@
+import QtQuick 2.0
+import QtQuick.Layouts 1.0
+import QtQuick.Window 2.0
+import QtQuick.Controls 1.2
+import QtQuick.Dialogs 1.2
+import Qt.example.tracelistmodel 1.0
+
+Window {
+    id: trace_window
+    width: 900
+    height: 700
+    title: qsTr("Trace") + (trace_model.file.toString() ? " - " + trace_model.file.toString() : "")
+
+    // Empty fields mean anything, otherwise they are hex
+    function parseHex(text, otherwise) {
+        return text.length > 0 ? parseInt(text, 16) : otherwise
+    }
+
+    TraceListModel {
+        id: trace_model
+    }
+
+    FileDialog {
+        id: open_dialog
+        title: qsTr("Open a trace")
+        nameFilters: [ "Traces (*.trace)", "All files (*)" ]
+        onAccepted: trace_model.file = fileUrl
+    }
+
+    RowLayout {
+        id: filter_row
+        anchors.left: parent.left
+        anchors.right: parent.right
+        anchors.top: parent.top
+
+        Button {
+            text: "Open..."
+            Layout.margins: 10
+            onClicked: open_dialog.open()
+        }
+        Label { text: "PC from $" }
+        TextField { id: lowest_field; implicitWidth: 50; inputMask: "HHHH;" }
+        Label { text: "to $" }
+        TextField { id: highest_field; implicitWidth: 50; inputMask: "HHHH;" }
+        Label { text: "Opcode $" }
+        TextField { id: opcode_field; implicitWidth: 30; inputMask: "HH;" }
+        Label { text: "Address $" }
+        TextField { id: address_field; implicitWidth: 50; inputMask: "HHHH;" }
+        Button {
+            text: "Filter"
+            onClicked: trace_model.setFilter(parseHex(lowest_field.text, 0x0000),
+                                             parseHex(highest_field.text, 0xFFFF),
+                                             parseHex(opcode_field.text, -1),
+                                             parseHex(address_field.text, -1))
+        }
+        Button {
+            text: "Clear"
+            onClicked: trace_model.clearFilter()
+        }
+        Label { text: "Cycle" }
+        TextField {
+            id: cycle_field
+            implicitWidth: 100
+            validator: RegExpValidator { regExp: /[0-9]*/ }
+            onAccepted: trace_list.positionViewAtIndex(trace_model.rowOfCycle(parseInt(text, 10)), ListView.Beginning)
+        }
+        Label {
+            text: trace_model.error ? trace_model.error
+                                    : trace_model.filtering ? qsTr("Filtering...")
+                                                            : trace_model.count + " / " + trace_model.records
+            color: trace_model.error ? "red" : "black"
+            Layout.fillWidth: true
+            Layout.margins: 10
+            elide: Text.ElideRight
+        }
+    }
+
+    // Only the rows on screen are ever asked for, and so decoded
+    ListView {
+        id: trace_list
+        anchors.left: parent.left
+        anchors.right: parent.right
+        anchors.top: filter_row.bottom
+        anchors.bottom: parent.bottom
+        anchors.margins: 10
+        clip: true
+        model: trace_model
+
+        delegate: Row {
+            spacing: 20
+
+            Text { text: model.cycle; width: 100; horizontalAlignment: Text.AlignRight; font.family: "Courier" }
+            Text { text: model.address; width: 50; font.family: "Courier" }
+            Text { text: model.bytes; width: 80; font.family: "Courier" }
+            Text { text: model.disassembly; width: 220; font.family: "Courier" }
+            Text { text: model.registers; width: 250; font.family: "Courier" }
+            Text { text: model.effectiveAddress; font.family: "Courier" }
+        }
+    }
+}
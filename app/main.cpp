@@ -1,9 +1,12 @@
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
+#include "accessheatmapview.hpp"
 #include "computer.hpp"
+#include "executionstatisticsmodel.hpp"
 #include "rambusdeviceview.hpp"
 #include "rambusdevicetablemodel.hpp"
 #include "rambusdevicedisassemblymodel.hpp"
+#include "tracelistmodel.hpp"
 
 int main(int argc, char *argv[])
 {
@@ -12,10 +15,13 @@ int main(int argc, char *argv[])
     // QCoreApplication::setAttribute(Qt::AA_EnableHighDpiScaling);
 
     // This is what allows QML to have access to our type.
+    AccessHeatmapView::RegisterType();
     Computer::RegisterType();
+    ExecutionStatisticsModel::RegisterType();
     RamBusDeviceView::RegisterType();
     RamBusDeviceTableModel::RegisterType();
     RamBusDeviceDisassemblyModel::RegisterType();
+    TraceListModel::RegisterType();
 
     QGuiApplication app(argc, argv);
 
@@ -8,6 +8,8 @@ import QtQuick.Window 2.0
 
 import QtQuick.Controls 1.2
 //import QtQuick.Controls 1.4
+
+import QtQuick.Dialogs 1.2
 import Qt.example.computer 1.0
 import Qt.example.rambusdeviceview 1.0
 import Qt.example.rambusdevicetablemodel 1.0
@@ -34,6 +36,40 @@ Window {
         endAddress: 0x9000
     }
 
+    TraceWindow {
+        id: trace_window
+    }
+
+    StatisticsWindow {
+        id: statistics_window
+    }
+
+    HeatmapWindow {
+        id: heatmap_window
+    }
+
+    FileDialog {
+        id: load_dialog
+        title: qsTr("Load a program image")
+        nameFilters: [ "Program images (*.bin *.hex *.ihx *.srec *.s19 *.s28 *.s37 *.mot *.nes)", "All files (*)" ]
+        onAccepted: Computer.loadImage(fileUrl)
+    }
+
+    FileDialog {
+        id: save_coverage_dialog
+        title: qsTr("Save the coverage")
+        selectExisting: false
+        nameFilters: [ "Code/data logs (*.cdl)", "Coverage flags (*.flags)" ]
+        onAccepted: Computer.cpu.saveCoverage(fileUrl)
+    }
+
+    FileDialog {
+        id: load_coverage_dialog
+        title: qsTr("Load the coverage")
+        nameFilters: [ "Code/data logs (*.cdl)", "Coverage flags (*.flags)", "All files (*)" ]
+        onAccepted: Computer.cpu.loadCoverage(fileUrl)
+    }
+
     RowLayout {
         id: clock_control_row
         anchors.left: parent.left
@@ -53,7 +89,56 @@ Window {
         Button {
             text: "Step"
             Layout.margins: 10
-            onClicked: Computer.cpu.clock()
+            onClicked: Computer.stepClock()
+        }
+        Button {
+            text: "Step Back"
+            Layout.margins: 10
+            enabled: Computer.rewindOldest >= 0 && Computer.rewindOldest < Computer.cycle
+            onClicked: Computer.stepInstructionBack()
+        }
+        Button {
+            text: "Load..."
+            Layout.margins: 10
+            onClicked: load_dialog.open()
+        }
+        Button {
+            text: "Trace..."
+            Layout.margins: 10
+            onClicked: trace_window.show()
+        }
+        Button {
+            text: "Statistics..."
+            Layout.margins: 10
+            onClicked: statistics_window.show()
+        }
+        Button {
+            text: "Heatmap..."
+            Layout.margins: 10
+            onClicked: heatmap_window.show()
+        }
+        CheckBox {
+            text: "Coverage"
+            Layout.margins: 10
+            checked: Computer.cpu.coverage
+            onClicked: Computer.cpu.coverage = checked
+        }
+        Button {
+            text: "Save Coverage..."
+            Layout.margins: 10
+            onClicked: save_coverage_dialog.open()
+        }
+        Button {
+            text: "Load Coverage..."
+            Layout.margins: 10
+            onClicked: load_coverage_dialog.open()
+        }
+        Text {
+            text: Computer.loadError
+            color: "red"
+            Layout.margins: 10
+            Layout.fillWidth: true
+            elide: Text.ElideRight
         }
     }
     ColumnLayout {
@@ -143,6 +228,8 @@ Window {
 
             model: Computer.ram
             page: 0x80
+            cpu: Computer.cpu
+            showCoverage: true
         }
     }
 }
@@ -0,0 +1,41 @@
+#include "benchmark_helpers.hpp"
+
+
+const char *NameOf(AddressMode_e mode)
+{
+    switch (mode)
+    {
+    case AddressMode_e::Accumulator:      return "ACC";
+    case AddressMode_e::Absolute:         return "ABS";
+    case AddressMode_e::AbsoluteXIndexed: return "ABX";
+    case AddressMode_e::AbsoluteYIndexed: return "ABY";
+    case AddressMode_e::Immediate:        return "IMM";
+    case AddressMode_e::Implied:          return "IMP";
+    case AddressMode_e::Indirect:         return "IND";
+    case AddressMode_e::XIndexedIndirect: return "IZX";
+    case AddressMode_e::IndirectYIndexed: return "IZY";
+    case AddressMode_e::Relative:         return "REL";
+    case AddressMode_e::ZeroPage:         return "ZP0";
+    case AddressMode_e::ZeroPageXIndexed: return "ZPX";
+    case AddressMode_e::ZeroPageYIndexed: return "ZPY";
+    }
+    return "???";
+}
+
+const char *NameOf(AbstractInstruction_e instruction)
+{
+    static const char *names[] = {
+        "ADC", "AND", "ASL", "BCC", "BCS", "BEQ", "BIT", "BMI",
+        "BNE", "BPL", "BRK", "BVC", "BVS", "CLC", "CLD", "CLI",
+        "CLV", "CMP", "CPX", "CPY", "DEC", "DEX", "DEY", "EOR",
+        "INC", "INX", "INY", "JMP", "JSR", "LDA", "LDX", "LDY",
+        "LSR", "NOP", "ORA", "PHA", "PHP", "PLA", "PLP", "ROL",
+        "ROR", "RTI", "RTS", "SBC", "SEC", "SED", "SEI", "STA",
+        "STX", "STY", "TAX", "TAY", "TSX", "TXA", "TXS", "TYA"
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(AbstractInstruction_e::END), "Name table is out of sync");
+
+    if (instruction < AbstractInstruction_e::END)
+        return names[static_cast<size_t>(instruction)];
+    return "???";
+}
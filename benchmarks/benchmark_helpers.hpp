@@ -0,0 +1,163 @@
+#ifndef BENCHMARK_HELPERS_HPP
+#define BENCHMARK_HELPERS_HPP
+
+#include "instructionexecutor.hpp"
+#include "instructions.hpp"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <initializer_list>
+#include <ostream>
+#include <string>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define BENCHMARK_HAS_HOST_CYCLES
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCHMARK_HAS_HOST_CYCLES
+#endif
+
+
+/** A bare CPU wired directly to 64K of RAM.
+ *
+ *  There are no Qt signals, devices or observers in the way, so what gets
+ *  measured is the executor itself.  Nothing observes the status register
+ *  either, so lazily evaluated flags are only computed when instructions
+ *  need them.
+ */
+class BenchmarkMachine
+{
+public:
+    using addressType = InstructionExecutor::addressType;
+    using memory_type = std::array<uint8_t, 64 * 1024>;
+
+    BenchmarkMachine() { memory.fill(0x00); }
+    BenchmarkMachine(const BenchmarkMachine &) = delete;
+
+    memory_type memory;
+    InstructionExecutor executor{ [this](addressType address, bool) { return memory[address]; },
+                                  [this](addressType address, uint8_t data) { memory[address] = data; },
+                                  [](InstructionExecutor::registerType) { },
+                                  [](InstructionExecutor::registerType) { },
+                                  [](InstructionExecutor::registerType) { },
+                                  [](addressType) { },
+                                  [](InstructionExecutor::registerType) { },
+                                  nullptr
+                                };
+    Registers  &registers = executor.registers();
+
+    /** Copies @p bytes into memory starting at @p address.
+     *
+     *  @return The address just past the last byte written
+     */
+    addressType load(addressType address, std::initializer_list<uint8_t> bytes)
+    {
+        for (uint8_t b : bytes)
+            memory[address++] = b;
+        return address;
+    }
+
+    void executeInstruction()
+    {
+        do {
+            executor.clock();
+        } while (!executor.complete());
+    }
+
+    BenchmarkMachine &operator =(const BenchmarkMachine &) = delete;
+};
+
+
+/** Measures elapsed host time.
+ *
+ */
+class Stopwatch
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    Stopwatch() : _start(clock_type::now()) { }
+
+    void restart() { _start = clock_type::now(); }
+
+    double elapsedNanoseconds() const
+    {
+        return std::chrono::duration<double, std::nano>(clock_type::now() - _start).count();
+    }
+
+private:
+    clock_type::time_point _start;
+};
+
+/** Reads the host's time stamp counter, or 0 where there isn't one.
+ *
+ *  On x86 the counter ticks at a constant rate close to the nominal clock
+ *  speed, so differences are (roughly) host clock cycles.
+ */
+inline uint64_t HostCycles()
+{
+#if defined(BENCHMARK_HAS_HOST_CYCLES)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/** Human readable names, used for reporting.
+ *
+ */
+///@{
+const char *NameOf(AddressMode_e mode);
+const char *NameOf(AbstractInstruction_e instruction);
+///@}
+
+/** Per-opcode benchmarks of the instructions that update the status register.
+ *
+ */
+void RunFlagUpdateBenchmarks(std::ostream &output);
+
+/** Every workload on each engine with and without a CoverageMap marking
+ *  every byte executed, read and written.
+ */
+void RunCoverageBenchmarks(std::ostream &output);
+
+/** Whole program speed on each of the interpreter engines that was built.
+ *
+ */
+void RunEngineBenchmarks(std::ostream &output);
+
+/** Whole program speed with and without superinstructions, fusing the
+ *  opcode pairs the workloads themselves use most.
+ */
+void RunFusionBenchmarks(std::ostream &output);
+
+/** Each of the 256 opcodes run on its own, on every engine that was built,
+ *  with page crossing variants of the indexed modes and branches.
+ */
+void RunOpcodeBenchmarks(std::ostream &output);
+
+/** Every workload with and without a CycleProfiler counting where the
+ *  cycles go.
+ */
+void RunProfileBenchmarks(std::ostream &output);
+
+/** Full and incremental snapshots of each workload, taken every frame:
+ *  how long they take, how big the deltas are, and how long rebuilding the
+ *  last state from the first snapshot and all the deltas takes.
+ */
+void RunSnapshotBenchmarks(std::ostream &output);
+
+/** Every workload with and without a TraceRecorder writing a trace of
+ *  every instruction to a file, and how much of it there is.
+ */
+void RunTraceBenchmarks(std::ostream &output);
+
+/** Every workload on every engine that was built, with the CPU wired
+ *  straight to memory and through the SystemBus.  Besides the report on
+ *  @p output, the measurements are written as CSV to @p results_path, so
+ *  runs can be compared with each other.
+ */
+void RunThroughputBenchmarks(std::ostream &output, const std::string &results_path);
+
+#endif // BENCHMARK_HELPERS_HPP
@@ -0,0 +1,41 @@
+TEMPLATE = app
+CONFIG += console c++17
+CONFIG -= app_bundle
+CONFIG -= qt
+CONFIG += thread
+
+# Benchmarks are meaningless without optimizations.
+CONFIG += release
+CONFIG -= debug
+
+HEADERS += \
+    benchmark_helpers.hpp \
+    workloads.hpp
+
+SOURCES += \
+    benchmark_helpers.cpp \
+    coverage_benchmarks.cpp \
+    engine_benchmarks.cpp \
+    flag_update_benchmarks.cpp \
+    fusion_benchmarks.cpp \
+    main.cpp \
+    opcode_benchmarks.cpp \
+    profile_benchmarks.cpp \
+    snapshot_benchmarks.cpp \
+    throughput_benchmarks.cpp \
+    trace_benchmarks.cpp \
+    workloads.cpp
+
+# Generated by the "Add Library..." right mouse menu option.
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../core/release/ -lemulatorcore
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../core/debug/ -lemulatorcore
+else:unix: LIBS += -L$$OUT_PWD/../core/ -lemulatorcore
+
+INCLUDEPATH += $$PWD/../core
+DEPENDPATH += $$PWD/../core
+
+win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../core/release/libemulatorcore.a
+else:win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../core/debug/libemulatorcore.a
+else:win32:!win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../core/release/emulatorcore.lib
+else:win32:!win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../core/debug/emulatorcore.lib
+else:unix: PRE_TARGETDEPS += $$OUT_PWD/../core/libemulatorcore.a
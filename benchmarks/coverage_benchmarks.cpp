@@ -0,0 +1,88 @@
+#include "accesscounters.hpp"
+#include "accessheatmap.hpp"
+#include "benchmark_helpers.hpp"
+#include "coveragemap.hpp"
+#include "workloads.hpp"
+#include <iomanip>
+
+namespace
+{
+using Engine = InstructionExecutor::Engine;
+
+constexpr uint32_t timed_cycles = 20000000;
+constexpr int      heatmap_updates = 100;
+
+const std::vector<std::pair<Engine, const char *>> engines {
+    { Engine::Table,    "table" },
+    { Engine::Threaded, "threaded" },
+    { Engine::TailCall, "tail call" }
+};
+
+// Emulated clock speed, in MHz, with or without a coverage map or counters
+double MegahertzFor(const Workload &workload, Engine engine, CoverageMap *coverage, AccessCounters *counters)
+{
+    BenchmarkMachine machine;
+
+    machine.executor.setEngine(engine);
+    LoadWorkload(machine, workload);
+    machine.executor.setCoverageMap(coverage);
+    machine.executor.setAccessCounters(counters);
+
+    Stopwatch timer;
+
+    RunWorkload(machine, workload, timed_cycles);
+
+    const double nanoseconds = timer.elapsedNanoseconds();
+
+    return machine.executor.clock_ticks * 1000.0 / nanoseconds;
+}
+
+// What it takes to bring a heatmap up to date, once a frame, in microseconds
+double MicrosecondsPerHeatmapUpdate(const AccessCounters &counters)
+{
+    AccessHeatmap heatmap;
+
+    heatmap.update(counters, 0.0);
+
+    Stopwatch timer;
+
+    for (int i = 0; i < heatmap_updates; ++i)
+        heatmap.update(counters, 1.0 / 60);
+    return timer.elapsedNanoseconds() / 1000.0 / heatmap_updates;
+}
+}
+
+
+void RunCoverageBenchmarks(std::ostream &output)
+{
+    output << "Marking every access in a coverage map, or counting it (" << timed_cycles << " cycles each)\n";
+    output << "Workload    Engine          MHz  covered  slowdown  counted  slowdown\n";
+    for (const Workload &workload : StandardWorkloads())
+    {
+        for (auto &engine : engines)
+        {
+            if (!InstructionExecutor::engineAvailable(engine.first))
+                continue;
+
+            CoverageMap    coverage;
+            AccessCounters counters;
+            const double   plain_megahertz = MegahertzFor(workload, engine.first, nullptr, nullptr);
+            const double   covered_megahertz = MegahertzFor(workload, engine.first, &coverage, nullptr);
+            const double   counted_megahertz = MegahertzFor(workload, engine.first, nullptr, &counters);
+
+            output << "  " << std::left << std::setw(10) << workload.name << std::setw(10) << engine.second << std::right
+                   << std::fixed << std::setprecision(2)
+                   << std::setw(9) << plain_megahertz
+                   << std::setw(9) << covered_megahertz
+                   << std::setw(9) << plain_megahertz / covered_megahertz << 'x'
+                   << std::setw(9) << counted_megahertz
+                   << std::setw(9) << plain_megahertz / counted_megahertz << "x\n";
+        }
+    }
+
+    AccessCounters counters;
+
+    MegahertzFor(StandardWorkloads().front(), Engine::Table, nullptr, &counters);
+    output << "Heatmap update: " << std::fixed << std::setprecision(0)
+           << MicrosecondsPerHeatmapUpdate(counters) << " us each\n";
+}
@@ -0,0 +1,53 @@
+#include "benchmark_helpers.hpp"
+#include "workloads.hpp"
+#include <iomanip>
+
+namespace
+{
+using Engine = InstructionExecutor::Engine;
+
+constexpr uint32_t timed_cycles = 20000000;
+
+const std::vector<std::pair<Engine, const char *>> engines {
+    { Engine::Table,    "table" },
+    { Engine::Threaded, "threaded" },
+    { Engine::TailCall, "tail call" }
+};
+
+// Emulated clock speed, in MHz, running the workload on the given engine.
+double MegahertzFor(const Workload &workload, Engine engine)
+{
+    BenchmarkMachine machine;
+
+    machine.executor.setEngine(engine);
+    LoadWorkload(machine, workload);
+
+    Stopwatch timer;
+
+    RunWorkload(machine, workload, timed_cycles);
+    return machine.executor.clock_ticks * 1000.0 / timer.elapsedNanoseconds();
+}
+}
+
+
+void RunEngineBenchmarks(std::ostream &output)
+{
+    output << "Interpreter engines (MHz, " << timed_cycles << " cycles each)\n";
+    output << "Workload  ";
+    for (auto &engine : engines)
+        output << std::setw(10) << engine.second;
+    output << '\n';
+
+    for (const Workload &workload : StandardWorkloads())
+    {
+        output << "  " << std::left << std::setw(8) << workload.name << std::right;
+        for (auto &engine : engines)
+        {
+            if (InstructionExecutor::engineAvailable(engine.first))
+                output << std::fixed << std::setprecision(2) << std::setw(10) << MegahertzFor(workload, engine.first);
+            else
+                output << std::setw(10) << "n/a";
+        }
+        output << '\n';
+    }
+}
@@ -0,0 +1,122 @@
+#include "benchmark_helpers.hpp"
+#include "opcodes.hpp"
+#include <iomanip>
+#include <set>
+#include <vector>
+
+namespace
+{
+constexpr BenchmarkMachine::addressType code_address    = 0x0400;
+constexpr BenchmarkMachine::addressType data_address    = 0x0300;
+constexpr uint8_t                       zp_address      = 0x10;
+constexpr uint8_t                       pointer_address = 0x20;
+constexpr int instructions_per_pass = 1000;
+constexpr int passes = 200;
+
+// Every instruction whose main job includes updating the status register.
+const std::vector<AbstractInstruction_e> flag_updating_instructions {
+    AbstractInstruction_e::ADC, AbstractInstruction_e::AND, AbstractInstruction_e::ASL,
+    AbstractInstruction_e::BIT, AbstractInstruction_e::CMP, AbstractInstruction_e::CPX,
+    AbstractInstruction_e::CPY, AbstractInstruction_e::DEC, AbstractInstruction_e::DEX,
+    AbstractInstruction_e::DEY, AbstractInstruction_e::EOR, AbstractInstruction_e::INC,
+    AbstractInstruction_e::INX, AbstractInstruction_e::INY, AbstractInstruction_e::LDA,
+    AbstractInstruction_e::LDX, AbstractInstruction_e::LDY, AbstractInstruction_e::LSR,
+    AbstractInstruction_e::ORA, AbstractInstruction_e::PLA, AbstractInstruction_e::ROL,
+    AbstractInstruction_e::ROR, AbstractInstruction_e::SBC, AbstractInstruction_e::TAX,
+    AbstractInstruction_e::TAY, AbstractInstruction_e::TSX, AbstractInstruction_e::TXA,
+    AbstractInstruction_e::TYA
+};
+
+// Implied comes first, so single mode instructions get reported under it.
+const std::vector<AddressMode_e> all_address_modes {
+    AddressMode_e::Implied,          AddressMode_e::Accumulator,      AddressMode_e::Absolute,
+    AddressMode_e::AbsoluteXIndexed, AddressMode_e::AbsoluteYIndexed, AddressMode_e::Immediate,
+    AddressMode_e::Indirect,         AddressMode_e::XIndexedIndirect, AddressMode_e::IndirectYIndexed,
+    AddressMode_e::Relative,         AddressMode_e::ZeroPage,         AddressMode_e::ZeroPageXIndexed,
+    AddressMode_e::ZeroPageYIndexed
+};
+
+/** Writes one copy of the instruction, with operands suitable for the address mode.
+ *
+ *  @return The address just past the instruction
+ */
+BenchmarkMachine::addressType LoadInstruction(BenchmarkMachine &machine, BenchmarkMachine::addressType address, uint8_t opcode, AddressMode_e mode)
+{
+    switch (mode)
+    {
+    case AddressMode_e::Immediate:
+        return machine.load(address, { opcode, 0x5A });
+    case AddressMode_e::ZeroPage:
+    case AddressMode_e::ZeroPageXIndexed:
+    case AddressMode_e::ZeroPageYIndexed:
+        return machine.load(address, { opcode, zp_address });
+    case AddressMode_e::XIndexedIndirect:
+    case AddressMode_e::IndirectYIndexed:
+        return machine.load(address, { opcode, pointer_address });
+    case AddressMode_e::Absolute:
+    case AddressMode_e::AbsoluteXIndexed:
+    case AddressMode_e::AbsoluteYIndexed:
+    case AddressMode_e::Indirect:
+        return machine.load(address, { opcode, data_address & 0xFF, data_address >> 8 });
+    default:
+        return machine.load(address, { opcode });
+    }
+}
+
+double NanosecondsPerInstruction(uint8_t opcode, AddressMode_e mode, bool lazy_flags)
+{
+    BenchmarkMachine              machine;
+    BenchmarkMachine::addressType address = code_address;
+
+    machine.executor.setLazyFlags(lazy_flags);
+
+    machine.memory[zp_address] = 0x5A;
+    machine.memory[data_address] = 0x5A;
+    machine.load(pointer_address, { data_address & 0xFF, data_address >> 8 });
+    for (int i = 0; i < instructions_per_pass; ++i)
+        address = LoadInstruction(machine, address, opcode, mode);
+
+    Stopwatch timer;
+
+    for (int pass = 0; pass < passes; ++pass)
+    {
+        machine.registers.program_counter = code_address;
+        for (int i = 0; i < instructions_per_pass; ++i)
+            machine.executeInstruction();
+    }
+    return timer.elapsedNanoseconds() / (static_cast<double>(passes) * instructions_per_pass);
+}
+}
+
+
+void RunFlagUpdateBenchmarks(std::ostream &output)
+{
+    output << "Flag update microbenchmarks (" << passes * instructions_per_pass << " instructions each)\n";
+    output << "Opcode  Instruction  Mode  ns/instruction  (lazy flags)\n";
+
+    auto report = [&output](uint8_t opcode, const char *instruction, AddressMode_e mode)
+    {
+        output << "  $" << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << static_cast<int>(opcode)
+               << std::dec << std::setfill(' ')
+               << "   " << std::setw(3) << instruction
+               << "          " << NameOf(mode)
+               << "   " << std::fixed << std::setprecision(2) << NanosecondsPerInstruction(opcode, mode, false)
+               << "          " << NanosecondsPerInstruction(opcode, mode, true) << '\n';
+    };
+
+    // A baseline, to show what the instruction dispatch alone costs.
+    report(OpcodeFor(AbstractInstruction_e::NOP, AddressMode_e::Implied), NameOf(AbstractInstruction_e::NOP), AddressMode_e::Implied);
+
+    std::set<uint8_t> reported;
+
+    for (AbstractInstruction_e instruction : flag_updating_instructions)
+        for (AddressMode_e mode : all_address_modes)
+        {
+            uint8_t opcode = OpcodeFor(instruction, mode);
+
+            // Zero means there is no such combination (BRK is the only real $00).
+            // Single mode instructions give the same opcode for every mode.
+            if ((opcode != 0x00) && reported.insert(opcode).second)
+                report(opcode, NameOf(instruction), mode);
+        }
+}
@@ -0,0 +1,70 @@
+#include "benchmark_helpers.hpp"
+#include "opcodepairhistogram.hpp"
+#include "workloads.hpp"
+#include <algorithm>
+#include <iomanip>
+
+namespace
+{
+constexpr uint32_t profile_cycles = 1000000;
+constexpr uint32_t timed_cycles   = 20000000;
+constexpr double   minimum_share  = 0.01;
+constexpr size_t   reported_pairs = 12;
+
+// Emulated clock speed, in MHz, running the workload with the given pairs fused.
+double MegahertzFor(const Workload &workload, const OpcodePairHistogram *histogram)
+{
+    BenchmarkMachine machine;
+
+    if (histogram)
+        machine.executor.selectSuperinstructions(*histogram, minimum_share);
+    LoadWorkload(machine, workload);
+
+    Stopwatch timer;
+
+    RunWorkload(machine, workload, timed_cycles);
+    return machine.executor.clock_ticks * 1000.0 / timer.elapsedNanoseconds();
+}
+
+bool IsFusible(const OpcodePairHistogram::Pair &pair)
+{
+    const auto &fusible = InstructionExecutor::fusiblePairs();
+
+    return std::find(fusible.begin(), fusible.end(), InstructionExecutor::opcodePairType(pair.first, pair.second)) != fusible.end();
+}
+}
+
+
+void RunFusionBenchmarks(std::ostream &output)
+{
+    const auto         &workloads = StandardWorkloads();
+    OpcodePairHistogram histogram;
+
+    // Profile every workload first, so the fused pairs are the ones that
+    // actually show up, rather than the ones somebody expected to.
+    for (const Workload &workload : workloads)
+    {
+        BenchmarkMachine machine;
+
+        machine.executor.setOpcodePairHistogram(&histogram);
+        LoadWorkload(machine, workload);
+        RunWorkload(machine, workload, profile_cycles);
+    }
+
+    const double total = static_cast<double>(histogram.total());
+
+    output << "Superinstruction fusion\n";
+    output << "Most frequent opcode pairs (" << histogram.total() << " instructions profiled)\n";
+    for (const auto &pair : histogram.mostFrequent(reported_pairs))
+        output << "  $" << std::hex << std::uppercase << std::setfill('0')
+               << std::setw(2) << static_cast<int>(pair.first) << " $" << std::setw(2) << static_cast<int>(pair.second)
+               << std::dec << std::setfill(' ')
+               << "  " << std::fixed << std::setprecision(2) << std::setw(6) << 100.0 * pair.count / total << '%'
+               << (IsFusible(pair) ? "  fusible" : "") << '\n';
+
+    output << "Workload    MHz  (fused)\n";
+    for (const Workload &workload : workloads)
+        output << "  " << std::left << std::setw(8) << workload.name << std::right
+               << std::fixed << std::setprecision(2) << std::setw(7) << MegahertzFor(workload, nullptr)
+               << "  " << std::setw(7) << MegahertzFor(workload, &histogram) << '\n';
+}
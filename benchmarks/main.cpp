@@ -0,0 +1,52 @@
+#include "benchmark_helpers.hpp"
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+
+int main(int argc, char *argv[])
+{
+    std::string results_path = "throughput.csv";
+
+    // The throughput suite also writes its measurements to a file, which
+    // --results can name.
+    if ((argc > 2) && (std::string(argv[1]) == "--results"))
+    {
+        results_path = argv[2];
+        argc -= 2;
+        argv += 2;
+    }
+
+    const std::map<std::string, std::function<void (std::ostream &)>> suites {
+        { "coverage",   RunCoverageBenchmarks },
+        { "engines",    RunEngineBenchmarks },
+        { "flags",      RunFlagUpdateBenchmarks },
+        { "fusion",     RunFusionBenchmarks },
+        { "opcodes",    RunOpcodeBenchmarks },
+        { "profile",    RunProfileBenchmarks },
+        { "snapshots",  RunSnapshotBenchmarks },
+        { "trace",      RunTraceBenchmarks },
+        { "throughput", [&results_path](std::ostream &output) { RunThroughputBenchmarks(output, results_path); } }
+    };
+
+    // With no arguments every suite is run, otherwise only the ones named.
+    if (argc < 2)
+    {
+        for (auto &suite : suites)
+            suite.second(std::cout);
+        return 0;
+    }
+
+    for (int i = 1; i < argc; ++i)
+    {
+        auto suite = suites.find(argv[i]);
+
+        if (suite == suites.end())
+        {
+            std::cerr << "Unknown benchmark suite: " << argv[i] << '\n';
+            return 1;
+        }
+        suite->second(std::cout);
+    }
+    return 0;
+}
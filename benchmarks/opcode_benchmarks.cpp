@@ -0,0 +1,229 @@
+#include "benchmark_helpers.hpp"
+#include "opcodes.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <vector>
+
+namespace
+{
+using Engine = InstructionExecutor::Engine;
+using addressType = BenchmarkMachine::addressType;
+using i = AbstractInstruction_e;
+using m = AddressMode_e;
+
+constexpr uint32_t warm_up_cycles = 20000;
+constexpr uint32_t timed_cycles   = 4000000;
+constexpr uint32_t cycles_per_run = 10000;
+
+// Where everything goes.  Straight line code runs from code_start up to
+// code_end, then jumps back.  Indexed data accesses either stay within the
+// data page or cross into the next one, and nothing writes near the code.
+constexpr addressType code_start      = 0x0400;
+constexpr addressType code_end        = 0x1F00;
+constexpr addressType data_page       = 0x2000;
+constexpr addressType data_crossing   = 0x20F0;
+constexpr uint8_t     index_value     = 0x20;
+constexpr uint8_t     zp_operand      = 0x80;
+constexpr uint8_t     izx_operand     = 0x20; // The pointer is at $20 + X
+constexpr uint8_t     izy_operand     = 0x30;
+constexpr addressType jmp_pointer     = 0x0300;
+
+const std::vector<std::pair<Engine, const char *>> engines {
+    { Engine::Table,    "table" },
+    { Engine::Threaded, "threaded" },
+    { Engine::TailCall, "tailcall" }
+};
+
+// The flag each branch tests, and whether it branches when it is set.
+struct Branch
+{
+    uint8_t   opcode;
+    FLAGS6502 flag;
+    bool      when_set;
+};
+
+const Branch branches[] {
+    { OpcodeFor(i::BPL, m::Relative), N, false }, { OpcodeFor(i::BMI, m::Relative), N, true },
+    { OpcodeFor(i::BVC, m::Relative), V, false }, { OpcodeFor(i::BVS, m::Relative), V, true },
+    { OpcodeFor(i::BCC, m::Relative), C, false }, { OpcodeFor(i::BCS, m::Relative), C, true },
+    { OpcodeFor(i::BNE, m::Relative), Z, false }, { OpcodeFor(i::BEQ, m::Relative), Z, true }
+};
+
+enum class Variant
+{
+    Plain,
+    NoPageCross,
+    PageCross,
+    NotTaken,
+    Taken,
+    TakenPageCross
+};
+
+const char *NameOf(Variant variant)
+{
+    switch (variant)
+    {
+    case Variant::Plain:          return "";
+    case Variant::NoPageCross:    return "same page";
+    case Variant::PageCross:      return "page cross";
+    case Variant::NotTaken:       return "not taken";
+    case Variant::Taken:          return "taken";
+    case Variant::TakenPageCross: return "taken, page cross";
+    }
+    return "";
+}
+
+std::vector<Variant> VariantsOf(uint8_t opcode)
+{
+    switch (AddressModeOf(opcode))
+    {
+    case m::AbsoluteXIndexed:
+    case m::AbsoluteYIndexed:
+    case m::IndirectYIndexed:
+        return { Variant::NoPageCross, Variant::PageCross };
+    case m::Relative:
+        return { Variant::NotTaken, Variant::Taken, Variant::TakenPageCross };
+    default:
+        return { Variant::Plain };
+    }
+}
+
+// Sets things up so the CPU does nothing but execute this opcode, over and
+// over.  Most instructions are laid out one after another; the ones that
+// change the flow of control are arranged to loop back to themselves.
+void Prepare(BenchmarkMachine &machine, uint8_t opcode, Variant variant)
+{
+    const bool        crossing = (variant == Variant::PageCross);
+    const addressType data = crossing ? data_crossing : data_page;
+
+    machine.registers.x = index_value;
+    machine.registers.y = index_value;
+    machine.registers.stack_pointer = 0xFD;
+    machine.registers.status = U;
+    machine.registers.program_counter = code_start;
+
+    // Pointers for the indirect modes, and a page of stack that makes RTS
+    // return to $0405 and RTI to $0404.
+    machine.load(izx_operand + index_value, { data_page & 0xFF, data_page >> 8 });
+    machine.load(izy_operand, { static_cast<uint8_t>(data & 0xFF), static_cast<uint8_t>(data >> 8) });
+    machine.load(jmp_pointer, { code_start & 0xFF, code_start >> 8 });
+    std::fill(machine.memory.begin() + 0x0100, machine.memory.begin() + 0x0200, 0x04);
+    machine.load(0xFFFE, { code_start & 0xFF, code_start >> 8 });
+
+    if (opcode == OpcodeFor(i::JMP, m::Absolute) || opcode == OpcodeFor(i::JSR, m::Absolute))
+    {
+        machine.load(code_start, { opcode, code_start & 0xFF, code_start >> 8 });
+        return;
+    }
+    if (opcode == OpcodeFor(i::JMP, m::Indirect))
+    {
+        machine.load(code_start, { opcode, jmp_pointer & 0xFF, jmp_pointer >> 8 });
+        return;
+    }
+    if (opcode == OpcodeFor(i::BRK, m::Implied))
+    {
+        machine.load(code_start, { opcode, 0x00 });
+        return;
+    }
+    if (opcode == OpcodeFor(i::RTS, m::Implied) || opcode == OpcodeFor(i::RTI, m::Implied))
+    {
+        machine.registers.program_counter = (opcode == OpcodeFor(i::RTS, m::Implied)) ? 0x0405 : 0x0404;
+        machine.load(machine.registers.program_counter, { opcode });
+        return;
+    }
+
+    for (const Branch &branch : branches)
+        if (branch.opcode == opcode)
+        {
+            const bool taken = (variant != Variant::NotTaken);
+
+            machine.registers.status = U | ((taken == branch.when_set) ? branch.flag : 0x00);
+            if (taken)
+            {
+                // A branch back to itself.  Placed at the end of a page, the
+                // program counter has moved on to the next page by the time
+                // the branch is taken.
+                machine.registers.program_counter = (variant == Variant::TakenPageCross) ? 0x04FE : 0x0410;
+                machine.load(machine.registers.program_counter, { opcode, 0xFE });
+                return;
+            }
+            break;
+        }
+
+    const AddressMode_e mode = AddressModeOf(opcode);
+    const int           length = 1 + OperandBytesOf(mode);
+    addressType         address = code_start;
+
+    while (address + length + 3 <= code_end)
+    {
+        machine.memory[address] = opcode;
+        if ((mode == m::ZeroPage) || (mode == m::ZeroPageXIndexed) || (mode == m::ZeroPageYIndexed))
+            machine.memory[address + 1] = zp_operand;
+        else if (mode == m::XIndexedIndirect)
+            machine.memory[address + 1] = izx_operand;
+        else if (mode == m::IndirectYIndexed)
+            machine.memory[address + 1] = izy_operand;
+        else if ((mode == m::Immediate) || (mode == m::Relative))
+            machine.memory[address + 1] = 0x00;
+        else if (length == 3)
+        {
+            machine.memory[address + 1] = data & 0xFF;
+            machine.memory[address + 2] = data >> 8;
+        }
+        address += length;
+    }
+    machine.load(address, { OpcodeFor(i::JMP, m::Absolute), code_start & 0xFF, code_start >> 8 });
+}
+
+// Host time per emulated instruction: clock cycles where the host has a
+// cycle counter, nanoseconds otherwise.
+double CostPerInstruction(uint8_t opcode, Variant variant, Engine engine)
+{
+    BenchmarkMachine machine;
+
+    machine.executor.setEngine(engine);
+    Prepare(machine, opcode, variant);
+    machine.executor.run(warm_up_cycles);
+
+    const uint64_t instructions = machine.executor.instructionCount();
+    const uint64_t host_cycles = HostCycles();
+    Stopwatch      timer;
+
+    for (uint32_t elapsed = 0; elapsed < timed_cycles; )
+        elapsed += machine.executor.run(cycles_per_run);
+
+    const double cost = (host_cycles != 0) ? static_cast<double>(HostCycles() - host_cycles) : timer.elapsedNanoseconds();
+
+    return cost / (machine.executor.instructionCount() - instructions);
+}
+}
+
+
+void RunOpcodeBenchmarks(std::ostream &output)
+{
+    output << "Opcode microbenchmarks (" << ((HostCycles() != 0) ? "host cycles" : "ns")
+           << " per instruction, " << timed_cycles << " cycles each)\n";
+    output << "Opcode  Instr  Mode  Variant           ";
+    for (auto &engine : engines)
+        output << std::setw(10) << engine.second;
+    output << '\n';
+
+    for (int opcode = 0; opcode < 256; ++opcode)
+        for (Variant variant : VariantsOf(static_cast<uint8_t>(opcode)))
+        {
+            output << "  $" << std::hex << std::uppercase << std::setw(2) << std::setfill('0') << opcode
+                   << std::dec << std::setfill(' ')
+                   << "   " << MnemonicOf(static_cast<uint8_t>(opcode))
+                   << "    " << NameOf(AddressModeOf(static_cast<uint8_t>(opcode)))
+                   << "   " << std::left << std::setw(18) << NameOf(variant) << std::right;
+            for (auto &engine : engines)
+            {
+                if (InstructionExecutor::engineAvailable(engine.first))
+                    output << std::fixed << std::setprecision(1) << std::setw(10)
+                           << CostPerInstruction(static_cast<uint8_t>(opcode), variant, engine.first);
+                else
+                    output << std::setw(10) << "n/a";
+            }
+            output << '\n';
+        }
+}
@@ -0,0 +1,45 @@
+#include "benchmark_helpers.hpp"
+#include "cycleprofiler.hpp"
+#include "workloads.hpp"
+#include <iomanip>
+
+namespace
+{
+constexpr uint32_t timed_cycles = 20000000;
+
+// Emulated clock speed, in MHz, with or without profiling
+double MegahertzFor(const Workload &workload, CycleProfiler *profiler)
+{
+    BenchmarkMachine machine;
+
+    LoadWorkload(machine, workload);
+    machine.executor.setCycleProfiler(profiler);
+
+    Stopwatch timer;
+
+    RunWorkload(machine, workload, timed_cycles);
+
+    const double nanoseconds = timer.elapsedNanoseconds();
+
+    return machine.executor.clock_ticks * 1000.0 / nanoseconds;
+}
+}
+
+
+void RunProfileBenchmarks(std::ostream &output)
+{
+    output << "Profiling the cycles of every instruction (" << timed_cycles << " cycles each)\n";
+    output << "Workload    MHz profiled  slowdown\n";
+    for (const Workload &workload : StandardWorkloads())
+    {
+        CycleProfiler profiler;
+        const double  plain_megahertz = MegahertzFor(workload, nullptr);
+        const double  profiled_megahertz = MegahertzFor(workload, &profiler);
+
+        output << "  " << std::left << std::setw(8) << workload.name << std::right
+               << std::fixed << std::setprecision(2)
+               << std::setw(7) << plain_megahertz
+               << std::setw(9) << profiled_megahertz
+               << std::setw(9) << plain_megahertz / profiled_megahertz << "x\n";
+    }
+}
@@ -0,0 +1,140 @@
+#include "benchmark_helpers.hpp"
+#include "computercore.hpp"
+#include "rewindbuffer.hpp"
+#include "workloads.hpp"
+#include <iomanip>
+#include <memory>
+
+namespace
+{
+// A frame of an NTSC NES, about what a front end runs between snapshots
+constexpr uint32_t frame_cycles = 29781;
+constexpr int      frames = 600;
+
+struct Measurement
+{
+    double full_nanoseconds = 0.0;    // Per full snapshot
+    double delta_nanoseconds = 0.0;   // Per delta
+    double delta_bytes = 0.0;         // Per delta
+    double restore_nanoseconds = 0.0; // A base and every delta after it
+};
+
+Measurement MeasureSnapshots(const Workload &workload)
+{
+    Measurement                measurement;
+    ComputerCore               computer;
+    auto                       base = std::make_unique<MachineSnapshot>();
+    std::vector<DeltaSnapshot> deltas(frames);
+    size_t                     bytes = 0;
+    double                     delta_nanoseconds = 0.0;
+
+    LoadWorkload(computer.cpu(), computer.ram().memory(), workload);
+    RunWorkload(computer.cpu(), workload, frame_cycles);
+
+    Stopwatch timer;
+
+    for (int i = 0; i < frames; ++i)
+        computer.saveState(*base);
+    measurement.full_nanoseconds = timer.elapsedNanoseconds() / frames;
+
+    for (DeltaSnapshot &delta : deltas)
+    {
+        RunWorkload(computer.cpu(), workload, frame_cycles);
+        timer.restart();
+        computer.saveDelta(delta);
+        delta_nanoseconds += timer.elapsedNanoseconds();
+        bytes += delta.size();
+    }
+    measurement.delta_nanoseconds = delta_nanoseconds / frames;
+    measurement.delta_bytes = static_cast<double>(bytes) / frames;
+
+    timer.restart();
+    computer.restoreState(*base, deltas);
+    measurement.restore_nanoseconds = timer.elapsedNanoseconds();
+    return measurement;
+}
+
+struct RewindMeasurement
+{
+    double push_nanoseconds = 0.0;    // Per snapshot, including taking it
+    double bytes = 0.0;               // Per snapshot, compressed
+    double restore_nanoseconds = 0.0; // Per snapshot, back into the computer
+};
+
+RewindMeasurement MeasureRewind(const Workload &workload)
+{
+    RewindMeasurement measurement;
+    ComputerCore      computer;
+    RewindBuffer      rewind;
+    auto              snapshot = std::make_unique<MachineSnapshot>();
+    double            push_nanoseconds = 0.0;
+
+    // Enough budget that nothing gets dropped
+    rewind.setInterval(frame_cycles);
+    rewind.setBudget(static_cast<size_t>(frames) * sizeof(MachineSnapshot));
+    LoadWorkload(computer.cpu(), computer.ram().memory(), workload);
+    RunWorkload(computer.cpu(), workload, frame_cycles);
+
+    Stopwatch timer;
+
+    for (int i = 0; i < frames; ++i)
+    {
+        RunWorkload(computer.cpu(), workload, frame_cycles);
+        timer.restart();
+        computer.saveState(*snapshot);
+        snapshot->cycle = static_cast<uint64_t>(i) * frame_cycles; // The workloads run the CPU, not the scheduler
+        rewind.push(*snapshot);
+        push_nanoseconds += timer.elapsedNanoseconds();
+    }
+    measurement.push_nanoseconds = push_nanoseconds / frames;
+    measurement.bytes = static_cast<double>(rewind.bytes()) / static_cast<double>(rewind.count());
+
+    // Newest first, as stepping back would
+    timer.restart();
+    for (int i = frames - 1; i >= 0; --i)
+    {
+        rewind.restore(static_cast<uint64_t>(i) * frame_cycles, *snapshot);
+        computer.restoreState(*snapshot);
+    }
+    measurement.restore_nanoseconds = timer.elapsedNanoseconds() / frames;
+    return measurement;
+}
+}
+
+
+void RunSnapshotBenchmarks(std::ostream &output)
+{
+    output << "Snapshots (a delta every " << frame_cycles << " cycles, " << frames << " of them)\n";
+    output << "Workload    full us  delta us  delta bytes  restore all us\n";
+
+    for (const Workload &workload : StandardWorkloads())
+    {
+        const Measurement measurement = MeasureSnapshots(workload);
+
+        output << "  " << std::left << std::setw(8) << workload.name << std::right
+               << std::fixed << std::setprecision(2)
+               << std::setw(9) << measurement.full_nanoseconds / 1000.0
+               << std::setw(10) << measurement.delta_nanoseconds / 1000.0
+               << std::setprecision(0)
+               << std::setw(13) << measurement.delta_bytes
+               << std::setprecision(2)
+               << std::setw(16) << measurement.restore_nanoseconds / 1000.0 << '\n';
+    }
+
+    output << "\nRewind (a snapshot every " << frame_cycles << " cycles, a keyframe every "
+           << RewindBuffer::default_keyframe_interval << ", XORed and compressed)\n";
+    output << "Workload    push us  bytes each  restore us\n";
+
+    for (const Workload &workload : StandardWorkloads())
+    {
+        const RewindMeasurement measurement = MeasureRewind(workload);
+
+        output << "  " << std::left << std::setw(8) << workload.name << std::right
+               << std::fixed << std::setprecision(2)
+               << std::setw(9) << measurement.push_nanoseconds / 1000.0
+               << std::setprecision(0)
+               << std::setw(12) << measurement.bytes
+               << std::setprecision(2)
+               << std::setw(12) << measurement.restore_nanoseconds / 1000.0 << '\n';
+    }
+}
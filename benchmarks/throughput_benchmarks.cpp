@@ -0,0 +1,110 @@
+#include "benchmark_helpers.hpp"
+#include "computercore.hpp"
+#include "workloads.hpp"
+#include <fstream>
+#include <iomanip>
+
+namespace
+{
+using Engine = InstructionExecutor::Engine;
+
+constexpr uint32_t timed_cycles = 20000000;
+
+const std::vector<std::pair<Engine, const char *>> engines {
+    { Engine::Table,    "table" },
+    { Engine::Threaded, "threaded" },
+    { Engine::TailCall, "tailcall" }
+};
+
+// How the CPU reaches memory: straight into an array, or through the
+// SystemBus and its devices as ComputerCore does.
+enum class BusMode
+{
+    Direct,
+    SystemBus
+};
+
+const std::vector<std::pair<BusMode, const char *>> bus_modes {
+    { BusMode::Direct,    "direct" },
+    { BusMode::SystemBus, "bus" }
+};
+
+struct Measurement
+{
+    uint64_t cycles = 0;
+    uint64_t instructions = 0;
+    double   nanoseconds = 0.0;
+
+    double megahertz() const { return cycles * 1000.0 / nanoseconds; }
+    double nanosecondsPerInstruction() const { return nanoseconds / instructions; }
+};
+
+Measurement Measure(InstructionExecutor &cpu, const Workload &workload)
+{
+    Measurement measurement;
+    Stopwatch   timer;
+
+    RunWorkload(cpu, workload, timed_cycles);
+    measurement.nanoseconds = timer.elapsedNanoseconds();
+    measurement.cycles = cpu.clock_ticks;
+    measurement.instructions = cpu.instructionCount();
+    return measurement;
+}
+
+Measurement MeasureOn(const Workload &workload, Engine engine, BusMode mode)
+{
+    if (mode == BusMode::Direct)
+    {
+        BenchmarkMachine machine;
+
+        machine.executor.setEngine(engine);
+        LoadWorkload(machine, workload);
+        return Measure(machine.executor, workload);
+    }
+
+    ComputerCore computer;
+
+    computer.cpu().setEngine(engine);
+    LoadWorkload(computer.cpu(), computer.ram().memory(), workload);
+    return Measure(computer.cpu(), workload);
+}
+}
+
+
+void RunThroughputBenchmarks(std::ostream &output, const std::string &results_path)
+{
+    std::ofstream results(results_path);
+
+    if (results)
+        results << std::fixed << "workload,engine,bus,cycles,instructions,nanoseconds,mhz,ns_per_instruction\n";
+
+    output << "Throughput (" << timed_cycles << " cycles each)\n";
+    output << "Workload    Engine    Bus          MHz  ns/instr\n";
+    for (const Workload &workload : StandardWorkloads())
+        for (auto &engine : engines)
+        {
+            if (!InstructionExecutor::engineAvailable(engine.first))
+                continue;
+
+            for (auto &mode : bus_modes)
+            {
+                Measurement measurement = MeasureOn(workload, engine.first, mode.first);
+
+                output << "  " << std::left << std::setw(10) << workload.name
+                       << std::setw(10) << engine.second << std::setw(6) << mode.second << std::right
+                       << std::fixed << std::setprecision(2) << std::setw(10) << measurement.megahertz()
+                       << std::setw(10) << measurement.nanosecondsPerInstruction() << '\n';
+                if (results)
+                    results << workload.name << ',' << engine.second << ',' << mode.second << ','
+                            << measurement.cycles << ',' << measurement.instructions << ','
+                            << std::setprecision(0) << measurement.nanoseconds << ','
+                            << std::setprecision(3) << measurement.megahertz() << ','
+                            << std::setprecision(3) << measurement.nanosecondsPerInstruction() << '\n';
+            }
+        }
+
+    if (results)
+        output << "Results written to " << results_path << '\n';
+    else
+        output << "Could not write the results to " << results_path << '\n';
+}
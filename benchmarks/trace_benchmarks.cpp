@@ -0,0 +1,81 @@
+#include "benchmark_helpers.hpp"
+#include "tracerecorder.hpp"
+#include "workloads.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <iomanip>
+
+namespace
+{
+constexpr uint32_t timed_cycles = 20000000;
+
+struct Measurement
+{
+    double   plain_megahertz = 0.0;
+    double   raw_megahertz = 0.0;
+    double   compact_megahertz = 0.0;
+    uint64_t raw_bytes = 0;
+    uint64_t compact_bytes = 0;
+};
+
+// Emulated clock speed, in MHz, with or without a trace being written to path
+double MegahertzFor(const Workload &workload, const std::string &path, TraceRecorder::Format format, uint64_t *bytes = nullptr)
+{
+    BenchmarkMachine machine;
+    TraceRecorder    recorder;
+    std::string      error;
+
+    LoadWorkload(machine, workload);
+    if (!path.empty())
+    {
+        if (!recorder.start(path, error, format))
+            return 0.0;
+        machine.executor.setTraceRecorder(&recorder);
+    }
+
+    // Waiting for the last of the trace to be written is part of the cost
+    Stopwatch timer;
+
+    RunWorkload(machine, workload, timed_cycles);
+    recorder.stop(error);
+
+    const double nanoseconds = timer.elapsedNanoseconds();
+
+    if (bytes)
+        *bytes = std::filesystem::file_size(path);
+    return machine.executor.clock_ticks * 1000.0 / nanoseconds;
+}
+
+Measurement Measure(const Workload &workload, const std::string &path)
+{
+    Measurement measurement;
+
+    measurement.plain_megahertz = MegahertzFor(workload, std::string(), TraceRecorder::Format::Raw);
+    measurement.raw_megahertz = MegahertzFor(workload, path, TraceRecorder::Format::Raw, &measurement.raw_bytes);
+    measurement.compact_megahertz = MegahertzFor(workload, path, TraceRecorder::Format::Compact, &measurement.compact_bytes);
+    std::remove(path.c_str());
+    return measurement;
+}
+}
+
+
+void RunTraceBenchmarks(std::ostream &output)
+{
+    const std::string path = (std::filesystem::temp_directory_path() / "benchmark.trace").string();
+
+    output << "Tracing every instruction to " << path << " (" << timed_cycles << " cycles each)\n";
+    output << "Workload    MHz     raw compact  slowdown  raw MB  smaller\n";
+    for (const Workload &workload : StandardWorkloads())
+    {
+        const Measurement measurement = Measure(workload, path);
+
+        output << "  " << std::left << std::setw(8) << workload.name << std::right
+               << std::fixed << std::setprecision(2)
+               << std::setw(7) << measurement.plain_megahertz
+               << std::setw(8) << measurement.raw_megahertz
+               << std::setw(8) << measurement.compact_megahertz
+               << std::setw(9) << measurement.plain_megahertz / measurement.compact_megahertz << 'x'
+               << std::setprecision(0) << std::setw(8) << measurement.raw_bytes / 1e6
+               << std::setprecision(1) << std::setw(8) << double(measurement.raw_bytes) / measurement.compact_bytes << "x\n";
+    }
+}
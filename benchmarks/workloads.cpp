@@ -0,0 +1,272 @@
+#include "workloads.hpp"
+#include "scheduler.hpp"
+#include <algorithm>
+#include <functional>
+
+
+const std::vector<Workload> &StandardWorkloads()
+{
+    static const std::vector<Workload> workloads
+    {
+        // The multiplication loop Computer::loadProgram() runs, repeated forever.
+        { "multiply", 0x0400, {
+            0xA2, 0x0A,             //        LDX #10
+            0x8E, 0x00, 0x00,       //        STX $0000
+            0xA2, 0x03,             //        LDX #3
+            0x8E, 0x01, 0x00,       //        STX $0001
+            0xAC, 0x00, 0x00,       //        LDY $0000
+            0xA9, 0x00,             //        LDA #0
+            0x18,                   //        CLC
+            0x6D, 0x01, 0x00,       // loop:  ADC $0001
+            0x88,                   //        DEY
+            0xD0, 0xFA,             //        BNE loop
+            0x8D, 0x02, 0x00,       //        STA $0002
+            0x4C, 0x00, 0x04        //        JMP $0400
+        } },
+        // Nested countdown loops.
+        { "delay", 0x0400, {
+            0xA0, 0x10,             //        LDY #$10
+            0xA2, 0x00,             // outer: LDX #$00
+            0xCA,                   // inner: DEX
+            0xD0, 0xFD,             //        BNE inner
+            0x88,                   //        DEY
+            0xD0, 0xF8,             //        BNE outer
+            0x4C, 0x00, 0x04        //        JMP $0400
+        } },
+        // Counts a zero page location up until it wraps.
+        { "counter", 0x0400, {
+            0xA9, 0x00,             //        LDA #$00
+            0x85, 0x10,             //        STA $10
+            0xE6, 0x10,             // loop:  INC $10
+            0xD0, 0xFC,             //        BNE loop
+            0x4C, 0x00, 0x04        //        JMP $0400
+        } },
+        // Looks for a byte that isn't there.
+        { "search", 0x0400, {
+            0xA2, 0x00,             //        LDX #$00
+            0xBD, 0x00, 0x02,       // loop:  LDA $0200,X
+            0xC9, 0xFF,             //        CMP #$FF
+            0xF0, 0x03,             //        BEQ found
+            0xE8,                   //        INX
+            0xD0, 0xF6,             //        BNE loop
+            0x4C, 0x00, 0x04        // found: JMP $0400
+        } },
+        // Fills a page.
+        { "fill", 0x0400, {
+            0xA0, 0x00,             //        LDY #$00
+            0xA9, 0x55,             // loop:  LDA #$55
+            0x99, 0x00, 0x03,       //        STA $0300,Y
+            0xC8,                   //        INY
+            0xD0, 0xF8,             //        BNE loop
+            0x4C, 0x00, 0x04        //        JMP $0400
+        } },
+        // Copies 1K from $2000 to $3000 through zero page pointers.
+        { "memcpy", 0x0400, {
+            0xA9, 0x00,             //        LDA #$00
+            0x85, 0x10,             //        STA $10
+            0x85, 0x12,             //        STA $12
+            0xA9, 0x20,             //        LDA #$20
+            0x85, 0x11,             //        STA $11
+            0xA9, 0x30,             //        LDA #$30
+            0x85, 0x13,             //        STA $13
+            0xA2, 0x04,             //        LDX #4
+            0xA0, 0x00,             //        LDY #0
+            0xB1, 0x10,             // loop:  LDA ($10),Y
+            0x91, 0x12,             //        STA ($12),Y
+            0xC8,                   //        INY
+            0xD0, 0xF9,             //        BNE loop
+            0xE6, 0x11,             //        INC $11
+            0xE6, 0x13,             //        INC $13
+            0xCA,                   //        DEX
+            0xD0, 0xF2,             //        BNE loop
+            0x4C, 0x00, 0x04        //        JMP $0400
+        } },
+        // The sieve of Eratosthenes, leaving a 1 at $2000 + n for every prime n < 256.
+        { "sieve", 0x0400, {
+            0xA2, 0x00,             //        LDX #0
+            0xA9, 0x01,             //        LDA #1
+            0x9D, 0x00, 0x20,       // clear: STA $2000,X
+            0xE8,                   //        INX
+            0xD0, 0xFA,             //        BNE clear
+            0xA2, 0x02,             //        LDX #2
+            0xBD, 0x00, 0x20,       // next:  LDA $2000,X
+            0xF0, 0x12,             //        BEQ skip
+            0x8A,                   //        TXA
+            0x86, 0x10,             //        STX $10
+            0x18,                   // mark:  CLC
+            0x65, 0x10,             //        ADC $10
+            0xB0, 0x0A,             //        BCS skip
+            0xA8,                   //        TAY
+            0xA9, 0x00,             //        LDA #0
+            0x99, 0x00, 0x20,       //        STA $2000,Y
+            0x98,                   //        TYA
+            0x4C, 0x14, 0x04,       //        JMP mark
+            0xE8,                   // skip:  INX
+            0xD0, 0xE6,             //        BNE next
+            0x4C, 0x00, 0x04        //        JMP $0400
+        } },
+        // Bubble sorts 64 scrambled bytes at $2000.
+        { "sort", 0x0400, {
+            0xA2, 0x3F,             //        LDX #63
+            0x8A,                   // fill:  TXA
+            0x49, 0x5A,             //        EOR #$5A
+            0x9D, 0x00, 0x20,       //        STA $2000,X
+            0xCA,                   //        DEX
+            0x10, 0xF7,             //        BPL fill
+            0xA9, 0x00,             // pass:  LDA #0
+            0x85, 0x10,             //        STA $10
+            0xA2, 0x00,             //        LDX #0
+            0xBD, 0x00, 0x20,       // cmp:   LDA $2000,X
+            0xDD, 0x01, 0x20,       //        CMP $2001,X
+            0x90, 0x0F,             //        BCC next
+            0xF0, 0x0D,             //        BEQ next
+            0xA8,                   //        TAY
+            0xBD, 0x01, 0x20,       //        LDA $2001,X
+            0x9D, 0x00, 0x20,       //        STA $2000,X
+            0x98,                   //        TYA
+            0x9D, 0x01, 0x20,       //        STA $2001,X
+            0xE6, 0x10,             //        INC $10
+            0xE8,                   // next:  INX
+            0xE0, 0x3F,             //        CPX #63
+            0xD0, 0xE4,             //        BNE cmp
+            0xA5, 0x10,             //        LDA $10
+            0xD0, 0xDA,             //        BNE pass
+            0x4C, 0x00, 0x04        //        JMP $0400
+        } },
+        // The bitwise CRC-32 of the bytes 0 to 255, left at $14-$17.
+        { "crc32", 0x0400, {
+            0xA2, 0x00,             //        LDX #0
+            0x8A,                   // fill:  TXA
+            0x9D, 0x00, 0x20,       //        STA $2000,X
+            0xE8,                   //        INX
+            0xD0, 0xF9,             //        BNE fill
+            0xA9, 0xFF,             //        LDA #$FF
+            0x85, 0x10,             //        STA $10
+            0x85, 0x11,             //        STA $11
+            0x85, 0x12,             //        STA $12
+            0x85, 0x13,             //        STA $13
+            0xA2, 0x00,             //        LDX #0
+            0xBD, 0x00, 0x20,       // byte:  LDA $2000,X
+            0x45, 0x10,             //        EOR $10
+            0x85, 0x10,             //        STA $10
+            0xA0, 0x08,             //        LDY #8
+            0x46, 0x13,             // bit:   LSR $13
+            0x66, 0x12,             //        ROR $12
+            0x66, 0x11,             //        ROR $11
+            0x66, 0x10,             //        ROR $10
+            0x90, 0x18,             //        BCC noxor
+            0xA5, 0x13,             //        LDA $13
+            0x49, 0xED,             //        EOR #$ED
+            0x85, 0x13,             //        STA $13
+            0xA5, 0x12,             //        LDA $12
+            0x49, 0xB8,             //        EOR #$B8
+            0x85, 0x12,             //        STA $12
+            0xA5, 0x11,             //        LDA $11
+            0x49, 0x83,             //        EOR #$83
+            0x85, 0x11,             //        STA $11
+            0xA5, 0x10,             //        LDA $10
+            0x49, 0x20,             //        EOR #$20
+            0x85, 0x10,             //        STA $10
+            0x88,                   // noxor: DEY
+            0xD0, 0xDB,             //        BNE bit
+            0xE8,                   //        INX
+            0xD0, 0xCF,             //        BNE byte
+            0xA2, 0x03,             //        LDX #3
+            0xB5, 0x10,             // final: LDA $10,X
+            0x49, 0xFF,             //        EOR #$FF
+            0x95, 0x14,             //        STA $14,X
+            0xCA,                   //        DEX
+            0x10, 0xF7,             //        BPL final
+            0x4C, 0x00, 0x04        //        JMP $0400
+        } },
+        // Decimal mode arithmetic: a four digit BCD counter going up in
+        // sevens, and another byte counting down in threes.  The carry into
+        // the high byte is explicit, as decimal ADC here ignores carry in.
+        { "bcd", 0x0400, {
+            0xF8,                   //        SED
+            0xA9, 0x00,             //        LDA #0
+            0x85, 0x10,             //        STA $10
+            0x85, 0x11,             //        STA $11
+            0x18,                   // loop:  CLC
+            0xA5, 0x10,             //        LDA $10
+            0x69, 0x07,             //        ADC #$07
+            0x85, 0x10,             //        STA $10
+            0x90, 0x07,             //        BCC down
+            0x18,                   //        CLC
+            0xA5, 0x11,             //        LDA $11
+            0x69, 0x01,             //        ADC #$01
+            0x85, 0x11,             //        STA $11
+            0x38,                   // down:  SEC
+            0xA5, 0x12,             //        LDA $12
+            0xE9, 0x03,             //        SBC #$03
+            0x85, 0x12,             //        STA $12
+            0xA5, 0x11,             //        LDA $11
+            0xC9, 0x99,             //        CMP #$99
+            0xD0, 0xE3,             //        BNE loop
+            0xD8,                   //        CLD
+            0x4C, 0x00, 0x04        //        JMP $0400
+        } },
+        // Counts in the foreground, with an interrupt every 100 cycles.
+        { "irq", 0x0400, {
+            0x58,                   //        CLI
+            0xE6, 0x30,             // loop:  INC $30
+            0xA5, 0x30,             //        LDA $30
+            0x18,                   //        CLC
+            0x69, 0x01,             //        ADC #1
+            0x85, 0x31,             //        STA $31
+            0x4C, 0x01, 0x04        //        JMP loop
+          },
+          100, 0x0500, {
+            0x48,                   //        PHA
+            0xBA,                   //        TSX
+            0xBD, 0x02, 0x01,       //        LDA $0102,X
+            0x29, 0xFB,             //        AND #$FB
+            0x9D, 0x02, 0x01,       //        STA $0102,X  (RTI leaves interrupts enabled)
+            0xE6, 0x20,             //        INC $20
+            0x68,                   //        PLA
+            0x40                    //        RTI
+        } },
+    };
+
+    return workloads;
+}
+
+void LoadWorkload(InstructionExecutor &cpu, BenchmarkMachine::memory_type &memory, const Workload &workload)
+{
+    std::copy(workload.code.begin(), workload.code.end(), memory.begin() + workload.origin);
+    if (workload.irq_interval)
+    {
+        std::copy(workload.irq_handler.begin(), workload.irq_handler.end(), memory.begin() + workload.irq_vector);
+        memory[0xFFFE] = workload.irq_vector & 0xFF;
+        memory[0xFFFF] = workload.irq_vector >> 8;
+    }
+    cpu.registers().program_counter = workload.origin;
+    cpu.registers().stack_pointer = 0xFD;
+}
+
+void LoadWorkload(BenchmarkMachine &machine, const Workload &workload)
+{
+    LoadWorkload(machine.executor, machine.memory, workload);
+}
+
+void RunWorkload(InstructionExecutor &cpu, const Workload &workload, uint32_t cycles)
+{
+    constexpr uint32_t cycles_per_run = 10000;
+
+    Scheduler             scheduler(cpu);
+    std::function<void()> interrupt = [&]()
+    {
+        cpu.irq();
+        scheduler.schedule(workload.irq_interval, interrupt);
+    };
+
+    if (workload.irq_interval)
+        scheduler.schedule(workload.irq_interval, interrupt);
+    for (uint32_t elapsed = 0; elapsed < cycles; )
+        elapsed += scheduler.run(cycles_per_run);
+}
+
+void RunWorkload(BenchmarkMachine &machine, const Workload &workload, uint32_t cycles)
+{
+    RunWorkload(machine.executor, workload, cycles);
+}
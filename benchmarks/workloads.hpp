@@ -0,0 +1,57 @@
+#ifndef WORKLOADS_HPP
+#define WORKLOADS_HPP
+
+#include "benchmark_helpers.hpp"
+#include <utility>
+#include <vector>
+
+
+/** A small 6502 program that loops forever, for measuring the emulator with.
+ *
+ */
+struct Workload
+{
+    using addressType = InstructionExecutor::addressType;
+
+    Workload(const char *name, addressType origin, std::vector<uint8_t> code,
+             uint32_t irq_interval = 0, addressType irq_vector = 0x0000, std::vector<uint8_t> irq_handler = {})
+        :
+        name(name),
+        origin(origin),
+        code(std::move(code)),
+        irq_interval(irq_interval),
+        irq_vector(irq_vector),
+        irq_handler(std::move(irq_handler))
+    {
+    }
+
+    const char          *name;
+    addressType          origin; ///< Where the code is loaded, and where execution starts
+    std::vector<uint8_t> code;
+    uint32_t             irq_interval; ///< Clock ticks between interrupts, or 0 for none
+    addressType          irq_vector;
+    std::vector<uint8_t> irq_handler; ///< Loaded at irq_vector
+};
+
+/** The programs every engine and configuration gets measured against.
+ *
+ */
+const std::vector<Workload> &StandardWorkloads();
+
+/** Copies the workload into @p memory, and points the CPU at it.
+ *
+ */
+///@{
+void LoadWorkload(InstructionExecutor &cpu, BenchmarkMachine::memory_type &memory, const Workload &workload);
+void LoadWorkload(BenchmarkMachine &machine, const Workload &workload);
+///@}
+
+/** Runs the CPU for at least @p cycles clock ticks, in batches the size a
+ *  front end would typically use, raising the workload's interrupts.
+ */
+///@{
+void RunWorkload(InstructionExecutor &cpu, const Workload &workload, uint32_t cycles);
+void RunWorkload(BenchmarkMachine &machine, const Workload &workload, uint32_t cycles);
+///@}
+
+#endif // WORKLOADS_HPP
@@ -0,0 +1,8 @@
+#include "accesscounters.hpp"
+#include <algorithm>
+
+
+void AccessCounters::clear()
+{
+    std::fill(_counts.begin(), _counts.end(), 0);
+}
@@ -0,0 +1,62 @@
+#ifndef ACCESSCOUNTERS_HPP
+#define ACCESSCOUNTERS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/** How many times each byte of the address space has been read, written
+ *  and executed.
+ *
+ *  A counter per address for each kind of access, in flat arrays, so
+ *  counting one is a single increment.  The counts wrap round rather than
+ *  stick at the top: whatever watches them, like AccessHeatmap, looks at
+ *  how far they have gone up since it last looked.
+ *
+ *  Executing counts the opcode and each operand byte.  Like CoverageMap,
+ *  fetching them isn't counted as reading, though using an immediate
+ *  operand is.
+ */
+class AccessCounters
+{
+public:
+    using addressType = uint16_t;
+    using countType   = uint32_t;
+
+    enum Access
+    {
+        Read,
+        Write,
+        Execute
+    };
+
+    static constexpr size_t accesses = 3;
+    static constexpr size_t size = 64 * 1024;
+
+    AccessCounters() : _counts(accesses * size, 0) { }
+
+    void record(Access access, addressType address) { ++_counts[access * size + address]; }
+
+    /** Counts an instruction of @p operand_bytes operands, starting at
+     *  @p address, as executed.
+     *
+     */
+    void recordInstruction(addressType address, uint8_t operand_bytes)
+    {
+        countType *executed = &_counts[Execute * size];
+
+        for (uint8_t i = 0; i <= operand_bytes; ++i)
+            ++executed[static_cast<addressType>(address + i)];
+    }
+
+    countType count(Access access, addressType address) const { return _counts[access * size + address]; }
+    const countType *data(Access access) const { return &_counts[access * size]; } ///< The counts of every address, from 0
+
+    void clear();
+
+private:
+    std::vector<countType> _counts; // Every address for each kind of access in turn
+};
+
+#endif // ACCESSCOUNTERS_HPP
@@ -0,0 +1,78 @@
+#include "accessheatmap.hpp"
+#include <algorithm>
+#include <cmath>
+
+
+namespace
+{
+constexpr size_t size = AccessCounters::size;
+
+// Brightness goes up by 32 each time the accesses double, so one access
+// shows and a couple of hundred saturate
+uint32_t Level(float heat)
+{
+    if (heat <= 0.0f)
+        return 0;
+    return static_cast<uint32_t>(std::min(255.0f, 32.0f * std::log2(1.0f + heat)));
+}
+
+// Heat that has cooled to below what shows at all
+constexpr float cold = 0.02f;
+}
+
+
+AccessHeatmap::AccessHeatmap(double half_life)
+    :
+    _half_life(std::max(half_life, 0.0)),
+    _seen(AccessCounters::accesses * size, 0),
+    _heat(AccessCounters::accesses * size, 0.0f),
+    _pixels(size, 0xFF000000)
+{
+}
+
+void AccessHeatmap::setHalfLife(double seconds)
+{
+    _half_life = std::max(seconds, 0.0);
+}
+
+bool AccessHeatmap::update(const AccessCounters &counters, double elapsed)
+{
+    const float cooling = (_half_life > 0.0) ? static_cast<float>(std::exp2(-std::max(elapsed, 0.0) / _half_life)) : 0.0f;
+    bool        warm = false;
+
+    for (size_t access = 0; access < AccessCounters::accesses; ++access)
+    {
+        const AccessCounters::countType *counts = counters.data(static_cast<AccessCounters::Access>(access));
+        AccessCounters::countType       *seen = &_seen[access * size];
+        float                           *heat = &_heat[access * size];
+
+        for (size_t address = 0; address < size; ++address)
+        {
+            // Unsigned, so a counter that has wrapped round still comes out right
+            const AccessCounters::countType added = _primed ? counts[address] - seen[address] : 0;
+
+            seen[address] = counts[address];
+            heat[address] = heat[address] * cooling + static_cast<float>(added);
+            if (heat[address] < cold)
+                heat[address] = 0.0f;
+            else
+                warm = true;
+        }
+    }
+    _primed = true;
+
+    const float *read    = &_heat[AccessCounters::Read * size];
+    const float *written = &_heat[AccessCounters::Write * size];
+    const float *execute = &_heat[AccessCounters::Execute * size];
+
+    for (size_t address = 0; address < size; ++address)
+        _pixels[address] = 0xFF000000 | (Level(written[address]) << 16) | (Level(read[address]) << 8) | Level(execute[address]);
+    return warm;
+}
+
+void AccessHeatmap::clear()
+{
+    _primed = false;
+    std::fill(_heat.begin(), _heat.end(), 0.0f);
+    std::fill(_pixels.begin(), _pixels.end(), 0xFF000000);
+}
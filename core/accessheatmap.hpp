@@ -0,0 +1,61 @@
+#ifndef ACCESSHEATMAP_HPP
+#define ACCESSHEATMAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "accesscounters.hpp"
+
+
+/** A picture of the address space, a pixel per byte, glowing where it has
+ *  lately been read, written and executed.
+ *
+ *  It is meant to be brought up to date now and then, once a frame say,
+ *  rather than on every access: update() takes how far each counter in
+ *  AccessCounters has gone up since the time before, and adds that to the
+ *  heat of the address after cooling what was there.  Heat halves every
+ *  halfLife() seconds.
+ *
+ *  The pixels are laid out a page to a row, 256 by 256, as 0xFFRRGGBB:
+ *  writes are red, reads green and executing blue, each brighter the more
+ *  accesses it has had, on a log scale.
+ */
+class AccessHeatmap
+{
+public:
+    using addressType = AccessCounters::addressType;
+
+    static constexpr int width  = 256;
+    static constexpr int height = 256;
+
+    explicit AccessHeatmap(double half_life = 0.5);
+
+    double halfLife() const { return _half_life; }
+    void   setHalfLife(double seconds);
+
+    /** Cools the heat by @p elapsed seconds, then adds the accesses in
+     *  @p counters since the last update, and redraws pixels().
+     *
+     *  The first update after construction or clear() only takes note of
+     *  where the counters are.
+     *
+     *  @return Whether anything is still warm, so is worth updating again
+     *          even if nothing more is counted
+     */
+    bool update(const AccessCounters &counters, double elapsed);
+
+    float    heat(AccessCounters::Access access, addressType address) const { return _heat[access * AccessCounters::size + address]; }
+    uint32_t pixel(addressType address) const { return _pixels[address]; }
+    const uint32_t *pixels() const { return _pixels.data(); } ///< A row of width() for each page, from 0
+
+    void clear(); ///< Cools everything at once
+
+private:
+    double _half_life;
+    bool   _primed = false;
+    std::vector<AccessCounters::countType> _seen; // The counters as they were at the last update
+    std::vector<float>    _heat;
+    std::vector<uint32_t> _pixels;
+};
+
+#endif // ACCESSHEATMAP_HPP
@@ -0,0 +1,101 @@
+#include "busdevice.hpp"
+#include <algorithm>
+#include <cstring>
+
+
+namespace
+{
+constexpr size_t address_space = 64 * 1024;
+
+/** Calls @p access with the part of each pass through the address space
+ *  that lies between @p lower and @p upper, and with how far into the block
+ *  that part starts.  @p outside gets the rest.
+ */
+template <typename Access, typename Outside>
+void ForEachPart(uint32_t address, size_t length, uint32_t lower, uint32_t upper, Access access, Outside outside)
+{
+    size_t offset = 0;
+
+    while (length > 0)
+    {
+        const size_t   pass = std::min(length, address_space - address);
+        const uint32_t first = std::max(address, lower);
+        const uint32_t last = std::min<uint32_t>(static_cast<uint32_t>(address + pass - 1), upper);
+
+        if (first <= last)
+        {
+            outside(offset, first - address);
+            access(static_cast<BusDevice::addressType>(first), offset + (first - address), last - first + 1);
+            outside(offset + (last + 1 - address), address + pass - (last + 1));
+        }
+        else
+            outside(offset, pass);
+        offset += pass;
+        length -= pass;
+        address = 0;
+    }
+}
+}
+
+
+BusDevice::BusDevice(addressType lower_address,
+                     addressType upper_address,
+                     bool        writable,
+                     bool        readable)
+    :
+    _lower_address_range(lower_address),
+    _upper_address_range(upper_address),
+    _writable(writable),
+    _readable(readable)
+{
+}
+
+BusDevice::~BusDevice()
+{
+}
+
+void BusDevice::write(addressType address, uint8_t data)
+{
+    if (handlesAddress(address) && writable())
+        writeImplementation(address, data);
+}
+
+uint8_t BusDevice::read(addressType address, bool read_only)
+{
+    if (handlesAddress(address) && readable())
+        return readImplementation(address, read_only);
+    return 0x00;
+}
+
+void BusDevice::writeBlock(addressType address, const uint8_t *data, size_t length)
+{
+    if (!writable())
+        return;
+    ForEachPart(address, length, _lower_address_range, _upper_address_range,
+                [&](addressType start, size_t offset, size_t count) { writeBlockImplementation(start, data + offset, count); },
+                [](size_t, size_t) { });
+}
+
+void BusDevice::readBlock(addressType address, uint8_t *data, size_t length, bool read_only)
+{
+    if (!readable())
+    {
+        std::memset(data, 0x00, length);
+        return;
+    }
+    ForEachPart(address, length, _lower_address_range, _upper_address_range,
+                [&](addressType start, size_t offset, size_t count) { readBlockImplementation(start, data + offset, count, read_only); },
+                [&](size_t offset, size_t count) { std::memset(data + offset, 0x00, count); });
+}
+
+void BusDevice::writeBlockImplementation(addressType address, const uint8_t *data, size_t length)
+{
+    for (size_t i = 0; i < length; ++i)
+        writeImplementation(static_cast<addressType>(address + i), data[i]);
+}
+
+void BusDevice::readBlockImplementation(addressType address, uint8_t *data, size_t length, bool read_only)
+{
+    for (size_t i = 0; i < length; ++i)
+        data[i] = readImplementation(static_cast<addressType>(address + i), read_only);
+}
@@ -0,0 +1,81 @@
+#ifndef BUSDEVICE_HPP
+#define BUSDEVICE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+
+/** Something connected to the bus, answering for a range of addresses.
+ *
+ *  This is plain C++, so it can be used without Qt.  IBusDevice makes one
+ *  available to QML.
+ */
+class BusDevice
+{
+public:
+    using addressType = uint16_t;
+
+    BusDevice(addressType lower_address,
+              addressType upper_address,
+              bool writable,
+              bool readable);
+    BusDevice(const BusDevice &) = delete;
+    virtual ~BusDevice() = 0;
+
+    bool writable() const { return _writable; }
+    bool readable() const { return _readable; }
+
+    addressType lowerAddress() const { return _lower_address_range; }
+    addressType upperAddress() const { return _upper_address_range; }
+
+    bool handlesAddress(addressType address) const
+    {
+        return (address >= _lower_address_range) && (address <= _upper_address_range);
+    }
+
+    /** Accesses the device.
+     *
+     *  Addresses outside the device's range, writes to a device that isn't
+     *  writable and reads from one that isn't readable are ignored (reads
+     *  give 0x00).
+     */
+    ///@{
+    void    write(addressType address, uint8_t data);
+    uint8_t read(addressType address, bool read_only);
+    ///@}
+
+    /** Accesses @p length bytes at once, starting at @p address.
+     *
+     *  The same as accessing them one at a time, only quicker for devices
+     *  that can copy a block: bytes outside the device's range are ignored
+     *  (reads give 0x00), and anything past the end of the address space
+     *  wraps around to the start.
+     */
+    ///@{
+    void writeBlock(addressType address, const uint8_t *data, size_t length);
+    void readBlock(addressType address, uint8_t *data, size_t length, bool read_only);
+    ///@}
+
+    BusDevice &operator =(const BusDevice &) = delete;
+protected:
+    virtual void    writeImplementation(addressType address, uint8_t data) = 0;
+    virtual uint8_t readImplementation(addressType address, bool read_only) = 0;
+
+    /** Block accesses, only ever made within the device's range and never
+     *  past the end of the address space.
+     *
+     *  These go a byte at a time unless overridden.
+     */
+    ///@{
+    virtual void writeBlockImplementation(addressType address, const uint8_t *data, size_t length);
+    virtual void readBlockImplementation(addressType address, uint8_t *data, size_t length, bool read_only);
+    ///@}
+
+private:
+    addressType _lower_address_range = 0;
+    addressType _upper_address_range = 0;
+    bool        _writable = false;
+    bool        _readable = false;
+};
+
+#endif // BUSDEVICE_HPP
@@ -0,0 +1,488 @@
+#include "compacttrace.hpp"
+#include "opcodes.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+
+namespace
+{
+// Which fields a record has, in the order they come in
+constexpr uint8_t has_jump = 0x01;              // The PC, when it isn't just after the instruction before
+constexpr uint8_t has_instruction = 0x02;       // The opcode and operands
+constexpr uint8_t has_a = 0x04;
+constexpr uint8_t has_x = 0x08;
+constexpr uint8_t has_y = 0x10;
+constexpr uint8_t has_stack_pointer = 0x20;
+constexpr uint8_t has_status = 0x40;            // The flags that changed
+constexpr uint8_t has_effective_address = 0x80; // When the addressing mode doesn't predict it
+
+// Anything bigger would be an awful lot of decoding for a single seek
+constexpr uint32_t max_block_records = 1024 * 1024;
+
+/** Where the addressing mode of @p record would have pointed it, from its
+ *  operands and registers alone.
+ *
+ *  The indirect modes go through memory, which a trace doesn't have, so
+ *  their effective addresses are always stored.
+ */
+uint16_t PredictedEffectiveAddress(const TraceRecord &record, AddressMode_e mode)
+{
+    const uint16_t operand = static_cast<uint16_t>(record.operands[0] | (record.operands[1] << 8));
+
+    switch (mode)
+    {
+    case AddressMode_e::Immediate:
+        return static_cast<uint16_t>(record.program_counter + 1);
+    case AddressMode_e::ZeroPage:
+        return record.operands[0];
+    case AddressMode_e::ZeroPageXIndexed:
+        return static_cast<uint8_t>(record.operands[0] + record.x);
+    case AddressMode_e::ZeroPageYIndexed:
+        return static_cast<uint8_t>(record.operands[0] + record.y);
+    case AddressMode_e::Relative:
+        return static_cast<uint16_t>(record.program_counter + 2 + static_cast<int8_t>(record.operands[0]));
+    case AddressMode_e::Absolute:
+        return operand;
+    case AddressMode_e::AbsoluteXIndexed:
+        return static_cast<uint16_t>(operand + record.x);
+    case AddressMode_e::AbsoluteYIndexed:
+        return static_cast<uint16_t>(operand + record.y);
+    default:
+        return 0x0000;
+    }
+}
+
+void PutVarint(std::vector<uint8_t> &out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool GetByte(const uint8_t *&in, const uint8_t *end, uint8_t &value)
+{
+    if (in == end)
+        return false;
+    value = *in++;
+    return true;
+}
+
+bool GetVarint(const uint8_t *&in, const uint8_t *end, uint64_t &value)
+{
+    value = 0;
+    for (unsigned shift = 0; (in != end) && (shift < 64); shift += 7)
+    {
+        const uint8_t byte = *in++;
+
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+// The PC jumps either way, so small distances back have to stay small
+uint32_t ZigZag(int16_t value) { return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 15); }
+int16_t  UnZigZag(uint32_t value) { return static_cast<int16_t>((value >> 1) ^ (0u - (value & 1))); }
+
+// What every block starts out comparing its first record with
+TraceRecord StartOfBlock(uint64_t first_cycle)
+{
+    TraceRecord record{};
+
+    record.cycle = first_cycle;
+    return record;
+}
+}
+
+
+/** A direct mapped cache of the instruction bytes last seen at each PC.
+ *
+ *  It only has to remember the instructions of the loop being run, so a
+ *  small one that gets cleared at the start of every block is plenty.
+ */
+class TraceInstructionCache
+{
+public:
+    void clear() { _entries.fill(Entry{}); }
+
+    bool matches(const TraceRecord &record) const
+    {
+        const Entry &entry = _entries[index(record.program_counter)];
+
+        return entry.valid && (entry.program_counter == record.program_counter) && (entry.opcode == record.opcode) &&
+               (entry.operands[0] == record.operands[0]) && (entry.operands[1] == record.operands[1]);
+    }
+
+    void remember(const TraceRecord &record)
+    {
+        _entries[index(record.program_counter)] = { record.program_counter, record.opcode,
+                                                    { record.operands[0], record.operands[1] }, true };
+    }
+
+    /** Fills in the instruction at the PC of @p record.
+     *
+     *  @return false if there is none
+     */
+    bool recall(TraceRecord &record) const
+    {
+        const Entry &entry = _entries[index(record.program_counter)];
+
+        if (!entry.valid || (entry.program_counter != record.program_counter))
+            return false;
+        record.opcode = entry.opcode;
+        record.operands[0] = entry.operands[0];
+        record.operands[1] = entry.operands[1];
+        return true;
+    }
+
+private:
+    struct Entry
+    {
+        uint16_t program_counter = 0x0000;
+        uint8_t  opcode = 0x00;
+        uint8_t  operands[2] = { 0x00, 0x00 };
+        bool     valid = false;
+    };
+
+    std::array<Entry, 4096> _entries;
+
+    static size_t index(uint16_t program_counter) { return program_counter & 0x0FFF; }
+};
+
+
+CompactTraceWriter::CompactTraceWriter()
+    :
+    _instructions(std::make_unique<TraceInstructionCache>())
+{
+}
+
+CompactTraceWriter::~CompactTraceWriter()
+{
+    std::string error;
+
+    close(error);
+}
+
+bool CompactTraceWriter::open(const std::string &path, std::string &error, uint32_t block_records)
+{
+    if (isOpen() && !close(error))
+        return false;
+
+    _file = std::fopen(path.c_str(), "wb");
+    if (!_file)
+    {
+        error = "Cannot create " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    TraceFileHeader header;
+
+    std::memcpy(header.magic, TraceFileHeader::compact_magic_value, sizeof(header.magic));
+    header.version = TraceFileHeader::current_version;
+    header.record_size = sizeof(TraceRecord);
+    _failed = (std::fwrite(&header, sizeof(header), 1, _file) != 1);
+
+    _path = path;
+    _block_records = std::clamp<uint32_t>(block_records, 1, max_block_records);
+    _offset = sizeof(header);
+    _records = 0;
+    _index.clear();
+    _block.clear();
+    _block_header.records = 0;
+    return true;
+}
+
+void CompactTraceWriter::write(const TraceRecord *records, size_t count)
+{
+    for (const TraceRecord *record = records; record != records + count; ++record)
+    {
+        if (_block_header.records == 0)
+        {
+            _block_header.first_cycle = record->cycle;
+            _previous = StartOfBlock(record->cycle);
+            _instructions->clear();
+        }
+
+        const AddressMode_e mode = AddressModeOf(record->opcode);
+        const uint16_t      next_pc = static_cast<uint16_t>(_previous.program_counter + _previous.length);
+        const size_t        mask_at = _block.size();
+        uint8_t             mask = 0x00;
+
+        _block.push_back(0x00);
+        PutVarint(_block, record->cycle - _previous.cycle);
+        if (record->program_counter != next_pc)
+        {
+            mask |= has_jump;
+            PutVarint(_block, ZigZag(static_cast<int16_t>(record->program_counter - next_pc)));
+        }
+        if (!_instructions->matches(*record))
+        {
+            mask |= has_instruction;
+            _block.push_back(record->opcode);
+            for (uint8_t i = 0; i < OperandBytesOf(mode); ++i)
+                _block.push_back(record->operands[i]);
+            _instructions->remember(*record);
+        }
+        if (record->a != _previous.a)
+        {
+            mask |= has_a;
+            _block.push_back(record->a);
+        }
+        if (record->x != _previous.x)
+        {
+            mask |= has_x;
+            _block.push_back(record->x);
+        }
+        if (record->y != _previous.y)
+        {
+            mask |= has_y;
+            _block.push_back(record->y);
+        }
+        if (record->stack_pointer != _previous.stack_pointer)
+        {
+            mask |= has_stack_pointer;
+            _block.push_back(record->stack_pointer);
+        }
+        if (record->status != _previous.status)
+        {
+            mask |= has_status;
+            _block.push_back(record->status ^ _previous.status);
+        }
+        if (record->effective_address != PredictedEffectiveAddress(*record, mode))
+        {
+            mask |= has_effective_address;
+            _block.push_back(static_cast<uint8_t>(record->effective_address));
+            _block.push_back(static_cast<uint8_t>(record->effective_address >> 8));
+        }
+        _block[mask_at] = mask;
+
+        _previous = *record;
+        ++_records;
+        if (++_block_header.records == _block_records)
+            writeBlock();
+    }
+}
+
+bool CompactTraceWriter::close(std::string &error)
+{
+    if (!isOpen())
+        return true;
+
+    if (_block_header.records > 0)
+        writeBlock();
+
+    CompactTraceTrailer trailer{};
+
+    trailer.index_offset = _offset;
+    trailer.blocks = _index.size();
+    trailer.records = _records;
+    trailer.block_records = _block_records;
+    std::memcpy(trailer.magic, CompactTraceTrailer::magic_value, sizeof(trailer.magic));
+    if (!_index.empty() && (std::fwrite(_index.data(), sizeof(CompactTraceIndexEntry), _index.size(), _file) != _index.size()))
+        _failed = true;
+    if (std::fwrite(&trailer, sizeof(trailer), 1, _file) != 1)
+        _failed = true;
+    if (std::fclose(_file) != 0)
+        _failed = true;
+    _file = nullptr;
+
+    if (_failed)
+    {
+        error = "Cannot write the whole trace to " + _path;
+        return false;
+    }
+    return true;
+}
+
+void CompactTraceWriter::writeBlock()
+{
+    _block_header.bytes = static_cast<uint32_t>(_block.size());
+    _index.push_back({ _block_header.first_cycle, _offset });
+    if ((std::fwrite(&_block_header, sizeof(_block_header), 1, _file) != 1) ||
+        (std::fwrite(_block.data(), 1, _block.size(), _file) != _block.size()))
+        _failed = true;
+    _offset += sizeof(_block_header) + _block.size();
+    _block.clear();
+    _block_header.records = 0;
+}
+
+
+bool CompactTraceFile::open(const std::string &path, std::string &error)
+{
+    TraceFileHeader header;
+
+    close();
+    if (!_file.open(path, error))
+        return false;
+    if ((_file.size() < sizeof(header)) ||
+        (std::memcmp(_file.data(), TraceFileHeader::compact_magic_value, sizeof(header.magic)) != 0))
+        error = path + " is not a compact trace file";
+    else
+    {
+        std::memcpy(&header, _file.data(), sizeof(header));
+        if ((header.version != TraceFileHeader::current_version) || (header.record_size != sizeof(TraceRecord)))
+            error = path + " is a trace from another version of the emulator";
+        else if (readIndex() || findBlocks())
+            return true;
+        else
+            error = path + " is damaged";
+    }
+    close();
+    return false;
+}
+
+void CompactTraceFile::close()
+{
+    _file.close();
+    _blocks.clear();
+    _records = 0;
+    _block_records = CompactTraceWriter::default_block_records;
+}
+
+size_t CompactTraceFile::blockOfCycle(uint64_t cycle) const
+{
+    const auto after = std::upper_bound(_blocks.begin(), _blocks.end(), cycle,
+                                        [](uint64_t wanted, const CompactTraceIndexEntry &entry) { return wanted < entry.first_cycle; });
+
+    return (after == _blocks.begin()) ? 0 : static_cast<size_t>(after - _blocks.begin() - 1);
+}
+
+bool CompactTraceFile::decodeBlock(size_t block, std::vector<TraceRecord> &records) const
+{
+    CompactTraceBlockHeader header;
+    const uint64_t          offset = _blocks[block].offset;
+
+    records.clear();
+    if ((offset > _file.size()) || (_file.size() - offset < sizeof(header)))
+        return false;
+    std::memcpy(&header, _file.data() + offset, sizeof(header));
+    if ((header.bytes > _file.size() - offset - sizeof(header)) || (header.records > _block_records))
+        return false;
+
+    const uint8_t        *in = _file.data() + offset + sizeof(header);
+    const uint8_t        *end = in + header.bytes;
+    TraceRecord           previous = StartOfBlock(header.first_cycle);
+    TraceInstructionCache instructions;
+
+    records.reserve(header.records);
+    for (uint32_t i = 0; i < header.records; ++i)
+    {
+        TraceRecord record = previous;
+        uint8_t     mask;
+        uint64_t    value;
+
+        if (!GetByte(in, end, mask) || !GetVarint(in, end, value))
+            return false;
+        record.cycle = previous.cycle + value;
+        record.program_counter = static_cast<uint16_t>(previous.program_counter + previous.length);
+        if (mask & has_jump)
+        {
+            if (!GetVarint(in, end, value))
+                return false;
+            record.program_counter = static_cast<uint16_t>(record.program_counter + UnZigZag(static_cast<uint32_t>(value)));
+        }
+        if (mask & has_instruction)
+        {
+            if (!GetByte(in, end, record.opcode))
+                return false;
+            record.operands[0] = record.operands[1] = 0x00;
+            for (uint8_t i = 0; i < OperandBytesOf(AddressModeOf(record.opcode)); ++i)
+                if (!GetByte(in, end, record.operands[i]))
+                    return false;
+            instructions.remember(record);
+        }
+        else if (!instructions.recall(record))
+            return false;
+
+        const AddressMode_e mode = AddressModeOf(record.opcode);
+
+        record.length = 1 + OperandBytesOf(mode);
+
+        uint8_t changed_flags = 0x00;
+        uint8_t low = 0x00;
+        uint8_t high = 0x00;
+
+        if (((mask & has_a) && !GetByte(in, end, record.a)) ||
+            ((mask & has_x) && !GetByte(in, end, record.x)) ||
+            ((mask & has_y) && !GetByte(in, end, record.y)) ||
+            ((mask & has_stack_pointer) && !GetByte(in, end, record.stack_pointer)) ||
+            ((mask & has_status) && !GetByte(in, end, changed_flags)) ||
+            ((mask & has_effective_address) && !(GetByte(in, end, low) && GetByte(in, end, high))))
+            return false;
+        record.status ^= changed_flags;
+        if (mask & has_effective_address)
+            record.effective_address = static_cast<uint16_t>(low | (high << 8));
+        else
+            record.effective_address = PredictedEffectiveAddress(record, mode);
+
+        records.push_back(record);
+        previous = record;
+    }
+    return in == end;
+}
+
+bool CompactTraceFile::record(uint64_t index, TraceRecord &record) const
+{
+    std::vector<TraceRecord> records;
+
+    if (index >= _records)
+        return false;
+
+    const size_t   block = blockOfRecord(index);
+    const uint64_t offset = index - firstRecordOf(block);
+
+    if (!decodeBlock(block, records) || (offset >= records.size()))
+        return false;
+    record = records[static_cast<size_t>(offset)];
+    return true;
+}
+
+bool CompactTraceFile::readIndex()
+{
+    CompactTraceTrailer trailer;
+
+    if (_file.size() < sizeof(TraceFileHeader) + sizeof(trailer))
+        return false;
+    std::memcpy(&trailer, _file.data() + _file.size() - sizeof(trailer), sizeof(trailer));
+    if ((std::memcmp(trailer.magic, CompactTraceTrailer::magic_value, sizeof(trailer.magic)) != 0) ||
+        (trailer.block_records == 0) || (trailer.index_offset > _file.size() - sizeof(trailer)) ||
+        (trailer.blocks * sizeof(CompactTraceIndexEntry) != _file.size() - sizeof(trailer) - trailer.index_offset) ||
+        (trailer.records > trailer.blocks * trailer.block_records))
+        return false;
+
+    _blocks.resize(static_cast<size_t>(trailer.blocks));
+    if (!_blocks.empty())
+        std::memcpy(_blocks.data(), _file.data() + trailer.index_offset, _blocks.size() * sizeof(CompactTraceIndexEntry));
+    _records = trailer.records;
+    _block_records = trailer.block_records;
+    return true;
+}
+
+bool CompactTraceFile::findBlocks()
+{
+    uint64_t offset = sizeof(TraceFileHeader);
+
+    // Only whole blocks of the same size can be found by number, so a trace
+    // that was cut short ends at its last complete block
+    while (_file.size() - offset >= sizeof(CompactTraceBlockHeader))
+    {
+        CompactTraceBlockHeader header;
+
+        std::memcpy(&header, _file.data() + offset, sizeof(header));
+        if ((header.bytes > _file.size() - offset - sizeof(header)) || (header.records == 0) ||
+            (_blocks.empty() ? (header.records > max_block_records) : (header.records != _block_records)))
+            break;
+        if (_blocks.empty())
+            _block_records = header.records;
+        _blocks.push_back({ header.first_cycle, offset });
+        _records += header.records;
+        offset += sizeof(header) + header.bytes;
+    }
+    return true;
+}
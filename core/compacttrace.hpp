@@ -0,0 +1,185 @@
+#ifndef COMPACTTRACE_HPP
+#define COMPACTTRACE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "mappedfile.hpp"
+#include "tracerecord.hpp"
+
+
+/** The compact trace file format.
+ *
+ *  Consecutive records mostly differ in very little: the PC moves on by the
+ *  length of the instruction, one or two registers change, and the same few
+ *  instructions come round again and again.  So each record is stored as
+ *  what differs from the one before it:
+ *
+ *  - a mask byte saying which of the fields below are there
+ *  - the cycle, as the number of ticks since the record before (a varint)
+ *  - the PC, only if it isn't just after the instruction before, as the
+ *    signed distance from there (a zigzag varint)
+ *  - the opcode and operands, only if they differ from the last ones seen
+ *    at that PC
+ *  - A, X, Y and SP, each only if it changed
+ *  - P, only if it changed, as the bit mask of the flags that did
+ *  - the effective address, only if it isn't the one the addressing mode
+ *    predicts from the operands and index registers
+ *
+ *  Records are grouped into blocks of a fixed number of records, each of
+ *  which starts over from nothing so it can be decoded on its own.  After
+ *  the last block comes an index of where every block starts, and which
+ *  cycle its first record is at, so finding the block a record or cycle is
+ *  in takes no decoding at all.
+ *
+ *  The file starts with a TraceFileHeader with compact_magic_value.  Each
+ *  block is a CompactTraceBlockHeader followed by its encoded records.  The
+ *  index is an array of CompactTraceIndexEntry, and the CompactTraceTrailer
+ *  at the very end of the file says where it is.  A trace that was never
+ *  closed has no index, but its blocks can still be found one after another.
+ */
+///@{
+struct CompactTraceBlockHeader
+{
+    uint32_t bytes;       ///< Of encoded records following this header
+    uint32_t records;
+    uint64_t first_cycle;
+};
+static_assert(sizeof(CompactTraceBlockHeader) == 16, "Block headers are written to files as they are");
+
+struct CompactTraceIndexEntry
+{
+    uint64_t first_cycle;
+    uint64_t offset;      ///< Of the block header, from the start of the file
+};
+static_assert(sizeof(CompactTraceIndexEntry) == 16, "Index entries are written to files as they are");
+
+struct CompactTraceTrailer
+{
+    static constexpr char magic_value[8] = { 'T', 'R', 'C', 'I', 'N', 'D', 'E', 'X' };
+
+    uint64_t index_offset;
+    uint64_t blocks;
+    uint64_t records;
+    uint32_t block_records; ///< In every block but the last
+    uint32_t reserved;
+    char     magic[8];
+};
+static_assert(sizeof(CompactTraceTrailer) == 40, "The trailer is written to files as it is");
+///@}
+
+// The instructions last seen at each PC, which the writer and the reader
+// keep track of in exactly the same way
+class TraceInstructionCache;
+
+
+/** Writes records to a compact trace file, see CompactTraceBlockHeader.
+ *
+ *  Records have to be as the executor writes them: a length matching the
+ *  opcode, and operands past the length and the reserved bytes all 0.
+ */
+class CompactTraceWriter
+{
+public:
+    static constexpr uint32_t default_block_records = 4096;
+
+    CompactTraceWriter();
+    CompactTraceWriter(const CompactTraceWriter &) = delete;
+    ~CompactTraceWriter();
+
+    /** Creates (or truncates) the file at @p path.
+     *
+     *  @return false, with the reason in @p error, if it can't be written
+     */
+    bool open(const std::string &path, std::string &error, uint32_t block_records = default_block_records);
+
+    void write(const TraceRecord *records, size_t count);
+    void write(const TraceRecord &record) { write(&record, 1); }
+
+    /** Writes out the last block and the index, and closes the file.
+     *
+     *  @return false, with the reason in @p error, if any of the trace could
+     *          not be written
+     */
+    bool close(std::string &error);
+
+    bool isOpen() const { return _file != nullptr; }
+
+    CompactTraceWriter &operator =(const CompactTraceWriter &) = delete;
+
+private:
+    std::FILE                             *_file = nullptr;
+    std::string                            _path;
+    bool                                   _failed = false;
+    uint32_t                               _block_records = default_block_records;
+    uint64_t                               _offset = 0; // Where the next block goes
+    uint64_t                               _records = 0;
+    std::vector<CompactTraceIndexEntry>    _index;
+    std::vector<uint8_t>                   _block; // Encoded records
+    CompactTraceBlockHeader                _block_header{};
+    TraceRecord                            _previous{};
+    std::unique_ptr<TraceInstructionCache> _instructions;
+
+    void writeBlock();
+};
+
+
+/** A compact trace file, mapped into memory, with every block a seek away.
+ *
+ *  Nothing is decoded until asked for, a block at a time.  Decoding only
+ *  reads the file, so any number of threads can decode from one of these,
+ *  each into its own vector.
+ */
+class CompactTraceFile
+{
+public:
+    /** @return false, with the reason in @p error, if @p path can't be read
+     *          or isn't a compact trace
+     */
+    bool open(const std::string &path, std::string &error);
+    void close();
+
+    bool isOpen() const { return _file.isOpen(); }
+
+    uint64_t records() const { return _records; }
+    size_t   blocks() const { return _blocks.size(); }
+    uint32_t blockRecords() const { return _block_records; }
+
+    uint64_t firstRecordOf(size_t block) const { return static_cast<uint64_t>(block) * _block_records; }
+    uint64_t firstCycleOf(size_t block) const { return _blocks[block].first_cycle; }
+
+    /** The block record number @p record is in.
+     *
+     */
+    size_t blockOfRecord(uint64_t record) const { return static_cast<size_t>(record / _block_records); }
+
+    /** The block holding the last record that starts at or before @p cycle,
+     *  or block 0 if they all start after it.
+     */
+    size_t blockOfCycle(uint64_t cycle) const;
+
+    /** Decodes all of @p block into @p records.
+     *
+     *  @return false if the block is damaged
+     */
+    bool decodeBlock(size_t block, std::vector<TraceRecord> &records) const;
+
+    /** Decodes record number @p index, which takes decoding its block.
+     *
+     */
+    bool record(uint64_t index, TraceRecord &record) const;
+
+private:
+    MappedFile                          _file;
+    std::vector<CompactTraceIndexEntry> _blocks;
+    uint64_t                            _records = 0;
+    uint32_t                            _block_records = 0;
+
+    bool readIndex();
+    bool findBlocks(); // For a trace without an index
+};
+
+#endif // COMPACTTRACE_HPP
@@ -0,0 +1,93 @@
+#include "computercore.hpp"
+#include <cstring>
+
+
+ComputerCore::ComputerCore()
+    :
+    _cpu{ [this](addressType address, bool read_only) { return _bus.read(address, read_only); },
+          [this](addressType address, uint8_t data) { _bus.write(address, data); },
+          nullptr, nullptr, nullptr, nullptr, nullptr, nullptr },
+    _scheduler(_cpu)
+{
+    _bus.attach(_ram);
+}
+
+void ComputerCore::load(addressType address, const uint8_t *data, size_t length)
+{
+    _ram.load(address, data, length);
+}
+
+void ComputerCore::boot(const ProgramImage &image)
+{
+    for (const ProgramImage::Segment &segment : image.segments())
+        _ram.load(segment.address, segment.data, segment.length);
+    if (image.entryPoint())
+        resetTo(*image.entryPoint());
+    else
+        _cpu.reset();
+}
+
+void ComputerCore::resetTo(addressType address)
+{
+    const uint8_t vector[2] = { static_cast<uint8_t>(address & 0xFF), static_cast<uint8_t>(address >> 8) };
+
+    // Through load(), so a delta saved afterwards has the new vector
+    _ram.load(0xFFFC, vector, sizeof(vector));
+    _cpu.reset();
+}
+
+void ComputerCore::saveState(MachineSnapshot &snapshot)
+{
+    snapshot.version = MachineSnapshot::current_version;
+    snapshot.cycle = _scheduler.now();
+    _cpu.saveState(snapshot.cpu);
+    snapshot.ram = _ram.memory();
+    _ram.clearDirtyPages();
+}
+
+void ComputerCore::restoreState(const MachineSnapshot &snapshot)
+{
+    _ram.memory() = snapshot.ram;
+    _ram.clearDirtyPages();
+    _cpu.restoreState(snapshot.cpu);
+    _scheduler.setNow(snapshot.cycle);
+}
+
+void ComputerCore::saveDelta(DeltaSnapshot &delta)
+{
+    const RamDevice::pageMask &dirty = _ram.dirtyPages();
+
+    delta.cycle = _scheduler.now();
+    _cpu.saveState(delta.cpu);
+    delta.pages = dirty;
+    delta.data.resize(dirty.count() * DeltaSnapshot::page_size);
+
+    uint8_t *page_data = delta.data.data();
+
+    for (size_t page = 0; page < dirty.size(); ++page)
+        if (dirty[page])
+        {
+            std::memcpy(page_data, _ram.memory().data() + page * DeltaSnapshot::page_size, DeltaSnapshot::page_size);
+            page_data += DeltaSnapshot::page_size;
+        }
+    _ram.clearDirtyPages();
+}
+
+void ComputerCore::restoreState(const MachineSnapshot &base, const std::vector<DeltaSnapshot> &deltas)
+{
+    // Only RAM is built up; the CPU and clock come from the last one
+    _ram.memory() = base.ram;
+    for (const DeltaSnapshot &delta : deltas)
+        delta.applyPagesTo(_ram.memory());
+    _ram.clearDirtyPages();
+    if (deltas.empty())
+    {
+        _cpu.restoreState(base.cpu);
+        _scheduler.setNow(base.cycle);
+    }
+    else
+    {
+        _cpu.restoreState(deltas.back().cpu);
+        _scheduler.setNow(deltas.back().cycle);
+    }
+}
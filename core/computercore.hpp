@@ -0,0 +1,84 @@
+#ifndef COMPUTERCORE_HPP
+#define COMPUTERCORE_HPP
+
+#include "instructionexecutor.hpp"
+#include "machinesnapshot.hpp"
+#include "programimage.hpp"
+#include "ramdevice.hpp"
+#include "scheduler.hpp"
+#include "systembus.hpp"
+
+
+/** A complete computer without any Qt: a CPU with 64K of RAM on its bus,
+ *  driven by a scheduler.
+ *
+ *  This is what headless tools build on.  Nobody observes the registers,
+ *  so lazily evaluated flags can stay lazy.
+ */
+class ComputerCore
+{
+public:
+    using addressType = InstructionExecutor::addressType;
+
+    ComputerCore();
+    ComputerCore(const ComputerCore &) = delete;
+
+    InstructionExecutor &cpu()       { return _cpu; }
+    SystemBus           &bus()       { return _bus; }
+    RamDevice           &ram()       { return _ram; }
+    Scheduler           &scheduler() { return _scheduler; }
+
+    /** Copies @p length bytes of @p data into RAM, starting at @p address.
+     *
+     *  Anything past the end of the address space wraps around to the start.
+     */
+    void load(addressType address, const uint8_t *data, size_t length);
+
+    /** Copies every segment of @p image into RAM, then resets the CPU.
+     *
+     *  The reset vector is pointed at the image's entry point, if it has
+     *  one, otherwise the image brings its own.
+     */
+    void boot(const ProgramImage &image);
+
+    /** Points the reset vector at @p address and resets the CPU.
+     *
+     */
+    void resetTo(addressType address);
+
+    /** Captures the CPU, RAM and the scheduler's clock.
+     *
+     *  Pending scheduler events and other devices on the bus are not part of
+     *  a snapshot; after restoring one, events stay due at the ticks they
+     *  were scheduled for.
+     *
+     *  Both start a new chain of deltas: the next saveDelta() holds what
+     *  changes from here on.
+     */
+    ///@{
+    void saveState(MachineSnapshot &snapshot);
+    void restoreState(const MachineSnapshot &snapshot);
+    ///@}
+
+    /** Captures the CPU, and only the pages of RAM written to since the last
+     *  snapshot or delta.
+     *
+     */
+    void saveDelta(DeltaSnapshot &delta);
+
+    /** Goes back to the state @p base followed by @p deltas was taken at.
+     *
+     *  The deltas have to be the ones saved, in order, after @p base.  Like
+     *  restoreState(), this starts a new chain.
+     */
+    void restoreState(const MachineSnapshot &base, const std::vector<DeltaSnapshot> &deltas);
+
+    ComputerCore &operator =(const ComputerCore &) = delete;
+private:
+    SystemBus           _bus;
+    RamDevice           _ram;
+    InstructionExecutor _cpu;
+    Scheduler           _scheduler;
+};
+
+#endif // COMPUTERCORE_HPP
@@ -0,0 +1,76 @@
+# The emulator itself, in plain C++: the CPU, the bus, RAM and the scheduler.
+# Nothing in here may depend on Qt, so headless tools can use it on its own.
+# The emulator library wraps these for QML.
+TEMPLATE = lib
+CONFIG += staticlib
+CONFIG += c++17
+CONFIG -= qt
+CONFIG += thread
+
+TARGET = emulatorcore
+
+# The interpreter engine InstructionExecutor::run() starts out with: table
+# (the default), threaded (computed goto) or tailcall (needs musttail).
+# For example: qmake EMULATOR_ENGINE=threaded
+isEmpty(EMULATOR_ENGINE): EMULATOR_ENGINE = table
+DEFINES += EMULATOR_ENGINE_$$upper($$EMULATOR_ENGINE)
+
+SOURCES += \
+    accesscounters.cpp \
+    accessheatmap.cpp \
+    busdevice.cpp \
+    compacttrace.cpp \
+    computercore.cpp \
+    coveragemap.cpp \
+    cycleprofiler.cpp \
+    decimaltables.cpp \
+    executionstatistics.cpp \
+    inputlog.cpp \
+    instructionexecutor.cpp \
+    lzcodec.cpp \
+    machinesnapshot.cpp \
+    mappedfile.cpp \
+    opcodepairhistogram.cpp \
+    programimage.cpp \
+    ramdevice.cpp \
+    rewindbuffer.cpp \
+    scheduler.cpp \
+    symboltable.cpp \
+    systembus.cpp \
+    tracecomparer.cpp \
+    tracereader.cpp \
+    tracerecorder.cpp \
+    traceview.cpp
+
+HEADERS += \
+    accesscounters.hpp \
+    accessheatmap.hpp \
+    busdevice.hpp \
+    compacttrace.hpp \
+    computercore.hpp \
+    coveragemap.hpp \
+    cycleprofiler.hpp \
+    decimaltables.hpp \
+    executionstatistics.hpp \
+    flags.hpp \
+    inputlog.hpp \
+    instructionexecutor.hpp \
+    instructions.hpp \
+    instructiontable.hpp \
+    lzcodec.hpp \
+    machinesnapshot.hpp \
+    mappedfile.hpp \
+    opcodepairhistogram.hpp \
+    opcodes.hpp \
+    programimage.hpp \
+    ramdevice.hpp \
+    registers.hpp \
+    rewindbuffer.hpp \
+    scheduler.hpp \
+    symboltable.hpp \
+    systembus.hpp \
+    tracecomparer.hpp \
+    tracereader.hpp \
+    tracerecord.hpp \
+    tracerecorder.hpp \
+    traceview.hpp
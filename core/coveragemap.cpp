@@ -0,0 +1,109 @@
+#include "coveragemap.hpp"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+
+
+namespace
+{
+// The bits of a code/data log, as FCEUX has them, and the one it leaves
+// unused that is taken for opcodes
+constexpr uint8_t log_code   = 0x01;
+constexpr uint8_t log_data   = 0x02;
+constexpr uint8_t log_opcode = 0x80;
+
+uint8_t ToCodeDataLog(uint8_t flags)
+{
+    uint8_t logged = 0;
+
+    if (flags & CoverageMap::Executed)
+        logged |= log_code;
+    if (flags & CoverageMap::Opcode)
+        logged |= log_opcode;
+    if (flags & (CoverageMap::Read | CoverageMap::IndirectPointer))
+        logged |= log_data;
+    return logged;
+}
+
+uint8_t FromCodeDataLog(uint8_t logged, bool has_opcodes)
+{
+    uint8_t flags = 0;
+
+    if (logged & log_code)
+        flags |= !has_opcodes ? CoverageMap::Executed : (logged & log_opcode) ? CoverageMap::Opcode : CoverageMap::Operand;
+    if (logged & log_data)
+        flags |= CoverageMap::Read;
+    return flags;
+}
+}
+
+
+CoverageMap::Format CoverageMap::formatOf(const std::string &path)
+{
+    std::string suffix = (path.size() >= 4) ? path.substr(path.size() - 4) : std::string();
+
+    std::transform(suffix.begin(), suffix.end(), suffix.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return (suffix == ".cdl") ? Format::CodeDataLog : Format::Flags;
+}
+
+
+size_t CoverageMap::count(uint8_t flags) const
+{
+    return static_cast<size_t>(std::count_if(_flags.begin(), _flags.end(), [flags](uint8_t used) { return (used & flags) != 0; }));
+}
+
+void CoverageMap::clear()
+{
+    std::fill(_flags.begin(), _flags.end(), 0);
+}
+
+void CoverageMap::merge(const CoverageMap &other)
+{
+    for (size_t address = 0; address < size; ++address)
+        _flags[address] |= other._flags[address];
+}
+
+bool CoverageMap::save(const std::string &path, std::string &error, Format format) const
+{
+    std::vector<uint8_t> saved(_flags);
+    std::ofstream        file(path, std::ios::binary);
+
+    if (format == Format::CodeDataLog)
+        std::transform(saved.begin(), saved.end(), saved.begin(), ToCodeDataLog);
+    if (!file.write(reinterpret_cast<const char *>(saved.data()), static_cast<std::streamsize>(saved.size())) ||
+        !file.flush())
+    {
+        error = "Couldn't write the coverage to " + path;
+        return false;
+    }
+    return true;
+}
+
+bool CoverageMap::load(const std::string &path, std::string &error, Format format)
+{
+    std::ifstream        file(path, std::ios::binary);
+    std::vector<uint8_t> flags(size + 1);
+
+    if (!file)
+    {
+        error = "Couldn't read the coverage from " + path;
+        return false;
+    }
+    // One byte more than it should have, to tell a longer file
+    file.read(reinterpret_cast<char *>(flags.data()), static_cast<std::streamsize>(flags.size()));
+    if (file.bad() || (static_cast<size_t>(file.gcount()) != size))
+    {
+        error = path + ": not a coverage map of 64 KiB";
+        return false;
+    }
+    flags.pop_back();
+    if (format == Format::CodeDataLog)
+    {
+        const bool has_opcodes = std::any_of(flags.begin(), flags.end(), [](uint8_t logged) { return (logged & log_opcode) != 0; });
+
+        for (uint8_t &logged : flags)
+            logged = FromCodeDataLog(logged, has_opcodes);
+    }
+    _flags.swap(flags);
+    return true;
+}
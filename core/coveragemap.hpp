@@ -0,0 +1,109 @@
+#ifndef COVERAGEMAP_HPP
+#define COVERAGEMAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/** How each byte of the address space has been used, since it was cleared.
+ *
+ *  One byte of flags per address, in a flat array, so marking an access is
+ *  a single OR and the whole thing can be left on for long runs.  The
+ *  executor marks opcodes and their operands as it starts each instruction,
+ *  and reads and writes as they go over the bus.  Opcode and operand fetches
+ *  don't count as reads; an immediate operand does, as the instruction uses
+ *  it as data.
+ *
+ *  It can be saved in two formats, both a byte for each address in turn,
+ *  64 KiB with no header:
+ *
+ *  - Format::CodeDataLog, in FCEUX's layout: 0x01 for a byte executed, as
+ *    opcode or operand, and 0x02 for one read, pointers included.  Opcodes
+ *    also have 0x80, a bit FCEUX leaves unused, so the instructions still
+ *    line up when it is loaded back.  Writes aren't kept.
+ *  - Format::Flags, the flags as the map holds them, which only this
+ *    project reads.
+ */
+class CoverageMap
+{
+public:
+    using addressType = uint16_t;
+
+    enum Flag : uint8_t
+    {
+        Opcode          = 0x01, ///< Executed as the first byte of an instruction
+        Read            = 0x02, ///< Read as data
+        Operand         = 0x04, ///< Executed as an operand byte
+        Written         = 0x08,
+        IndirectPointer = 0x10, ///< Read as half of a pointer: JMP (a), (zp,X), (zp),Y and the vectors
+
+        Executed = Opcode | Operand,
+        All      = Opcode | Read | Operand | Written | IndirectPointer
+    };
+
+    enum class Format : uint8_t
+    {
+        CodeDataLog,
+        Flags
+    };
+
+    static constexpr size_t size = 64 * 1024;
+
+    /** @return CodeDataLog for a path ending in .cdl, otherwise Flags
+     *
+     */
+    static Format formatOf(const std::string &path);
+
+    CoverageMap() : _flags(size, 0) { }
+
+    void record(addressType address, uint8_t flags) { _flags[address] |= flags; }
+
+    /** Marks an instruction of @p operand_bytes operands, starting at
+     *  @p address, as executed.
+     *
+     */
+    void recordInstruction(addressType address, uint8_t operand_bytes)
+    {
+        _flags[address] |= Opcode;
+        for (uint8_t i = 1; i <= operand_bytes; ++i)
+            _flags[static_cast<addressType>(address + i)] |= Operand;
+    }
+
+    uint8_t flags(addressType address) const { return _flags[address]; }
+    const uint8_t *data() const { return _flags.data(); } ///< The flags of every address, from 0
+
+    /** @return How many addresses have any of @p flags
+     *
+     */
+    size_t count(uint8_t flags) const;
+
+    void clear();
+
+    /** Adds the accesses recorded in @p other, as from another run.
+     *
+     */
+    void merge(const CoverageMap &other);
+
+    /** Writes the map to the file at @p path in @p format.
+     *
+     *  @return false, with the reason in @p error, if it couldn't be written
+     */
+    bool save(const std::string &path, std::string &error, Format format = Format::CodeDataLog) const;
+
+    /** Replaces the map with the one in @p format in the file at @p path.
+     *
+     *  Code in a code/data log from FCEUX itself, without the opcode bit
+     *  anywhere, is taken as both opcodes and operands: it could be either.
+     *
+     *  @return false, with the reason in @p error, if the file can't be read
+     *          or isn't the right size.  The map is left alone in that case.
+     */
+    bool load(const std::string &path, std::string &error, Format format = Format::CodeDataLog);
+
+private:
+    std::vector<uint8_t> _flags;
+};
+
+#endif // COVERAGEMAP_HPP
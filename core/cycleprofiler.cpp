@@ -0,0 +1,225 @@
+#include "cycleprofiler.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+
+uint64_t CycleProfiler::topLevelCycles() const
+{
+    const uint64_t running = _frames.empty() ? 0 : _total - _frames.front().entered;
+
+    return _total - _top_level_children - running;
+}
+
+void CycleProfiler::clear()
+{
+    std::fill(_cycles.begin(), _cycles.end(), 0);
+    _total = 0;
+    _top_level_children = 0;
+    _frames.clear();
+    _subroutines.clear();
+    _nodes.assign(1, Node());
+    _children.clear();
+    _next_sample = _sample_interval ? _sample_interval : no_sample;
+}
+
+void CycleProfiler::setSampleInterval(uint32_t cycles)
+{
+    _sample_interval = cycles;
+    _next_sample = cycles ? _total + cycles : no_sample;
+}
+
+uint64_t CycleProfiler::samples() const
+{
+    uint64_t samples = 0;
+
+    for (const Node &node : _nodes)
+        samples += node.samples;
+    return samples;
+}
+
+std::vector<CycleProfiler::AddressCost> CycleProfiler::hottestAddresses(size_t maximum) const
+{
+    std::vector<AddressCost> costs;
+
+    for (uint32_t address = 0; address < _cycles.size(); ++address)
+        if (_cycles[address])
+            costs.push_back({ static_cast<addressType>(address), _cycles[address] });
+
+    // Ties are broken by address, so the order is always the same.
+    std::sort(costs.begin(), costs.end(), [](const AddressCost &left, const AddressCost &right)
+    {
+        if (left.cycles != right.cycles)
+            return left.cycles > right.cycles;
+        return left.address < right.address;
+    });
+    if (costs.size() > maximum)
+        costs.resize(maximum);
+    return costs;
+}
+
+std::vector<CycleProfiler::SubroutineCost> CycleProfiler::subroutines() const
+{
+    // Returning from everything still running, on copies
+    std::vector<Frame>                          frames = _frames;
+    std::unordered_map<addressType, Subroutine> subroutines = _subroutines;
+    uint64_t                                    top_level_children = _top_level_children;
+    std::vector<SubroutineCost>                 costs;
+
+    while (!frames.empty())
+        pop(frames, subroutines, _total, top_level_children);
+
+    for (const auto &subroutine : subroutines)
+        costs.push_back({ subroutine.first, subroutine.second.calls, subroutine.second.inclusive, subroutine.second.exclusive });
+    std::sort(costs.begin(), costs.end(), [](const SubroutineCost &left, const SubroutineCost &right)
+    {
+        if (left.inclusive != right.inclusive)
+            return left.inclusive > right.inclusive;
+        return left.address < right.address;
+    });
+    return costs;
+}
+
+std::vector<CycleProfiler::addressType> CycleProfiler::reportedAddresses(size_t maximum) const
+{
+    std::vector<addressType>          addresses;
+    const std::vector<SubroutineCost> subroutine_costs = subroutines();
+
+    for (size_t i = 0; (i < subroutine_costs.size()) && (i < maximum); ++i)
+        addresses.push_back(subroutine_costs[i].address);
+    for (const AddressCost &cost : hottestAddresses(maximum))
+        addresses.push_back(cost.address);
+    std::sort(addresses.begin(), addresses.end());
+    addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+    return addresses;
+}
+
+void CycleProfiler::writeReport(std::ostream &output, const disassemblyType &disassembly, size_t maximum) const
+{
+    const double per_cent = _total ? 100.0 / static_cast<double>(_total) : 0.0;
+
+    auto instruction = [&disassembly](addressType address)
+    {
+        const auto line = disassembly.find(address);
+
+        if (line != disassembly.end())
+            return line->second;
+
+        std::ostringstream text;
+
+        text << '$' << std::hex << std::uppercase << std::setfill('0') << std::setw(4) << address;
+        return text.str();
+    };
+
+    std::vector<SubroutineCost> subroutine_costs = subroutines();
+
+    if (subroutine_costs.size() > maximum)
+        subroutine_costs.resize(maximum);
+
+    output << std::fixed << std::setprecision(2)
+           << "Cycles by subroutine, of " << _total << '\n'
+           << std::setw(12) << "inclusive" << std::setw(9) << '%' << std::setw(13) << "exclusive" << std::setw(9) << '%'
+           << std::setw(11) << "calls" << "  subroutine\n";
+    for (const SubroutineCost &cost : subroutine_costs)
+    {
+        output << std::setw(12) << cost.inclusive << std::setw(8) << cost.inclusive * per_cent << '%'
+               << std::setw(13) << cost.exclusive << std::setw(8) << cost.exclusive * per_cent << '%'
+               << std::setw(11) << cost.calls << "  " << instruction(cost.address) << '\n';
+    }
+    output << std::setw(12) << topLevelCycles() << std::setw(8) << topLevelCycles() * per_cent << "%"
+           << std::setw(35) << ' ' << "(top level)\n"
+           << "\nCycles by address\n"
+           << std::setw(12) << "cycles" << std::setw(9) << '%' << "  instruction\n";
+    for (const AddressCost &cost : hottestAddresses(maximum))
+        output << std::setw(12) << cost.cycles << std::setw(8) << cost.cycles * per_cent << "%  " << instruction(cost.address) << '\n';
+}
+
+void CycleProfiler::writeCollapsedStacks(std::ostream &output, const SymbolTable &symbols) const
+{
+    std::vector<std::string> stacks;
+    std::vector<std::string> names;
+
+    for (uint32_t index = 0; index < _nodes.size(); ++index)
+    {
+        if (!_nodes[index].samples)
+            continue;
+
+        names.clear();
+        for (uint32_t path = index; path != 0; path = _nodes[path].parent)
+        {
+            const Node &node = _nodes[path];
+
+            switch (node.kind)
+            {
+            case FrameKind::Call:
+                names.push_back(symbols.nameOf(node.address));
+                break;
+            case FrameKind::Break:
+                names.push_back(symbols.nameOf(node.address) + " (BRK)");
+                break;
+            case FrameKind::Interrupt:
+                names.push_back(symbols.nameOf(node.address) + " (interrupt)");
+                break;
+            }
+        }
+
+        std::string stack = "(top level)";
+
+        for (auto name = names.rbegin(); name != names.rend(); ++name)
+            stack += ';' + *name;
+        stacks.push_back(stack + ' ' + std::to_string(_nodes[index].samples));
+    }
+
+    // The tools don't mind the order, but a diff of two runs does
+    std::sort(stacks.begin(), stacks.end());
+    for (const std::string &stack : stacks)
+        output << stack << '\n';
+}
+
+void CycleProfiler::sample()
+{
+    // Every interval crossed by the last instruction counts
+    const uint64_t periods = (_total - _next_sample) / _sample_interval + 1;
+
+    _nodes[_frames.empty() ? 0 : _frames.back().node].samples += periods;
+    _next_sample += periods * _sample_interval;
+}
+
+void CycleProfiler::enter(addressType address, uint8_t stack_pointer, FrameKind kind)
+{
+    const uint32_t parent = _frames.empty() ? 0 : _frames.back().node;
+    const uint64_t key = (uint64_t(parent) << 18) | (uint64_t(kind) << 16) | address;
+    const auto     child = _children.emplace(key, static_cast<uint32_t>(_nodes.size()));
+
+    if (child.second)
+        _nodes.push_back({ parent, address, kind, 0 });
+
+    Subroutine &subroutine = _subroutines[address];
+
+    subroutine.calls++;
+    subroutine.active++;
+    _frames.push_back({ address, stack_pointer, child.first->second, _total });
+}
+
+void CycleProfiler::leave(unsigned stack_pointer)
+{
+    while (!_frames.empty() && (_frames.back().stack_pointer <= stack_pointer))
+        pop(_frames, _subroutines, _total, _top_level_children);
+}
+
+void CycleProfiler::pop(std::vector<Frame> &frames, std::unordered_map<addressType, Subroutine> &subroutines,
+                        uint64_t now, uint64_t &top_level_children)
+{
+    const Frame    frame = frames.back();
+    const uint64_t elapsed = now - frame.entered;
+    Subroutine    &subroutine = subroutines[frame.address];
+
+    frames.pop_back();
+    subroutine.exclusive += elapsed - frame.children;
+    if (--subroutine.active == 0)
+        subroutine.inclusive += elapsed;
+    if (frames.empty())
+        top_level_children += elapsed;
+    else
+        frames.back().children += elapsed;
+}
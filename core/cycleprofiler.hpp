@@ -0,0 +1,249 @@
+#ifndef CYCLEPROFILER_HPP
+#define CYCLEPROFILER_HPP
+
+#include "symboltable.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+/** Where the guest program spends its cycles.
+ *
+ *  Every instruction's cycles are added to a counter for the address it
+ *  was fetched from, in a flat array covering the whole address space.
+ *
+ *  A shadow call stack follows JSR and RTS, BRK, interrupts and RTI, so the
+ *  cycles can also be added up per subroutine: exclusive cycles are those
+ *  of the subroutine's own instructions, inclusive ones include everything
+ *  it called.  Frames are matched to returns by the stack pointer, so code
+ *  that drops a return address, or uses RTS as a computed jump, doesn't
+ *  confuse it.
+ *
+ *  Every call path seen is kept in a tree, and each frame knows its place
+ *  in it.  When sampling, every so many cycles the path running is counted
+ *  once, which costs the same however deep the stack is; the counts come
+ *  out as collapsed stacks, for flame graphs.
+ *
+ *  The executor fills one of these in while it runs, when asked to.
+ */
+class CycleProfiler
+{
+public:
+    using addressType = uint16_t;
+    using disassemblyType = std::map<addressType, std::string>;
+
+    struct AddressCost
+    {
+        addressType address;
+        uint64_t    cycles;
+    };
+
+    struct SubroutineCost
+    {
+        addressType address; ///< Where it was called
+        uint64_t    calls;
+        uint64_t    inclusive;
+        uint64_t    exclusive;
+    };
+
+    CycleProfiler() : _cycles(64 * 1024, 0), _nodes(1) { }
+
+    /** Counts an instruction that has just executed.
+     *
+     *  @param address       Where it was fetched from
+     *  @param opcode        What it was
+     *  @param stack_pointer The stack pointer before it ran
+     *  @param next          The program counter after it ran
+     *  @param cycles        How many clock ticks it took
+     */
+    void record(addressType address, uint8_t opcode, uint8_t stack_pointer, addressType next, uint32_t cycles)
+    {
+        _cycles[address] += cycles;
+        switch (opcode)
+        {
+        case jsr_opcode:
+            call(next, stack_pointer, cycles, FrameKind::Call);
+            break;
+        case brk_opcode:
+            call(next, stack_pointer, cycles, FrameKind::Break);
+            break;
+        case rts_opcode:
+            charge(cycles);
+            leave(stack_pointer + 2);
+            break;
+        case rti_opcode:
+            charge(cycles);
+            leave(stack_pointer + 3);
+            break;
+        default:
+            charge(cycles);
+            break;
+        }
+    }
+
+    /** Counts an IRQ or NMI the CPU has just taken.
+     *
+     *  The cycles it took to get to the handler are the handler's, and are
+     *  counted at its first instruction's address.
+     *
+     *  @param handler       Where the vector sent the CPU
+     *  @param stack_pointer The stack pointer before the CPU pushed anything
+     *  @param cycles        How many clock ticks it took
+     */
+    void interrupt(addressType handler, uint8_t stack_pointer, uint32_t cycles)
+    {
+        _cycles[handler] += cycles;
+        leave(stack_pointer);
+        enter(handler, stack_pointer, FrameKind::Interrupt);
+        charge(cycles);
+    }
+
+    /** Returns from every frame, as the CPU has been reset.
+     *
+     */
+    void unwind() { leave(0x100); }
+
+    /** Counts the call path running once every @p cycles cycles.
+     *
+     *  0, the default, stops sampling.  The samples taken so far are kept.
+     */
+    void setSampleInterval(uint32_t cycles);
+    uint32_t sampleInterval() const { return _sample_interval; }
+
+    uint64_t cycles(addressType address) const { return _cycles[address]; }
+    uint64_t total() const { return _total; }
+
+    /** Cycles spent outside of any subroutine the profiler saw being called.
+     *
+     */
+    uint64_t topLevelCycles() const;
+
+    size_t depth() const { return _frames.size(); } ///< Subroutines called and not yet returned from
+
+    uint64_t samples() const; ///< Taken since the last clear()
+
+    void clear();
+
+    /** The @p maximum addresses that took the most cycles, most first.
+     *
+     */
+    std::vector<AddressCost> hottestAddresses(size_t maximum) const;
+
+    /** Every subroutine called, by inclusive cycles, most first.
+     *
+     *  Those still running are counted up to now, as if they had just
+     *  returned.  Recursive calls only add to inclusive cycles once.
+     */
+    std::vector<SubroutineCost> subroutines() const;
+
+    /** The addresses a report of the @p maximum hottest addresses and
+     *  subroutines would show, for building a disassembly of them.
+     *
+     */
+    std::vector<addressType> reportedAddresses(size_t maximum) const;
+
+    /** Writes the @p maximum costliest subroutines and addresses to
+     *  @p output, a line each, with the instruction there as @p disassembly
+     *  has it.
+     *
+     */
+    void writeReport(std::ostream &output, const disassemblyType &disassembly, size_t maximum) const;
+
+    /** Writes the samples to @p output as collapsed stacks, the input
+     *  flamegraph.pl and its kin expect.
+     *
+     *  A line per call path sampled, outermost first, with how many samples
+     *  it got:
+     *
+     *      (top level);main;draw_sprite 1234
+     *
+     *  Subroutines go by their name in @p symbols, or their address.  Those
+     *  entered by BRK or an interrupt say so.
+     */
+    void writeCollapsedStacks(std::ostream &output, const SymbolTable &symbols) const;
+
+private:
+    static constexpr uint8_t brk_opcode = 0x00;
+    static constexpr uint8_t jsr_opcode = 0x20;
+    static constexpr uint8_t rti_opcode = 0x40;
+    static constexpr uint8_t rts_opcode = 0x60;
+
+    static constexpr uint64_t no_sample = UINT64_MAX; // For _next_sample when not sampling
+
+    enum class FrameKind : uint8_t
+    {
+        Call,
+        Break,
+        Interrupt
+    };
+
+    struct Subroutine
+    {
+        uint64_t calls = 0;
+        uint64_t inclusive = 0;
+        uint64_t exclusive = 0;
+        uint32_t active = 0; // Frames of it on the stack, more than one when recursive
+    };
+
+    struct Frame
+    {
+        addressType address;
+        uint8_t     stack_pointer; // Before the call, so the return address is just below
+        uint32_t    node;          // Its call path
+        uint64_t    entered;       // _total when it was called
+        uint64_t    children = 0;  // Cycles spent in the subroutines it called
+    };
+
+    // A call path: the frame on top, and the path of the one below it
+    struct Node
+    {
+        uint32_t    parent = 0;
+        addressType address = 0;
+        FrameKind   kind = FrameKind::Call;
+        uint64_t    samples = 0;
+    };
+
+    std::vector<uint64_t> _cycles;
+    uint64_t              _total = 0;
+    uint64_t              _top_level_children = 0; // Cycles of subroutines called from the top level, once returned
+    std::vector<Frame>    _frames;
+    std::unordered_map<addressType, Subroutine> _subroutines;
+    std::vector<Node>     _nodes;                  // _nodes[0] is the top level
+    std::unordered_map<uint64_t, uint32_t> _children; // Node by parent, kind and address
+    uint32_t              _sample_interval = 0;
+    uint64_t              _next_sample = no_sample;
+
+    void charge(uint32_t cycles)
+    {
+        _total += cycles;
+        if (_total >= _next_sample)
+            sample();
+    }
+
+    void sample();
+
+    // A JSR's or BRK's own cycles belong to its caller
+    void call(addressType address, uint8_t stack_pointer, uint32_t cycles, FrameKind kind)
+    {
+        // A frame at or above this stack pointer has been dropped without
+        // returning, or this call would overwrite its return address
+        leave(stack_pointer);
+        charge(cycles);
+        enter(address, stack_pointer, kind);
+    }
+
+    void enter(addressType address, uint8_t stack_pointer, FrameKind kind);
+
+    // Returns from every frame called with the stack pointer at or below
+    // stack_pointer, as their return addresses are off the stack by now
+    void leave(unsigned stack_pointer);
+
+    static void pop(std::vector<Frame> &frames, std::unordered_map<addressType, Subroutine> &subroutines,
+                    uint64_t now, uint64_t &top_level_children);
+};
+
+#endif // CYCLEPROFILER_HPP
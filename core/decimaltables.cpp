@@ -0,0 +1,95 @@
+#include "decimaltables.hpp"
+
+namespace
+{
+struct BCDResult {
+    uint8_t sum;
+    bool    hi_nybble_carry;
+};
+
+BCDResult addBCD(uint8_t left, uint8_t right)
+{
+    // First add low nybbles to get the first digit...
+    uint16_t low_nybble_result = ((uint16_t)left  & 0x000F) +
+                                 ((uint16_t)right & 0x000F);
+    uint16_t low_nybble_carry = (low_nybble_result > 0x09) ? 0x0001 : 0x0000;
+
+    // Check for the wrap-around...
+    if (low_nybble_carry)
+        low_nybble_result -= 10;
+
+    // Then add high nybbles to get the second digit...
+    uint16_t hi_nybble_result = ((uint16_t)left  >> 4) +
+                                ((uint16_t)right >> 4) +
+                                low_nybble_carry;
+    uint16_t hi_nybble_carry = (hi_nybble_result > 0x09) ? 0x0001 : 0x0000;
+
+    if (hi_nybble_carry)
+        hi_nybble_result -= 10;
+
+    return { static_cast<uint8_t>(low_nybble_result | (hi_nybble_result << 4)), static_cast<bool>(hi_nybble_carry) }; // Splice the nybbles back together
+}
+
+uint8_t flagBit(FLAGS6502 f, bool v)
+{
+    return v ? f : 0x00;
+}
+}
+
+
+const DecimalTables &DecimalTables::instance()
+{
+    static const DecimalTables tables;
+
+    return tables;
+}
+
+DecimalTables::DecimalTables()
+{
+    for (int carry = 0; carry < 2; ++carry)
+        for (int accumulator = 0; accumulator < 256; ++accumulator)
+            for (int operand = 0; operand < 256; ++operand)
+            {
+                uint32_t i = index(accumulator, operand, carry);
+
+                _add[i]      = computeAdd(accumulator, operand, carry);
+                _subtract[i] = computeSubtract(accumulator, operand, carry);
+            }
+}
+
+// Decimal mode addition.
+//
+// NOTE: The carry in does not take part in the sum.  This mirrors the
+//       behavior the executor has always had, and it is what the
+//       tables are validated against.
+DecimalTables::Entry DecimalTables::computeAdd(uint8_t accumulator, uint8_t operand, bool carry)
+{
+    (void)carry;
+
+    BCDResult result = addBCD(accumulator, operand);
+    uint16_t  temp = result.sum;
+    Entry     entry;
+
+    entry.result = temp & 0x00FF;
+    entry.flags  = flagBit(C, result.hi_nybble_carry) |
+                   flagBit(Z, (temp & 0x00FF) == 0) |
+                   flagBit(V, (~((uint16_t)accumulator ^ (uint16_t)operand) & ((uint16_t)accumulator ^ temp)) & 0x0080) |
+                   flagBit(N, temp & 0x80);
+    return entry;
+}
+
+// Decimal mode subtraction, done by adding the nines' complement of the operand.
+DecimalTables::Entry DecimalTables::computeSubtract(uint8_t accumulator, uint8_t operand, bool carry)
+{
+    uint16_t  value = 0x99 - operand;
+    BCDResult result = addBCD(accumulator, value + (uint16_t)carry);
+    uint16_t  temp = result.sum;
+    Entry     entry;
+
+    entry.result = temp & 0x00FF;
+    entry.flags  = flagBit(C, result.hi_nybble_carry) |
+                   flagBit(Z, (temp & 0x00FF) == 0) |
+                   flagBit(V, (temp ^ (uint16_t)accumulator) & (temp ^ value) & 0x0080) |
+                   flagBit(N, temp & 0x0080);
+    return entry;
+}
@@ -0,0 +1,72 @@
+#ifndef DECIMALTABLES_HPP
+#define DECIMALTABLES_HPP
+
+#include <array>
+#include <cstdint>
+#include "flags.hpp"
+
+
+/** Precomputed results for ADC and SBC while in decimal (BCD) mode.
+ *
+ *  The nibble-by-nibble arithmetic of decimal mode needs several branches
+ *  per operation.  Since there are only 256 x 256 x 2 (accumulator, operand,
+ *  carry in) possible inputs, we compute every answer once and turn each
+ *  decimal ADC/SBC into a single table lookup.
+ *
+ *  Each entry holds the resulting accumulator value along with the C, Z, V
+ *  and N flags, already positioned as they are in the status register, so
+ *  the flags can be merged into the status register with one mask.
+ */
+class DecimalTables
+{
+public:
+    struct Entry
+    {
+        uint8_t result = 0x00;
+        uint8_t flags  = 0x00; ///< Only ever contains the bits in @c affectedFlags()
+    };
+
+    /** The status register bits that are replaced by a table entry.
+     *
+     */
+    static constexpr uint8_t affectedFlags() { return C | Z | V | N; }
+
+    /** Retrieves the (lazily built) shared tables.
+     *
+     */
+    static const DecimalTables &instance();
+
+    const Entry &add(uint8_t accumulator, uint8_t operand, bool carry) const
+    {
+        return _add[index(accumulator, operand, carry)];
+    }
+
+    const Entry &subtract(uint8_t accumulator, uint8_t operand, bool carry) const
+    {
+        return _subtract[index(accumulator, operand, carry)];
+    }
+
+    /** The nibble-by-nibble computations the tables are generated from.
+     *
+     *  These are kept available so the tables can be validated against them.
+     */
+    ///@{
+    static Entry computeAdd(uint8_t accumulator, uint8_t operand, bool carry);
+    static Entry computeSubtract(uint8_t accumulator, uint8_t operand, bool carry);
+    ///@}
+
+private:
+    using table_type = std::array<Entry, 2 * 256 * 256>;
+
+    DecimalTables();
+
+    static constexpr uint32_t index(uint8_t accumulator, uint8_t operand, bool carry)
+    {
+        return (static_cast<uint32_t>(carry) << 16) | (static_cast<uint32_t>(accumulator) << 8) | operand;
+    }
+
+    table_type _add;
+    table_type _subtract;
+};
+
+#endif // DECIMALTABLES_HPP
@@ -0,0 +1,53 @@
+#include "executionstatistics.hpp"
+#include "opcodes.hpp"
+#include <algorithm>
+#include <numeric>
+
+
+uint64_t ExecutionStatistics::addressModeCount(AddressMode_e mode) const
+{
+    uint64_t count = 0;
+
+    for (unsigned opcode = 0; opcode < _opcodes.size(); ++opcode)
+    {
+        if (AddressModeOf(static_cast<uint8_t>(opcode)) == mode)
+            count += _opcodes[opcode];
+    }
+    return count;
+}
+
+uint64_t ExecutionStatistics::instructions() const
+{
+    return std::accumulate(_opcodes.begin(), _opcodes.end(), uint64_t{ 0 });
+}
+
+uint64_t ExecutionStatistics::branchesNotTaken() const
+{
+    // Every relative instruction is a branch, and it either went or it didn't
+    return addressModeCount(AddressMode_e::Relative) - _branches_taken;
+}
+
+void ExecutionStatistics::clear()
+{
+    *this = ExecutionStatistics();
+}
+
+std::vector<ExecutionStatistics::OpcodeCount> ExecutionStatistics::mostFrequent(size_t maximum) const
+{
+    std::vector<OpcodeCount> counts;
+
+    for (unsigned opcode = 0; opcode < _opcodes.size(); ++opcode)
+        if (_opcodes[opcode])
+            counts.push_back({ static_cast<uint8_t>(opcode), _opcodes[opcode] });
+
+    // Ties are broken by opcode, so the order is always the same.
+    std::sort(counts.begin(), counts.end(), [](const OpcodeCount &left, const OpcodeCount &right)
+    {
+        if (left.count != right.count)
+            return left.count > right.count;
+        return left.opcode < right.opcode;
+    });
+    if (counts.size() > maximum)
+        counts.resize(maximum);
+    return counts;
+}
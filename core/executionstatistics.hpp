@@ -0,0 +1,78 @@
+#ifndef EXECUTIONSTATISTICS_HPP
+#define EXECUTIONSTATISTICS_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "instructions.hpp"
+
+
+/** What the executor has been doing: how often each opcode ran, how many
+ *  page crossings cost an extra cycle, which way the branches went and how
+ *  much arithmetic was done in decimal mode.
+ *
+ *  The executor always keeps these, at the cost of an increment or two per
+ *  instruction.  Anything that can be worked out from the opcode counts,
+ *  like the counts per addressing mode or the branches not taken, is only
+ *  worked out when asked for.
+ */
+class ExecutionStatistics
+{
+public:
+    struct OpcodeCount
+    {
+        uint8_t  opcode;
+        uint64_t count;
+    };
+
+    /** Counting, from the executor.
+     *
+     */
+    ///@{
+    void recordOpcode(uint8_t opcode) { ++_opcodes[opcode]; }
+    void recordPageCrossing(uint8_t penalty) { _page_crossings += penalty; } ///< @p penalty is 0 or 1
+    void recordBranchTaken(bool crossed_page) { ++_branches_taken; _branch_page_crossings += crossed_page; }
+    void recordDecimalAddition() { ++_decimal_additions; }
+    void recordDecimalSubtraction() { ++_decimal_subtractions; }
+    ///@}
+
+    uint64_t opcodeCount(uint8_t opcode) const { return _opcodes[opcode]; }
+    uint64_t addressModeCount(AddressMode_e mode) const;
+    uint64_t instructions() const; ///< Both halves of a superinstruction count
+
+    /** Extra cycles taken by indexed reads that crossed into the next page.
+     *
+     */
+    uint64_t pageCrossings() const { return _page_crossings; }
+
+    /** Branches taken, the ones of those whose target was on another page,
+     *  and branches that carried straight on.
+     */
+    ///@{
+    uint64_t branchesTaken() const { return _branches_taken; }
+    uint64_t branchPageCrossings() const { return _branch_page_crossings; }
+    uint64_t branchesNotTaken() const;
+    ///@}
+
+    uint64_t decimalAdditions() const { return _decimal_additions; } ///< ADC with D set
+    uint64_t decimalSubtractions() const { return _decimal_subtractions; } ///< SBC with D set
+
+    void clear();
+
+    /** The @p maximum most frequent opcodes, most frequent first.
+     *
+     *  Opcodes that never ran are not included.
+     */
+    std::vector<OpcodeCount> mostFrequent(size_t maximum = 256) const;
+
+private:
+    std::array<uint64_t, 256> _opcodes{};
+    uint64_t                  _page_crossings = 0;
+    uint64_t                  _branches_taken = 0;
+    uint64_t                  _branch_page_crossings = 0;
+    uint64_t                  _decimal_additions = 0;
+    uint64_t                  _decimal_subtractions = 0;
+};
+
+#endif // EXECUTIONSTATISTICS_HPP
@@ -0,0 +1,30 @@
+#ifndef FLAGS_HPP
+#define FLAGS_HPP
+
+#include <array>
+#include <cstdint>
+
+enum FLAGS6502 : uint8_t
+{
+    C = (1 << 0),	// Carry Bit
+    Z = (1 << 1),	// Zero
+    I = (1 << 2),	// Disable Interrupts
+    D = (1 << 3),	// Decimal Mode (unused in this implementation)
+    B = (1 << 4),	// Break
+    U = (1 << 5),	// Unused
+    V = (1 << 6),	// Overflow
+    N = (1 << 7),	// Negative
+};
+
+// The N and Z flags that a result value produces, indexed by that value.
+// This lets an instruction update both flags with a single lookup.
+inline constexpr std::array<uint8_t, 256> NZFlagsTable = []
+{
+    std::array<uint8_t, 256> table{};
+
+    for (int value = 0; value < 256; ++value)
+        table[value] = (value == 0x00) ? Z : (value & N);
+    return table;
+}();
+
+#endif // FLAGS_HPP
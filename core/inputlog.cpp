@@ -0,0 +1,27 @@
+#include "inputlog.hpp"
+#include <algorithm>
+
+
+void InputLog::record(uint64_t cycle, Input input)
+{
+    discardFrom(cycle + 1);
+    _events.push_back({ cycle, input });
+}
+
+void InputLog::discardFrom(uint64_t cycle)
+{
+    _events.erase(_events.begin() + static_cast<std::ptrdiff_t>(firstAt(cycle)), _events.end());
+}
+
+void InputLog::discardBefore(uint64_t cycle)
+{
+    _events.erase(_events.begin(), _events.begin() + static_cast<std::ptrdiff_t>(firstAt(cycle)));
+}
+
+size_t InputLog::firstAt(uint64_t cycle) const
+{
+    const auto first = std::lower_bound(_events.begin(), _events.end(), cycle,
+                                        [](const Event &event, uint64_t wanted) { return event.cycle < wanted; });
+
+    return static_cast<size_t>(first - _events.begin());
+}
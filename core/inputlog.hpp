@@ -0,0 +1,72 @@
+#ifndef INPUTLOG_HPP
+#define INPUTLOG_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/** What happened to a machine from outside, and at which clock tick.
+ *
+ *  The executor is deterministic: the same state, clocked the same number of
+ *  times with the same interrupts at the same ticks, always ends up in the
+ *  same state.  A snapshot and this log are therefore enough to get back to
+ *  any tick after the snapshot, by clocking forward and feeding in each
+ *  input as its tick comes round.
+ *
+ *  An input logged at a tick happened once the machine had got there, so a
+ *  snapshot taken at that tick doesn't include it.
+ */
+class InputLog
+{
+public:
+    enum class Input : uint8_t
+    {
+        Reset,
+        Irq,
+        Nmi
+    };
+
+    struct Event
+    {
+        uint64_t cycle;
+        Input    input;
+    };
+
+    /** Adds @p input at tick @p cycle.
+     *
+     *  Anything logged after that tick is dropped first: that was a future
+     *  that has been rewound away.
+     */
+    void record(uint64_t cycle, Input input);
+
+    void discardFrom(uint64_t cycle);   ///< Drops the inputs at or after @p cycle
+    void discardBefore(uint64_t cycle); ///< Drops the inputs before @p cycle
+    void clear() { _events.clear(); }
+
+    const std::vector<Event> &events() const { return _events; } ///< Oldest first
+
+    /** @return The index of the first event at or after @p cycle, or the
+     *          number of events if there is none
+     */
+    size_t firstAt(uint64_t cycle) const;
+
+    /** Gives @p input to @p cpu, anything with reset(), irq() and nmi().
+     *
+     */
+    template <typename Cpu>
+    static void apply(Cpu &cpu, Input input)
+    {
+        switch (input)
+        {
+        case Input::Reset: cpu.reset(); break;
+        case Input::Irq:   cpu.irq();   break;
+        case Input::Nmi:   cpu.nmi();   break;
+        }
+    }
+
+private:
+    std::vector<Event> _events;
+};
+
+#endif // INPUTLOG_HPP
@@ -0,0 +1,2134 @@
+#include "instructionexecutor.hpp"
+#include "decimaltables.hpp"
+#include "instructiontable.hpp"
+#include "opcodes.hpp"
+
+// The threaded engine needs "labels as values", a GCC extension Clang has too.
+#if defined(__GNUC__)
+#define EMULATOR_HAS_COMPUTED_GOTO
+#endif
+
+// Chaining instructions with tail calls is only safe when the compiler
+// guarantees them, otherwise every instruction would grow the stack.
+#if !defined(EMULATOR_MUSTTAIL) && defined(__has_cpp_attribute)
+#if __has_cpp_attribute(clang::musttail)
+#define EMULATOR_MUSTTAIL [[clang::musttail]]
+#elif __has_cpp_attribute(gnu::musttail)
+#define EMULATOR_MUSTTAIL [[gnu::musttail]]
+#endif
+#endif
+#if defined(EMULATOR_MUSTTAIL)
+#define EMULATOR_HAS_TAIL_CALLS
+#endif
+
+#if defined(EMULATOR_ENGINE_THREADED) && !defined(EMULATOR_HAS_COMPUTED_GOTO)
+#error "The threaded engine needs a compiler with computed goto (GCC or Clang)"
+#endif
+#if defined(EMULATOR_ENGINE_TAILCALL) && !defined(EMULATOR_HAS_TAIL_CALLS)
+#error "The tail call engine needs a compiler with guaranteed tail calls (musttail)"
+#endif
+
+
+InstructionExecutor::InstructionExecutor(readDelegate  read_signal,
+                                         writeDelegate write_signal,
+                                         registerValueChangedDelegate a_changed_signal,
+                                         registerValueChangedDelegate x_changed_signal,
+                                         registerValueChangedDelegate y_changed_signal,
+                                         addressValueChangedDelegate  program_counter_changed_signal,
+                                         registerValueChangedDelegate stack_pointer_changed_signal,
+                                         registerValueChangedDelegate status_changed_signal
+                                         )
+    :
+    _read_delegate(read_signal),
+    _write_delegate(write_signal),
+    _fusion(256),
+    _observers{ a_changed_signal,
+                x_changed_signal,
+                y_changed_signal,
+                stack_pointer_changed_signal,
+                program_counter_changed_signal,
+                status_changed_signal }
+{
+    // Assembles the translation table. The instruction set itself lives in
+    // instructiontable.hpp, so the threaded interpreters can be generated
+    // from exactly the same entries. It is one big initializer list, with
+    // an entry per opcode in numerical order.
+
+    // For convenience to get function pointers to members of this class, I'm using this
+    // or else it will be much much larger :D
+    using a = InstructionExecutor;
+#define LOOKUP_ENTRY(opcode, name, operate, addrmode, cycles) { name, &a::operate, &a::addrmode, cycles },
+    _lookup = { INSTRUCTION_TABLE(LOOKUP_ENTRY) };
+#undef LOOKUP_ENTRY
+
+    updateDispatchTables();
+}
+
+// The 6502 can address between 0x0000 - 0xFFFF. The high byte is often referred
+// to as the "page", and the low byte is the offset into that page. This implies
+// there are 256 pages, each containing 256 bytes.
+//
+// Several addressing modes have the potential to require an additional clock
+// cycle if they cross a page boundary. This is combined with several instructions
+// that enable this additional clock cycle. So each addressing function returns
+// a flag saying it has potential, as does each instruction. If both instruction
+// and address function return 1, then an additional clock cycle is required.
+
+
+// Address Mode: Implied
+// There is no additional data required for this instruction. The instruction
+// does something very simple like like sets a status bit. However, we will
+// target the accumulator, for instructions like PHA
+uint8_t InstructionExecutor::IMP()
+{
+    _state.fetched = _state.registers.a;
+    return 0;
+}
+
+// Address Mode: Immediate
+// The instruction expects the next byte to be used as a value, so we'll prep
+// the read address to point to the next byte
+uint8_t InstructionExecutor::IMM()
+{
+    _state.addr_abs = _state.registers.program_counter++;
+    return 0;
+}
+
+// Address Mode: Zero Page
+// To save program bytes, zero page addressing allows you to absolutely address
+// a location in first 0xFF bytes of address range. Clearly this only requires
+// one byte instead of the usual two.
+uint8_t InstructionExecutor::ZP0()
+{
+    _state.addr_abs = readCode(_state.registers.program_counter);
+    _state.registers.program_counter++;
+    _state.addr_abs &= 0x00FF;
+    return 0;
+}
+
+// Address Mode: Zero Page with X Offset
+// Fundamentally the same as Zero Page addressing, but the contents of the X Register
+// is added to the supplied single byte address. This is useful for iterating through
+// ranges within the first page.
+uint8_t InstructionExecutor::ZPX()
+{
+    _state.addr_abs = (readCode(_state.registers.program_counter) + _state.registers.x);
+    _state.registers.program_counter++;
+    _state.addr_abs &= 0x00FF;
+    return 0;
+}
+
+// Address Mode: Zero Page with Y Offset
+// Same as above but uses Y Register for offset
+uint8_t InstructionExecutor::ZPY()
+{
+    _state.addr_abs = (readCode(_state.registers.program_counter) + _state.registers.y);
+    _state.registers.program_counter++;
+    _state.addr_abs &= 0x00FF;
+    return 0;
+}
+
+// Address Mode: Relative
+// This address mode is exclusive to branch instructions. The address
+// must reside within -128 to +127 of the branch instruction, i.e.
+// you cant directly branch to any address in the addressable range.
+uint8_t InstructionExecutor::REL()
+{
+    _state.addr_rel = readCode(_state.registers.program_counter);
+    _state.registers.program_counter++;
+    if (_state.addr_rel & 0x80)
+        _state.addr_rel |= 0xFF00;
+    return 0;
+}
+
+// Address Mode: Absolute
+// A full 16-bit address is loaded and used
+uint8_t InstructionExecutor::ABS()
+{
+    uint16_t lo = readCode(_state.registers.program_counter);
+    _state.registers.program_counter++;
+    uint16_t hi = readCode(_state.registers.program_counter);
+    _state.registers.program_counter++;
+    _state.addr_abs = (hi << 8) | lo;
+
+    return 0;
+}
+
+// Address Mode: Absolute with X Offset
+// Fundamentally the same as absolute addressing, but the contents of the X Register
+// is added to the supplied two byte address. If the resulting address changes
+// the page, an additional clock cycle is required
+uint8_t InstructionExecutor::ABX()
+{
+    uint16_t lo = readCode(_state.registers.program_counter);
+    _state.registers.program_counter++;
+    uint16_t hi = readCode(_state.registers.program_counter);
+    _state.registers.program_counter++;
+
+    _state.addr_abs = (hi << 8) | lo;
+    _state.addr_abs += _state.registers.x;
+
+    if ((_state.addr_abs & 0xFF00) != (hi << 8))
+        return 1;
+    else
+        return 0;
+}
+
+// Address Mode: Absolute with Y Offset
+// Fundamentally the same as absolute addressing, but the contents of the Y Register
+// is added to the supplied two byte address. If the resulting address changes
+// the page, an additional clock cycle is required
+uint8_t InstructionExecutor::ABY()
+
+{
+    uint16_t lo = readCode(_state.registers.program_counter);
+    _state.registers.program_counter++;
+    uint16_t hi = readCode(_state.registers.program_counter);
+    _state.registers.program_counter++;
+
+    _state.addr_abs = (hi << 8) | lo;
+
+    _state.addr_abs += _state.registers.y;
+
+    if ((_state.addr_abs & 0xFF00) != (hi << 8))
+        return 1;
+    else
+        return 0;
+}
+
+// Note: The next 3 address modes use indirection (aka Pointers!)
+
+// Address Mode: Indirect
+// The supplied 16-bit address is read to get the actual 16-bit address. This is
+// instruction is unusual in that it has a bug in the hardware! To emulate its
+// function accurately, we also need to emulate this bug. If the low byte of the
+// supplied address is 0xFF, then to read the high byte of the actual address
+// we need to cross a page boundary. This doesnt actually work on the chip as
+// designed, instead it wraps back around in the same page, yielding an
+// invalid actual address
+uint8_t InstructionExecutor::IND()
+{
+    uint16_t ptr_lo = readCode(_state.registers.program_counter);
+    _state.registers.program_counter++;
+    uint16_t ptr_hi = readCode(_state.registers.program_counter);
+    _state.registers.program_counter++;
+
+    uint16_t ptr = (ptr_hi << 8) | ptr_lo;
+
+    if (ptr_lo == 0x00FF) // Simulate page boundary hardware bug
+    {
+        _state.addr_abs = (readPointer(ptr & 0xFF00) << 8) | readPointer(ptr + 0);
+    }
+    else // Behave normally
+    {
+        _state.addr_abs = (readPointer(ptr + 1) << 8) | readPointer(ptr + 0);
+    }
+    return 0;
+}
+
+// Address Mode: Indirect X
+// The supplied 8-bit address is offset by X Register to index
+// a location in page 0x00. The actual 16-bit address is read
+// from this location
+uint8_t InstructionExecutor::IZX()
+{
+    uint16_t t = readCode(_state.registers.program_counter);
+    _state.registers.program_counter++;
+
+    uint16_t lo = readPointer((uint16_t)(t + (uint16_t)_state.registers.x) & 0x00FF);
+    uint16_t hi = readPointer((uint16_t)(t + (uint16_t)_state.registers.x + 1) & 0x00FF);
+
+    _state.addr_abs = (hi << 8) | lo;
+
+    return 0;
+}
+
+// Address Mode: Indirect Y
+// The supplied 8-bit address indexes a location in page 0x00. From
+// here the actual 16-bit address is read, and the contents of
+// Y Register is added to it to offset it. If the offset causes a
+// change in page then an additional clock cycle is required.
+uint8_t InstructionExecutor::IZY()
+{
+    uint16_t t = readCode(_state.registers.program_counter);
+    _state.registers.program_counter++;
+
+    uint16_t lo = readPointer(t & 0x00FF);
+    uint16_t hi = readPointer((t + 1) & 0x00FF);
+
+    _state.addr_abs = (hi << 8) | lo;
+    _state.addr_abs += _state.registers.y;
+
+    if ((_state.addr_abs & 0xFF00) != (hi << 8))
+        return 1;
+    else
+        return 0;
+}
+
+// This function sources the data used by the instruction into
+// a convenient numeric variable. Some instructions dont have to
+// fetch data as the source is implied by the instruction. For example
+// "INX" increments the X register. There is no additional data
+// required. For all other addressing modes, the data resides at
+// the location held within addr_abs, so it is read from there.
+// Immediate adress mode exploits this slightly, as that has
+// set addr_abs = pc + 1, so it fetches the data from the
+// next byte for example "LDA $FF" just loads the accumulator with
+// 256, i.e. no far reaching memory fetch is required. "fetched"
+// is a variable global to the CPU, and is set by calling this
+// function. It also returns it for convenience.
+uint8_t InstructionExecutor::fetch()
+{
+    if (!(_lookup[_state.opcode].addrmode == &InstructionExecutor::IMP))
+        _state.fetched = read(_state.addr_abs);
+    return _state.fetched;
+}
+
+uint8_t InstructionExecutor::read(addressType address, bool read_only)
+{
+    if (_coverage && !read_only)
+        _coverage->record(address, CoverageMap::Read);
+    if (_access_counters && !read_only)
+        _access_counters->record(AccessCounters::Read, address);
+    return (_read_delegate) ? _read_delegate(address, read_only) : 0x00;
+}
+
+void InstructionExecutor::write(addressType address, uint8_t data)
+{
+    if (_coverage)
+        _coverage->record(address, CoverageMap::Written);
+    if (_access_counters)
+        _access_counters->record(AccessCounters::Write, address);
+    if (_write_delegate)
+        _write_delegate(address, data);
+}
+
+uint8_t InstructionExecutor::readCode(addressType address)
+{
+    return (_read_delegate) ? _read_delegate(address, false) : 0x00;
+}
+
+uint8_t InstructionExecutor::readPointer(addressType address)
+{
+    if (_coverage)
+        _coverage->record(address, CoverageMap::IndirectPointer);
+    return read(address);
+}
+
+// Forces the 6502 into a known state. This is hard-wired inside the CPU. The
+// registers are set to 0x00, the status register is cleared except for unused
+// bit which remains at 1. An absolute address is read from location 0xFFFC
+// which contains a second address that the program counter is set to. This
+// allows the programmer to jump to a known and programmable location in the
+// memory to start executing from. Typically the programmer would set the value
+// at location 0xFFFC at compile time.
+void InstructionExecutor::reset()
+{
+    // Get address to set program counter to
+    _state.addr_abs = 0xFFFC;
+    uint16_t lo = readPointer(_state.addr_abs + 0);
+    uint16_t hi = readPointer(_state.addr_abs + 1);
+
+    // Set it
+    _state.registers.program_counter = (hi << 8) | lo;
+
+    // Reset internal registers
+    _state.registers.a = 0;
+    _state.registers.x = 0;
+    _state.registers.y = 0;
+    _state.registers.stack_pointer = 0xFD;
+    discardPendingFlags();
+    _state.registers.status = 0x00 | U;
+
+    // Clear internal helper variables
+    _state.addr_rel = 0x0000;
+    _state.addr_abs = 0x0000;
+    _state.fetched = 0x00;
+
+    // Reset takes time
+    _state.cycles = 8;
+
+    if (_profiler)
+        _profiler->unwind();
+}
+
+void InstructionExecutor::irq()
+{
+    // If interrupts are allowed
+    if (GetFlag(I) == 0)
+    {
+        const uint8_t stack_pointer = _state.registers.stack_pointer;
+
+        // Push the program counter to the stack. It's 16-bits dont
+        // forget so that takes two pushes
+        write(0x0100 + _state.registers.stack_pointer, (_state.registers.program_counter >> 8) & 0x00FF);
+        _state.registers.stack_pointer--;
+        write(0x0100 + _state.registers.stack_pointer, _state.registers.program_counter & 0x00FF);
+        _state.registers.stack_pointer--;
+
+        // Then Push the status register to the stack
+        SetFlags(B | U | I, U | I);
+        write(0x0100 + _state.registers.stack_pointer, status());
+        _state.registers.stack_pointer--;
+
+        // Read new program counter location from fixed address
+        _state.addr_abs = 0xFFFE;
+        uint16_t lo = readPointer(_state.addr_abs + 0);
+        uint16_t hi = readPointer(_state.addr_abs + 1);
+        _state.registers.program_counter = (hi << 8) | lo;
+
+        // IRQs take time
+        _state.cycles = 7;
+
+        if (_profiler)
+            _profiler->interrupt(_state.registers.program_counter, stack_pointer, _state.cycles);
+    }
+}
+
+void InstructionExecutor::nmi()
+{
+    const uint8_t stack_pointer = _state.registers.stack_pointer;
+
+    write(0x0100 + _state.registers.stack_pointer, (_state.registers.program_counter >> 8) & 0x00FF);
+    _state.registers.stack_pointer--;
+    write(0x0100 + _state.registers.stack_pointer, _state.registers.program_counter & 0x00FF);
+    _state.registers.stack_pointer--;
+
+    SetFlags(B | U | I, U | I);
+    write(0x0100 + _state.registers.stack_pointer, status());
+    _state.registers.stack_pointer--;
+
+    _state.addr_abs = 0xFFFA;
+    uint16_t lo = readPointer(_state.addr_abs + 0);
+    uint16_t hi = readPointer(_state.addr_abs + 1);
+    _state.registers.program_counter = (hi << 8) | lo;
+
+    _state.cycles = 8;
+
+    if (_profiler)
+        _profiler->interrupt(_state.registers.program_counter, stack_pointer, _state.cycles);
+}
+
+void InstructionExecutor::clock()
+{
+    // Each instruction requires a variable number of clock cycles to execute.
+    // In my emulation, I only care about the final result and so I perform
+    // the entire computation in one hit. In hardware, each clock cycle would
+    // perform "microcode" style transformations of the CPUs state.
+    //
+    // To remain compliant with connected devices, it's important that the
+    // emulation also takes "time" in order to execute instructions, so I
+    // implement that delay by simply counting down the cycles required by
+    // the instruction. When it reaches 0, the instruction is complete, and
+    // the next one is ready to be executed.
+    if (complete())
+    {
+        // Let's remember the previous values so we may only emit a single signal for whatever changed.
+        Registers registers_before = _state.registers;
+
+        if (_trace || _profiler)
+            observeNextInstruction(_cycle_count);
+        else
+            executeNextInstruction();
+
+        notifyChanges(registers_before);
+    }
+
+    // Increment global clock count - Traces record it, and its a handy
+    // watch variable for debugging
+    clock_ticks++;
+    _cycle_count++;
+
+    // Decrement the number of cycles remaining for this instruction
+    _state.cycles--;
+}
+
+uint32_t InstructionExecutor::run(uint32_t cycles)
+{
+    // Nobody is told about the intermediate states, so only the state at
+    // the start needs remembering.  The loops themselves keep their
+    // bookkeeping in locals, and only the hot state is touched per instruction.
+    const Registers registers_before = registers();
+    uint32_t        elapsed = _state.cycles;
+
+    _state.stop_requested = false;
+
+    if (_trace || _profiler)
+        elapsed = runObserved(cycles, elapsed);
+    else
+    {
+        switch (_engine)
+        {
+        case Engine::Threaded:
+            elapsed = runThreaded(cycles, elapsed);
+            break;
+        case Engine::TailCall:
+            elapsed = runTailCalls(cycles, elapsed);
+            break;
+        case Engine::Table:
+            elapsed = runTable(cycles, elapsed);
+            break;
+        }
+    }
+
+    _state.cycles = 0;
+    clock_ticks += elapsed;
+    _cycle_count += elapsed;
+    notifyChanges(registers_before);
+    return elapsed;
+}
+
+void InstructionExecutor::executeNextInstruction()
+{
+    // Read next instruction byte. This 8-bit value is used to index
+    // the translation table to get the relevant information about
+    // how to implement the instruction
+    beginInstruction(readCode(_state.registers.program_counter));
+    completeInstruction();
+}
+
+void InstructionExecutor::traceNextInstruction(uint64_t cycle)
+{
+    const uint16_t      pc = _state.registers.program_counter;
+    const uint8_t       opcode = readCode(pc);
+    const AddressMode_e mode = AddressModeOf(opcode);
+    const uint8_t       operand_bytes = OperandBytesOf(mode);
+    TraceRecord        &record = _trace->next();
+
+    // The registers as the instruction finds them, with any pending flags
+    materializeFlags();
+    record.cycle = cycle;
+    record.program_counter = pc;
+    record.opcode = opcode;
+    record.length = 1 + operand_bytes;
+    record.operands[0] = (operand_bytes > 0) ? read(static_cast<addressType>(pc + 1), true) : 0x00;
+    record.operands[1] = (operand_bytes > 1) ? read(static_cast<addressType>(pc + 2), true) : 0x00;
+    record.a = _state.registers.a;
+    record.x = _state.registers.x;
+    record.y = _state.registers.y;
+    record.stack_pointer = _state.registers.stack_pointer;
+    record.status = _state.registers.status;
+    record.reserved[0] = record.reserved[1] = record.reserved[2] = 0x00;
+
+    beginInstruction(opcode);
+    completeInstruction();
+
+    // Not taken branches leave addr_abs alone, so their target is worked out
+    if (mode == AddressMode_e::Relative)
+        record.effective_address = static_cast<uint16_t>(pc + 2 + static_cast<int8_t>(record.operands[0]));
+    else if ((mode == AddressMode_e::Implied) || (mode == AddressMode_e::Accumulator))
+        record.effective_address = 0x0000;
+    else
+        record.effective_address = _state.addr_abs;
+    _trace->commit();
+}
+
+void InstructionExecutor::observeNextInstruction(uint64_t cycle)
+{
+    const uint16_t pc = _state.registers.program_counter;
+    const uint8_t  stack_pointer = _state.registers.stack_pointer;
+
+    if (_trace)
+        traceNextInstruction(cycle);
+    else
+        executeNextInstruction();
+    if (_profiler)
+        _profiler->record(pc, _state.opcode, stack_pointer, _state.registers.program_counter, _state.cycles);
+}
+
+void InstructionExecutor::beginInstruction(uint8_t opcode)
+{
+    if (_pair_histogram)
+        _pair_histogram->record(_state.opcode, opcode);
+    _statistics.recordOpcode(opcode);
+    if (_coverage)
+        _coverage->recordInstruction(_state.registers.program_counter, OperandBytesOf(AddressModeOf(opcode)));
+    if (_access_counters)
+        _access_counters->recordInstruction(_state.registers.program_counter, OperandBytesOf(AddressModeOf(opcode)));
+    _state.opcode = opcode;
+    _state.instructions++;
+
+    // Always set the unused status flag bit to 1
+    SetFlag(U, true);
+
+    // Increment program counter, we read the opcode byte
+    _state.registers.program_counter++;
+}
+
+uint8_t InstructionExecutor::completeInstruction()
+{
+    const INSTRUCTION &instruction = _lookup[_state.opcode];
+
+    // Get Starting number of cycles
+    _state.cycles = instruction.cycles;
+
+    // Perform fetch of intermmediate data using the
+    // required addressing mode
+    uint8_t additional_cycle1 = (this->*instruction.addrmode)();
+
+    // Perform operation
+    uint8_t additional_cycle2 = (this->*instruction.operate)();
+
+    // The addressmode and opcode may have altered the number
+    // of cycles this instruction requires before its completed
+    _state.cycles += (additional_cycle1 & additional_cycle2);
+    _statistics.recordPageCrossing(additional_cycle1 & additional_cycle2);
+
+    if (additional_cycle2 > 1)
+        _state.cycles += additional_cycle2 - 1; // Takes care of being in BCD mode
+
+    // Always set the unused status flag bit to 1
+    SetFlag(U, true);
+    return _state.cycles;
+}
+
+// Interpreter engines ==========================================
+// Three ways of getting from one instruction to the next, all running the
+// same addressing modes and operations from instructiontable.hpp. The
+// table engine makes two indirect calls per instruction through _lookup.
+// The other two generate a handler per opcode, with the addressing mode
+// and operation known at compile time so they can be inlined, and jump
+// from handler to handler without returning to a central loop: that gives
+// every opcode its own indirect jump, which predicts far better than one
+// shared call site.
+
+auto InstructionExecutor::defaultEngine() -> Engine
+{
+#if defined(EMULATOR_ENGINE_THREADED)
+    return Engine::Threaded;
+#elif defined(EMULATOR_ENGINE_TAILCALL)
+    return Engine::TailCall;
+#else
+    return Engine::Table;
+#endif
+}
+
+bool InstructionExecutor::engineAvailable(Engine engine)
+{
+    switch (engine)
+    {
+    case Engine::Table:
+        return true;
+    case Engine::Threaded:
+#if defined(EMULATOR_HAS_COMPUTED_GOTO)
+        return true;
+#else
+        return false;
+#endif
+    case Engine::TailCall:
+#if defined(EMULATOR_HAS_TAIL_CALLS)
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+bool InstructionExecutor::setEngine(Engine engine)
+{
+    if (!engineAvailable(engine))
+        return false;
+    _engine = engine;
+    return true;
+}
+
+template <uint8_t (InstructionExecutor::*Operate)(void), uint8_t (InstructionExecutor::*AddressMode)(void), uint8_t Cycles>
+uint8_t InstructionExecutor::execute()
+{
+    _state.cycles = Cycles;
+
+    uint8_t additional_cycle1 = (this->*AddressMode)();
+    uint8_t additional_cycle2 = (this->*Operate)();
+
+    _state.cycles += (additional_cycle1 & additional_cycle2);
+    _statistics.recordPageCrossing(additional_cycle1 & additional_cycle2);
+
+    if (additional_cycle2 > 1)
+        _state.cycles += additional_cycle2 - 1; // Takes care of being in BCD mode
+
+    SetFlag(U, true);
+    return _state.cycles;
+}
+
+uint32_t InstructionExecutor::runTable(uint32_t cycles, uint32_t elapsed)
+{
+    while ((elapsed < cycles) && !_state.stop_requested)
+    {
+        uint8_t opcode = readCode(_state.registers.program_counter);
+
+        beginInstruction(opcode);
+        if (superinstructionHandler fused = _fusion[opcode].handler)
+            elapsed += (this->*fused)();
+        else
+            elapsed += completeInstruction();
+    }
+    return elapsed;
+}
+
+uint32_t InstructionExecutor::runObserved(uint32_t cycles, uint32_t elapsed)
+{
+    while ((elapsed < cycles) && !_state.stop_requested)
+    {
+        observeNextInstruction(_cycle_count + elapsed);
+        elapsed += _state.cycles;
+    }
+    return elapsed;
+}
+
+uint32_t InstructionExecutor::runThreaded(uint32_t cycles, uint32_t elapsed)
+{
+#if defined(EMULATOR_HAS_COMPUTED_GOTO)
+    using a = InstructionExecutor;
+
+#define HANDLER_ADDRESS(code, name, operate, addrmode, base_cycles) &&opcode_##code,
+    static void *const handlers[256] = { INSTRUCTION_TABLE(HANDLER_ADDRESS) };
+#undef HANDLER_ADDRESS
+
+    // Superinstructions take over the handler of the first opcode of their
+    // pair.  The table is kept from one run to the next, until they change.
+    if (_threaded_dispatch.empty())
+    {
+        _threaded_dispatch.resize(256);
+        for (int i = 0; i < 256; ++i)
+            _threaded_dispatch[i] = (_fusion[i].handler) ? &&fused : handlers[i];
+    }
+
+    void *const *const dispatch = _threaded_dispatch.data();
+    uint8_t            opcode;
+
+#define DISPATCH() \
+    if ((elapsed >= cycles) || _state.stop_requested) \
+        return elapsed; \
+    opcode = readCode(_state.registers.program_counter); \
+    beginInstruction(opcode); \
+    goto *dispatch[opcode]
+
+    DISPATCH();
+
+#define HANDLER(code, name, operate, addrmode, base_cycles) \
+opcode_##code: \
+    elapsed += execute<&a::operate, &a::addrmode, base_cycles>(); \
+    DISPATCH();
+
+    INSTRUCTION_TABLE(HANDLER)
+
+#undef HANDLER
+
+fused:
+    elapsed += (this->*_fusion[opcode].handler)();
+    DISPATCH();
+
+#undef DISPATCH
+#else
+    return runTable(cycles, elapsed);
+#endif
+}
+
+uint32_t InstructionExecutor::runTailCalls(uint32_t cycles, uint32_t elapsed)
+{
+#if defined(EMULATOR_HAS_TAIL_CALLS)
+    return dispatchTailCall(*this, cycles, elapsed);
+#else
+    return runTable(cycles, elapsed);
+#endif
+}
+
+#if defined(EMULATOR_HAS_TAIL_CALLS)
+uint32_t InstructionExecutor::dispatchTailCall(InstructionExecutor &cpu, uint32_t cycles, uint32_t elapsed)
+{
+    if ((elapsed >= cycles) || cpu._state.stop_requested)
+        return elapsed;
+
+    uint8_t opcode = cpu.readCode(cpu._state.registers.program_counter);
+
+    cpu.beginInstruction(opcode);
+    EMULATOR_MUSTTAIL return cpu._tail_calls[opcode](cpu, cycles, elapsed);
+}
+
+template <uint8_t (InstructionExecutor::*Operate)(void), uint8_t (InstructionExecutor::*AddressMode)(void), uint8_t Cycles>
+uint32_t InstructionExecutor::tailCall(InstructionExecutor &cpu, uint32_t cycles, uint32_t elapsed)
+{
+    elapsed += cpu.execute<Operate, AddressMode, Cycles>();
+    EMULATOR_MUSTTAIL return dispatchTailCall(cpu, cycles, elapsed);
+}
+
+uint32_t InstructionExecutor::fusedTailCall(InstructionExecutor &cpu, uint32_t cycles, uint32_t elapsed)
+{
+    elapsed += (cpu.*cpu._fusion[cpu._state.opcode].handler)();
+    EMULATOR_MUSTTAIL return dispatchTailCall(cpu, cycles, elapsed);
+}
+#endif
+
+void InstructionExecutor::updateDispatchTables()
+{
+    // The threaded engine's labels only exist inside runThreaded(), which
+    // builds its table again on its next run
+    _threaded_dispatch.clear();
+
+#if defined(EMULATOR_HAS_TAIL_CALLS)
+    using a = InstructionExecutor;
+
+#define TAIL_CALL(code, name, operate, addrmode, base_cycles) &a::tailCall<&a::operate, &a::addrmode, base_cycles>,
+    static const tailCallHandler handlers[256] = { INSTRUCTION_TABLE(TAIL_CALL) };
+#undef TAIL_CALL
+
+    _tail_calls.resize(256);
+    for (int i = 0; i < 256; ++i)
+        _tail_calls[i] = (_fusion[i].handler) ? &a::fusedTailCall : handlers[i];
+#endif
+}
+
+// Superinstructions ============================================
+// Each handler below is entered right after the opcode of the first
+// instruction of its pair has been read (see run()). It does the work
+// of the first instruction, then checks if the second one follows. If
+// it does, and that pair is enabled, the second instruction is finished
+// by the handler as well. The results must be indistinguishable from
+// executing the two instructions one by one: same registers, same flags,
+// same memory accesses in the same order, and the same total cycles.
+
+const std::vector<InstructionExecutor::Superinstruction> &InstructionExecutor::superinstructions()
+{
+    using a = InstructionExecutor;
+    using i = AbstractInstruction_e;
+    using m = AddressMode_e;
+
+    static const std::vector<Superinstruction> pairs
+    {
+        { OpcodeFor(i::DEY, m::Implied),   OpcodeFor(i::BNE, m::Relative),         &a::DEY_BNE },
+        { OpcodeFor(i::DEX, m::Implied),   OpcodeFor(i::BNE, m::Relative),         &a::DEX_BNE },
+        { OpcodeFor(i::LDA, m::Immediate), OpcodeFor(i::STA, m::ZeroPage),         &a::LDA_STA },
+        { OpcodeFor(i::LDA, m::Immediate), OpcodeFor(i::STA, m::ZeroPageXIndexed), &a::LDA_STA },
+        { OpcodeFor(i::LDA, m::Immediate), OpcodeFor(i::STA, m::Absolute),         &a::LDA_STA },
+        { OpcodeFor(i::LDA, m::Immediate), OpcodeFor(i::STA, m::AbsoluteXIndexed), &a::LDA_STA },
+        { OpcodeFor(i::LDA, m::Immediate), OpcodeFor(i::STA, m::AbsoluteYIndexed), &a::LDA_STA },
+        { OpcodeFor(i::CMP, m::Immediate), OpcodeFor(i::BEQ, m::Relative),         &a::CMP_BEQ },
+        { OpcodeFor(i::INC, m::ZeroPage),  OpcodeFor(i::BNE, m::Relative),         &a::INC_BNE },
+        { OpcodeFor(i::CLC, m::Implied),   OpcodeFor(i::ADC, m::Immediate),        &a::CLC_ADC },
+        { OpcodeFor(i::CLC, m::Implied),   OpcodeFor(i::ADC, m::ZeroPage),         &a::CLC_ADC },
+        { OpcodeFor(i::CLC, m::Implied),   OpcodeFor(i::ADC, m::Absolute),         &a::CLC_ADC },
+    };
+
+    return pairs;
+}
+
+auto InstructionExecutor::fusiblePairs() -> std::vector<opcodePairType>
+{
+    std::vector<opcodePairType> pairs;
+
+    for (const Superinstruction &superinstruction : superinstructions())
+        pairs.emplace_back(superinstruction.first, superinstruction.second);
+    return pairs;
+}
+
+bool InstructionExecutor::enableSuperinstruction(uint8_t first, uint8_t second)
+{
+    for (const Superinstruction &superinstruction : superinstructions())
+        if ((superinstruction.first == first) && (superinstruction.second == second))
+        {
+            _fusion[first].handler = superinstruction.handler;
+            _fusion[first].seconds.set(second);
+            updateDispatchTables();
+            return true;
+        }
+    return false;
+}
+
+void InstructionExecutor::disableSuperinstructions()
+{
+    for (FusionSlot &slot : _fusion)
+        slot = FusionSlot();
+    updateDispatchTables();
+}
+
+auto InstructionExecutor::enabledSuperinstructions() const -> std::vector<opcodePairType>
+{
+    std::vector<opcodePairType> pairs;
+
+    for (const Superinstruction &superinstruction : superinstructions())
+        if (_fusion[superinstruction.first].seconds.test(superinstruction.second))
+            pairs.emplace_back(superinstruction.first, superinstruction.second);
+    return pairs;
+}
+
+size_t InstructionExecutor::selectSuperinstructions(const OpcodePairHistogram &histogram, double minimum_share)
+{
+    const uint64_t total = histogram.total();
+    size_t         enabled = 0;
+
+    disableSuperinstructions();
+    if (total == 0)
+        return 0;
+    for (const Superinstruction &superinstruction : superinstructions())
+    {
+        double share = static_cast<double>(histogram.count(superinstruction.first, superinstruction.second)) / total;
+
+        if ((share > 0.0) && (share >= minimum_share) && enableSuperinstruction(superinstruction.first, superinstruction.second))
+            ++enabled;
+    }
+    return enabled;
+}
+
+bool InstructionExecutor::continueFusion(uint32_t &cycles)
+{
+    uint8_t second = readCode(_state.registers.program_counter);
+
+    if (_fusion[_state.opcode].seconds.test(second))
+    {
+        beginInstruction(second);
+        cycles += _lookup[second].cycles;
+        return true;
+    }
+
+    // Not the pair we were hoping for, so this is just the next instruction.
+    beginInstruction(second);
+    cycles += completeInstruction();
+    return false;
+}
+
+uint32_t InstructionExecutor::fusedBranch(bool taken)
+{
+    uint32_t cycles = 0;
+
+    REL();
+    if (taken)
+    {
+        cycles++;
+        _state.addr_abs = _state.registers.program_counter + _state.addr_rel;
+
+        const bool crossed_page = (_state.addr_abs & 0xFF00) != (_state.registers.program_counter & 0xFF00);
+
+        cycles += crossed_page;
+        _statistics.recordBranchTaken(crossed_page);
+        _state.registers.program_counter = _state.addr_abs;
+    }
+    return cycles;
+}
+
+// Superinstruction: DEY, BNE
+// Typical for counted loops. The branch tests Y itself rather than Z, so
+// with lazy flags nothing needs to be materialized.
+uint32_t InstructionExecutor::DEY_BNE()
+{
+    uint32_t cycles = _lookup[_state.opcode].cycles;
+
+    _state.registers.y--;
+    SetNZ(_state.registers.y);
+    if (continueFusion(cycles))
+        cycles += fusedBranch(_state.registers.y != 0);
+    return cycles;
+}
+
+// Superinstruction: DEX, BNE
+uint32_t InstructionExecutor::DEX_BNE()
+{
+    uint32_t cycles = _lookup[_state.opcode].cycles;
+
+    _state.registers.x--;
+    SetNZ(_state.registers.x);
+    if (continueFusion(cycles))
+        cycles += fusedBranch(_state.registers.x != 0);
+    return cycles;
+}
+
+// Superinstruction: LDA #, STA (zero page or absolute, possibly indexed)
+// STA never takes the page crossing cycle, so only its addressing mode
+// has to be run.
+uint32_t InstructionExecutor::LDA_STA()
+{
+    uint32_t cycles = _lookup[_state.opcode].cycles;
+
+    IMM();
+    _state.fetched = read(_state.addr_abs);
+    _state.registers.a = _state.fetched;
+    SetNZ(_state.registers.a);
+    if (continueFusion(cycles))
+    {
+        (this->*_lookup[_state.opcode].addrmode)();
+        write(_state.addr_abs, _state.registers.a);
+    }
+    return cycles;
+}
+
+// Superinstruction: CMP #, BEQ
+// Z after a compare is just equality, so the branch tests that directly.
+uint32_t InstructionExecutor::CMP_BEQ()
+{
+    uint32_t cycles = _lookup[_state.opcode].cycles;
+
+    IMM();
+    _state.fetched = read(_state.addr_abs);
+    _state.temp = (uint16_t)_state.registers.a - (uint16_t)_state.fetched;
+    updateFlags(FlagOperation::Compare, _state.registers.a, _state.fetched, _state.temp);
+    if (continueFusion(cycles))
+        cycles += fusedBranch(_state.registers.a == _state.fetched);
+    return cycles;
+}
+
+// Superinstruction: INC zp, BNE
+uint32_t InstructionExecutor::INC_BNE()
+{
+    uint32_t cycles = _lookup[_state.opcode].cycles;
+
+    ZP0();
+    _state.fetched = read(_state.addr_abs);
+    _state.temp = _state.fetched + 1;
+    write(_state.addr_abs, _state.temp & 0x00FF);
+    SetNZ(_state.temp & 0x00FF);
+    if (continueFusion(cycles))
+        cycles += fusedBranch((_state.temp & 0x00FF) != 0);
+    return cycles;
+}
+
+// Superinstruction: CLC, ADC
+// The start of every multi-byte addition. The carry in is known to be
+// clear, so in binary mode it doesn't have to be read back at all.
+uint32_t InstructionExecutor::CLC_ADC()
+{
+    uint32_t cycles = _lookup[_state.opcode].cycles;
+
+    SetFlag(C, false);
+    if (continueFusion(cycles))
+    {
+        uint8_t additional_cycle1 = (this->*_lookup[_state.opcode].addrmode)();
+
+        if (GetFlag(D))
+        {
+            // Decimal mode is left to the regular instruction.
+            uint8_t additional_cycle2 = ADC();
+
+            cycles += (additional_cycle1 & additional_cycle2) + additional_cycle2 - 1;
+            _statistics.recordPageCrossing(additional_cycle1 & additional_cycle2);
+        }
+        else
+        {
+            fetch();
+            _state.temp = (uint16_t)_state.registers.a + (uint16_t)_state.fetched;
+            updateFlags(FlagOperation::Add, _state.registers.a, _state.fetched, _state.temp);
+            _state.registers.a = _state.temp & 0x00FF;
+            cycles += additional_cycle1;
+            _statistics.recordPageCrossing(additional_cycle1);
+        }
+    }
+    return cycles;
+}
+
+void InstructionExecutor::notifyChanges(const Registers &before)
+{
+    // Find out what has changed and emit the appropriate signals.  Headless
+    // users may not observe some registers at all.
+    if ((_state.registers.program_counter != before.program_counter) && _observers.program_counter_changed)
+        _observers.program_counter_changed(_state.registers.program_counter);
+    // Reporting the status means it has to be up to date. Without anyone
+    // observing it, lazily evaluated flags can stay pending.
+    if (_observers.status_changed)
+    {
+        materializeFlags();
+        if (_state.registers.status != before.status)
+            _observers.status_changed(_state.registers.status);
+    }
+    if ((_state.registers.stack_pointer != before.stack_pointer) && _observers.stack_pointer_changed)
+        _observers.stack_pointer_changed(_state.registers.stack_pointer);
+    if ((_state.registers.a != before.a) && _observers.a_changed)
+        _observers.a_changed(_state.registers.a);
+    if ((_state.registers.x != before.x) && _observers.x_changed)
+        _observers.x_changed(_state.registers.x);
+    if ((_state.registers.y != before.y) && _observers.y_changed)
+        _observers.y_changed(_state.registers.y);
+}
+
+void InstructionExecutor::saveState(Snapshot &snapshot) const
+{
+    snapshot.state = _state;
+    snapshot.clock_ticks = clock_ticks;
+    snapshot.cycle_count = _cycle_count;
+}
+
+void InstructionExecutor::restoreState(const Snapshot &snapshot)
+{
+    const Registers registers_before = registers();
+    const bool      lazy_flags = _state.lazy_flags;
+    const bool      stop_requested = _state.stop_requested;
+
+    _state = snapshot.state;
+    _state.lazy_flags = lazy_flags;
+    _state.stop_requested = stop_requested;
+    clock_ticks = snapshot.clock_ticks;
+    _cycle_count = snapshot.cycle_count;
+    // Flags left pending by a lazy executor are fine to compute now
+    if (!lazy_flags)
+        materializeFlags();
+    notifyChanges(registers_before);
+}
+
+void InstructionExecutor::setLazyFlags(bool enabled)
+{
+    if (!enabled)
+        materializeFlags();
+    _state.lazy_flags = enabled;
+}
+
+uint8_t InstructionExecutor::flagsAffectedBy(FlagOperation operation)
+{
+    switch (operation)
+    {
+    case FlagOperation::Result:     return Z | N;
+    case FlagOperation::Add:        return C | Z | V | N;
+    case FlagOperation::Compare:    return C | Z | N;
+    case FlagOperation::ShiftLeft:  return C | Z | N;
+    case FlagOperation::ShiftRight: return C | Z | N;
+    case FlagOperation::Bit:        return Z | V | N;
+    }
+    return 0x00;
+}
+
+// Gathers up every flag an ALU operation affects, so they can be stored at once.
+uint8_t InstructionExecutor::computeFlags(FlagOperation operation, uint8_t left, uint8_t right, uint16_t result)
+{
+    switch (operation)
+    {
+    case FlagOperation::Result:
+        return NZFlagsTable[result & 0x00FF];
+
+    case FlagOperation::Add:
+        // The carry flag out exists in the high byte bit 0.
+        // The signed Overflow flag is set when both operands have the same
+        // sign, and the result has a different one.  It is calculated in
+        // bit 7, so shift it down to where V lives.
+        return ((result >> 8) & C) |
+               NZFlagsTable[result & 0x00FF] |
+               (((~((uint16_t)left ^ (uint16_t)right) & ((uint16_t)left ^ result)) & 0x0080) >> 1);
+
+    case FlagOperation::Compare:
+        return ((left >= right) ? C : 0x00) | NZFlagsTable[(left - right) & 0x00FF];
+
+    case FlagOperation::ShiftLeft:
+        return ((result >> 8) & C) | NZFlagsTable[result & 0x00FF];
+
+    case FlagOperation::ShiftRight:
+        return (left & C) | NZFlagsTable[result & 0x00FF];
+
+    case FlagOperation::Bit:
+        return (NZFlagsTable[(left & right) & 0x00FF] & Z) | (right & (N | V));
+    }
+    return 0x00;
+}
+
+void InstructionExecutor::updateFlags(FlagOperation operation, uint8_t left, uint8_t right, uint16_t result)
+{
+    uint8_t affected = flagsAffectedBy(operation);
+
+    if (_state.lazy_flags)
+    {
+        // Only one operation can be pending.  If the previous one left flags
+        // this one does not overwrite, those have to be computed now.
+        if (_state.deferred.pending & ~affected)
+            materializeFlags();
+        _state.deferred = { affected, operation, left, right, result };
+    }
+    else
+        _state.registers.SetFlags(affected, computeFlags(operation, left, right, result));
+}
+
+void InstructionExecutor::materializeFlags() const
+{
+    if (_state.deferred.pending)
+    {
+        _state.registers.SetFlags(_state.deferred.pending, computeFlags(_state.deferred.operation, _state.deferred.left, _state.deferred.right, _state.deferred.result));
+        _state.deferred.pending = 0x00;
+    }
+}
+
+namespace
+{
+// Whether the byte at address is better shown as data than decoded as an
+// instruction with operand_bytes operands, going by what coverage has seen
+bool DisassembleAsData(const CoverageMap &coverage, size_t address, uint8_t operand_bytes)
+{
+    const uint8_t flags = coverage.flags(static_cast<uint16_t>(address));
+
+    if (flags & CoverageMap::Opcode)
+        return false;
+    if (flags)
+        return true;
+
+    // Never touched, so it may well be code, unless its operands would
+    // swallow the start of an instruction that did run
+    for (uint8_t i = 1; i <= operand_bytes; ++i)
+    {
+        const uint8_t operand = coverage.flags(static_cast<uint16_t>(address + i));
+
+        if ((operand & CoverageMap::Opcode) && !(operand & CoverageMap::Operand))
+            return true;
+    }
+    return false;
+}
+}
+
+auto InstructionExecutor::disassemble(addressType start, addressType stop, const CoverageMap *coverage) -> disassemblyType
+{
+    size_t  addr = start; // MUST be a value type that holds more values than start!
+    uint8_t value = 0x00, lo = 0x00, hi = 0x00;
+    size_t  line_addr = 0;
+    disassemblyType mapLines;
+
+    // A convenient utility to convert variables into
+    // hex strings because "modern C++"'s method with
+    // streams is atrocious
+    auto hex = [](size_t n, uint8_t d)
+    {
+        std::string s(d, '0');
+
+        for (; d > 0; --d, n >>= 4)
+            s[d - 1] = "0123456789ABCDEF"[n & 0xF];
+        return s;
+    };
+
+    // Starting at the specified address we read an instruction
+    // byte, which in turn yields information from the lookup table
+    // as to how many additional bytes we need to read and what the
+    // addressing mode is. I need this info to assemble human readable
+    // syntax, which is different depending upon the addressing mode
+
+    // As the instruction is decoded, a std::string is assembled
+    // with the readable output
+    while (addr <= stop)
+    {
+        line_addr = addr;
+
+        // Prefix line with instruction address
+        std::string sInst = "$" + hex(addr, 4) + ": ";
+
+        // Read instruction, and get its readable name
+        uint8_t opcode = _read_delegate(addr, true); addr++;
+
+        if (coverage && DisassembleAsData(*coverage, line_addr, OperandBytesOf(AddressModeOf(opcode))))
+        {
+            mapLines[line_addr] = sInst + ".byte $" + hex(opcode, 2) + " {DATA}";
+            continue;
+        }
+        sInst += _lookup[opcode].name + " ";
+
+        // Get oprands from desired locations, and form the
+        // instruction based upon its addressing mode. These
+        // routines mimmick the actual fetch routine of the
+        // 6502 in order to get accurate data as part of the
+        // instruction
+        if (_lookup[opcode].addrmode == &InstructionExecutor::IMP)
+        {
+            sInst += " {IMP}";
+        }
+        else if (_lookup[opcode].addrmode == &InstructionExecutor::IMM)
+        {
+            value = _read_delegate(addr, true); addr++;
+            sInst += "#$" + hex(value, 2) + " {IMM}";
+        }
+        else if (_lookup[opcode].addrmode == &InstructionExecutor::ZP0)
+        {
+            lo = _read_delegate(addr, true); addr++;
+            hi = 0x00;
+            sInst += "$" + hex(lo, 2) + " {ZP0}";
+        }
+        else if (_lookup[opcode].addrmode == &InstructionExecutor::ZPX)
+        {
+            lo = _read_delegate(addr, true); addr++;
+            hi = 0x00;
+            sInst += "$" + hex(lo, 2) + ", X {ZPX}";
+        }
+        else if (_lookup[opcode].addrmode == &InstructionExecutor::ZPY)
+        {
+            lo = _read_delegate(addr, true); addr++;
+            hi = 0x00;
+            sInst += "$" + hex(lo, 2) + ", Y {ZPY}";
+        }
+        else if (_lookup[opcode].addrmode == &InstructionExecutor::IZX)
+        {
+            lo = _read_delegate(addr, true); addr++;
+            hi = 0x00;
+            sInst += "($" + hex(lo, 2) + ", X) {IZX}";
+        }
+        else if (_lookup[opcode].addrmode == &InstructionExecutor::IZY)
+        {
+            lo = _read_delegate(addr, true); addr++;
+            hi = 0x00;
+            sInst += "($" + hex(lo, 2) + "), Y {IZY}";
+        }
+        else if (_lookup[opcode].addrmode == &InstructionExecutor::ABS)
+        {
+            lo = _read_delegate(addr, true); addr++;
+            hi = _read_delegate(addr, true); addr++;
+            sInst += "$" + hex((uint16_t)(hi << 8) | lo, 4) + " {ABS}";
+        }
+        else if (_lookup[opcode].addrmode == &InstructionExecutor::ABX)
+        {
+            lo = _read_delegate(addr, true); addr++;
+            hi = _read_delegate(addr, true); addr++;
+            sInst += "$" + hex((uint16_t)(hi << 8) | lo, 4) + ", X {ABX}";
+        }
+        else if (_lookup[opcode].addrmode == &InstructionExecutor::ABY)
+        {
+            lo = _read_delegate(addr, true); addr++;
+            hi = _read_delegate(addr, true); addr++;
+            sInst += "$" + hex((uint16_t)(hi << 8) | lo, 4) + ", Y {ABY}";
+        }
+        else if (_lookup[opcode].addrmode == &InstructionExecutor::IND)
+        {
+            lo = _read_delegate(addr, true); addr++;
+            hi = _read_delegate(addr, true); addr++;
+            sInst += "($" + hex((uint16_t)(hi << 8) | lo, 4) + ") {IND}";
+        }
+        else if (_lookup[opcode].addrmode == &InstructionExecutor::REL)
+        {
+            value = _read_delegate(addr, true); addr++;
+            sInst += "$" + hex(value, 2) + " [$" + hex(addr + value, 4) + "] {REL}";
+        }
+
+        // Add the formed string to a std::map, using the instruction's
+        // address as the key. This makes it convenient to look for later
+        // as the instructions are variable in length, so a straight up
+        // incremental index is not sufficient.
+        mapLines[line_addr] = sInst;
+    }
+
+    return mapLines;
+}
+///////////////////////////////////////////////////////////////////////////////
+
+// INSTRUCTION IMPLEMENTATIONS
+
+// Note: Ive started with the two most complicated instructions to emulate, which
+// ironically is addition and subtraction! Ive tried to include a detailed
+// explanation as to why they are so complex, yet so fundamental. Im also NOT
+// going to do this through the explanation of 1 and 2's complement.
+
+// Instruction: Add with Carry In
+// Function:    A = A + M + C
+// Flags Out:   C, V, N, Z
+//
+// Explanation:
+// The purpose of this function is to add a value to the accumulator and a carry bit. If
+// the result is > 255 there is an overflow setting the carry bit. Ths allows you to
+// chain together ADC instructions to add numbers larger than 8-bits. This in itself is
+// simple, however the 6502 supports the concepts of Negativity/Positivity and Signed Overflow.
+//
+// 10000100 = 128 + 4 = 132 in normal circumstances, we know this as unsigned and it allows
+// us to represent numbers between 0 and 255 (given 8 bits). The 6502 can also interpret
+// this word as something else if we assume those 8 bits represent the range -128 to +127,
+// i.e. it has become signed.
+//
+// Since 132 > 127, it effectively wraps around, through -128, to -124. This wraparound is
+// called overflow, and this is a useful to know as it indicates that the calculation has
+// gone outside the permissable range, and therefore no longer makes numeric sense.
+//
+// Note the implementation of ADD is the same in binary, this is just about how the numbers
+// are represented, so the word 10000100 can be both -124 and 132 depending upon the
+// context the programming is using it in. We can prove this!
+//
+//  10000100 =  132  or  -124
+// +00010001 = + 17      + 17
+//  ========    ===       ===     See, both are valid additions, but our interpretation of
+//  10010101 =  149  or  -107     the context changes the value, not the hardware!
+//
+// In principle under the -128 to 127 range:
+// 10000000 = -128, 11111111 = -1, 00000000 = 0, 00000000 = +1, 01111111 = +127
+// therefore negative numbers have the most significant set, positive numbers do not
+//
+// To assist us, the 6502 can set the overflow flag, if the result of the addition has
+// wrapped around. V <- ~(A^M) & A^(A+M+C) :D lol, let's work out why!
+//
+// Let's suppose we have A = 30, M = 10 and C = 0
+//          A = 30 = 00011110
+//          M = 10 = 00001010+
+//     RESULT = 40 = 00101000
+//
+// Here we have not gone out of range. The resulting significant bit has not changed.
+// So let's make a truth table to understand when overflow has occurred. Here I take
+// the MSB of each component, where R is RESULT.
+//
+// A  M  R | V | A^R | A^M |~(A^M) |
+// 0  0  0 | 0 |  0  |  0  |   1   |
+// 0  0  1 | 1 |  1  |  0  |   1   |
+// 0  1  0 | 0 |  0  |  1  |   0   |
+// 0  1  1 | 0 |  1  |  1  |   0   |  so V = ~(A^M) & (A^R)
+// 1  0  0 | 0 |  1  |  1  |   0   |
+// 1  0  1 | 0 |  0  |  1  |   0   |
+// 1  1  0 | 1 |  1  |  0  |   1   |
+// 1  1  1 | 0 |  0  |  0  |   1   |
+//
+// We can see how the above equation calculates V, based on A, M and R. V was chosen
+// based on the following hypothesis:
+//       Positive Number + Positive Number = Negative Result -> Overflow
+//       Negative Number + Negative Number = Positive Result -> Overflow
+//       Positive Number + Negative Number = Either Result -> Cannot Overflow
+//       Positive Number + Positive Number = Positive Result -> OK! No Overflow
+//       Negative Number + Negative Number = Negative Result -> OK! NO Overflow
+
+uint8_t InstructionExecutor::ADC()
+{
+    // Grab the data that we are adding to the accumulator
+    fetch();
+
+    // Check for BCD mode
+    if (GetFlag(D))
+    {
+        // Every decimal mode result (and its flags) has been precomputed,
+        // so this is just a lookup.
+        const DecimalTables::Entry &result = DecimalTables::instance().add(_state.registers.a, _state.fetched, GetFlag(C));
+
+        _statistics.recordDecimalAddition();
+
+        _state.temp = result.result;
+        SetFlags(DecimalTables::affectedFlags(), result.flags);
+        _state.registers.a = result.result;
+    }
+    else
+    {
+        // Add is performed in 16-bit domain for emulation to capture any
+        // carry bit, which will exist in bit 8 of the 16-bit word
+        _state.temp = (uint16_t)_state.registers.a + (uint16_t)_state.fetched + (uint16_t)GetFlag(C);
+
+        // The carry, zero, overflow and negative flags all come from the
+        // operands and the 16-bit result (see computeFlags())
+        updateFlags(FlagOperation::Add, _state.registers.a, _state.fetched, _state.temp);
+
+        // Load the result into the accumulator (it's 8-bit dont forget!)
+        _state.registers.a = _state.temp & 0x00FF;
+    }
+
+    // This instruction has the potential to require an additional clock cycle
+    return 1 + GetFlag(D);
+}
+
+// Instruction: Subtraction with Borrow In
+// Function:    A = A - M - (1 - C)
+// Flags Out:   C, V, N, Z
+//
+// Explanation:
+// Given the explanation for ADC above, we can reorganise our data
+// to use the same computation for addition, for subtraction by multiplying
+// the data by -1, i.e. make it negative
+//
+// A = A - M - (1 - C)  ->  A = A + -1 * (M - (1 - C))  ->  A = A + (-M + 1 + C)
+//
+// To make a signed positive number negative, we can invert the bits and add 1
+// (OK, I lied, a little bit of 1 and 2s complement :P)
+//
+//  5 = 00000101
+// -5 = 11111010 + 00000001 = 11111011 (or 251 in our 0 to 255 range)
+//
+// The range is actually unimportant, because if I take the value 15, and add 251
+// to it, given we wrap around at 256, the result is 10, so it has effectively
+// subtracted 5, which was the original intention. (15 + 251) % 256 = 10
+//
+// Note that the equation above used (1-C), but this got converted to + 1 + C.
+// This means we already have the +1, so all we need to do is invert the bits
+// of M, the data(!) therfore we can simply add, exactly the same way we did
+// before.
+
+uint8_t InstructionExecutor::SBC()
+{
+    fetch();
+
+    // Operating in 16-bit domain to capture carry out
+
+    // Check for BCD mode
+    if (GetFlag(D))
+    {
+        // The nines' complement addition has been precomputed as well.
+        const DecimalTables::Entry &result = DecimalTables::instance().subtract(_state.registers.a, _state.fetched, GetFlag(C));
+
+        _statistics.recordDecimalSubtraction();
+
+        _state.temp = result.result;
+        SetFlags(DecimalTables::affectedFlags(), result.flags);
+        _state.registers.a = result.result;
+    }
+    else
+    {
+        uint16_t value = complement(_state.fetched, GetFlag(D));
+
+        // Notice this is exactly the same as addition from here!
+        _state.temp = (uint16_t)_state.registers.a + value + (uint16_t)GetFlag(C);
+        updateFlags(FlagOperation::Add, _state.registers.a, value, _state.temp);
+        _state.registers.a = _state.temp & 0x00FF;
+    }
+
+    return 1 + GetFlag(D);
+}
+
+// OK! Complicated operations are done! the following are much simpler
+// and conventional. The typical order of events is:
+// 1) Fetch the data you are working with
+// 2) Perform calculation
+// 3) Store the result in desired place
+// 4) Set Flags of the status register
+// 5) Return if instruction has potential to require additional
+//    clock cycle
+
+
+// Instruction: Bitwise Logic AND
+// Function:    A = A & M
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::AND()
+{
+    fetch();
+    _state.registers.a = _state.registers.a & _state.fetched;
+    SetNZ(_state.registers.a);
+    return 1;
+}
+
+
+// Instruction: Arithmetic Shift Left
+// Function:    A = C <- (A << 1) <- 0
+// Flags Out:   N, Z, C
+uint8_t InstructionExecutor::ASL()
+{
+    fetch();
+    _state.temp = (uint16_t)_state.fetched << 1;
+    updateFlags(FlagOperation::ShiftLeft, _state.fetched, 0x00, _state.temp);
+    if (_lookup[_state.opcode].addrmode == &InstructionExecutor::IMP)
+        _state.registers.a = _state.temp & 0x00FF;
+    else
+        write(_state.addr_abs, _state.temp & 0x00FF);
+    return 0;
+}
+
+
+// Instruction: Branch if Carry Clear
+// Function:    if(C == 0) pc = address
+uint8_t InstructionExecutor::BCC()
+{
+    if (GetFlag(C) == 0)
+    {
+        _state.cycles++;
+        _state.addr_abs = _state.registers.program_counter + _state.addr_rel;
+
+        const bool crossed_page = (_state.addr_abs & 0xFF00) != (_state.registers.program_counter & 0xFF00);
+
+        _state.cycles += crossed_page;
+        _statistics.recordBranchTaken(crossed_page);
+        _state.registers.program_counter = _state.addr_abs;
+    }
+    return 0;
+}
+
+
+// Instruction: Branch if Carry Set
+// Function:    if(C == 1) pc = address
+uint8_t InstructionExecutor::BCS()
+{
+    if (GetFlag(C) == 1)
+    {
+        _state.cycles++;
+        _state.addr_abs = _state.registers.program_counter + _state.addr_rel;
+
+        const bool crossed_page = (_state.addr_abs & 0xFF00) != (_state.registers.program_counter & 0xFF00);
+
+        _state.cycles += crossed_page;
+        _statistics.recordBranchTaken(crossed_page);
+        _state.registers.program_counter = _state.addr_abs;
+    }
+    return 0;
+}
+
+// Instruction: Branch if Equal
+// Function:    if(Z == 1) pc = address
+uint8_t InstructionExecutor::BEQ()
+{
+    if (GetFlag(Z) == 1)
+    {
+        _state.cycles++;
+        _state.addr_abs = _state.registers.program_counter + _state.addr_rel;
+
+        const bool crossed_page = (_state.addr_abs & 0xFF00) != (_state.registers.program_counter & 0xFF00);
+
+        _state.cycles += crossed_page;
+        _statistics.recordBranchTaken(crossed_page);
+        _state.registers.program_counter = _state.addr_abs;
+    }
+    return 0;
+}
+
+uint8_t InstructionExecutor::BIT()
+{
+    fetch();
+    _state.temp = _state.registers.a & _state.fetched;
+    updateFlags(FlagOperation::Bit, _state.registers.a, _state.fetched, _state.temp);
+    return 0;
+}
+
+// Instruction: Branch if Negative
+// Function:    if(N == 1) pc = address
+uint8_t InstructionExecutor::BMI()
+{
+    if (GetFlag(N) == 1)
+    {
+        _state.cycles++;
+        _state.addr_abs = _state.registers.program_counter + _state.addr_rel;
+
+        const bool crossed_page = (_state.addr_abs & 0xFF00) != (_state.registers.program_counter & 0xFF00);
+
+        _state.cycles += crossed_page;
+        _statistics.recordBranchTaken(crossed_page);
+        _state.registers.program_counter = _state.addr_abs;
+    }
+    return 0;
+}
+
+
+// Instruction: Branch if Not Equal
+// Function:    if(Z == 0) pc = address
+uint8_t InstructionExecutor::BNE()
+{
+    if (GetFlag(Z) == 0)
+    {
+        _state.cycles++;
+        _state.addr_abs = _state.registers.program_counter + _state.addr_rel;
+
+        const bool crossed_page = (_state.addr_abs & 0xFF00) != (_state.registers.program_counter & 0xFF00);
+
+        _state.cycles += crossed_page;
+        _statistics.recordBranchTaken(crossed_page);
+        _state.registers.program_counter = _state.addr_abs;
+    }
+    return 0;
+}
+
+// Instruction: Branch if Positive
+// Function:    if(N == 0) pc = address
+uint8_t InstructionExecutor::BPL()
+{
+    if (GetFlag(N) == 0)
+    {
+        _state.cycles++;
+        _state.addr_abs = _state.registers.program_counter + _state.addr_rel;
+
+        const bool crossed_page = (_state.addr_abs & 0xFF00) != (_state.registers.program_counter & 0xFF00);
+
+        _state.cycles += crossed_page;
+        _statistics.recordBranchTaken(crossed_page);
+        _state.registers.program_counter = _state.addr_abs;
+    }
+    return 0;
+}
+
+// Instruction: Break
+// Function:    Program Sourced Interrupt
+uint8_t InstructionExecutor::BRK()
+{
+    _state.registers.program_counter++;
+
+    SetFlag(I, 1);
+    write(0x0100 + _state.registers.stack_pointer, (_state.registers.program_counter >> 8) & 0x00FF);
+    _state.registers.stack_pointer--;
+    write(0x0100 + _state.registers.stack_pointer, _state.registers.program_counter & 0x00FF);
+    _state.registers.stack_pointer--;
+
+    write(0x0100 + _state.registers.stack_pointer, status() | B);
+    _state.registers.stack_pointer--;
+    SetFlag(B, 0);
+
+    _state.registers.program_counter = (uint16_t)readPointer(0xFFFE) | ((uint16_t)readPointer(0xFFFF) << 8);
+    return 0;
+}
+
+// Instruction: Branch if Overflow Clear
+// Function:    if(V == 0) pc = address
+uint8_t InstructionExecutor::BVC()
+{
+    if (GetFlag(V) == 0)
+    {
+        _state.cycles++;
+        _state.addr_abs = _state.registers.program_counter + _state.addr_rel;
+
+        const bool crossed_page = (_state.addr_abs & 0xFF00) != (_state.registers.program_counter & 0xFF00);
+
+        _state.cycles += crossed_page;
+        _statistics.recordBranchTaken(crossed_page);
+        _state.registers.program_counter = _state.addr_abs;
+    }
+    return 0;
+}
+
+// Instruction: Branch if Overflow Set
+// Function:    if(V == 1) pc = address
+uint8_t InstructionExecutor::BVS()
+{
+    if (GetFlag(V) == 1)
+    {
+        _state.cycles++;
+        _state.addr_abs = _state.registers.program_counter + _state.addr_rel;
+
+        const bool crossed_page = (_state.addr_abs & 0xFF00) != (_state.registers.program_counter & 0xFF00);
+
+        _state.cycles += crossed_page;
+        _statistics.recordBranchTaken(crossed_page);
+        _state.registers.program_counter = _state.addr_abs;
+    }
+    return 0;
+}
+
+// Instruction: Clear Carry Flag
+// Function:    C = 0
+uint8_t InstructionExecutor::CLC()
+{
+    SetFlag(C, false);
+    return 0;
+}
+
+// Instruction: Clear Decimal Flag
+// Function:    D = 0
+uint8_t InstructionExecutor::CLD()
+{
+    SetFlag(D, false);
+    return 0;
+}
+
+// Instruction: Disable Interrupts / Clear Interrupt Flag
+// Function:    I = 0
+uint8_t InstructionExecutor::CLI()
+{
+    SetFlag(I, false);
+    return 0;
+}
+
+
+// Instruction: Clear Overflow Flag
+// Function:    V = 0
+uint8_t InstructionExecutor::CLV()
+{
+    SetFlag(V, false);
+    return 0;
+}
+
+// Instruction: Compare Accumulator
+// Function:    C <- A >= M      Z <- (A - M) == 0
+// Flags Out:   N, C, Z
+uint8_t InstructionExecutor::CMP()
+{
+    fetch();
+    _state.temp = (uint16_t)_state.registers.a - (uint16_t)_state.fetched;
+    updateFlags(FlagOperation::Compare, _state.registers.a, _state.fetched, _state.temp);
+    return 1;
+}
+
+
+// Instruction: Compare X Register
+// Function:    C <- X >= M      Z <- (X - M) == 0
+// Flags Out:   N, C, Z
+uint8_t InstructionExecutor::CPX()
+{
+    fetch();
+    _state.temp = (uint16_t)_state.registers.x - (uint16_t)_state.fetched;
+    updateFlags(FlagOperation::Compare, _state.registers.x, _state.fetched, _state.temp);
+    return 0;
+}
+
+// Instruction: Compare Y Register
+// Function:    C <- Y >= M      Z <- (Y - M) == 0
+// Flags Out:   N, C, Z
+uint8_t InstructionExecutor::CPY()
+{
+    fetch();
+    _state.temp = (uint16_t)_state.registers.y - (uint16_t)_state.fetched;
+    updateFlags(FlagOperation::Compare, _state.registers.y, _state.fetched, _state.temp);
+    return 0;
+}
+
+// Instruction: Decrement Value at Memory Location
+// Function:    M = M - 1
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::DEC()
+{
+    fetch();
+    _state.temp = _state.fetched - 1;
+    write(_state.addr_abs, _state.temp & 0x00FF);
+    SetNZ(_state.temp & 0x00FF);
+    return 0;
+}
+
+// Instruction: Decrement X Register
+// Function:    X = X - 1
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::DEX()
+{
+    _state.registers.x--;
+    SetNZ(_state.registers.x);
+    return 0;
+}
+
+
+// Instruction: Decrement Y Register
+// Function:    Y = Y - 1
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::DEY()
+{
+    _state.registers.y--;
+    SetNZ(_state.registers.y);
+    return 0;
+}
+
+
+// Instruction: Bitwise Logic XOR
+// Function:    A = A xor M
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::EOR()
+{
+    fetch();
+    _state.registers.a = _state.registers.a ^ _state.fetched;
+    SetNZ(_state.registers.a);
+    return 1;
+}
+
+// Instruction: Increment Value at Memory Location
+// Function:    M = M + 1
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::INC()
+{
+    fetch();
+    _state.temp = _state.fetched + 1;
+    write(_state.addr_abs, _state.temp & 0x00FF);
+    SetNZ(_state.temp & 0x00FF);
+    return 0;
+}
+
+
+// Instruction: Increment X Register
+// Function:    X = X + 1
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::INX()
+{
+    _state.registers.x++;
+    SetNZ(_state.registers.x);
+    return 0;
+}
+
+
+// Instruction: Increment Y Register
+// Function:    Y = Y + 1
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::INY()
+{
+    _state.registers.y++;
+    SetNZ(_state.registers.y);
+    return 0;
+}
+
+
+// Instruction: Jump To Location
+// Function:    pc = address
+uint8_t InstructionExecutor::JMP()
+{
+    _state.registers.program_counter = _state.addr_abs;
+    return 0;
+}
+
+
+// Instruction: Jump To Sub-Routine
+// Function:    Push current pc to stack, pc = address
+uint8_t InstructionExecutor::JSR()
+{
+    _state.registers.program_counter--;
+
+    write(0x0100 + _state.registers.stack_pointer, (_state.registers.program_counter >> 8) & 0x00FF);
+    _state.registers.stack_pointer--;
+    write(0x0100 + _state.registers.stack_pointer, _state.registers.program_counter & 0x00FF);
+    _state.registers.stack_pointer--;
+
+    _state.registers.program_counter = _state.addr_abs;
+    return 0;
+}
+
+// Instruction: Load The Accumulator
+// Function:    A = M
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::LDA()
+{
+    fetch();
+    _state.registers.a = _state.fetched;
+    SetNZ(_state.registers.a);
+    return 1;
+}
+
+
+// Instruction: Load The X Register
+// Function:    X = M
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::LDX()
+{
+    fetch();
+    _state.registers.x = _state.fetched;
+    SetNZ(_state.registers.x);
+    return 1;
+}
+
+
+// Instruction: Load The Y Register
+// Function:    Y = M
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::LDY()
+{
+    fetch();
+    _state.registers.y = _state.fetched;
+    SetNZ(_state.registers.y);
+    return 1;
+}
+
+uint8_t InstructionExecutor::LSR()
+{
+    fetch();
+    _state.temp = _state.fetched >> 1;
+    updateFlags(FlagOperation::ShiftRight, _state.fetched, 0x00, _state.temp);
+    if (_lookup[_state.opcode].addrmode == &InstructionExecutor::IMP)
+        _state.registers.a = _state.temp & 0x00FF;
+    else
+        write(_state.addr_abs, _state.temp & 0x00FF);
+    return 0;
+}
+
+uint8_t InstructionExecutor::NOP()
+{
+    // Sadly not all NOPs are equal, Ive added a few here
+    // based on https://wiki.nesdev.com/w/index.php/CPU_unofficial_opcodes
+    // and will add more based on game compatibility, and ultimately
+    // I'd like to cover all illegal opcodes too
+    switch (_state.opcode) {
+    case 0x1C:
+    case 0x3C:
+    case 0x5C:
+    case 0x7C:
+    case 0xDC:
+    case 0xFC:
+        return 1;
+        break;
+    }
+    return 0;
+}
+
+// Instruction: Bitwise Logic OR
+// Function:    A = A | M
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::ORA()
+{
+    fetch();
+    _state.registers.a = _state.registers.a | _state.fetched;
+    SetNZ(_state.registers.a);
+    return 1;
+}
+
+
+// Instruction: Push Accumulator to Stack
+// Function:    A -> stack
+uint8_t InstructionExecutor::PHA()
+{
+    write(0x0100 + _state.registers.stack_pointer, _state.registers.a);
+    _state.registers.stack_pointer--;
+    return 0;
+}
+
+
+// Instruction: Push Status Register to Stack
+// Function:    status -> stack
+// Note:        Break flag is set to 1 before push
+uint8_t InstructionExecutor::PHP()
+{
+    write(0x0100 + _state.registers.stack_pointer, status() | B | U);
+    SetFlags(B | U, 0x00);
+    _state.registers.stack_pointer--;
+    return 0;
+}
+
+// Instruction: Pop Accumulator off Stack
+// Function:    A <- stack
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::PLA()
+{
+    _state.registers.stack_pointer++;
+    _state.registers.a = read(0x0100 + _state.registers.stack_pointer);
+    SetNZ(_state.registers.a);
+    return 0;
+}
+
+
+// Instruction: Pop Status Register off Stack
+// Function:    Status <- stack
+uint8_t InstructionExecutor::PLP()
+{
+    _state.registers.stack_pointer++;
+    discardPendingFlags();
+    _state.registers.status = read(0x0100 + _state.registers.stack_pointer);
+    SetFlag(U, 1);
+    return 0;
+}
+
+uint8_t InstructionExecutor::ROL()
+{
+    fetch();
+    _state.temp = (uint16_t)(_state.fetched << 1) | GetFlag(C);
+    updateFlags(FlagOperation::ShiftLeft, _state.fetched, 0x00, _state.temp);
+    if (_lookup[_state.opcode].addrmode == &InstructionExecutor::IMP)
+        _state.registers.a = _state.temp & 0x00FF;
+    else
+        write(_state.addr_abs, _state.temp & 0x00FF);
+    return 0;
+}
+
+uint8_t InstructionExecutor::ROR()
+{
+    fetch();
+    _state.temp = (uint16_t)(GetFlag(C) << 7) | (_state.fetched >> 1);
+    updateFlags(FlagOperation::ShiftRight, _state.fetched, 0x00, _state.temp);
+    if (_lookup[_state.opcode].addrmode == &InstructionExecutor::IMP)
+        _state.registers.a = _state.temp & 0x00FF;
+    else
+        write(_state.addr_abs, _state.temp & 0x00FF);
+    return 0;
+}
+
+uint8_t InstructionExecutor::RTI()
+{
+    _state.registers.stack_pointer++;
+    discardPendingFlags();
+    _state.registers.status = read(0x0100 + _state.registers.stack_pointer);
+    _state.registers.status &= ~(B | U);
+
+    _state.registers.stack_pointer++;
+    _state.registers.program_counter = (uint16_t)read(0x0100 + _state.registers.stack_pointer);
+    _state.registers.stack_pointer++;
+    _state.registers.program_counter |= (uint16_t)read(0x0100 + _state.registers.stack_pointer) << 8;
+    return 0;
+}
+
+uint8_t InstructionExecutor::RTS()
+{
+    _state.registers.stack_pointer++;
+    _state.registers.program_counter = (uint16_t)read(0x0100 + _state.registers.stack_pointer);
+    _state.registers.stack_pointer++;
+    _state.registers.program_counter |= (uint16_t)read(0x0100 + _state.registers.stack_pointer) << 8;
+
+    _state.registers.program_counter++;
+    return 0;
+}
+
+// Instruction: Set Carry Flag
+// Function:    C = 1
+uint8_t InstructionExecutor::SEC()
+{
+    SetFlag(C, true);
+    return 0;
+}
+
+
+// Instruction: Set Decimal Flag
+// Function:    D = 1
+uint8_t InstructionExecutor::SED()
+{
+    SetFlag(D, true);
+    return 0;
+}
+
+
+// Instruction: Set Interrupt Flag / Enable Interrupts
+// Function:    I = 1
+uint8_t InstructionExecutor::SEI()
+{
+    SetFlag(I, true);
+    return 0;
+}
+
+
+// Instruction: Store Accumulator at Address
+// Function:    M = A
+uint8_t InstructionExecutor::STA()
+{
+    write(_state.addr_abs, _state.registers.a);
+    return 0;
+}
+
+
+// Instruction: Store X Register at Address
+// Function:    M = X
+uint8_t InstructionExecutor::STX()
+{
+    write(_state.addr_abs, _state.registers.x);
+    return 0;
+}
+
+
+// Instruction: Store Y Register at Address
+// Function:    M = Y
+uint8_t InstructionExecutor::STY()
+{
+    write(_state.addr_abs, _state.registers.y);
+    return 0;
+}
+
+// Instruction: Transfer Accumulator to X Register
+// Function:    X = A
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::TAX()
+{
+    _state.registers.x = _state.registers.a;
+    SetNZ(_state.registers.x);
+    return 0;
+}
+
+
+// Instruction: Transfer Accumulator to Y Register
+// Function:    Y = A
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::TAY()
+{
+    _state.registers.y = _state.registers.a;
+    SetNZ(_state.registers.y);
+    return 0;
+}
+
+
+// Instruction: Transfer Stack Pointer to X Register
+// Function:    X = stack pointer
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::TSX()
+{
+    _state.registers.x = _state.registers.stack_pointer;
+    SetNZ(_state.registers.x);
+    return 0;
+}
+
+
+// Instruction: Transfer X Register to Accumulator
+// Function:    A = X
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::TXA()
+{
+    _state.registers.a = _state.registers.x;
+    SetNZ(_state.registers.a);
+    return 0;
+}
+
+
+// Instruction: Transfer X Register to Stack Pointer
+// Function:    stack pointer = X
+uint8_t InstructionExecutor::TXS()
+{
+    _state.registers.stack_pointer = _state.registers.x;
+    return 0;
+}
+
+// Instruction: Transfer Y Register to Accumulator
+// Function:    A = Y
+// Flags Out:   N, Z
+uint8_t InstructionExecutor::TYA()
+{
+    _state.registers.a = _state.registers.y;
+    SetNZ(_state.registers.a);
+    return 0;
+}
+
+
+// This function captures illegal opcodes
+uint8_t InstructionExecutor::XXX()
+{
+    return 0;
+}
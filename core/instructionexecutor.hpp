@@ -0,0 +1,556 @@
+#ifndef INSTRUCTIONEXECUTOR_HPP
+#define INSTRUCTIONEXECUTOR_HPP
+
+#include <bitset>
+#include <functional>
+#include <map>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "accesscounters.hpp"
+#include "coveragemap.hpp"
+#include "cycleprofiler.hpp"
+#include "executionstatistics.hpp"
+#include "opcodepairhistogram.hpp"
+#include "registers.hpp"
+#include "tracerecorder.hpp"
+
+
+class InstructionExecutor
+{
+public:
+    using addressType = uint16_t;
+    using registerType = uint8_t;
+    using readDelegate  = std::function<uint8_t (addressType, bool)>;
+    using writeDelegate = std::function<void (addressType, uint8_t)>;
+    using registerValueChangedDelegate = std::function<void (registerType)>;
+    using addressValueChangedDelegate  = std::function<void (addressType)>;
+    using disassemblyType = std::map<addressType, std::string>;
+    using opcodePairType  = std::pair<uint8_t, uint8_t>;
+
+    // This structure and the following vector are used to compile and store
+    // the opcode translation table. The 6502 can effectively have 256
+    // different instructions. Each of these are stored in a table in numerical
+    // order so they can be looked up easily, with no decoding required.
+    // Each table entry holds:
+
+    //	Pneumonic : A textual representation of the instruction (used for disassembly)
+    //	Opcode Function: A function pointer to the implementation of the opcode
+    //	Opcode Address Mode : A function pointer to the implementation of the
+    //						  addressing mechanism used by the instruction
+    //	Cycle Count : An integer that represents the base number of clock cycles the
+    //				  CPU requires to perform the instruction
+    struct INSTRUCTION
+    {
+        std::string name;
+        uint8_t (InstructionExecutor::*operate)(void)  = nullptr;
+        uint8_t (InstructionExecutor::*addrmode)(void) = nullptr;
+        uint8_t cycles = 0;
+    };
+
+    InstructionExecutor() = delete;
+    // Any of the change delegates may be empty, if nobody is interested.
+    InstructionExecutor(readDelegate  read_signal,
+                        writeDelegate write_signal,
+                        registerValueChangedDelegate a_changed_signal,
+                        registerValueChangedDelegate x_changed_signal,
+                        registerValueChangedDelegate y_changed_signal,
+                        addressValueChangedDelegate  program_counter_changed_signal,
+                        registerValueChangedDelegate stack_pointer_changed_signal,
+                        registerValueChangedDelegate status_changed_signal);
+    InstructionExecutor(const InstructionExecutor &) = delete;
+    InstructionExecutor(InstructionExecutor &&) = delete;
+
+    // Addressing Modes =============================================
+    // The 6502 has a variety of addressing modes to access data in
+    // memory, some of which are direct and some are indirect (like
+    // pointers in C++). Each opcode contains information about which
+    // addressing mode should be employed to facilitate the
+    // instruction, in regards to where it reads/writes the data it
+    // uses. The address mode changes the number of bytes that
+    // makes up the full instruction, so we implement addressing
+    // before executing the instruction, to make sure the program
+    // counter is at the correct location, the instruction is
+    // primed with the addresses it needs, and the number of clock
+    // cycles the instruction requires is calculated. These functions
+    // may adjust the number of cycles required depending upon where
+    // and how the memory is accessed, so they return the required
+    // adjustment.
+
+    uint8_t IMP(); uint8_t IMM();
+    uint8_t ZP0(); uint8_t ZPX();
+    uint8_t ZPY(); uint8_t REL();
+    uint8_t ABS(); uint8_t ABX();
+    uint8_t ABY(); uint8_t IND();
+    uint8_t IZX(); uint8_t IZY();
+
+    // Opcodes ======================================================
+    // There are 56 "legitimate" opcodes provided by the 6502 CPU. I
+    // have not modelled "unofficial" opcodes. As each opcode is
+    // defined by 1 byte, there are potentially 256 possible codes.
+    // Codes are not used in a "switch case" style on a processor,
+    // instead they are repsonisble for switching individual parts of
+    // CPU circuits on and off. The opcodes listed here are official,
+    // meaning that the functionality of the chip when provided with
+    // these codes is as the developers intended it to be. Unofficial
+    // codes will of course also influence the CPU circuitry in
+    // interesting ways, and can be exploited to gain additional
+    // functionality!
+    //
+    // These functions return 0 normally, but some are capable of
+    // requiring more clock cycles when executed under certain
+    // conditions combined with certain addressing modes. If that is
+    // the case, they return 1.
+    //
+    // I have included detailed explanations of each function in
+    // the class implementation file. Note they are listed in
+    // alphabetical order here for ease of finding.
+
+    uint8_t ADC();	uint8_t AND();	uint8_t ASL();	uint8_t BCC();
+    uint8_t BCS();	uint8_t BEQ();	uint8_t BIT();	uint8_t BMI();
+    uint8_t BNE();	uint8_t BPL();	uint8_t BRK();	uint8_t BVC();
+    uint8_t BVS();	uint8_t CLC();	uint8_t CLD();	uint8_t CLI();
+    uint8_t CLV();	uint8_t CMP();	uint8_t CPX();	uint8_t CPY();
+    uint8_t DEC();	uint8_t DEX();	uint8_t DEY();	uint8_t EOR();
+    uint8_t INC();	uint8_t INX();	uint8_t INY();	uint8_t JMP();
+    uint8_t JSR();	uint8_t LDA();	uint8_t LDX();	uint8_t LDY();
+    uint8_t LSR();	uint8_t NOP();	uint8_t ORA();	uint8_t PHA();
+    uint8_t PHP();	uint8_t PLA();	uint8_t PLP();	uint8_t ROL();
+    uint8_t ROR();	uint8_t RTI();	uint8_t RTS();	uint8_t SBC();
+    uint8_t SEC();	uint8_t SED();	uint8_t SEI();	uint8_t STA();
+    uint8_t STX();	uint8_t STY();	uint8_t TAX();	uint8_t TAY();
+    uint8_t TSX();	uint8_t TXA();	uint8_t TXS();	uint8_t TYA();
+
+    // I capture all "unofficial" opcodes with this function. It is
+    // functionally identical to a NOP
+    uint8_t XXX();
+
+    // Indicates the current instruction has completed by returning true. This is
+    // a utility function to enable "step-by-step" execution, without manually
+    // clocking every cycle
+    bool complete() const { return remainingCyclesForInstruction() == 0; }
+
+    uint8_t remainingCyclesForInstruction() const { return _state.cycles; }
+
+    void reset();
+    void irq();
+    void nmi();
+
+    void clock(); ///< Executes one clock tick
+
+    /** Executes whole instructions until at least @p cycles clock ticks have elapsed.
+     *
+     *  An instruction that is already in progress is finished first.  Unlike
+     *  clock(), the change delegates are called only once, at the end, for
+     *  whatever differs from the state the run started with.  The
+     *  instructions are executed by the engine chosen with setEngine().
+     *
+     *  @return The number of clock ticks actually executed
+     */
+    uint32_t run(uint32_t cycles);
+
+    /** Ends the run() in progress as soon as the current instruction (or
+     *  superinstruction) is complete, however many cycles were asked for.
+     *
+     *  Meant for bus devices and observers called from within run().  A stop
+     *  requested outside of run() is forgotten when the next one starts.
+     */
+    void stop() { _state.stop_requested = true; }
+
+    uint32_t clock_ticks = 0; // A global accumulation of the number of clocks
+
+    /** The number of clock ticks run since the executor was created.
+     *
+     *  The same count as clock_ticks, but wide enough never to wrap round,
+     *  so traces can take their cycles from it however long they get.
+     */
+    uint64_t cycleCount() const { return _cycle_count; }
+
+    /** The number of instructions started since the executor was created,
+     *  counting both halves of a superinstruction.
+     */
+    uint64_t instructionCount() const { return _state.instructions; }
+
+    /** Everything the CPU is in the middle of, as plain data.
+     *
+     *  A snapshot covers the registers, an instruction still in progress,
+     *  pending lazy flags and the counters, so execution carries on from a
+     *  restored one exactly as it did from where it was taken.  The engine,
+     *  superinstructions, lazy flag setting and delegates belong to the
+     *  executor, not to the snapshot.
+     */
+    struct Snapshot;
+
+    void saveState(Snapshot &snapshot) const;
+
+    /** Puts the CPU back to @p snapshot, telling the change delegates about
+     *  every register that differs.
+     */
+    void restoreState(const Snapshot &snapshot);
+
+    /** Access to the registers.
+     *
+     *  Any flags still pending from lazy evaluation are brought up to date
+     *  first, so callers always see the correct status register.
+     */
+    ///@{
+    const Registers &registers() const { materializeFlags(); return _state.registers; }
+          Registers &registers()       { materializeFlags(); return _state.registers; }
+    ///@}
+
+    /** The up to date status register, materializing any pending flags.
+     *
+     */
+    uint8_t status() const { materializeFlags(); return _state.registers.status; }
+
+    /** Turns lazy flag evaluation on or off.
+     *
+     *  With lazy flags, an ALU instruction only records what it operated on,
+     *  and C/Z/V/N are computed from that record when something actually reads
+     *  them (branches, PHP, BRK, interrupts, or a call to status()/registers()).
+     *  Results that are overwritten before anything looks at them are never
+     *  computed at all.
+     *
+     *  @note If a status changed delegate was given, the flags still have to
+     *        be materialized after every instruction to report the change, so
+     *        this pays off when the executor runs without a status observer.
+     */
+    void setLazyFlags(bool enabled);
+    bool lazyFlags() const { return _state.lazy_flags; }
+
+    /** Superinstructions.
+     *
+     *  run() can execute some common pairs of instructions (DEY/BNE, DEX/BNE,
+     *  LDA/STA, CMP/BEQ, INC/BNE, CLC/ADC) with a single dispatch, through a
+     *  handler that does the work of both.  Registers, flags, memory accesses
+     *  and the combined cycle count are exactly those of the two instructions
+     *  run separately.  clock() always executes one instruction at a time.
+     *
+     *  Which of the fusible pairs are used is decided at run time, so the set
+     *  can be tuned from an OpcodePairHistogram of the code actually being run.
+     */
+    ///@{
+    static std::vector<opcodePairType> fusiblePairs();
+
+    bool enableSuperinstruction(uint8_t first, uint8_t second); ///< @return false if the pair cannot be fused
+    void disableSuperinstructions();
+    std::vector<opcodePairType> enabledSuperinstructions() const;
+
+    /** Enables exactly the fusible pairs that make up at least @p minimum_share
+     *  (0.0 - 1.0) of the pairs counted in @p histogram.
+     *
+     *  @return The number of superinstructions enabled
+     */
+    size_t selectSuperinstructions(const OpcodePairHistogram &histogram, double minimum_share);
+    ///@}
+
+    /** The interpreter cores run() can use.
+     *
+     *  All of them execute the same instruction implementations, generated
+     *  from instructiontable.hpp, and give identical results.  They differ
+     *  only in how they get from one instruction to the next.  clock()
+     *  always steps through the lookup table.
+     */
+    enum class Engine : uint8_t
+    {
+        Table,    ///< Calls through the lookup table of member function pointers
+        Threaded, ///< Direct threading, jumping between handlers with computed goto
+        TailCall  ///< A function per opcode, each tail calling the next one
+    };
+
+    /** The engine chosen when the emulator was built, see emulator.pro.
+     *
+     */
+    static Engine defaultEngine();
+
+    /** Whether @p engine was compiled in; Threaded needs computed goto
+     *  (GCC or Clang), TailCall needs guaranteed tail calls (musttail).
+     */
+    static bool   engineAvailable(Engine engine);
+
+    bool   setEngine(Engine engine); ///< @return false if the engine is not available
+    Engine engine() const { return _engine; }
+
+    /** Counts every pair of consecutively executed opcodes into @p histogram.
+     *
+     *  Pass nullptr to stop counting.  The histogram must outlive its use here.
+     */
+    void setOpcodePairHistogram(OpcodePairHistogram *histogram) { _pair_histogram = histogram; }
+
+    /** Counts of what has been executed, kept by every engine all the time.
+     *
+     *  They are not part of a Snapshot: restoring one leaves them alone, so
+     *  anything run again after rewinding is counted again.
+     */
+    ///@{
+    const ExecutionStatistics &statistics() const { return _statistics; }
+    void resetStatistics() { _statistics.clear(); }
+    ///@}
+
+    /** Hands a TraceRecord of every instruction executed to @p recorder,
+     *  which has to be recording.
+     *
+     *  Pass nullptr to stop tracing.  While tracing, run() executes one
+     *  instruction at a time through the lookup table, whatever the engine,
+     *  and without superinstructions, so every instruction gets its record.
+     *  The recorder must outlive its use here.
+     */
+    void setTraceRecorder(TraceRecorder *recorder) { _trace = recorder; }
+    TraceRecorder *traceRecorder() const { return _trace; }
+
+    /** Counts the cycles of every instruction executed into @p profiler.
+     *
+     *  Pass nullptr to stop profiling.  Like tracing, profiling runs one
+     *  instruction at a time through the lookup table, so every one of them
+     *  is seen.  Interrupts and resets are passed on to it too.  The
+     *  profiler must outlive its use here.
+     */
+    void setCycleProfiler(CycleProfiler *profiler) { _profiler = profiler; }
+    CycleProfiler *cycleProfiler() const { return _profiler; }
+
+    /** Marks every byte the CPU executes, reads or writes in @p coverage.
+     *
+     *  Pass nullptr to stop.  Unlike tracing and profiling this works with
+     *  every engine and with superinstructions, at the cost of an OR per
+     *  access.  Reads made for the debugger, with read_only set, don't
+     *  count.  The map must outlive its use here.
+     */
+    void setCoverageMap(CoverageMap *coverage) { _coverage = coverage; }
+    CoverageMap *coverageMap() const { return _coverage; }
+
+    /** Counts every byte the CPU executes, reads or writes in @p counters,
+     *  which is what an AccessHeatmap is drawn from.
+     *
+     *  Pass nullptr to stop.  It works with every engine, as coverage does,
+     *  and counts what coverage marks.  The counters must outlive their use
+     *  here.
+     */
+    void setAccessCounters(AccessCounters *counters) { _access_counters = counters; }
+    AccessCounters *accessCounters() const { return _access_counters; }
+
+    /** Disassembles the instructions from @p start to @p stop, a line
+     *  each by address.
+     *
+     *  Given a @p coverage map, bytes it has as data and never executed
+     *  come out as .byte lines, as does anything whose operands would run
+     *  into an opcode it has seen executed, so the instructions after it
+     *  line up.
+     */
+    auto disassemble(addressType start, addressType stop, const CoverageMap *coverage = nullptr) -> disassemblyType;
+
+    InstructionExecutor &operator =(const InstructionExecutor &) = delete;
+    InstructionExecutor &operator =(InstructionExecutor &&) = delete;
+protected:
+    // The kinds of ALU results that lazy flag evaluation can defer.  Each
+    // one knows which flags it affects and how to compute them from the
+    // recorded operands and result.
+    enum class FlagOperation : uint8_t
+    {
+        Result,     ///< N and Z from the result (loads, transfers, logic, INC/DEC)
+        Add,        ///< ADC and binary mode SBC (the right operand is already complemented)
+        Compare,    ///< CMP, CPX, CPY
+        ShiftLeft,  ///< ASL, ROL (carry out is bit 8 of the result)
+        ShiftRight, ///< LSR, ROR (carry out is bit 0 of the left operand)
+        Bit         ///< BIT
+    };
+
+    // The last ALU operation whose flags have not been computed yet
+    struct DeferredFlags
+    {
+        uint8_t       pending = 0x00; // The flags still waiting to be computed
+        FlagOperation operation = FlagOperation::Result;
+        uint8_t       left = 0x00;
+        uint8_t       right = 0x00;
+        uint16_t      result = 0x0000;
+    };
+
+    // Everything the CPU touches while executing an instruction, packed
+    // together into a single cache line.
+    struct alignas(64) CpuState
+    {
+        Registers     registers;
+        uint16_t      temp = 0x0000; // A convenience variable used everywhere
+        uint16_t      addr_abs = 0x0000; // All used memory addresses end up in here
+        uint16_t      addr_rel = 0x0000; // Represents absolute address following a branch
+        uint8_t       fetched = 0x00; // Represents the working input value to the ALU
+        uint8_t       opcode = 0x00; // Is the instruction byte
+        uint8_t       cycles = 0; // Counts how many cycles the instruction has remaining
+        bool          lazy_flags = false;
+        bool          stop_requested = false; // Ends run() early, see stop()
+        DeferredFlags deferred;
+        uint64_t      instructions = 0; // Counts every instruction started
+    };
+    static_assert(sizeof(CpuState) == 64, "The hot CPU state should fill exactly one cache line");
+
+    // Observers of register changes.  They are only consulted once an
+    // instruction has completed, so they are kept away from the hot state.
+    struct Observers
+    {
+        registerValueChangedDelegate a_changed;
+        registerValueChangedDelegate x_changed;
+        registerValueChangedDelegate y_changed;
+        registerValueChangedDelegate stack_pointer_changed;
+        addressValueChangedDelegate  program_counter_changed;
+        registerValueChangedDelegate status_changed;
+    };
+
+    // A superinstruction handler is entered just after the first opcode of
+    // its pair has been read, and returns the cycles taken by both halves.
+    using superinstructionHandler = uint32_t (InstructionExecutor::*)(void);
+
+    struct Superinstruction
+    {
+        uint8_t first;
+        uint8_t second;
+        superinstructionHandler handler;
+    };
+
+    // The enabled superinstructions starting with a particular opcode
+    struct FusionSlot
+    {
+        superinstructionHandler handler = nullptr;
+        std::bitset<256>        seconds;
+    };
+
+    // The tail call engine's handlers all share this signature, so each one
+    // can hand over to the next as its very last action.
+    using tailCallHandler = uint32_t (*)(InstructionExecutor &cpu, uint32_t cycles, uint32_t elapsed);
+
+    // Mutable, so pending flags can be materialized from the const accessors
+    mutable CpuState _state;
+    readDelegate     _read_delegate;
+    writeDelegate    _write_delegate;
+    std::vector<INSTRUCTION> _lookup;
+    std::vector<FusionSlot>  _fusion; // Indexed by the first opcode of the pair
+    std::vector<tailCallHandler> _tail_calls; // Indexed by opcode, with superinstructions patched in
+    std::vector<void *>      _threaded_dispatch; // Labels in runThreaded(), likewise; empty until it runs
+    OpcodePairHistogram     *_pair_histogram = nullptr;
+    ExecutionStatistics      _statistics;
+    TraceRecorder           *_trace = nullptr;
+    CycleProfiler           *_profiler = nullptr;
+    CoverageMap             *_coverage = nullptr;
+    AccessCounters          *_access_counters = nullptr;
+    uint64_t                 _cycle_count = 0; // See cycleCount()
+    Engine           _engine = defaultEngine();
+    Observers        _observers;
+
+    // Every pair that has a superinstruction handler
+    static const std::vector<Superinstruction> &superinstructions();
+
+    // Superinstruction handlers, named after the pair of instructions they fuse
+    uint32_t DEY_BNE(); uint32_t DEX_BNE(); uint32_t LDA_STA();
+    uint32_t CMP_BEQ(); uint32_t INC_BNE(); uint32_t CLC_ADC();
+
+    // Reads the opcode following the first half of a superinstruction.  If
+    // it completes an enabled pair, the second instruction is started, its
+    // base cycles are added to cycles, and true is returned for the handler
+    // to finish it.  Otherwise it is simply executed on its own.
+    bool     continueFusion(uint32_t &cycles);
+
+    // The second half of a superinstruction ending in a branch
+    uint32_t fusedBranch(bool taken);
+
+    // The read location of data can come from two sources, a memory address, or
+    // its immediately available as part of the instruction. This function decides
+    // depending on address mode of instruction byte
+    uint8_t fetch();
+
+    uint8_t read(addressType address, bool read_only = false);
+    void    write(addressType address, uint8_t data);
+
+    // Opcodes and operands are read through readCode(), which coverage
+    // doesn't count as reading, and pointers through readPointer()
+    uint8_t readCode(addressType address);
+    uint8_t readPointer(addressType address);
+
+    // Convenience functions to access status register.  They keep the
+    // deferred flags consistent: reading a pending flag computes it, and
+    // writing one simply overrides what was pending.
+    uint8_t GetFlag(FLAGS6502 f) const
+    {
+        if (_state.deferred.pending & f)
+            materializeFlags();
+        return _state.registers.GetFlag(f);
+    }
+    void    SetFlag(FLAGS6502 f, bool v) { SetFlags(f, v ? f : 0x00); }
+    void    SetFlags(uint8_t mask, uint8_t values)
+    {
+        _state.deferred.pending &= ~mask;
+        _state.registers.SetFlags(mask, values);
+    }
+    void    SetNZ(uint8_t value) { updateFlags(FlagOperation::Result, 0x00, 0x00, value); }
+
+    // Sets the flags affected by an ALU operation, either right away or,
+    // with lazy flags, by recording it for later
+    void    updateFlags(FlagOperation operation, uint8_t left, uint8_t right, uint16_t result);
+
+    // Fetches, decodes and executes the next instruction in one go, leaving
+    // the number of cycles it takes in _state.cycles
+    void    executeNextInstruction();
+
+    // executeNextInstruction(), recording the instruction for the trace
+    // recorder as starting on clock tick cycle
+    void    traceNextInstruction(uint64_t cycle);
+
+    // executeNextInstruction() for when the instruction is being traced,
+    // profiled or both
+    void    observeNextInstruction(uint64_t cycle);
+
+    // The two halves of executing an instruction: beginInstruction() takes
+    // an opcode that has just been read, and completeInstruction() runs its
+    // addressing mode and operation, returning the cycles it takes
+    void    beginInstruction(uint8_t opcode);
+    uint8_t completeInstruction();
+
+    // completeInstruction() for an opcode known at compile time, so the
+    // addressing mode and operation can be inlined into the handler
+    template <uint8_t (InstructionExecutor::*Operate)(void), uint8_t (InstructionExecutor::*AddressMode)(void), uint8_t Cycles>
+    uint8_t execute();
+
+    // The interpreter loops behind run().  Each one executes whole
+    // instructions until elapsed reaches cycles, and returns elapsed.
+    ///@{
+    uint32_t runTable(uint32_t cycles, uint32_t elapsed);
+    uint32_t runThreaded(uint32_t cycles, uint32_t elapsed);
+    uint32_t runTailCalls(uint32_t cycles, uint32_t elapsed);
+    uint32_t runObserved(uint32_t cycles, uint32_t elapsed);
+    ///@}
+
+    // The tail call engine: dispatchTailCall() starts the next instruction
+    // and jumps to its handler, which executes it and jumps back.
+    ///@{
+    static uint32_t dispatchTailCall(InstructionExecutor &cpu, uint32_t cycles, uint32_t elapsed);
+    template <uint8_t (InstructionExecutor::*Operate)(void), uint8_t (InstructionExecutor::*AddressMode)(void), uint8_t Cycles>
+    static uint32_t tailCall(InstructionExecutor &cpu, uint32_t cycles, uint32_t elapsed);
+    static uint32_t fusedTailCall(InstructionExecutor &cpu, uint32_t cycles, uint32_t elapsed);
+    ///@}
+
+    // Rebuilds _tail_calls, and has runThreaded() rebuild its table, after
+    // the enabled superinstructions change
+    void    updateDispatchTables();
+
+    // Calls the change delegates for every register that differs from before
+    void    notifyChanges(const Registers &before);
+
+    // Computes any pending flags into the status register
+    void    materializeFlags() const;
+
+    // Forgets any pending flags, for when the whole status register is replaced
+    void    discardPendingFlags() { _state.deferred.pending = 0x00; }
+
+    static uint8_t flagsAffectedBy(FlagOperation operation);
+    static uint8_t computeFlags(FlagOperation operation, uint8_t left, uint8_t right, uint16_t result);
+
+    uint8_t   complement(uint8_t input, bool decimal_mode) const { return (decimal_mode) ? 0x99 - input :
+                                                                                           0xFF ^ input; }
+};
+
+struct InstructionExecutor::Snapshot
+{
+    CpuState state;
+    uint32_t clock_ticks;
+    uint64_t cycle_count;
+};
+static_assert(std::is_trivially_copyable<InstructionExecutor::Snapshot>::value, "A snapshot has to be copyable with memcpy");
+
+#endif // INSTRUCTIONEXECUTOR_HPP
@@ -0,0 +1,199 @@
+#include "lzcodec.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+
+namespace
+{
+constexpr size_t   min_match = 4;
+constexpr size_t   max_offset = 0xFFFF;
+constexpr unsigned hash_bits = 12;
+constexpr uint32_t no_position = 0xFFFFFFFF;
+
+// Misses move on faster and faster, so data that won't compress doesn't
+// cost a probe per byte
+constexpr unsigned skip_shift = 6;
+
+uint32_t Load32(const uint8_t *data)
+{
+    uint32_t value;
+
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+uint64_t Load64(const uint8_t *data)
+{
+    uint64_t value;
+
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+/** How many bytes at @p a and @p b are the same, up to @p limit.
+ *
+ *  Runs are what snapshot deltas are made of, so this goes a word at a time.
+ */
+size_t MatchLength(const uint8_t *a, const uint8_t *b, size_t limit)
+{
+    size_t length = 0;
+
+    while (length + 8 <= limit)
+    {
+        const uint64_t difference = Load64(a + length) ^ Load64(b + length);
+
+        if (difference != 0)
+        {
+            // The first differing byte is the lowest on little endian hosts
+            for (; a[length] == b[length]; ++length)
+                ;
+            return length;
+        }
+        length += 8;
+    }
+    while ((length < limit) && (a[length] == b[length]))
+        ++length;
+    return length;
+}
+
+uint32_t Hash(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - hash_bits);
+}
+
+/** Writes what's left of a length after the 15 that fits in its token.
+ *
+ */
+uint8_t *WriteLength(uint8_t *out, size_t length)
+{
+    for (length -= 15; length >= 255; length -= 255)
+        *out++ = 255;
+    *out++ = static_cast<uint8_t>(length);
+    return out;
+}
+
+bool ReadLength(const uint8_t *&in, const uint8_t *end, size_t &length)
+{
+    uint8_t more;
+
+    do {
+        if (in == end)
+            return false;
+        more = *in++;
+        length += more;
+    } while (more == 255);
+    return true;
+}
+
+uint8_t *WriteLiterals(uint8_t *out, uint8_t token, const uint8_t *literals, size_t count)
+{
+    *out++ = static_cast<uint8_t>(token | ((count < 15) ? count << 4 : 0xF0));
+    if (count >= 15)
+        out = WriteLength(out, count);
+    std::memcpy(out, literals, count);
+    return out + count;
+}
+}
+
+
+size_t LzCodec::compress(const uint8_t *source, size_t length, uint8_t *destination)
+{
+    std::array<uint32_t, 1u << hash_bits> table;
+    uint8_t *out = destination;
+    size_t   anchor = 0;
+    size_t   position = 0;
+
+    table.fill(no_position);
+    while (position + min_match <= length)
+    {
+        const uint32_t sequence = Load32(source + position);
+        uint32_t      &entry = table[Hash(sequence)];
+        const size_t   candidate = entry;
+
+        entry = static_cast<uint32_t>(position);
+        if ((candidate == no_position) || (position - candidate > max_offset) || (Load32(source + candidate) != sequence))
+        {
+            position += 1 + ((position - anchor) >> skip_shift);
+            continue;
+        }
+
+        const size_t match = min_match + MatchLength(source + candidate + min_match, source + position + min_match,
+                                                     length - position - min_match);
+
+        const size_t  offset = position - candidate;
+        const uint8_t match_nibble = static_cast<uint8_t>((match - min_match < 15) ? match - min_match : 15);
+
+        out = WriteLiterals(out, match_nibble, source + anchor, position - anchor);
+        *out++ = static_cast<uint8_t>(offset);
+        *out++ = static_cast<uint8_t>(offset >> 8);
+        if (match_nibble == 15)
+            out = WriteLength(out, match - min_match);
+        position += match;
+        anchor = position;
+    }
+    out = WriteLiterals(out, 0, source + anchor, length - anchor);
+    return static_cast<size_t>(out - destination);
+}
+
+bool LzCodec::decompress(const uint8_t *source, size_t source_length, uint8_t *destination, size_t length)
+{
+    const uint8_t *in = source;
+    const uint8_t *end = source + source_length;
+    size_t         out = 0;
+
+    while (in != end)
+    {
+        const uint8_t token = *in++;
+        size_t        literals = token >> 4;
+
+        if ((literals == 15) && !ReadLength(in, end, literals))
+            return false;
+        if ((literals > static_cast<size_t>(end - in)) || (literals > length - out))
+            return false;
+        std::memcpy(destination + out, in, literals);
+        in += literals;
+        out += literals;
+
+        // The last sequence has no match
+        if (in == end)
+            break;
+        if (end - in < 2)
+            return false;
+
+        const size_t offset = in[0] | (static_cast<size_t>(in[1]) << 8);
+        size_t       match = (token & 0x0F) + min_match;
+
+        in += 2;
+        if (((token & 0x0F) == 15) && !ReadLength(in, end, match))
+            return false;
+        if ((offset == 0) || (offset > out) || (match > length - out))
+            return false;
+
+        // Matches can overlap what they write, which is how runs are stored
+        uint8_t       *to = destination + out;
+        const uint8_t *from = to - offset;
+
+        if (offset >= match)
+            std::memcpy(to, from, match);
+        else if (offset == 1)
+            std::memset(to, *from, match);
+        else
+        {
+            // Repeat the pattern, doubling what's copied each time so no
+            // copy overlaps itself
+            size_t done = offset;
+
+            std::memcpy(to, from, offset);
+            while (done < match)
+            {
+                const size_t chunk = std::min(done, match - done);
+
+                std::memcpy(to + done, to, chunk);
+                done += chunk;
+            }
+        }
+        out += match;
+    }
+    return out == length;
+}
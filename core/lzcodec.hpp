@@ -0,0 +1,44 @@
+#ifndef LZCODEC_HPP
+#define LZCODEC_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+
+/** A small, fast LZ77 compressor in the style of LZ4.
+ *
+ *  The output is a series of sequences, each a token byte (literal count in
+ *  the high nibble, match length less four in the low nibble, 15 meaning more
+ *  length bytes follow), the literals, then a two byte little endian offset
+ *  back to the match.  The last sequence is literals only.
+ *
+ *  It trades ratio for speed: one hash probe per position, no lazy matching.
+ *  What it is good at is long runs, such as the zeroes left when a snapshot
+ *  is XORed with one taken a moment earlier.
+ */
+class LzCodec
+{
+public:
+    /** The most compress() can write for @p length bytes of input.
+     *
+     */
+    static constexpr size_t maxCompressedSize(size_t length) { return length + length / 255 + 16; }
+
+    /** Compresses @p length bytes at @p source into @p destination, which has
+     *  to have room for maxCompressedSize() bytes.
+     *
+     *  @return The number of bytes written
+     */
+    static size_t compress(const uint8_t *source, size_t length, uint8_t *destination);
+
+    /** Decompresses what compress() wrote into exactly @p length bytes at
+     *  @p destination.
+     *
+     *  @return false if @p source is corrupt or doesn't decompress to
+     *          @p length bytes.  Nothing is ever written beyond @p length
+     *          bytes, whatever @p source holds.
+     */
+    static bool decompress(const uint8_t *source, size_t source_length, uint8_t *destination, size_t length);
+};
+
+#endif // LZCODEC_HPP
@@ -0,0 +1,22 @@
+#include "machinesnapshot.hpp"
+#include <cstring>
+
+
+void DeltaSnapshot::applyTo(MachineSnapshot &snapshot) const
+{
+    applyPagesTo(snapshot.ram);
+    snapshot.cycle = cycle;
+    snapshot.cpu = cpu;
+}
+
+void DeltaSnapshot::applyPagesTo(RamDevice::memory_type &ram) const
+{
+    const uint8_t *page_data = data.data();
+
+    for (size_t page = 0; page < pages.size(); ++page)
+        if (pages[page])
+        {
+            std::memcpy(ram.data() + page * page_size, page_data, page_size);
+            page_data += page_size;
+        }
+}
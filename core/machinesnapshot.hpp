@@ -0,0 +1,56 @@
+#ifndef MACHINESNAPSHOT_HPP
+#define MACHINESNAPSHOT_HPP
+
+#include "instructionexecutor.hpp"
+#include "ramdevice.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+
+/** The whole state of a CPU with 64K of RAM, as one block of plain data.
+ *
+ *  Taking or restoring one is little more than copying 64K, so thousands
+ *  can be taken every second.  Being plain data, a snapshot can also be
+ *  written out as it is; the version says whether one read back in still
+ *  fits.
+ */
+struct MachineSnapshot
+{
+    static constexpr uint32_t current_version = 2;
+
+    uint32_t                      version = current_version;
+    uint64_t                      cycle = 0; ///< Clock ticks run when it was taken
+    InstructionExecutor::Snapshot cpu;
+    RamDevice::memory_type        ram;
+};
+static_assert(std::is_trivially_copyable<MachineSnapshot>::value, "A snapshot has to be copyable with memcpy");
+
+/** What changed since the snapshot before it: the CPU, and only the pages
+ *  of RAM that were written to in between.
+ *
+ *  A chain of these on top of a full MachineSnapshot rebuilds every state
+ *  along the way.  Reusing a delta keeps its buffer, so taking one every
+ *  frame doesn't allocate.
+ */
+struct DeltaSnapshot
+{
+    static constexpr size_t page_size = 256;
+
+    uint64_t                      cycle = 0;
+    InstructionExecutor::Snapshot cpu;
+    RamDevice::pageMask           pages; ///< The pages stored in data
+    std::vector<uint8_t>          data;  ///< The pages, lowest first
+
+    size_t size() const { return sizeof(cycle) + sizeof(cpu) + sizeof(pages) + data.size(); } ///< Bytes of state held
+
+    /** Brings @p snapshot, the state this delta was taken on top of, up to
+     *  the state it was taken at.
+     */
+    void applyTo(MachineSnapshot &snapshot) const;
+
+    void applyPagesTo(RamDevice::memory_type &ram) const; ///< Just the RAM part of applyTo()
+};
+
+#endif // MACHINESNAPSHOT_HPP
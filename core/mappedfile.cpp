@@ -0,0 +1,126 @@
+#include "mappedfile.hpp"
+
+#ifdef _WIN32
+#   ifndef NOMINMAX
+#       define NOMINMAX
+#   endif
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#   include <cerrno>
+#   include <cstring>
+#endif
+
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const std::string &path, std::string &error)
+{
+    close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        error = "Cannot open " + path;
+        return false;
+    }
+
+    LARGE_INTEGER size;
+
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        error = "Cannot tell how big " + path + " is";
+        return false;
+    }
+    // A mapping can't be empty, but an empty file is still a file
+    if (size.QuadPart != 0)
+    {
+        _mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (_mapping)
+            _data = static_cast<const uint8_t *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+        if (!_data)
+        {
+            if (_mapping)
+                CloseHandle(_mapping);
+            _mapping = nullptr;
+            CloseHandle(file);
+            error = "Cannot map " + path;
+            return false;
+        }
+    }
+    CloseHandle(file);
+    _size = static_cast<size_t>(size.QuadPart);
+    _open = true;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (_data)
+        UnmapViewOfFile(_data);
+    if (_mapping)
+        CloseHandle(_mapping);
+    _data = nullptr;
+    _mapping = nullptr;
+    _size = 0;
+    _open = false;
+}
+#else
+bool MappedFile::open(const std::string &path, std::string &error)
+{
+    close();
+
+    const int file = ::open(path.c_str(), O_RDONLY);
+
+    if (file < 0)
+    {
+        error = "Cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    struct stat status;
+
+    if (fstat(file, &status) != 0)
+    {
+        error = "Cannot tell how big " + path + " is: " + std::strerror(errno);
+        ::close(file);
+        return false;
+    }
+    // A mapping can't be empty, but an empty file is still a file
+    if (status.st_size != 0)
+    {
+        void *mapping = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+        if (mapping == MAP_FAILED)
+        {
+            error = "Cannot map " + path + ": " + std::strerror(errno);
+            ::close(file);
+            return false;
+        }
+        _data = static_cast<const uint8_t *>(mapping);
+    }
+    // The mapping stays valid without the descriptor
+    ::close(file);
+    _size = static_cast<size_t>(status.st_size);
+    _open = true;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (_data)
+        munmap(const_cast<uint8_t *>(_data), _size);
+    _data = nullptr;
+    _size = 0;
+    _open = false;
+}
+#endif
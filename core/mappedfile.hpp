@@ -0,0 +1,43 @@
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+/** A whole file, mapped read only into memory.
+ *
+ *  The pages are only read in as they are touched, and nothing is copied
+ *  until the caller copies it.
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+   ~MappedFile();
+
+    /** Maps the file at @p path, unmapping whatever was mapped before.
+     *
+     *  @return false, with the reason in @p error, if the file can't be mapped
+     */
+    bool open(const std::string &path, std::string &error);
+    void close();
+
+    bool isOpen() const { return _open; }
+
+    const uint8_t *data() const { return _data; }
+    size_t         size() const { return _size; }
+
+    MappedFile &operator =(const MappedFile &) = delete;
+private:
+    const uint8_t *_data = nullptr;
+    size_t         _size = 0;
+    bool           _open = false;
+#ifdef _WIN32
+    void          *_mapping = nullptr;
+#endif
+};
+
+#endif // MAPPEDFILE_HPP
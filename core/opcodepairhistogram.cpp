@@ -0,0 +1,34 @@
+#include "opcodepairhistogram.hpp"
+#include <algorithm>
+#include <numeric>
+
+
+uint64_t OpcodePairHistogram::total() const
+{
+    return std::accumulate(_counts.begin(), _counts.end(), uint64_t{ 0 });
+}
+
+void OpcodePairHistogram::clear()
+{
+    std::fill(_counts.begin(), _counts.end(), 0);
+}
+
+std::vector<OpcodePairHistogram::Pair> OpcodePairHistogram::mostFrequent(size_t maximum) const
+{
+    std::vector<Pair> pairs;
+
+    for (uint32_t i = 0; i < _counts.size(); ++i)
+        if (_counts[i])
+            pairs.push_back({ static_cast<uint8_t>(i >> 8), static_cast<uint8_t>(i & 0xFF), _counts[i] });
+
+    // Ties are broken by opcode, so the order is always the same.
+    std::sort(pairs.begin(), pairs.end(), [](const Pair &left, const Pair &right)
+    {
+        if (left.count != right.count)
+            return left.count > right.count;
+        return index(left.first, left.second) < index(right.first, right.second);
+    });
+    if (pairs.size() > maximum)
+        pairs.resize(maximum);
+    return pairs;
+}
@@ -0,0 +1,45 @@
+#ifndef OPCODEPAIRHISTOGRAM_HPP
+#define OPCODEPAIRHISTOGRAM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+/** Counts how often each opcode is immediately followed by each other opcode.
+ *
+ *  The executor fills one of these in while it runs, when asked to.  The most
+ *  frequent pairs are the candidates for superinstruction fusion.
+ */
+class OpcodePairHistogram
+{
+public:
+    struct Pair
+    {
+        uint8_t  first;
+        uint8_t  second;
+        uint64_t count;
+    };
+
+    OpcodePairHistogram() : _counts(256 * 256, 0) { }
+
+    void record(uint8_t first, uint8_t second) { ++_counts[index(first, second)]; }
+
+    uint64_t count(uint8_t first, uint8_t second) const { return _counts[index(first, second)]; }
+    uint64_t total() const;
+
+    void clear();
+
+    /** The @p maximum most frequent pairs, most frequent first.
+     *
+     *  Pairs that were never seen are not included.
+     */
+    std::vector<Pair> mostFrequent(size_t maximum) const;
+
+private:
+    std::vector<uint64_t> _counts;
+
+    static uint32_t index(uint8_t first, uint8_t second) { return (static_cast<uint32_t>(first) << 8) | second; }
+};
+
+#endif // OPCODEPAIRHISTOGRAM_HPP
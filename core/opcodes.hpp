@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include "instructions.hpp"
+#include "instructiontable.hpp"
 
 constexpr uint8_t OpcodeFor(const AbstractInstruction_e instruction, const AddressMode_e address_mode)
 {
@@ -402,6 +403,35 @@ constexpr uint8_t OpcodeFor(const AbstractInstruction_e instruction, const Addre
         return 0xEA;
         break;
     case AbstractInstruction_e::ORA:
+        switch (address_mode)
+        {
+        case AddressMode_e::Absolute:
+            return 0x0D;
+            break;
+        case AddressMode_e::AbsoluteXIndexed:
+            return 0x1D;
+            break;
+        case AddressMode_e::AbsoluteYIndexed:
+            return 0x19;
+            break;
+        case AddressMode_e::Immediate:
+            return 0x09;
+            break;
+        case AddressMode_e::XIndexedIndirect:
+            return 0x01;
+            break;
+        case AddressMode_e::IndirectYIndexed:
+            return 0x11;
+            break;
+        case AddressMode_e::ZeroPage:
+            return 0x05;
+            break;
+        case AddressMode_e::ZeroPageXIndexed:
+            return 0x15;
+            break;
+        default:
+            break;
+        }
         break;
     case AbstractInstruction_e::PHA:
         return 0x48;
@@ -592,4 +622,68 @@ constexpr uint8_t OpcodeFor(const AbstractInstruction_e instruction, const Addre
     return 0;
 }
 
+/** The addressing mode the executor decodes @p opcode with.
+ *
+ *  The executor treats accumulator mode as implied; ASL, LSR, ROL and ROR
+ *  on the accumulator are told apart here by their opcodes.  Unofficial
+ *  opcodes are all implied, and BRK is immediate, skipping its padding byte.
+ */
+constexpr AddressMode_e AddressModeOf(uint8_t opcode)
+{
+    constexpr AddressMode_e IMM = AddressMode_e::Immediate;
+    constexpr AddressMode_e ZP0 = AddressMode_e::ZeroPage;
+    constexpr AddressMode_e ZPX = AddressMode_e::ZeroPageXIndexed;
+    constexpr AddressMode_e ZPY = AddressMode_e::ZeroPageYIndexed;
+    constexpr AddressMode_e REL = AddressMode_e::Relative;
+    constexpr AddressMode_e ABS = AddressMode_e::Absolute;
+    constexpr AddressMode_e ABX = AddressMode_e::AbsoluteXIndexed;
+    constexpr AddressMode_e ABY = AddressMode_e::AbsoluteYIndexed;
+    constexpr AddressMode_e IND = AddressMode_e::Indirect;
+    constexpr AddressMode_e IZX = AddressMode_e::XIndexedIndirect;
+    constexpr AddressMode_e IZY = AddressMode_e::IndirectYIndexed;
+    const     AddressMode_e IMP = ((opcode & 0x9F) == 0x0A) ? AddressMode_e::Accumulator : AddressMode_e::Implied;
+
+    switch (opcode)
+    {
+#define ADDRESS_MODE_OF(code, name, operate, addrmode, base_cycles) case code: return addrmode;
+    INSTRUCTION_TABLE(ADDRESS_MODE_OF)
+#undef ADDRESS_MODE_OF
+    }
+    return IMP;
+}
+
+/** The mnemonic of @p opcode as the disassembly shows it, "???" for the
+ *  unofficial opcodes.
+ */
+constexpr const char *MnemonicOf(uint8_t opcode)
+{
+    switch (opcode)
+    {
+#define MNEMONIC_OF(code, name, operate, addrmode, base_cycles) case code: return name;
+    INSTRUCTION_TABLE(MNEMONIC_OF)
+#undef MNEMONIC_OF
+    }
+    return "???";
+}
+
+/** The number of bytes that follow the opcode in @p mode.
+ *
+ */
+constexpr uint8_t OperandBytesOf(AddressMode_e mode)
+{
+    switch (mode)
+    {
+    case AddressMode_e::Accumulator:
+    case AddressMode_e::Implied:
+        return 0;
+    case AddressMode_e::Absolute:
+    case AddressMode_e::AbsoluteXIndexed:
+    case AddressMode_e::AbsoluteYIndexed:
+    case AddressMode_e::Indirect:
+        return 2;
+    default:
+        return 1;
+    }
+}
+
 #endif // OPCODES_HPP
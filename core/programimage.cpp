@@ -0,0 +1,423 @@
+#include "programimage.hpp"
+#include <algorithm>
+#include <cstring>
+
+
+namespace
+{
+constexpr uint32_t address_space = 64 * 1024;
+constexpr size_t   ines_header = 16;
+constexpr size_t   ines_trainer = 512;
+constexpr size_t   ines_prg_unit = 16 * 1024;
+
+int Nibble(uint8_t character)
+{
+    if ((character >= '0') && (character <= '9'))
+        return character - '0';
+    if ((character >= 'A') && (character <= 'F'))
+        return character - 'A' + 10;
+    if ((character >= 'a') && (character <= 'f'))
+        return character - 'a' + 10;
+    return -1;
+}
+
+bool IsSpace(uint8_t character)
+{
+    return (character == ' ') || (character == '\t') || (character == '\r') || (character == '\n');
+}
+
+/** Turns @p length hex digit pairs at @p text into bytes.
+ *
+ */
+bool HexBytes(const uint8_t *text, size_t length, uint8_t *bytes)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        const int high = Nibble(text[2 * i]);
+        const int low = Nibble(text[2 * i + 1]);
+
+        if ((high < 0) || (low < 0))
+            return false;
+        bytes[i] = static_cast<uint8_t>((high << 4) | low);
+    }
+    return true;
+}
+
+/** Calls @p handle with each line of text that isn't blank, without its line
+ *  ending or surrounding white space, until it returns false.
+ *
+ */
+template <typename Handler>
+bool ForEachLine(const uint8_t *data, size_t size, Handler handle)
+{
+    size_t number = 0;
+
+    for (size_t start = 0; start < size; )
+    {
+        const uint8_t *end_of_line = static_cast<const uint8_t *>(std::memchr(data + start, '\n', size - start));
+        size_t         end = end_of_line ? static_cast<size_t>(end_of_line - data) : size;
+        const size_t   next = end + 1;
+
+        ++number;
+        while ((start < end) && IsSpace(data[start]))
+            ++start;
+        while ((end > start) && IsSpace(data[end - 1]))
+            --end;
+        if ((end > start) && !handle(data + start, end - start, number))
+            return false;
+        start = next;
+    }
+    return true;
+}
+
+std::string LineError(size_t number, const std::string &problem)
+{
+    return "Line " + std::to_string(number) + ": " + problem;
+}
+}
+
+
+bool ProgramImage::load(const std::string &path, Format format, addressType raw_address, std::string &error)
+{
+    _segments.clear();
+    if (!_file.open(path, error))
+        return false;
+    if (!decode(_file.data(), _file.size(), format, raw_address, error))
+    {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+bool ProgramImage::decode(const uint8_t *data, size_t size, Format format, addressType raw_address, std::string &error)
+{
+    _segments.clear();
+    _decoded.clear();
+    _entry_point.reset();
+    _format = (format == Format::Detect) ? detectFormat(data, size) : format;
+
+    bool decoded = false;
+
+    switch (_format)
+    {
+    case Format::Detect:
+    case Format::Raw:
+        decoded = decodeRaw(data, size, raw_address, error);
+        break;
+    case Format::IntelHex:
+        decoded = decodeIntelHex(data, size, error);
+        break;
+    case Format::SRecord:
+        decoded = decodeSRecord(data, size, error);
+        break;
+    case Format::INes:
+        decoded = decodeINes(data, size, error);
+        break;
+    }
+    if (!decoded)
+    {
+        _segments.clear();
+        _entry_point.reset();
+        return false;
+    }
+    if (_segments.empty())
+    {
+        error = "There is nothing to load";
+        return false;
+    }
+    if (!_entry_point && !coversResetVector())
+        _entry_point = _segments.front().address;
+    return true;
+}
+
+size_t ProgramImage::size() const
+{
+    size_t total = 0;
+
+    for (const Segment &segment : _segments)
+        total += segment.length;
+    return total;
+}
+
+ProgramImage::Format ProgramImage::detectFormat(const uint8_t *data, size_t size)
+{
+    if ((size >= 4) && (std::memcmp(data, "NES\x1A", 4) == 0))
+        return Format::INes;
+
+    size_t start = 0;
+
+    while ((start < size) && IsSpace(data[start]))
+        ++start;
+    if (start + 2 > size)
+        return Format::Raw;
+
+    // The text formats have nothing but hex digits after the record mark,
+    // at least as far as the end of the first line
+    size_t digits = start + ((data[start] == ':') ? 1 : 2);
+
+    if ((data[start] != ':') && ((data[start] != 'S') || (Nibble(data[start + 1]) < 0)))
+        return Format::Raw;
+    while ((digits < size) && !IsSpace(data[digits]))
+        if (Nibble(data[digits++]) < 0)
+            return Format::Raw;
+    return (data[start] == ':') ? Format::IntelHex : Format::SRecord;
+}
+
+bool ProgramImage::formatFromName(const std::string &name, Format &format)
+{
+    if (name == "auto")
+        format = Format::Detect;
+    else if (name == "raw")
+        format = Format::Raw;
+    else if (name == "ihex")
+        format = Format::IntelHex;
+    else if (name == "srec")
+        format = Format::SRecord;
+    else if (name == "ines")
+        format = Format::INes;
+    else
+        return false;
+    return true;
+}
+
+bool ProgramImage::decodeRaw(const uint8_t *data, size_t size, addressType address, std::string &error)
+{
+    if (size > address_space)
+    {
+        error = "The image is " + std::to_string(size) + " bytes, it has to fit in 64K";
+        return false;
+    }
+    if (size > 0)
+        _segments.push_back({ address, data, size });
+    return true;
+}
+
+bool ProgramImage::decodeIntelHex(const uint8_t *data, size_t size, std::string &error)
+{
+    uint32_t base = 0;
+    bool     ended = false;
+
+    // Every byte takes two characters, so this never has to grow and the
+    // segments can point straight into it
+    _decoded.reserve(size / 2);
+
+    const bool decoded = ForEachLine(data, size, [&](const uint8_t *line, size_t length, size_t number)
+    {
+        uint8_t record[5 + 255];
+
+        if (line[0] != ':')
+        {
+            error = LineError(number, "a record has to start with ':'");
+            return false;
+        }
+        if ((length < 11) || (length > 1 + 2 * sizeof(record)) || ((length - 1) % 2 != 0) ||
+            !HexBytes(line + 1, (length - 1) / 2, record))
+        {
+            error = LineError(number, "not a valid record");
+            return false;
+        }
+
+        const size_t count = record[0];
+
+        if (length != 11 + 2 * count)
+        {
+            error = LineError(number, "the record is the wrong length for its byte count");
+            return false;
+        }
+
+        uint8_t sum = 0;
+
+        for (size_t i = 0; i < count + 5; ++i)
+            sum = static_cast<uint8_t>(sum + record[i]);
+        if (sum != 0)
+        {
+            error = LineError(number, "checksum mismatch");
+            return false;
+        }
+
+        const uint32_t offset = (static_cast<uint32_t>(record[1]) << 8) | record[2];
+        const uint8_t *payload = record + 4;
+        uint32_t       value = 0;
+
+        for (size_t i = 0; i < std::min<size_t>(count, 4); ++i)
+            value = (value << 8) | payload[i];
+
+        switch (record[3])
+        {
+        case 0x00: // Data
+            if (base + offset + count > address_space)
+            {
+                error = LineError(number, "the data lies outside the 6502's 64K");
+                return false;
+            }
+            addDecoded(base + offset, payload, count);
+            return true;
+        case 0x01: // End of file
+            ended = true;
+            return false;
+        case 0x02: // Extended segment address
+            base = value << 4;
+            return true;
+        case 0x04: // Extended linear address
+            base = value << 16;
+            return true;
+        case 0x03: // Start segment address, CS:IP
+        case 0x05: // Start linear address
+            if (record[3] == 0x03)
+                value = ((value >> 16) << 4) + (value & 0xFFFF);
+            if (value >= address_space)
+            {
+                error = LineError(number, "the start address lies outside the 6502's 64K");
+                return false;
+            }
+            _entry_point = static_cast<addressType>(value);
+            return true;
+        }
+        error = LineError(number, "unknown record type");
+        return false;
+    });
+
+    return decoded || ended;
+}
+
+bool ProgramImage::decodeSRecord(const uint8_t *data, size_t size, std::string &error)
+{
+    _decoded.reserve(size / 2);
+
+    return ForEachLine(data, size, [&](const uint8_t *line, size_t length, size_t number)
+    {
+        uint8_t record[256];
+
+        if ((length < 4) || (length > 2 + 2 * sizeof(record)) || (line[0] != 'S') || (Nibble(line[1]) < 0) || (length % 2 != 0) ||
+            !HexBytes(line + 2, (length - 2) / 2, record))
+        {
+            error = LineError(number, "not a valid record");
+            return false;
+        }
+
+        const size_t count = record[0];
+
+        if (length != 4 + 2 * count)
+        {
+            error = LineError(number, "the record is the wrong length for its byte count");
+            return false;
+        }
+
+        uint8_t sum = 0;
+
+        for (size_t i = 0; i <= count; ++i)
+            sum = static_cast<uint8_t>(sum + record[i]);
+        if (sum != 0xFF)
+        {
+            error = LineError(number, "checksum mismatch");
+            return false;
+        }
+
+        const char type = static_cast<char>(line[1]);
+        size_t     address_bytes = 0;
+
+        switch (type)
+        {
+        case '0': case '1': case '5': case '9': address_bytes = 2; break;
+        case '2': case '6': case '8':           address_bytes = 3; break;
+        case '3': case '7':                     address_bytes = 4; break;
+        default:
+            error = LineError(number, "unknown record type");
+            return false;
+        }
+        if (count < address_bytes + 1)
+        {
+            error = LineError(number, "the record is too short for its address");
+            return false;
+        }
+
+        uint32_t address = 0;
+
+        for (size_t i = 1; i <= address_bytes; ++i)
+            address = (address << 8) | record[i];
+
+        const uint8_t *payload = record + 1 + address_bytes;
+        const size_t   payload_length = count - address_bytes - 1;
+
+        switch (type)
+        {
+        case '1': case '2': case '3': // Data
+            if (address + payload_length > address_space)
+            {
+                error = LineError(number, "the data lies outside the 6502's 64K");
+                return false;
+            }
+            addDecoded(address, payload, payload_length);
+            break;
+        case '7': case '8': case '9': // Start address
+            if (address >= address_space)
+            {
+                error = LineError(number, "the start address lies outside the 6502's 64K");
+                return false;
+            }
+            _entry_point = static_cast<addressType>(address);
+            break;
+        default: // Header and record counts
+            break;
+        }
+        return true;
+    });
+}
+
+bool ProgramImage::decodeINes(const uint8_t *data, size_t size, std::string &error)
+{
+    if ((size < ines_header) || (std::memcmp(data, "NES\x1A", 4) != 0))
+    {
+        error = "Not an iNES image";
+        return false;
+    }
+
+    const size_t units = data[4];
+    const size_t prg_start = ines_header + ((data[6] & 0x04) ? ines_trainer : 0);
+    const size_t prg_size = units * ines_prg_unit;
+
+    // Without a mapper only NROM fits: 16K mirrored at $8000 and $C000, or
+    // 32K filling both
+    if ((units == 0) || (units > 2))
+    {
+        error = "The image has " + std::to_string(units) + " x 16K of PRG ROM, only 16K or 32K can be loaded without a mapper";
+        return false;
+    }
+    if (size < prg_start + prg_size)
+    {
+        error = "The image is shorter than its header says";
+        return false;
+    }
+
+    const uint8_t *prg = data + prg_start;
+
+    _segments.push_back({ 0x8000, prg, prg_size });
+    if (units == 1)
+        _segments.push_back({ 0xC000, prg, prg_size });
+    return true;
+}
+
+void ProgramImage::addDecoded(uint32_t address, const uint8_t *data, size_t length)
+{
+    if (length == 0)
+        return;
+
+    // Records usually follow on from each other, so they make one segment
+    const uint8_t *end = _decoded.data() + _decoded.size();
+
+    _decoded.insert(_decoded.end(), data, data + length);
+    if (!_segments.empty() && (_segments.back().data + _segments.back().length == end) &&
+        (_segments.back().address + _segments.back().length == address))
+        _segments.back().length += length;
+    else
+        _segments.push_back({ static_cast<addressType>(address), end, length });
+}
+
+bool ProgramImage::coversResetVector() const
+{
+    for (const Segment &segment : _segments)
+        if ((segment.address <= 0xFFFC) && (segment.address + segment.length >= 0xFFFE))
+            return true;
+    return false;
+}
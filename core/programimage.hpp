@@ -0,0 +1,104 @@
+#ifndef PROGRAMIMAGE_HPP
+#define PROGRAMIMAGE_HPP
+
+#include "mappedfile.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+
+/** A program to put into memory, read from a file.
+ *
+ *  Understands raw binaries, Intel HEX, Motorola S-records and the PRG ROM
+ *  of iNES cartridges.  The file is mapped rather than read, and whatever is
+ *  already binary (raw and iNES images) is used where it lies; only the text
+ *  formats get decoded into a buffer.  Either way the result is a handful of
+ *  segments, each ready to be copied into RAM in one go.
+ */
+class ProgramImage
+{
+public:
+    using addressType = uint16_t;
+
+    enum class Format
+    {
+        Detect,     ///< Work it out from the contents
+        Raw,
+        IntelHex,
+        SRecord,
+        INes
+    };
+
+    /** A run of bytes that go at consecutive addresses.
+     *
+     */
+    struct Segment
+    {
+        addressType    address;
+        const uint8_t *data;
+        size_t         length;
+    };
+
+    ProgramImage() = default;
+    ProgramImage(const ProgramImage &) = delete;
+
+    /** Reads the image in the file at @p path.
+     *
+     *  @param raw_address Where a raw binary goes; the other formats say
+     *                     for themselves
+     *
+     *  @return false, with the reason in @p error, if the file can't be read
+     *          or makes no sense as the given format
+     */
+    bool load(const std::string &path, Format format, addressType raw_address, std::string &error);
+
+    /** Like load(), but the image is already in memory.
+     *
+     *  Raw and iNES segments point into @p data, so it has to outlive them.
+     */
+    bool decode(const uint8_t *data, size_t size, Format format, addressType raw_address, std::string &error);
+
+    Format                      format() const   { return _format; }
+    const std::vector<Segment> &segments() const { return _segments; }
+    size_t                      size() const;    ///< Bytes over all the segments
+
+    /** Where to start running the program.
+     *
+     *  The start address the image gives, if it has one, otherwise where its
+     *  first segment goes.  Empty when the image brings its own reset vector,
+     *  as every iNES image does.
+     */
+    std::optional<addressType> entryPoint() const { return _entry_point; }
+
+    /** Works out the format from the first few bytes of an image.
+     *
+     */
+    static Format detectFormat(const uint8_t *data, size_t size);
+
+    /** Format names, as used on command lines and from QML: raw, ihex, srec,
+     *  ines and auto.
+     *
+     *  @return false if @p name isn't one of them
+     */
+    static bool formatFromName(const std::string &name, Format &format);
+
+    ProgramImage &operator =(const ProgramImage &) = delete;
+private:
+    MappedFile                 _file;
+    std::vector<uint8_t>       _decoded;   // What the text formats turn into
+    std::vector<Segment>       _segments;
+    std::optional<addressType> _entry_point;
+    Format                     _format = Format::Raw;
+
+    bool decodeRaw(const uint8_t *data, size_t size, addressType address, std::string &error);
+    bool decodeIntelHex(const uint8_t *data, size_t size, std::string &error);
+    bool decodeSRecord(const uint8_t *data, size_t size, std::string &error);
+    bool decodeINes(const uint8_t *data, size_t size, std::string &error);
+
+    void addDecoded(uint32_t address, const uint8_t *data, size_t length);
+    bool coversResetVector() const;
+};
+
+#endif // PROGRAMIMAGE_HPP
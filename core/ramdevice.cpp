@@ -0,0 +1,71 @@
+#include "ramdevice.hpp"
+#include <algorithm>
+#include <cstring>
+
+
+RamDevice::RamDevice()
+    :
+    BusDevice(0x0000, 0xFFFF, true, true)
+{
+    std::fill(std::begin(_data), std::end(_data), 0);
+}
+
+RamDevice::~RamDevice()
+{
+}
+
+void RamDevice::load(addressType address, const uint8_t *data, size_t length)
+{
+    markDirty(address, length);
+    while (length > 0)
+    {
+        const size_t part = std::min(length, _data.size() - address);
+
+        std::memcpy(_data.data() + address, data, part);
+        data += part;
+        length -= part;
+        address = 0;
+    }
+}
+
+void RamDevice::writeImplementation(addressType address, uint8_t data)
+{
+    _data[address] = data;
+    _dirty_pages[address >> 8] = true;
+    if (_write_observer)
+        _write_observer(address, data);
+}
+
+uint8_t RamDevice::readImplementation(addressType address, bool)
+{
+    return _data[address];
+}
+
+void RamDevice::writeBlockImplementation(addressType address, const uint8_t *data, size_t length)
+{
+    std::memcpy(_data.data() + address, data, length);
+    markDirty(address, length);
+    if (_block_write_observer)
+        _block_write_observer(address, length);
+    else if (_write_observer)
+        for (size_t i = 0; i < length; ++i)
+            _write_observer(static_cast<addressType>(address + i), data[i]);
+}
+
+void RamDevice::readBlockImplementation(addressType address, uint8_t *data, size_t length, bool)
+{
+    std::memcpy(data, _data.data() + address, length);
+}
+
+void RamDevice::markDirty(addressType address, size_t length)
+{
+    if (length == 0)
+        return;
+    if (length >= _data.size())
+    {
+        _dirty_pages.set();
+        return;
+    }
+    for (size_t page = address >> 8, last = (address + length - 1) >> 8; page <= last; ++page)
+        _dirty_pages[page & 0xFF] = true;
+}
@@ -0,0 +1,82 @@
+#ifndef RAMDEVICE_HPP
+#define RAMDEVICE_HPP
+
+#include "busdevice.hpp"
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+
+/** 64K of RAM, covering the whole address space.
+ *
+ */
+class RamDevice : public BusDevice
+{
+public:
+    using memory_type = std::array<uint8_t, 64 * 1024>;
+    using writeObserver = std::function<void (addressType, uint8_t)>;
+    using blockWriteObserver = std::function<void (addressType, size_t)>;
+    using pageMask = std::bitset<256>; ///< A bit for every 256 byte page
+
+    RamDevice();
+   ~RamDevice() override;
+
+    /** Gives access to the memory.
+     *
+     *  @return A reference to the underlying memory
+     */
+    ///@{
+    const memory_type &memory() const { return _data; }
+          memory_type &memory()       { return _data; }
+    ///@}
+
+    /** Calls @p observer with every byte written through the bus.
+     *
+     *  Pass nullptr to stop.  Writes made directly to memory() are not seen.
+     */
+    void setWriteObserver(writeObserver observer) { _write_observer = std::move(observer); }
+
+    /** Calls @p observer once for every block written through the bus, with
+     *  where the block starts and how long it is.
+     *
+     *  Without one, the write observer sees each byte of the block instead.
+     *  Pass nullptr to stop.
+     */
+    void setBlockWriteObserver(blockWriteObserver observer) { _block_write_observer = std::move(observer); }
+
+    /** Copies @p length bytes of @p data into memory, starting at @p address.
+     *
+     *  Anything past the end of the address space wraps around to the start.
+     *  Like writing to memory() this is not seen by the write observer, it is
+     *  up to the caller to say what changed.  The pages are marked dirty.
+     */
+    void load(addressType address, const uint8_t *data, size_t length);
+
+    /** The pages written to since the last clearDirtyPages(), through the
+     *  bus or load().
+     *
+     *  Incremental snapshots only need to store these.  Changes made
+     *  directly to memory() are not tracked.
+     */
+    const pageMask &dirtyPages() const { return _dirty_pages; }
+    void            clearDirtyPages()  { _dirty_pages.reset(); }
+
+protected:
+    void    writeImplementation(addressType address, uint8_t data) override;
+    uint8_t readImplementation(addressType address, bool read_only) override;
+
+    void writeBlockImplementation(addressType address, const uint8_t *data, size_t length) override;
+    void readBlockImplementation(addressType address, uint8_t *data, size_t length, bool read_only) override;
+
+private:
+    memory_type        _data;
+    pageMask           _dirty_pages;
+    writeObserver      _write_observer;
+    blockWriteObserver _block_write_observer;
+
+    void markDirty(addressType address, size_t length);
+};
+
+#endif // RAMDEVICE_HPP
@@ -19,10 +19,20 @@ struct Registers
     }
     void    SetFlag(FLAGS6502 f, bool v)
     {
-        if (v)
-            status |= f;
-        else
-            status &= ~f;
+        SetFlags(f, v ? f : 0x00);
+    }
+
+    // Replaces every flag in mask with the corresponding bit of values,
+    // all in a single store.
+    void    SetFlags(uint8_t mask, uint8_t values)
+    {
+        status = (status & ~mask) | (values & mask);
+    }
+
+    // Sets the N and Z flags according to value
+    void    SetNZ(uint8_t value)
+    {
+        status = (status & ~(N | Z)) | NZFlagsTable[value];
     }
 };
 
@@ -0,0 +1,167 @@
+#include "rewindbuffer.hpp"
+#include "lzcodec.hpp"
+#include <algorithm>
+#include <cstring>
+
+
+namespace
+{
+constexpr size_t ram_size = sizeof(RamDevice::memory_type);
+
+/** Sets @p to to @p a XOR @p b, for @p length bytes, a multiple of 8.
+ *
+ *  Going through words, rather than bytes that could alias anything, lets
+ *  the compiler vectorise it.
+ */
+void Xor(uint8_t *to, const uint8_t *a, const uint8_t *b, size_t length)
+{
+    for (size_t i = 0; i < length; i += sizeof(uint64_t))
+    {
+        uint64_t word_a;
+        uint64_t word_b;
+
+        std::memcpy(&word_a, a + i, sizeof(word_a));
+        std::memcpy(&word_b, b + i, sizeof(word_b));
+        word_a ^= word_b;
+        std::memcpy(to + i, &word_a, sizeof(word_a));
+    }
+}
+}
+
+
+RewindBuffer::RewindBuffer()
+    :
+    _keyframe(ram_size),
+    _work(ram_size),
+    _compressed(LzCodec::maxCompressedSize(ram_size))
+{
+}
+
+void RewindBuffer::setBudget(size_t bytes)
+{
+    _budget = bytes;
+    trim();
+}
+
+void RewindBuffer::push(const MachineSnapshot &snapshot)
+{
+    while (!_entries.empty() && (_entries.back().cycle >= snapshot.cycle))
+        dropNewest();
+
+    Entry          entry{ snapshot.cycle, snapshot.cpu, !_have_keyframe || (_since_keyframe + 1 >= _keyframe_interval), {} };
+    const uint8_t *ram = snapshot.ram.data();
+    size_t         length;
+
+    if (entry.keyframe)
+    {
+        std::memcpy(_keyframe.data(), ram, ram_size);
+        _have_keyframe = true;
+        _keyframe_cycle = snapshot.cycle;
+        _since_keyframe = 0;
+        length = LzCodec::compress(ram, ram_size, _compressed.data());
+    }
+    else
+    {
+        Xor(_work.data(), ram, _keyframe.data(), ram_size);
+        ++_since_keyframe;
+        length = LzCodec::compress(_work.data(), ram_size, _compressed.data());
+    }
+    entry.ram.assign(_compressed.begin(), _compressed.begin() + static_cast<std::ptrdiff_t>(length));
+    _bytes += bytesOf(entry);
+    _entries.push_back(std::move(entry));
+    trim();
+}
+
+bool RewindBuffer::restore(uint64_t cycle, MachineSnapshot &snapshot)
+{
+    const auto after = std::upper_bound(_entries.begin(), _entries.end(), cycle,
+                                        [](uint64_t wanted, const Entry &entry) { return wanted < entry.cycle; });
+
+    if (after == _entries.begin())
+        return false;
+
+    const Entry &entry = *(after - 1);
+    auto         keyframe = after - 1;
+    uint8_t     *ram = snapshot.ram.data();
+
+    // Groups are only ever dropped whole, so the oldest entry is a keyframe
+    while (!keyframe->keyframe)
+        --keyframe;
+    if (_have_keyframe && (keyframe->cycle == _keyframe_cycle))
+        std::memcpy(ram, _keyframe.data(), ram_size);
+    else if (!LzCodec::decompress(keyframe->ram.data(), keyframe->ram.size(), ram, ram_size))
+        return false;
+    if (!entry.keyframe)
+    {
+        if (!LzCodec::decompress(entry.ram.data(), entry.ram.size(), _work.data(), ram_size))
+            return false;
+        Xor(ram, ram, _work.data(), ram_size);
+    }
+    snapshot.version = MachineSnapshot::current_version;
+    snapshot.cycle = entry.cycle;
+    snapshot.cpu = entry.cpu;
+    return true;
+}
+
+void RewindBuffer::discardAfter(uint64_t cycle)
+{
+    while (!_entries.empty() && (_entries.back().cycle > cycle))
+        dropNewest();
+}
+
+void RewindBuffer::clear()
+{
+    _entries.clear();
+    _bytes = 0;
+    _since_keyframe = 0;
+    _have_keyframe = false;
+}
+
+std::optional<uint64_t> RewindBuffer::oldestCycle() const
+{
+    if (_entries.empty())
+        return std::nullopt;
+    return _entries.front().cycle;
+}
+
+std::optional<uint64_t> RewindBuffer::newestCycle() const
+{
+    if (_entries.empty())
+        return std::nullopt;
+    return _entries.back().cycle;
+}
+
+void RewindBuffer::dropNewest()
+{
+    const Entry &newest = _entries.back();
+
+    // Without its keyframe, the next snapshot has to be one
+    _bytes -= bytesOf(newest);
+    if (newest.keyframe)
+        _have_keyframe = false;
+    else if (_since_keyframe > 0)
+        --_since_keyframe;
+    _entries.pop_back();
+}
+
+void RewindBuffer::trim()
+{
+    while (_bytes > _budget)
+    {
+        if (_entries.empty())
+            return;
+
+        // A keyframe can only go along with the deltas on it
+        const auto next = std::find_if(_entries.begin() + 1, _entries.end(), [](const Entry &entry) { return entry.keyframe; });
+
+        if (next == _entries.end())
+        {
+            // Start a new group, so this one can go next time
+            _since_keyframe = _keyframe_interval;
+            return;
+        }
+        for (auto entry = _entries.begin(); entry != next; ++entry)
+            _bytes -= bytesOf(*entry);
+        _entries.erase(_entries.begin(), next);
+    }
+}
@@ -0,0 +1,124 @@
+#ifndef REWINDBUFFER_HPP
+#define REWINDBUFFER_HPP
+
+#include "machinesnapshot.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <vector>
+
+
+/** The recent history of a machine, as compressed snapshots taken at a fixed
+ *  interval, to rewind through.
+ *
+ *  Every so often a snapshot is kept whole, as a keyframe; the ones between
+ *  keep their RAM XORed with the keyframe before them, which leaves mostly
+ *  zeroes.  Both are compressed with LzCodec.  Restoring one takes at most
+ *  two decompressions and an XOR over 64K, however far back it is.
+ *
+ *  The buffer holds as much history as fits in its budget, dropping the
+ *  oldest keyframe and everything that depends on it to make room.  The
+ *  newest keyframe and the snapshots after it are always kept.
+ */
+class RewindBuffer
+{
+public:
+    static constexpr size_t   default_budget = 16 * 1024 * 1024;
+    static constexpr uint64_t default_interval = 1000;
+    static constexpr unsigned default_keyframe_interval = 30;
+
+    RewindBuffer();
+    RewindBuffer(const RewindBuffer &) = delete;
+
+    /** How many bytes of snapshots to keep, at most.
+     *
+     *  Lowering it drops history straight away.
+     */
+    ///@{
+    size_t budget() const { return _budget; }
+    void   setBudget(size_t bytes);
+    ///@}
+
+    /** How many clock ticks apart snapshots are taken.
+     *
+     */
+    ///@{
+    uint64_t interval() const { return _interval; }
+    void     setInterval(uint64_t cycles) { _interval = (cycles > 0) ? cycles : 1; }
+    ///@}
+
+    /** How many snapshots make up a keyframe and the deltas after it.
+     *
+     *  Longer groups compress better, but can only be dropped all at once.
+     */
+    ///@{
+    unsigned keyframeInterval() const { return _keyframe_interval; }
+    void     setKeyframeInterval(unsigned snapshots) { _keyframe_interval = (snapshots > 0) ? snapshots : 1; }
+    ///@}
+
+    /** @return Whether a snapshot should be pushed at @p cycle, an interval
+     *          or more after the last one
+     */
+    bool due(uint64_t cycle) const { return _entries.empty() || (cycle >= _entries.back().cycle + _interval); }
+
+    /** Adds @p snapshot as the newest.
+     *
+     *  Anything taken at or after its cycle is dropped first: that history
+     *  was rewound away.
+     */
+    void push(const MachineSnapshot &snapshot);
+
+    /** Puts the newest snapshot taken at or before @p cycle into @p snapshot.
+     *
+     *  @return false if they're all newer
+     */
+    bool restore(uint64_t cycle, MachineSnapshot &snapshot);
+
+    /** Drops every snapshot taken after @p cycle.
+     *
+     */
+    void discardAfter(uint64_t cycle);
+
+    void clear();
+
+    size_t count() const { return _entries.size(); }
+    size_t bytes() const { return _bytes; } ///< What the snapshots take up, compressed
+
+    /** When the oldest and newest snapshots were taken; empty when there are
+     *  none.
+     */
+    ///@{
+    std::optional<uint64_t> oldestCycle() const;
+    std::optional<uint64_t> newestCycle() const;
+    ///@}
+
+    RewindBuffer &operator =(const RewindBuffer &) = delete;
+private:
+    struct Entry
+    {
+        uint64_t                      cycle;
+        InstructionExecutor::Snapshot cpu;
+        bool                          keyframe;
+        std::vector<uint8_t>          ram; // Compressed, and XORed with the keyframe unless it is one
+    };
+
+    std::deque<Entry>    _entries;
+    size_t               _budget = default_budget;
+    uint64_t             _interval = default_interval;
+    unsigned             _keyframe_interval = default_keyframe_interval;
+    size_t               _bytes = 0;
+    unsigned             _since_keyframe = 0;
+    bool                 _have_keyframe = false; // Whether _keyframe holds the newest keyframe's RAM
+    uint64_t             _keyframe_cycle = 0;
+    std::vector<uint8_t> _keyframe;
+    std::vector<uint8_t> _work;
+    std::vector<uint8_t> _compressed;
+
+    static size_t bytesOf(const Entry &entry) { return sizeof(Entry) + entry.ram.capacity(); }
+
+    void dropNewest();
+    void trim();
+};
+
+#endif // REWINDBUFFER_HPP
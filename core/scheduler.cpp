@@ -0,0 +1,46 @@
+#include "scheduler.hpp"
+#include <algorithm>
+#include <utility>
+
+
+Scheduler::Scheduler(InstructionExecutor &cpu)
+    :
+    _cpu(cpu)
+{
+}
+
+void Scheduler::schedule(uint32_t delay, eventType event)
+{
+    _events.push({ _now + delay, _sequence++, std::move(event) });
+}
+
+void Scheduler::clear()
+{
+    _events = decltype(_events)();
+}
+
+uint32_t Scheduler::run(uint32_t cycles)
+{
+    const uint64_t start = _now;
+    const uint64_t end = _now + cycles;
+
+    _stopping = false;
+    while ((_now < end) && !_stopping)
+    {
+        // Run up to the next event, or the end, whichever comes first
+        uint64_t until = (_events.empty()) ? end : std::min(end, _events.top().due);
+
+        if (until > _now)
+            _now += _cpu.run(static_cast<uint32_t>(until - _now));
+
+        while (!_events.empty() && (_events.top().due <= _now) && !_stopping)
+        {
+            // Popped first, as the event may well schedule another
+            eventType event = _events.top().event;
+
+            _events.pop();
+            event();
+        }
+    }
+    return static_cast<uint32_t>(_now - start);
+}
@@ -0,0 +1,80 @@
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include "instructionexecutor.hpp"
+#include <functional>
+#include <queue>
+#include <vector>
+
+
+/** Runs a CPU, firing events at given clock ticks along the way.
+ *
+ *  Events are how anything outside the CPU gets to act in time with it:
+ *  raising an interrupt, ticking a timer, stopping the run.  The CPU runs
+ *  whole instructions in between, so an event fires at the end of the
+ *  instruction during which it fell due.  Events due at the same tick fire
+ *  in the order they were scheduled.
+ */
+class Scheduler
+{
+public:
+    using eventType = std::function<void ()>;
+
+    explicit Scheduler(InstructionExecutor &cpu);
+    Scheduler(const Scheduler &) = delete;
+
+    /** Fires @p event once @p delay clock ticks from now have been run.
+     *
+     *  Events may schedule further events, including themselves.
+     */
+    void schedule(uint32_t delay, eventType event);
+
+    void   clear();                                  ///< Forgets every pending event
+    size_t pending() const { return _events.size(); }
+
+    /** Runs the CPU for at least @p cycles clock ticks, firing the events
+     *  that fall due.
+     *
+     *  @return The number of clock ticks actually run
+     */
+    uint32_t run(uint32_t cycles);
+
+    /** Ends the current run() after the instruction or event in progress.
+     *
+     *  Meant to be called from an event, or a bus device.
+     */
+    void stop() { _stopping = true; _cpu.stop(); }
+
+    uint64_t now() const { return _now; } ///< Clock ticks run so far
+
+    /** Moves the clock to @p now, for going back to a snapshot.
+     *
+     *  Pending events keep the tick they are due at.
+     */
+    void setNow(uint64_t now) { _now = now; }
+
+    Scheduler &operator =(const Scheduler &) = delete;
+private:
+    struct Event
+    {
+        uint64_t  due;
+        uint64_t  sequence; // Keeps events due at the same tick in order
+        eventType event;
+    };
+
+    struct Later
+    {
+        bool operator ()(const Event &left, const Event &right) const
+        {
+            return (left.due != right.due) ? (left.due > right.due) : (left.sequence > right.sequence);
+        }
+    };
+
+    InstructionExecutor &_cpu;
+    std::priority_queue<Event, std::vector<Event>, Later> _events;
+    uint64_t             _now = 0;
+    uint64_t             _sequence = 0;
+    bool                 _stopping = false;
+};
+
+#endif // SCHEDULER_HPP
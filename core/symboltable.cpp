@@ -0,0 +1,149 @@
+#include "symboltable.hpp"
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+
+namespace
+{
+std::string Trim(const std::string &text)
+{
+    size_t start = 0;
+    size_t end = text.size();
+
+    while ((start < end) && std::isspace(static_cast<unsigned char>(text[start])))
+        ++start;
+    while ((end > start) && std::isspace(static_cast<unsigned char>(text[end - 1])))
+        --end;
+    return text.substr(start, end - start);
+}
+
+// A number in base, or in hex if written as $C000.  Base 0 reads decimal,
+// and hex written as 0xC000.
+bool ParseAddress(std::string text, int base, SymbolTable::addressType &address)
+{
+    if (!text.empty() && (text[0] == '$'))
+    {
+        text = text.substr(1);
+        base = 16;
+    }
+
+    try
+    {
+        size_t                   used = 0;
+        const unsigned long long value = std::stoull(text, &used, base);
+
+        if ((used != text.size()) || (value > 0xFFFF))
+            return false;
+        address = static_cast<SymbolTable::addressType>(value);
+        return true;
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+}
+
+// al C:C000 .reset
+bool DecodeLabel(std::istringstream &words, SymbolTable::addressType &address, std::string &name)
+{
+    std::string value;
+
+    if (!(words >> value >> name))
+        return false;
+
+    const size_t memory_space = value.find(':');
+
+    if (memory_space != std::string::npos)
+        value = value.substr(memory_space + 1);
+    if (!name.empty() && (name[0] == '.'))
+        name = name.substr(1);
+    return !name.empty() && ParseAddress(value, 16, address);
+}
+
+// reset = $C000, or reset := $C000
+bool DecodeAssignment(const std::string &line, size_t equals, SymbolTable::addressType &address, std::string &name)
+{
+    name = line.substr(0, equals);
+    if (!name.empty() && (name.back() == ':'))
+        name.pop_back();
+    name = Trim(name);
+    return !name.empty() && (name.find_first_of(" \t") == std::string::npos) &&
+           ParseAddress(Trim(line.substr(equals + 1)), 0, address);
+}
+}
+
+
+bool SymbolTable::load(const std::string &path, std::string &error)
+{
+    std::ifstream file(path);
+
+    if (!file)
+    {
+        error = "Couldn't read symbols from " + path;
+        return false;
+    }
+
+    std::ostringstream text;
+
+    text << file.rdbuf();
+    if (!decode(text.str(), error))
+    {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+bool SymbolTable::decode(const std::string &text, std::string &error)
+{
+    std::istringstream lines(text);
+    std::string        line;
+    size_t             number = 0;
+
+    while (std::getline(lines, line))
+    {
+        ++number;
+
+        const size_t comment = line.find_first_of(";#");
+
+        if (comment != std::string::npos)
+            line.erase(comment);
+        line = Trim(line);
+        if (line.empty())
+            continue;
+
+        std::istringstream words(line);
+        std::string        first;
+        addressType        address = 0;
+        std::string        name;
+        bool               decoded = false;
+
+        words >> first;
+        if (first == "al")
+            decoded = DecodeLabel(words, address, name);
+        else if (line.find('=') != std::string::npos)
+            decoded = DecodeAssignment(line, line.find('='), address, name);
+
+        if (!decoded)
+        {
+            error = "Line " + std::to_string(number) + ": not a symbol";
+            return false;
+        }
+        add(address, name);
+    }
+    return true;
+}
+
+std::string SymbolTable::nameOf(addressType address) const
+{
+    if (const std::string *name = find(address))
+        return *name;
+
+    std::ostringstream text;
+
+    text << '$' << std::hex << std::uppercase << std::setfill('0') << std::setw(4) << address;
+    return text.str();
+}
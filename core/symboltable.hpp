@@ -0,0 +1,66 @@
+#ifndef SYMBOLTABLE_HPP
+#define SYMBOLTABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+
+/** Names for addresses, read from an assembler's symbol file.
+ *
+ *  Understands the two kinds of line most 6502 assemblers can write out:
+ *  VICE label files, as ld65 -Ln, ACME and 64tass make them
+ *
+ *      al C:C000 .reset
+ *
+ *  and plain assignments, as in a ca65 or DASM listing of equates
+ *
+ *      reset = $C000
+ *
+ *  Blank lines and comments starting with ';' or '#' are skipped.  An
+ *  address with more than one name keeps the first.
+ */
+class SymbolTable
+{
+public:
+    using addressType = uint16_t;
+
+    /** Adds the symbols in the file at @p path.
+     *
+     *  @return false, with the reason in @p error, if the file can't be read
+     *          or has a line that isn't a symbol
+     */
+    bool load(const std::string &path, std::string &error);
+
+    /** Like load(), but the file is already in memory.
+     *
+     */
+    bool decode(const std::string &text, std::string &error);
+
+    void add(addressType address, const std::string &name) { _names.emplace(address, name); }
+    void clear() { _names.clear(); }
+
+    size_t size() const { return _names.size(); }
+    bool   empty() const { return _names.empty(); }
+
+    /** @return The name of @p address, or nullptr if it hasn't got one
+     *
+     */
+    const std::string *find(addressType address) const
+    {
+        const auto found = _names.find(address);
+
+        return (found != _names.end()) ? &found->second : nullptr;
+    }
+
+    /** @return The name of @p address, or the address itself as $C000
+     *
+     */
+    std::string nameOf(addressType address) const;
+
+private:
+    std::unordered_map<addressType, std::string> _names;
+};
+
+#endif // SYMBOLTABLE_HPP
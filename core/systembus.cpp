@@ -0,0 +1,72 @@
+#include "systembus.hpp"
+#include <algorithm>
+#include <cstring>
+
+
+void SystemBus::attach(BusDevice &device)
+{
+    detach(device);
+    _devices.push_back(&device);
+}
+
+void SystemBus::detach(BusDevice &device)
+{
+    _devices.erase(std::remove(_devices.begin(), _devices.end(), &device), _devices.end());
+}
+
+void SystemBus::write(addressType address, uint8_t data)
+{
+    for (BusDevice *device : _devices)
+        device->write(address, data);
+}
+
+uint8_t SystemBus::read(addressType address, bool read_only)
+{
+    for (auto device = _devices.rbegin(); device != _devices.rend(); ++device)
+        if ((*device)->readable() && (*device)->handlesAddress(address))
+            return (*device)->read(address, read_only);
+    return 0x00;
+}
+
+void SystemBus::writeBlock(addressType address, const uint8_t *data, size_t length)
+{
+    for (BusDevice *device : _devices)
+        device->writeBlock(address, data, length);
+}
+
+void SystemBus::readBlock(addressType address, uint8_t *data, size_t length, bool read_only)
+{
+    uint32_t start = address;
+
+    while (length > 0)
+    {
+        // Whoever answers for the first byte answers until their range ends,
+        // or a device attached after them takes over
+        auto     answering = _devices.rend();
+        uint32_t end = 0xFFFF;
+
+        for (auto device = _devices.rbegin(); device != _devices.rend(); ++device)
+        {
+            if (!(*device)->readable())
+                continue;
+            if ((*device)->handlesAddress(static_cast<addressType>(start)))
+            {
+                answering = device;
+                end = std::min<uint32_t>(end, (*device)->upperAddress());
+                break;
+            }
+            if ((*device)->lowerAddress() > start)
+                end = std::min<uint32_t>(end, (*device)->lowerAddress() - 1u);
+        }
+
+        const size_t count = std::min<size_t>(length, end - start + 1);
+
+        if (answering != _devices.rend())
+            (*answering)->readBlock(static_cast<addressType>(start), data, count, read_only);
+        else
+            std::memset(data, 0x00, count);
+        data += count;
+        length -= count;
+        start = (start + count) & 0xFFFF;
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef SYSTEMBUS_HPP
+#define SYSTEMBUS_HPP
+
+#include "busdevice.hpp"
+#include <vector>
+
+
+/** Connects the CPU to the devices attached to it.
+ *
+ *  A write goes to every device that handles the address.  A read is
+ *  answered by the most recently attached readable device that handles it,
+ *  or gives 0x00 if there is none.
+ */
+class SystemBus
+{
+public:
+    using addressType = BusDevice::addressType;
+
+    SystemBus() = default;
+    SystemBus(const SystemBus &) = delete;
+
+    /** Attaches @p device, which must stay alive until it is detached.
+     *
+     */
+    void attach(BusDevice &device);
+    void detach(BusDevice &device);
+
+    const std::vector<BusDevice *> &devices() const { return _devices; }
+
+    void    write(addressType address, uint8_t data);
+    uint8_t read(addressType address, bool read_only = false);
+
+    /** Accesses @p length bytes at once, starting at @p address.
+     *
+     *  The result is the same as accessing the bytes one at a time, but the
+     *  block is split where the device answering changes and each device
+     *  gets its part in one go.  The block wraps around the end of the
+     *  address space.
+     */
+    ///@{
+    void writeBlock(addressType address, const uint8_t *data, size_t length);
+    void readBlock(addressType address, uint8_t *data, size_t length, bool read_only = false);
+    ///@}
+
+    SystemBus &operator =(const SystemBus &) = delete;
+private:
+    std::vector<BusDevice *> _devices; // In the order they were attached
+};
+
+#endif // SYSTEMBUS_HPP
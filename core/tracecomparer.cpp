@@ -0,0 +1,296 @@
+#include "tracecomparer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+
+namespace
+{
+// The status bits that a text log is compared on, see TraceComparer
+constexpr uint8_t text_status_mask = 0xCF;
+
+bool ParseHex(const std::string &text, size_t at, size_t digits, unsigned &value)
+{
+    if (at + digits > text.size())
+        return false;
+
+    value = 0;
+    for (size_t i = at; i < at + digits; ++i)
+    {
+        const char c = text[i];
+
+        if ((c >= '0') && (c <= '9'))
+            value = (value << 4) | unsigned(c - '0');
+        else if ((c >= 'A') && (c <= 'F'))
+            value = (value << 4) | unsigned(c - 'A' + 10);
+        else if ((c >= 'a') && (c <= 'f'))
+            value = (value << 4) | unsigned(c - 'a' + 10);
+        else
+            return false;
+    }
+    return true;
+}
+
+// The hex value written after label, such as " A:", in a line of a text log
+bool ParseLabelledHex(const std::string &line, const char *label, size_t digits, unsigned &value)
+{
+    const size_t at = line.find(label);
+
+    return (at != std::string::npos) && ParseHex(line, at + std::strlen(label), digits, value);
+}
+
+bool LooksLikeBinaryTrace(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    char          magic[sizeof(TraceFileHeader::magic_value)] = {};
+
+    // Either magic value, told apart by TraceReader
+    file.read(magic, sizeof(magic));
+    return file && (std::memcmp(magic, TraceFileHeader::magic_value, sizeof(magic) - 1) == 0);
+}
+}
+
+
+bool ReferenceTrace::open(const std::string &path, std::string &error)
+{
+    close();
+    _path = path;
+    if (LooksLikeBinaryTrace(path))
+    {
+        _fields = all_fields;
+        _operand_count = 2;
+        return _binary.open(path, error);
+    }
+
+    _text.open(path);
+    if (!_text)
+    {
+        error = "Cannot open " + path;
+        return false;
+    }
+
+    // Making sure of the first line now saves finding out part way through a run
+    TraceRecord first;
+
+    if (!next(first))
+    {
+        error = _error.empty() ? (path + " is empty") : _error;
+        close();
+        return false;
+    }
+    _text.clear();
+    _text.seekg(0);
+    _line = 0;
+    return true;
+}
+
+void ReferenceTrace::close()
+{
+    _binary.close();
+    if (_text.is_open())
+        _text.close();
+    _text.clear();
+    _error.clear();
+    _line = 0;
+    _fields = 0;
+    _operand_count = 0;
+}
+
+bool ReferenceTrace::next(TraceRecord &record)
+{
+    if (!_text.is_open())
+    {
+        if (_binary.next(record))
+            return true;
+        _error = _binary.error();
+        return false;
+    }
+
+    while (std::getline(_text, _buffer))
+    {
+        ++_line;
+        if (!_buffer.empty() && (_buffer.back() == '\r'))
+            _buffer.pop_back();
+        if (_buffer.find_first_not_of(" \t") == std::string::npos)
+            continue;
+        if (parseLine(record))
+            return true;
+        _error = "Line " + std::to_string(_line) + " of " + _path + " is not a nestest style log line";
+        return false;
+    }
+    return false;
+}
+
+bool ReferenceTrace::parseLine(TraceRecord &record)
+{
+    unsigned value = 0;
+    unsigned a = 0, x = 0, y = 0, status = 0, stack_pointer = 0;
+
+    record = TraceRecord{};
+    if (!ParseHex(_buffer, 0, 4, value) || (_buffer.size() < 5) || (_buffer[4] != ' '))
+        return false;
+    record.program_counter = static_cast<uint16_t>(value);
+
+    // The instruction bytes, up to the mnemonic
+    size_t  at = 4;
+    uint8_t bytes[3] = {};
+    uint8_t count = 0;
+
+    while (count < 3)
+    {
+        at = _buffer.find_first_not_of(' ', at);
+        if ((at == std::string::npos) || !ParseHex(_buffer, at, 2, value) ||
+            ((at + 2 < _buffer.size()) && (_buffer[at + 2] != ' ')))
+            break;
+        bytes[count++] = static_cast<uint8_t>(value);
+        at += 2;
+    }
+    if (count == 0)
+        return false;
+    record.opcode = bytes[0];
+    record.operands[0] = bytes[1];
+    record.operands[1] = bytes[2];
+    record.length = count;
+    _operand_count = count - 1;
+
+    if (!ParseLabelledHex(_buffer, " A:", 2, a) || !ParseLabelledHex(_buffer, " X:", 2, x) ||
+        !ParseLabelledHex(_buffer, " Y:", 2, y) || !ParseLabelledHex(_buffer, " P:", 2, status) ||
+        !ParseLabelledHex(_buffer, " SP:", 2, stack_pointer))
+        return false;
+    record.a = static_cast<uint8_t>(a);
+    record.x = static_cast<uint8_t>(x);
+    record.y = static_cast<uint8_t>(y);
+    record.status = static_cast<uint8_t>(status);
+    record.stack_pointer = static_cast<uint8_t>(stack_pointer);
+    _fields = program_counter_field | instruction_field | a_field | x_field | y_field | stack_pointer_field | status_field;
+
+    const size_t cycles = _buffer.find(" CYC:");
+
+    if (cycles != std::string::npos)
+    {
+        try
+        {
+            record.cycle = std::stoull(_buffer.substr(cycles + 5));
+            _fields |= cycle_field;
+        }
+        catch (const std::exception &)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+bool TraceComparer::open(const std::string &path, std::string &error)
+{
+    _result = Result::Matching;
+    _done.store(false, std::memory_order_relaxed);
+    _compared = 0;
+    _divergence = Divergence{};
+    return _reference.open(path, error);
+}
+
+void TraceComparer::compare(const TraceRecord *records, size_t count)
+{
+    // Once done, the rest of the run is only passed over
+    for (const TraceRecord *actual = records; !done() && (actual != records + count); ++actual)
+    {
+        TraceRecord expected;
+
+        if (!_reference.next(expected))
+        {
+            _result = _reference.error().empty() ? Result::ReferenceEnded : Result::ReferenceDamaged;
+            _done.store(true, std::memory_order_release);
+            break;
+        }
+        if (_compared == 0)
+        {
+            _reference_first_cycle = expected.cycle;
+            _first_cycle = actual->cycle;
+        }
+        expected.cycle = expected.cycle - _reference_first_cycle + _first_cycle;
+
+        const uint16_t fields = differences(expected, *actual);
+
+        if (fields != 0)
+        {
+            diverge(expected, *actual, fields);
+            break;
+        }
+        _context[_compared % context_records] = *actual;
+        ++_compared;
+    }
+}
+
+const char *TraceComparer::fieldName(uint16_t field)
+{
+    switch (field)
+    {
+    case ReferenceTrace::cycle_field:
+        return "cycle";
+    case ReferenceTrace::program_counter_field:
+        return "PC";
+    case ReferenceTrace::instruction_field:
+        return "instruction";
+    case ReferenceTrace::a_field:
+        return "A";
+    case ReferenceTrace::x_field:
+        return "X";
+    case ReferenceTrace::y_field:
+        return "Y";
+    case ReferenceTrace::stack_pointer_field:
+        return "SP";
+    case ReferenceTrace::status_field:
+        return "P";
+    case ReferenceTrace::effective_address_field:
+        return "effective address";
+    default:
+        return "?";
+    }
+}
+
+uint16_t TraceComparer::differences(const TraceRecord &expected, const TraceRecord &actual) const
+{
+    const bool    text = _reference.isText();
+    const uint8_t status_mask = text ? text_status_mask : 0xFF;
+    uint16_t      fields = 0;
+
+    if (expected.cycle != actual.cycle)
+        fields |= ReferenceTrace::cycle_field;
+    if (expected.program_counter != actual.program_counter)
+        fields |= ReferenceTrace::program_counter_field;
+    if ((expected.opcode != actual.opcode) ||
+        (text ? (std::memcmp(expected.operands, actual.operands, std::min<size_t>(_reference.operandCount(), actual.length - 1)) != 0)
+              : ((expected.length != actual.length) || (std::memcmp(expected.operands, actual.operands, sizeof(expected.operands)) != 0))))
+        fields |= ReferenceTrace::instruction_field;
+    if (expected.a != actual.a)
+        fields |= ReferenceTrace::a_field;
+    if (expected.x != actual.x)
+        fields |= ReferenceTrace::x_field;
+    if (expected.y != actual.y)
+        fields |= ReferenceTrace::y_field;
+    if (expected.stack_pointer != actual.stack_pointer)
+        fields |= ReferenceTrace::stack_pointer_field;
+    if ((expected.status & status_mask) != (actual.status & status_mask))
+        fields |= ReferenceTrace::status_field;
+    if (expected.effective_address != actual.effective_address)
+        fields |= ReferenceTrace::effective_address_field;
+    return fields & _reference.fields();
+}
+
+void TraceComparer::diverge(const TraceRecord &expected, const TraceRecord &actual, uint16_t fields)
+{
+    const uint64_t context = std::min<uint64_t>(_compared, context_records);
+
+    _divergence.index = _compared;
+    _divergence.line = _reference.line();
+    _divergence.fields = fields;
+    _divergence.expected = expected;
+    _divergence.actual = actual;
+    _divergence.before.clear();
+    for (uint64_t i = _compared - context; i < _compared; ++i)
+        _divergence.before.push_back(_context[i % context_records]);
+    _result = Result::Diverged;
+    _done.store(true, std::memory_order_release);
+}
@@ -0,0 +1,159 @@
+#ifndef TRACECOMPARER_HPP
+#define TRACECOMPARER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "tracereader.hpp"
+#include "tracerecord.hpp"
+
+
+/** A trace that a run is checked against, read a record at a time.
+ *
+ *  Either a trace file written by TraceRecorder, in either format, or a
+ *  nestest style text log, with a line per instruction such as:
+ *
+ *      C000  4C F5 C5  JMP $C5F5                       A:00 X:00 Y:00 P:24 SP:FD PPU:  0, 21 CYC:7
+ *
+ *  Of which the PC, the instruction bytes, the registers and CYC, if there,
+ *  are used.  Nothing is read ahead of the record asked for, so references
+ *  of any size can be used.
+ */
+class ReferenceTrace
+{
+public:
+    /** Which fields of a record there are to compare
+     *
+     */
+    ///@{
+    static constexpr uint16_t cycle_field = 0x0001;
+    static constexpr uint16_t program_counter_field = 0x0002;
+    static constexpr uint16_t instruction_field = 0x0004; ///< The opcode and operands
+    static constexpr uint16_t a_field = 0x0008;
+    static constexpr uint16_t x_field = 0x0010;
+    static constexpr uint16_t y_field = 0x0020;
+    static constexpr uint16_t stack_pointer_field = 0x0040;
+    static constexpr uint16_t status_field = 0x0080;
+    static constexpr uint16_t effective_address_field = 0x0100;
+    static constexpr uint16_t all_fields = 0x01FF;
+    ///@}
+
+    /** @return false, with the reason in @p error, if @p path can't be read
+     *          or is neither a trace file nor a text log
+     */
+    bool open(const std::string &path, std::string &error);
+    void close();
+
+    /** Reads the next record into @p record.
+     *
+     *  Only the fields() of it are filled in.  From a text log, the length
+     *  is the number of instruction bytes listed, and the operands past
+     *  those are 0.
+     *
+     *  @return false at the end of the trace, or if the next line of a text
+     *          log can't be made sense of or the next block of a compact
+     *          trace is damaged, which error() then says
+     */
+    bool next(TraceRecord &record);
+
+    uint16_t fields() const { return _fields; }
+
+    /** The operand bytes of the last record, as a text log can list fewer
+     *  than the instruction has.
+     *
+     */
+    uint8_t operandCount() const { return _operand_count; }
+
+    bool        isText() const { return _text.is_open(); }
+    uint64_t    line() const { return _line; } ///< Of the last record, in a text log
+    std::string error() const { return _error; }
+
+private:
+    TraceReader   _binary;
+    std::ifstream _text;
+    std::string   _path;
+    std::string   _buffer; // The line being parsed
+    std::string   _error;
+    uint64_t      _line = 0;
+    uint16_t      _fields = 0;
+    uint8_t       _operand_count = 0;
+
+    bool parseLine(TraceRecord &record);
+};
+
+
+/** Checks the trace of a run against a ReferenceTrace, as it runs.
+ *
+ *  compare() is handed the records of the run in order, as a consumer of a
+ *  TraceRecorder, so it runs on the recorder's writer thread and the
+ *  emulation never waits for it.  It stops comparing at the first record
+ *  that differs, or when the reference runs out, and whoever runs the
+ *  emulation polls done() to stop it too.  Once the recorder has been
+ *  stopped, everything else here can be read.
+ *
+ *  Cycles are compared counting from the first instruction of each trace,
+ *  so a reference that counts from a different point still lines up.  The
+ *  B and unused bits of P, which don't really exist, are not compared with
+ *  a text log, as logs differ in how they show them.
+ */
+class TraceComparer
+{
+public:
+    static constexpr size_t context_records = 8; ///< Kept from before a divergence
+
+    enum class Result : uint8_t
+    {
+        Matching,        ///< Everything so far, and the reference has more
+        Diverged,        ///< See divergence()
+        ReferenceEnded,  ///< After every record of the reference matched
+        ReferenceDamaged ///< See error()
+    };
+
+    struct Divergence
+    {
+        uint64_t                 index = 0;   ///< Of the first record that differs, counting from 0
+        uint64_t                 line = 0;    ///< Of the reference, if it is a text log
+        uint16_t                 fields = 0;  ///< That differ
+        TraceRecord              expected{};  ///< With the cycle counted from where the run's started
+        TraceRecord              actual{};
+        std::vector<TraceRecord> before;      ///< The records that matched just before, oldest first
+    };
+
+    /** Opens the reference trace at @p path.
+     *
+     *  @return false, with the reason in @p error, if it can't be read
+     */
+    bool open(const std::string &path, std::string &error);
+
+    void compare(const TraceRecord *records, size_t count);
+
+    bool     done() const { return _done.load(std::memory_order_acquire); }
+    Result   result() const { return _result; }
+    uint64_t compared() const { return _compared; } ///< Records that matched
+
+    const Divergence &divergence() const { return _divergence; }
+    std::string       error() const { return _reference.error(); }
+
+    /** The name of a ReferenceTrace field, such as "PC" or "A".
+     *
+     */
+    static const char *fieldName(uint16_t field);
+
+private:
+    ReferenceTrace                           _reference;
+    Result                                   _result = Result::Matching;
+    std::atomic<bool>                        _done{ false };
+    uint64_t                                 _compared = 0;
+    uint64_t                                 _reference_first_cycle = 0;
+    uint64_t                                 _first_cycle = 0;
+    std::array<TraceRecord, context_records> _context{}; // A ring of the last ones that matched
+    Divergence                               _divergence;
+
+    uint16_t differences(const TraceRecord &expected, const TraceRecord &actual) const;
+    void     diverge(const TraceRecord &expected, const TraceRecord &actual, uint16_t fields);
+};
+
+#endif // TRACECOMPARER_HPP
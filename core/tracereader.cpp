@@ -0,0 +1,84 @@
+#include "tracereader.hpp"
+#include <cerrno>
+#include <cstring>
+
+
+namespace
+{
+constexpr size_t chunk_records = 4096;
+}
+
+
+bool TraceReader::open(const std::string &path, std::string &error)
+{
+    close();
+    _path = path;
+    _file = std::fopen(path.c_str(), "rb");
+    if (!_file)
+    {
+        error = "Cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    TraceFileHeader header;
+
+    if (std::fread(&header, sizeof(header), 1, _file) != 1)
+        error = path + " is not a trace file";
+    else if (std::memcmp(header.magic, TraceFileHeader::compact_magic_value, sizeof(header.magic)) == 0)
+    {
+        close();
+        return _compact.open(path, error);
+    }
+    else if (std::memcmp(header.magic, TraceFileHeader::magic_value, sizeof(header.magic)) != 0)
+        error = path + " is not a trace file";
+    else if ((header.version != TraceFileHeader::current_version) || (header.record_size != sizeof(TraceRecord)))
+        error = path + " is a trace from another version of the emulator";
+    else
+        return true;
+
+    close();
+    return false;
+}
+
+void TraceReader::close()
+{
+    if (_file)
+        std::fclose(_file);
+    _file = nullptr;
+    _compact.close();
+    _next_block = 0;
+    _chunk.clear();
+    _position = 0;
+    _error.clear();
+}
+
+bool TraceReader::next(TraceRecord &record)
+{
+    if (_position == _chunk.size())
+    {
+        if (_compact.isOpen())
+        {
+            if (_next_block == _compact.blocks())
+                return false;
+            if (!_compact.decodeBlock(_next_block, _chunk))
+            {
+                _error = "Block " + std::to_string(_next_block) + " of " + _path + " is damaged";
+                _chunk.clear();
+                return false;
+            }
+            ++_next_block;
+        }
+        else if (_file)
+        {
+            _chunk.resize(chunk_records);
+            _chunk.resize(std::fread(_chunk.data(), sizeof(TraceRecord), chunk_records, _file));
+        }
+        else
+            return false;
+        _position = 0;
+        if (_chunk.empty())
+            return false;
+    }
+    record = _chunk[_position++];
+    return true;
+}
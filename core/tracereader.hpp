@@ -0,0 +1,58 @@
+#ifndef TRACEREADER_HPP
+#define TRACEREADER_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "compacttrace.hpp"
+#include "tracerecord.hpp"
+
+
+/** Reads back a trace file written by TraceRecorder, one record at a time.
+ *
+ *  Raw and compact traces are both read, and records are read in chunks (a
+ *  block at a time from compact ones), so memory use stays the same however
+ *  long the trace is.
+ */
+class TraceReader
+{
+public:
+    TraceReader() = default;
+    TraceReader(const TraceReader &) = delete;
+    ~TraceReader() { close(); }
+
+    /** @return false, with the reason in @p error, if @p path can't be read
+     *          or isn't a trace file
+     */
+    bool open(const std::string &path, std::string &error);
+    void close();
+
+    bool isOpen() const { return (_file != nullptr) || _compact.isOpen(); }
+
+    /** Reads the next record into @p record.
+     *
+     *  @return false at the end of the trace, or at a damaged block of a
+     *          compact one, which error() then says; a partly written
+     *          record at the very end of a raw trace is ignored
+     */
+    bool next(TraceRecord &record);
+
+    /** Why the trace ended early, or empty if it didn't.
+     *
+     */
+    const std::string &error() const { return _error; }
+
+    TraceReader &operator =(const TraceReader &) = delete;
+
+private:
+    std::FILE               *_file = nullptr; // A raw trace
+    std::string              _path;
+    std::string              _error;
+    CompactTraceFile         _compact;
+    size_t                   _next_block = 0; // Of the compact trace
+    std::vector<TraceRecord> _chunk;
+    size_t                   _position = 0;
+};
+
+#endif // TRACEREADER_HPP
@@ -0,0 +1,52 @@
+#ifndef TRACERECORD_HPP
+#define TRACERECORD_HPP
+
+#include <cstdint>
+
+
+/** One executed instruction, as a trace records it.
+ *
+ *  The registers are the ones the instruction started with, the same way
+ *  nestest style logs show them.  The effective address is where the
+ *  addressing mode pointed the instruction: the branch target for relative
+ *  mode, and 0 for implied and accumulator mode, which have none.
+ *
+ *  Records are plain data of a fixed size, written to trace files exactly
+ *  as they are in memory (little endian).
+ */
+struct TraceRecord
+{
+    uint64_t cycle;             ///< The clock tick the instruction started on
+    uint16_t program_counter;
+    uint16_t effective_address;
+    uint8_t  opcode;
+    uint8_t  operands[2];       ///< Only the first length - 1 are meaningful, the rest are 0
+    uint8_t  length;            ///< Of the whole instruction, in bytes
+    uint8_t  a;
+    uint8_t  x;
+    uint8_t  y;
+    uint8_t  stack_pointer;
+    uint8_t  status;
+    uint8_t  reserved[3];       ///< Always 0
+};
+static_assert(sizeof(TraceRecord) == 24, "Trace records are written to files as they are");
+
+/** What a trace file starts with.
+ *
+ *  In a raw trace, the records follow straight after it, one after another.
+ *  A compact trace has a magic value of its own, and is made up of blocks
+ *  of encoded records, see CompactTraceWriter.
+ */
+struct TraceFileHeader
+{
+    static constexpr char     magic_value[8] = { '6', '5', '0', '2', 'T', 'R', 'C', 'E' };
+    static constexpr char     compact_magic_value[8] = { '6', '5', '0', '2', 'T', 'R', 'C', 'Z' }; ///< See CompactTraceWriter
+    static constexpr uint32_t current_version = 1;
+
+    char     magic[8];
+    uint32_t version;
+    uint32_t record_size; ///< sizeof(TraceRecord), in case it ever grows
+};
+static_assert(sizeof(TraceFileHeader) == 16, "The trace file header is written to files as it is");
+
+#endif // TRACERECORD_HPP
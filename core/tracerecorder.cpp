@@ -0,0 +1,169 @@
+#include "tracerecorder.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <utility>
+
+
+namespace
+{
+// How long the writer sleeps when it has caught up.  The ring holds tens of
+// milliseconds of full speed emulation, so this is far from filling it.
+constexpr auto idle_wait = std::chrono::microseconds(500);
+
+size_t RoundUpToPowerOfTwo(size_t value)
+{
+    size_t result = 1;
+
+    while (result < value)
+        result <<= 1;
+    return result;
+}
+}
+
+
+TraceRecorder::TraceRecorder(size_t capacity)
+    :
+    _records(RoundUpToPowerOfTwo(std::max<size_t>(capacity, 2))),
+    _mask(_records.size() - 1)
+{
+}
+
+TraceRecorder::~TraceRecorder()
+{
+    std::string error;
+
+    stop(error);
+}
+
+bool TraceRecorder::start(const std::string &path, std::string &error, Format format)
+{
+    if (recording() && !stop(error))
+        return false;
+    if ((format == Format::Compact) ? !_compact.open(path, error) : !openRaw(path, error))
+        return false;
+
+    _path = path;
+    startWriter();
+    return true;
+}
+
+bool TraceRecorder::start(consumerDelegate consumer, std::string &error)
+{
+    if (recording() && !stop(error))
+        return false;
+
+    _consumer = std::move(consumer);
+    startWriter();
+    return true;
+}
+
+void TraceRecorder::startWriter()
+{
+    _failed = false;
+    _head.store(0, std::memory_order_relaxed);
+    _tail.store(0, std::memory_order_relaxed);
+    _cached_tail = 0;
+    _stopping.store(false, std::memory_order_relaxed);
+    _writer = std::thread(&TraceRecorder::drain, this);
+}
+
+bool TraceRecorder::openRaw(const std::string &path, std::string &error)
+{
+    _file = std::fopen(path.c_str(), "wb");
+    if (!_file)
+    {
+        error = "Cannot create " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    // The ring is buffer enough, and is written out in big chunks straight
+    // from where the records are, without copying them again
+    std::setvbuf(_file, nullptr, _IONBF, 0);
+
+    TraceFileHeader header;
+
+    std::memcpy(header.magic, TraceFileHeader::magic_value, sizeof(header.magic));
+    header.version = TraceFileHeader::current_version;
+    header.record_size = sizeof(TraceRecord);
+    if (std::fwrite(&header, sizeof(header), 1, _file) != 1)
+    {
+        error = "Cannot write to " + path;
+        std::fclose(_file);
+        _file = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool TraceRecorder::stop(std::string &error)
+{
+    if (!recording())
+        return true;
+
+    _stopping.store(true, std::memory_order_release);
+    _writer.join();
+    if (_consumer)
+    {
+        _consumer = nullptr;
+        return true;
+    }
+    if (_compact.isOpen())
+        return _compact.close(error);
+
+    const bool closed = (std::fclose(_file) == 0);
+
+    _file = nullptr;
+    if (_failed || !closed)
+    {
+        error = "Cannot write the whole trace to " + _path;
+        return false;
+    }
+    return true;
+}
+
+void TraceRecorder::waitForRoom(uint64_t head)
+{
+    _cached_tail = _tail.load(std::memory_order_acquire);
+    while (head - _cached_tail == _records.size())
+    {
+        std::this_thread::yield();
+        _cached_tail = _tail.load(std::memory_order_acquire);
+    }
+}
+
+void TraceRecorder::drain()
+{
+    uint64_t tail = _tail.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        // Looking at _stopping first means that, once it is seen, _head
+        // already includes the very last record
+        const bool     stopping = _stopping.load(std::memory_order_acquire);
+        const uint64_t head = _head.load(std::memory_order_acquire);
+
+        if (head == tail)
+        {
+            if (stopping)
+                return;
+            std::this_thread::sleep_for(idle_wait);
+            continue;
+        }
+
+        // As much as is there, up to where the ring wraps round
+        const size_t first = static_cast<size_t>(tail & _mask);
+        const size_t count = static_cast<size_t>(std::min<uint64_t>(head - tail, _records.size() - first));
+
+        // After a failed write the rest is still consumed, so the producer
+        // never waits for room that won't come
+        if (_consumer)
+            _consumer(&_records[first], count);
+        else if (_compact.isOpen())
+            _compact.write(&_records[first], count);
+        else if (!_failed && (std::fwrite(&_records[first], sizeof(TraceRecord), count, _file) != count))
+            _failed = true;
+        tail += count;
+        _tail.store(tail, std::memory_order_release);
+    }
+}
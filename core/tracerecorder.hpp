@@ -0,0 +1,135 @@
+#ifndef TRACERECORDER_HPP
+#define TRACERECORDER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "compacttrace.hpp"
+#include "tracerecord.hpp"
+
+
+/** Writes a trace of every instruction executed to a file, in the background.
+ *
+ *  The executor fills in each record right where it goes in a ring buffer.
+ *  A thread of its own takes the records out of the ring and writes them
+ *  to the file, so the emulation never waits for the disk unless it
+ *  outruns it for long enough to fill the whole ring.  Nothing is ever
+ *  dropped: a full ring makes next() wait for room.
+ *
+ *  The ring has a single producer, whoever adds the records, and a single
+ *  consumer, the writer thread, so the two only share a pair of atomic
+ *  indices and never take a lock.  Encoding a compact trace is done by the
+ *  writer thread as well, and so is handing the records to a consumer, such
+ *  as a TraceComparer, when there is one instead of a file.
+ */
+class TraceRecorder
+{
+public:
+    static constexpr size_t default_capacity = 64 * 1024; ///< Records
+
+    using consumerDelegate = std::function<void (const TraceRecord *, size_t)>;
+
+    enum class Format : uint8_t
+    {
+        Raw,    ///< Every TraceRecord just as it is
+        Compact ///< Delta encoded, and indexed, see CompactTraceWriter
+    };
+
+    /** @param capacity The number of records the ring holds, rounded up to
+     *                  a power of two
+     */
+    explicit TraceRecorder(size_t capacity = default_capacity);
+    TraceRecorder(const TraceRecorder &) = delete;
+    ~TraceRecorder();
+
+    /** Creates (or truncates) the trace file at @p path and starts the
+     *  writer thread.  A recording already in progress is stopped first.
+     *
+     *  @return false, with the reason in @p error, if the file can't be written
+     */
+    bool start(const std::string &path, std::string &error, Format format = Format::Compact);
+
+    /** Starts the writer thread handing the records to @p consumer, in
+     *  order and in as big batches as there are, instead of writing a file.
+     *  A recording already in progress is stopped first.
+     *
+     *  @return false, with the reason in @p error, if that recording failed
+     */
+    bool start(consumerDelegate consumer, std::string &error);
+
+    /** Waits for everything recorded to be written, or consumed, then
+     *  closes the file.
+     *
+     *  @return false, with the reason in @p error, if any of it could not
+     *          be written
+     */
+    bool stop(std::string &error);
+
+    bool recording() const { return _writer.joinable(); }
+
+    /** The number of records since start().
+     *
+     *  Only the thread adding records sees an exact count.
+     */
+    uint64_t recorded() const { return _head.load(std::memory_order_relaxed); }
+
+    size_t capacity() const { return _records.size(); }
+
+    /** Adding a record, in two steps so it can be filled in right where it
+     *  sits in the ring: next() returns the record to fill in, and commit()
+     *  queues it to be written.  Only ever call these from one thread at a
+     *  time, and only while recording.
+     */
+    ///@{
+    TraceRecord &next()
+    {
+        const uint64_t head = _head.load(std::memory_order_relaxed);
+
+        if (head - _cached_tail == _records.size())
+            waitForRoom(head);
+        return _records[head & _mask];
+    }
+
+    void commit() { _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    void record(const TraceRecord &record)
+    {
+        next() = record;
+        commit();
+    }
+    ///@}
+
+    TraceRecorder &operator =(const TraceRecorder &) = delete;
+
+private:
+    std::vector<TraceRecord> _records;
+    uint64_t                 _mask;
+
+    // The producer and the consumer each write one of these, so they are
+    // kept on separate cache lines
+    alignas(64) std::atomic<uint64_t> _head{ 0 }; // The next record to be filled in
+    uint64_t                         _cached_tail = 0; // The producer's last look at _tail
+    alignas(64) std::atomic<uint64_t> _tail{ 0 }; // The next record to be written out
+
+    std::atomic<bool>  _stopping{ false };
+    std::FILE         *_file = nullptr; // A raw trace
+    CompactTraceWriter _compact;
+    consumerDelegate   _consumer;
+    std::string        _path;
+    bool               _failed = false; // Only touched by the writer thread until it is joined
+    std::thread        _writer;
+
+    bool openRaw(const std::string &path, std::string &error);
+    void startWriter();
+    void waitForRoom(uint64_t head);
+
+    // The writer thread
+    void drain();
+};
+
+#endif // TRACERECORDER_HPP
@@ -0,0 +1,185 @@
+#include "traceview.hpp"
+#include <algorithm>
+#include <cstring>
+
+
+bool TraceView::open(const std::string &path, std::string &error)
+{
+    TraceFileHeader header;
+
+    close();
+    if (!_raw.open(path, error))
+        return false;
+    if (_raw.size() >= sizeof(header))
+        std::memcpy(&header, _raw.data(), sizeof(header));
+    if ((_raw.size() >= sizeof(header)) &&
+        (std::memcmp(header.magic, TraceFileHeader::compact_magic_value, sizeof(header.magic)) == 0))
+    {
+        _raw.close();
+        if (!_compact.open(path, error))
+            return false;
+        _records = _compact.records();
+        return true;
+    }
+
+    if ((_raw.size() < sizeof(header)) || (std::memcmp(header.magic, TraceFileHeader::magic_value, sizeof(header.magic)) != 0))
+        error = path + " is not a trace file";
+    else if ((header.version != TraceFileHeader::current_version) || (header.record_size != sizeof(TraceRecord)))
+        error = path + " is a trace from another version of the emulator";
+    else
+    {
+        // A partly written record at the very end is ignored
+        _records = (_raw.size() - sizeof(header)) / sizeof(TraceRecord);
+        return true;
+    }
+    close();
+    return false;
+}
+
+void TraceView::close()
+{
+    _raw.close();
+    _compact.close();
+    _records = 0;
+    for (CachedChunk &cached : _cache)
+        cached.valid = false;
+}
+
+size_t TraceView::chunks() const
+{
+    if (_compact.isOpen())
+        return _compact.blocks();
+    return static_cast<size_t>((_records + chunk_records - 1) / chunk_records);
+}
+
+uint64_t TraceView::firstRecordOf(size_t chunk) const
+{
+    if (_compact.isOpen())
+        return _compact.firstRecordOf(chunk);
+    return static_cast<uint64_t>(chunk) * chunk_records;
+}
+
+bool TraceView::readChunk(size_t chunk, std::vector<TraceRecord> &records) const
+{
+    if (chunk >= chunks())
+    {
+        records.clear();
+        return false;
+    }
+    if (_compact.isOpen())
+        return _compact.decodeBlock(chunk, records);
+
+    const uint64_t first = firstRecordOf(chunk);
+
+    records.resize(static_cast<size_t>(std::min<uint64_t>(chunk_records, _records - first)));
+    std::memcpy(records.data(), _raw.data() + sizeof(TraceFileHeader) + first * sizeof(TraceRecord),
+                records.size() * sizeof(TraceRecord));
+    return true;
+}
+
+bool TraceView::record(uint64_t index, TraceRecord &record)
+{
+    if (index >= _records)
+        return false;
+
+    // A raw trace needs no decoding at all
+    if (!_compact.isOpen())
+    {
+        std::memcpy(&record, _raw.data() + sizeof(TraceFileHeader) + index * sizeof(TraceRecord), sizeof(record));
+        return true;
+    }
+
+    const size_t       chunk = _compact.blockOfRecord(index);
+    const CachedChunk *cached = cachedChunk(chunk);
+    const uint64_t     offset = index - firstRecordOf(chunk);
+
+    if (!cached || (offset >= cached->records.size()))
+        return false;
+    record = cached->records[static_cast<size_t>(offset)];
+    return true;
+}
+
+uint64_t TraceView::recordOfCycle(uint64_t cycle)
+{
+    if (_records == 0)
+        return 0;
+
+    // Cycles only go up, so a binary search finds it, over the index and
+    // then within a single block of a compact trace
+    if (!_compact.isOpen())
+    {
+        const TraceRecord *records = reinterpret_cast<const TraceRecord *>(_raw.data() + sizeof(TraceFileHeader));
+        uint64_t           low = 0;
+        uint64_t           high = _records;
+
+        while (low < high)
+        {
+            const uint64_t middle = low + (high - low) / 2;
+            uint64_t       middle_cycle;
+
+            std::memcpy(&middle_cycle, &records[middle].cycle, sizeof(middle_cycle));
+            if (middle_cycle < cycle)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+        return low;
+    }
+
+    size_t chunk = _compact.blockOfCycle(cycle);
+
+    for (; chunk < _compact.blocks(); ++chunk)
+    {
+        const CachedChunk *cached = cachedChunk(chunk);
+
+        if (!cached)
+            break;
+
+        const auto found = std::lower_bound(cached->records.begin(), cached->records.end(), cycle,
+                                            [](const TraceRecord &record, uint64_t wanted) { return record.cycle < wanted; });
+
+        if (found != cached->records.end())
+            return firstRecordOf(chunk) + static_cast<uint64_t>(found - cached->records.begin());
+    }
+    return _records;
+}
+
+bool TraceView::filter(const TraceFilter &filter, std::vector<uint64_t> &rows, const std::atomic<bool> *cancel) const
+{
+    std::vector<TraceRecord> records;
+
+    rows.clear();
+    for (size_t chunk = 0; chunk < chunks(); ++chunk)
+    {
+        if (cancel && cancel->load(std::memory_order_relaxed))
+            return false;
+        // A damaged chunk is only skipped, as the rest of the trace may be fine
+        if (!readChunk(chunk, records))
+            continue;
+
+        const uint64_t first = firstRecordOf(chunk);
+
+        for (size_t i = 0; i < records.size(); ++i)
+        {
+            if (filter.matches(records[i]))
+                rows.push_back(first + i);
+        }
+    }
+    return true;
+}
+
+auto TraceView::cachedChunk(size_t chunk) -> const CachedChunk *
+{
+    for (const CachedChunk &cached : _cache)
+    {
+        if (cached.valid && (cached.chunk == chunk))
+            return &cached;
+    }
+
+    CachedChunk &victim = _cache[_next_victim];
+
+    _next_victim = (_next_victim + 1) % _cache.size();
+    victim.chunk = chunk;
+    victim.valid = _compact.decodeBlock(chunk, victim.records);
+    return victim.valid ? &victim : nullptr;
+}
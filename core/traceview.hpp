@@ -0,0 +1,111 @@
+#ifndef TRACEVIEW_HPP
+#define TRACEVIEW_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "compacttrace.hpp"
+#include "mappedfile.hpp"
+#include "tracerecord.hpp"
+
+
+/** Which records of a trace to keep when filtering one.
+ *
+ *  A record is kept if it matches everything that is given.
+ */
+struct TraceFilter
+{
+    uint16_t                lowest_program_counter = 0x0000;
+    uint16_t                highest_program_counter = 0xFFFF;
+    std::optional<uint8_t>  opcode;
+    std::optional<uint16_t> effective_address;
+
+    bool matches(const TraceRecord &record) const
+    {
+        return (record.program_counter >= lowest_program_counter) && (record.program_counter <= highest_program_counter) &&
+               (!opcode || (record.opcode == *opcode)) &&
+               (!effective_address || (record.effective_address == *effective_address));
+    }
+
+    bool keepsEverything() const
+    {
+        return (lowest_program_counter == 0x0000) && (highest_program_counter == 0xFFFF) && !opcode && !effective_address;
+    }
+};
+
+
+/** Any record of a trace file, of either format, without reading the file.
+ *
+ *  The file is mapped into memory, and is read in chunks: the blocks of a
+ *  compact trace, and runs of chunk_records records of a raw one.  Only
+ *  the chunk a record is in is ever decoded to get at it, and the last few
+ *  are kept, so stepping through nearby records decodes each chunk once.
+ *
+ *  record() keeps those chunks, so only one thread at a time may call it.
+ *  Everything else only reads the file, so filter() can run on another
+ *  thread while record() is being called.
+ */
+class TraceView
+{
+public:
+    static constexpr uint32_t chunk_records = 4096; ///< Of a raw trace
+
+    /** @return false, with the reason in @p error, if @p path can't be mapped
+     *          or isn't a trace file
+     */
+    bool open(const std::string &path, std::string &error);
+    void close();
+
+    bool     isOpen() const { return _raw.isOpen() || _compact.isOpen(); }
+    uint64_t records() const { return _records; }
+
+    size_t   chunks() const;
+    uint64_t firstRecordOf(size_t chunk) const;
+
+    /** Decodes all of @p chunk into @p records.
+     *
+     *  @return false if it is damaged
+     */
+    bool readChunk(size_t chunk, std::vector<TraceRecord> &records) const;
+
+    /** Reads record number @p index into @p record.
+     *
+     *  @return false if there is no such record, or its chunk is damaged
+     */
+    bool record(uint64_t index, TraceRecord &record);
+
+    /** The number of the first record that starts at or after @p cycle, or
+     *  records() if there is none.
+     */
+    uint64_t recordOfCycle(uint64_t cycle);
+
+    /** Finds the numbers of every record @p filter keeps, in order, a chunk
+     *  at a time.
+     *
+     *  @return false, leaving @p rows as far as it got, if @p cancel was set
+     *          part way through
+     */
+    bool filter(const TraceFilter &filter, std::vector<uint64_t> &rows, const std::atomic<bool> *cancel = nullptr) const;
+
+private:
+    struct CachedChunk
+    {
+        size_t                   chunk = 0;
+        std::vector<TraceRecord> records;
+        bool                     valid = false;
+    };
+
+    MappedFile                 _raw;
+    CompactTraceFile           _compact;
+    uint64_t                   _records = 0;
+    std::array<CachedChunk, 4> _cache;
+    size_t                     _next_victim = 0; // Of _cache, round robin
+
+    const CachedChunk *cachedChunk(size_t chunk);
+};
+
+#endif // TRACEVIEW_HPP
@@ -0,0 +1,120 @@
+#include "accessheatmapview.hpp"
+#include <QImage>
+#include <QPainter>
+#include <QQuickWindow>
+#include <QtQml>
+
+
+AccessHeatmapView::AccessHeatmapView(QQuickItem *parent)
+    :
+    QQuickPaintedItem(parent),
+    _heatmap(_half_life)
+{
+    setImplicitWidth(AccessHeatmap::width);
+    setImplicitHeight(AccessHeatmap::height);
+    setTextureSize(QSize(AccessHeatmap::width, AccessHeatmap::height));
+    setOpaquePainting(true);
+    // A pixel to a byte, however big it's shown
+    setSmooth(false);
+    setAntialiasing(false);
+}
+
+AccessHeatmapView::~AccessHeatmapView()
+{
+    if (_cpu && (_cpu->accessCounters() == &_counters))
+        _cpu->setAccessCounters(nullptr);
+}
+
+void AccessHeatmapView::RegisterType()
+{
+    qmlRegisterType<AccessHeatmapView>("Qt.example.accessheatmapview",
+                                       1,
+                                       0,
+                                       "AccessHeatmapView");
+}
+
+void AccessHeatmapView::setCpu(olc6502 *new_cpu)
+{
+    if (new_cpu != _cpu)
+    {
+        if (_cpu)
+        {
+            _cpu->disconnect(_cpu, &olc6502::pcChanged, this, &AccessHeatmapView::onCpuPcChanged);
+            if (_cpu->accessCounters() == &_counters)
+                _cpu->setAccessCounters(nullptr);
+        }
+        _cpu = new_cpu;
+        if (new_cpu)
+        {
+            new_cpu->connect(new_cpu, &olc6502::pcChanged, this, &AccessHeatmapView::onCpuPcChanged);
+            new_cpu->setAccessCounters(&_counters);
+        }
+        _restart = true;
+        emit cpuChanged();
+        update();
+    }
+}
+
+void AccessHeatmapView::setHalfLife(qreal seconds)
+{
+    if (seconds != _half_life)
+    {
+        _half_life = seconds;
+        emit halfLifeChanged();
+        update();
+    }
+}
+
+int AccessHeatmapView::addressAt(qreal x, qreal y) const
+{
+    if ((x < 0) || (y < 0) || (x >= width()) || (y >= height()))
+        return -1;
+
+    const int column = static_cast<int>(x * AccessHeatmap::width / width());
+    const int row    = static_cast<int>(y * AccessHeatmap::height / height());
+
+    return (row << 8) | column;
+}
+
+void AccessHeatmapView::paint(QPainter *painter)
+{
+    if (_restart)
+    {
+        _heatmap.clear();
+        _since_update.start();
+        _restart = false;
+    }
+    _heatmap.setHalfLife(_half_life);
+    _warm = _heatmap.update(_counters, _since_update.restart() / 1000.0);
+
+    // The texture is as big as the picture, so this copies the pixels
+    // across one for one, into the same texture every frame
+    const QImage image(reinterpret_cast<const uchar *>(_heatmap.pixels()),
+                       AccessHeatmap::width, AccessHeatmap::height, QImage::Format_RGB32);
+
+    painter->drawImage(boundingRect(), image);
+}
+
+void AccessHeatmapView::itemChange(ItemChange change, const ItemChangeData &value)
+{
+    if (change == ItemSceneChange)
+    {
+        if (_window)
+            _window->disconnect(_window, &QQuickWindow::frameSwapped, this, &AccessHeatmapView::onFrameSwapped);
+        _window = value.window;
+        if (_window)
+            _window->connect(_window, &QQuickWindow::frameSwapped, this, &AccessHeatmapView::onFrameSwapped);
+    }
+    QQuickPaintedItem::itemChange(change, value);
+}
+
+void AccessHeatmapView::onCpuPcChanged()
+{
+    update();
+}
+
+void AccessHeatmapView::onFrameSwapped()
+{
+    if (_warm)
+        update();
+}
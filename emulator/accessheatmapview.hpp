@@ -0,0 +1,91 @@
+#ifndef ACCESSHEATMAPVIEW_HPP
+#define ACCESSHEATMAPVIEW_HPP
+
+#include <QElapsedTimer>
+#include <QQuickPaintedItem>
+#include "accesscounters.hpp"
+#include "accessheatmap.hpp"
+#include "olc6502.hpp"
+
+
+/** Shows where the CPU has lately been reading, writing and executing, as
+ *  an AccessHeatmap: a pixel for each byte, a row for each page.
+ *
+ *  The CPU only counts accesses, into counters the view gives it.  The
+ *  heat is worked out from them once a frame, as the scene graph is synced,
+ *  and painted into a texture of 256 by 256, the same one each time, which
+ *  works the same with the software renderer.
+ */
+class AccessHeatmapView : public QQuickPaintedItem
+{
+    Q_OBJECT
+
+    Q_PROPERTY(olc6502 *cpu      READ cpu      WRITE setCpu      NOTIFY cpuChanged)
+    Q_PROPERTY(qreal    halfLife READ halfLife WRITE setHalfLife NOTIFY halfLifeChanged)
+public:
+    AccessHeatmapView(QQuickItem *parent = nullptr);
+   ~AccessHeatmapView() override;
+
+    /** Registers this type with the Qt type system
+     *
+     */
+    static void RegisterType();
+
+    /** The CPU to count the accesses of.  Counting starts when it is set,
+     *  and stops when it is replaced or the view goes.
+     *
+     */
+    ///@{
+    olc6502 *cpu() const { return _cpu; }
+    void     setCpu(olc6502 *new_cpu);
+    ///@}
+
+    /** How many seconds it takes the heat to halve.
+     *
+     */
+    ///@{
+    qreal halfLife() const { return _half_life; }
+    void  setHalfLife(qreal seconds);
+    ///@}
+
+    /** @return The address drawn at @p x, @p y in the view, or -1 if that is
+     *          outside it
+     */
+    Q_INVOKABLE int addressAt(qreal x, qreal y) const;
+
+    void paint(QPainter *painter) override;
+
+signals:
+    void cpuChanged();
+    void halfLifeChanged();
+
+protected:
+    void itemChange(ItemChange change, const ItemChangeData &value) override;
+
+private:
+    olc6502       *_cpu = nullptr;
+    qreal          _half_life = 0.5;
+    AccessCounters _counters;
+
+    // Only used while the scene graph is synced, with the GUI thread waiting
+    AccessHeatmap  _heatmap;
+    QElapsedTimer  _since_update;
+    bool           _restart = true;
+    bool           _warm = false;
+
+    QQuickWindow  *_window = nullptr;
+
+private slots:
+    /** Asks for a frame, with whatever the CPU has counted since the last
+     *  one.  However often the PC changes, the frames come no faster.
+     *
+     */
+    void onCpuPcChanged();
+
+    /** Asks for another frame as long as something is still cooling down
+     *
+     */
+    void onFrameSwapped();
+};
+
+#endif // ACCESSHEATMAPVIEW_HPP
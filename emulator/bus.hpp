@@ -3,8 +3,15 @@
 
 #include <QObject>
 #include <cstdint>
+#include "ibusdevice.hpp"
+#include "systembus.hpp"
 
 
+/** Makes a SystemBus from the core library available to Qt and QML.
+ *
+ *  Accesses go straight from the bus to the devices, without any signals
+ *  in between.
+ */
 class Bus : public QObject
 {
     Q_OBJECT
@@ -17,13 +24,31 @@ public:
     static constexpr addressType minAddress() { return 0x00; }
     static constexpr addressType maxAddress() { return static_cast<addressType>(1 << (bitWidth() - 1)); }
 
+    /** Attaches @p device, which must outlive the bus or be detached first.
+     *
+     */
+    ///@{
+    void attach(IBusDevice &device) { _bus.attach(device.device()); }
+    void detach(IBusDevice &device) { _bus.detach(device.device()); }
+    ///@}
+
+    SystemBus &systemBus() { return _bus; }
+
+    /** Accesses @p length bytes at once, split across the devices.
+     *
+     *  @see SystemBus::writeBlock
+     */
+    ///@{
+    void writeBlock(addressType address, const uint8_t *data, size_t length) { _bus.writeBlock(address, data, length); }
+    void readBlock(addressType address, uint8_t *data, size_t length, bool read_only) { _bus.readBlock(address, data, length, read_only); }
+    ///@}
+
 public slots:
     void    write(addressType address, uint8_t data);
     uint8_t read(addressType address, bool read_only);
 
-signals:
-    void    busWritten(addressType address, uint8_t data);
-    uint8_t busRead(addressType address, bool read_only);
+private:
+    SystemBus _bus;
 };
 
 #endif // BUS_HPP
@@ -3,22 +3,21 @@
 #include <QtQml>
 #include <QQmlEngine>
 #include <QJSEngine>
-#include <sstream>
+#include <QSignalBlocker>
+#include <algorithm>
+#include <cstring>
+#include <vector>
 
 
-Computer::Computer(QObject *parent) : QObject(parent)
+Computer::Computer(QObject *parent)
+    :
+    QObject(parent),
+    _rewind_snapshot(std::make_unique<MachineSnapshot>())
 {
-    // Read signals
-    QObject::connect(&_cpu, &olc6502::readSignal,
-                     &_bus, &Bus::read);
-    QObject::connect(&_bus,    &Bus::busRead,
-                     &_memory, &RamBusDevice::read);
+    // The CPU talks to the memory through the core bus directly
+    _bus.attach(_memory);
+    _cpu.setBus(&_bus.systemBus());
 
-    // Write signals
-    QObject::connect(&_cpu, &olc6502::writeSignal,
-                     &_bus, &Bus::write);
-    QObject::connect(&_bus,    &Bus::busWritten,
-                     &_memory, &RamBusDevice::write);
     _clock.setInterval(16);
     _clock.setSingleShot(false);
     QObject::connect(&_clock, &QTimer::timeout,
@@ -39,6 +38,23 @@ void Computer::stopClock()
 void Computer::stepClock()
 {
     _cpu.clock();
+    recordRewind();
+    emit cycleChanged();
+}
+
+void Computer::reset()
+{
+    logInput(InputLog::Input::Reset);
+}
+
+void Computer::irq()
+{
+    logInput(InputLog::Input::Irq);
+}
+
+void Computer::nmi()
+{
+    logInput(InputLog::Input::Nmi);
 }
 
 void Computer::timerTimeout()
@@ -68,25 +84,262 @@ void Computer::loadProgram()
        NOP
    */
 
-    // Convert hex string into bytes for RAM
-    std::stringstream ss;
+    static const uint8_t program[] = {
+        0xA2, 0x0A, 0x8E, 0x00, 0x00, 0xA2, 0x03, 0x8E, 0x01, 0x00, 0xAC, 0x00, 0x00, 0xA9, 0x00, 0x18,
+        0x6D, 0x01, 0x00, 0x88, 0xD0, 0xFA, 0x8D, 0x02, 0x00, 0xEA, 0xEA, 0xEA
+    };
+    ProgramImage image;
+    std::string  error;
+
+    image.decode(program, sizeof(program), ProgramImage::Format::Raw, 0x8000, error);
+    boot(image);
+}
 
-    ss << "A2 0A 8E 00 00 A2 03 8E 01 00 AC 00 00 A9 00 18 6D 01 00 88 D0 FA 8D 02 00 EA EA EA";
+bool Computer::loadImage(const QUrl &file, const QString &format, int address)
+{
+    ProgramImage::Format image_format;
+    ProgramImage         image;
+    std::string          error;
 
-    for (uint16_t nOffset = 0x8000; !ss.eof(); ++nOffset)
+    if (!ProgramImage::formatFromName(format.toStdString(), image_format))
     {
-        std::string b;
+        setLoadError(tr("Unknown image format %1").arg(format));
+        return false;
+    }
+    if ((address < 0) || (address > 0xFFFF))
+    {
+        setLoadError(tr("The load address has to be between $0000 and $FFFF"));
+        return false;
+    }
+
+    const QString path = file.isLocalFile() ? file.toLocalFile() : file.toString();
 
-        ss >> b;
-        _memory.write(nOffset, (uint8_t)std::stoul(b, nullptr, 16));
+    if (!image.load(path.toStdString(), image_format, static_cast<ProgramImage::addressType>(address), error))
+    {
+        setLoadError(QString::fromStdString(error));
+        return false;
     }
+    boot(image);
+    setLoadError(QString());
+    return true;
+}
+
+void Computer::saveState(MachineSnapshot &snapshot) const
+{
+    snapshot.version = MachineSnapshot::current_version;
+    snapshot.cycle = _cpu.clockTicks();
+    _cpu.saveState(snapshot.cpu);
+    snapshot.ram = _memory.memory();
+}
+
+void Computer::restoreState(const MachineSnapshot &snapshot)
+{
+    _memory.load(0x0000, snapshot.ram.data(), snapshot.ram.size());
+    _cpu.restoreState(snapshot.cpu);
+}
+
+QByteArray Computer::saveState() const
+{
+    // Snapshots are too big for the stack, and need more alignment than a
+    // QByteArray gives
+    auto snapshot = std::make_unique<MachineSnapshot>();
+
+    saveState(*snapshot);
+    return QByteArray(reinterpret_cast<const char *>(snapshot.get()), sizeof(MachineSnapshot));
+}
 
-    // Set Reset Vector
-    _memory.write(0xFFFC, 0x00);
-    _memory.write(0xFFFD, 0x80);
+bool Computer::restoreState(const QByteArray &state)
+{
+    auto snapshot = std::make_unique<MachineSnapshot>();
+
+    if (state.size() != static_cast<int>(sizeof(MachineSnapshot)))
+        return false;
+    std::memcpy(snapshot.get(), state.constData(), sizeof(MachineSnapshot));
+    if (snapshot->version != MachineSnapshot::current_version)
+        return false;
+    restoreState(*snapshot);
+
+    // The history led somewhere else
+    _rewind.clear();
+    _inputs.clear();
+    emit rewindChanged();
+    emit cycleChanged();
+    return true;
+}
+
+bool Computer::stepBack()
+{
+    const uint32_t now = _cpu.clockTicks();
+
+    if ((now == 0) || !_rewind.restore(now - 1, *_rewind_snapshot))
+        return false;
+    return goBackTo(static_cast<uint32_t>(_rewind_snapshot->cycle));
+}
+
+bool Computer::rewindTo(int cycle)
+{
+    if ((cycle < 0) || (static_cast<uint32_t>(cycle) > _cpu.clockTicks()))
+        return false;
+    return goBackTo(static_cast<uint32_t>(cycle));
+}
+
+bool Computer::stepInstructionBack()
+{
+    // Part way through an instruction, the last one to start is that one
+    return goBackToLast([]() { return true; }, _cpu.complete() ? 0 : 1);
+}
+
+bool Computer::runBackTo(int address)
+{
+    if ((address < 0) || (address > 0xFFFF))
+        return false;
+    return goBackToLast([this, address]() { return _cpu.pc() == address; });
+}
+
+void Computer::setRewindBudget(int bytes)
+{
+    if (bytes != rewindBudget())
+    {
+        _rewind.setBudget(static_cast<size_t>(std::max(bytes, 0)));
+        emit rewindChanged();
+    }
+}
+
+void Computer::setRewindInterval(int cycles)
+{
+    if (cycles != rewindInterval())
+    {
+        _rewind.setInterval(static_cast<uint64_t>(std::max(cycles, 1)));
+        emit rewindChanged();
+    }
+}
+
+void Computer::logInput(InputLog::Input input)
+{
+    _inputs.record(_cpu.clockTicks(), input);
+    InputLog::apply(_cpu, input);
+}
+
+void Computer::recordRewind()
+{
+    if (_rewind.due(_cpu.clockTicks()))
+    {
+        saveState(*_rewind_snapshot);
+        _rewind.push(*_rewind_snapshot);
+
+        // Inputs from before the oldest snapshot can never be replayed
+        _inputs.discardBefore(*_rewind.oldestCycle());
+        emit rewindChanged();
+    }
+}
+
+bool Computer::goBackTo(uint32_t cycle)
+{
+    if (!_rewind.restore(cycle, *_rewind_snapshot))
+        return false;
+
+    InstructionExecutor::Snapshot shown;
+
+    // Snapshots are taken every so many ticks; replaying from the one
+    // before gets to the exact tick.  The views only need to see the end,
+    // so the CPU is put back as they last saw it, for the final restore to
+    // tell them what changed.
+    _cpu.saveState(shown);
+    {
+        const QSignalBlocker cpu_blocker(_cpu);
+        const QSignalBlocker memory_blocker(_memory);
+
+        restoreState(*_rewind_snapshot);
+        replayTo(cycle);
+        saveState(*_rewind_snapshot);
+        _cpu.restoreState(shown);
+    }
+    restoreState(*_rewind_snapshot);
+
+    // What came after is forgotten; running on records it afresh
+    _rewind.discardAfter(cycle);
+    _inputs.discardFrom(cycle);
+    emit rewindChanged();
+    emit cycleChanged();
+    return true;
+}
+
+bool Computer::goBackToLast(const std::function<bool ()> &matches, size_t skipping)
+{
+    auto                  now = std::make_unique<MachineSnapshot>();
+    std::vector<uint32_t> found; // Newest first
+
+    saveState(*now);
+    {
+        const QSignalBlocker cpu_blocker(_cpu);
+        const QSignalBlocker memory_blocker(_memory);
+        uint32_t             end = _cpu.clockTicks();
+
+        // Replay from one snapshot to the next, newest first, until there are
+        // enough instruction starts that match
+        while ((found.size() <= skipping) && (end > 0) && _rewind.restore(end - 1, *_rewind_snapshot))
+        {
+            std::vector<uint32_t> starts;
+
+            restoreState(*_rewind_snapshot);
+            replayTo(end, [this, &matches, &starts]()
+            {
+                if (matches())
+                    starts.push_back(_cpu.clockTicks());
+            });
+            found.insert(found.end(), starts.rbegin(), starts.rend());
+            end = static_cast<uint32_t>(_rewind_snapshot->cycle);
+        }
+
+        // As the views last saw it, whether or not it goes back from there
+        restoreState(*now);
+    }
+    return (found.size() > skipping) && goBackTo(found[skipping]);
+}
+
+void Computer::replayTo(uint32_t cycle, const std::function<void ()> &at_instruction_start)
+{
+    const std::vector<InputLog::Event> &events = _inputs.events();
+    size_t                              next = _inputs.firstAt(_cpu.clockTicks());
+
+    while (_cpu.clockTicks() < cycle)
+    {
+        // As it was when the machine got to this tick, before any input
+        if (at_instruction_start && _cpu.complete())
+            at_instruction_start();
+        for (; (next < events.size()) && (events[next].cycle == _cpu.clockTicks()); ++next)
+            InputLog::apply(_cpu, events[next].input);
+        _cpu.clock();
+    }
+}
+
+void Computer::boot(const ProgramImage &image)
+{
+    _memory.load(image);
+
+    // Set Reset Vector, unless the image has its own
+    if (image.entryPoint())
+    {
+        _memory.write(0xFFFC, *image.entryPoint() & 0xFF);
+        _memory.write(0xFFFD, *image.entryPoint() >> 8);
+    }
 
     // Reset
     _cpu.reset();
+
+    // There's no going back to before the program was loaded
+    _rewind.clear();
+    _inputs.clear();
+    emit rewindChanged();
+}
+
+void Computer::setLoadError(const QString &error)
+{
+    if (error != _load_error)
+    {
+        _load_error = error;
+        emit loadErrorChanged();
+    }
 }
 
 void Computer::RegisterType()
@@ -3,9 +3,16 @@
 
 #include <QObject>
 #include <QTimer>
+#include <QUrl>
 #include "olc6502.hpp"
 #include "bus.hpp"
+#include "inputlog.hpp"
+#include "machinesnapshot.hpp"
 #include "rambusdevice.hpp"
+#include "rewindbuffer.hpp"
+#include <functional>
+#include <memory>
+#include <optional>
 
 
 class Computer : public QObject
@@ -14,20 +21,124 @@ class Computer : public QObject
 
     Q_PROPERTY(olc6502      *cpu READ cpu CONSTANT FINAL)
     Q_PROPERTY(RamBusDevice *ram READ ram CONSTANT FINAL)
+    Q_PROPERTY(QString      loadError READ loadError NOTIFY loadErrorChanged FINAL)
+    Q_PROPERTY(int          cycle READ cycle NOTIFY cycleChanged FINAL)
+
+    Q_PROPERTY(int rewindBudget   READ rewindBudget   WRITE setRewindBudget   NOTIFY rewindChanged FINAL)
+    Q_PROPERTY(int rewindInterval READ rewindInterval WRITE setRewindInterval NOTIFY rewindChanged FINAL)
+    Q_PROPERTY(int rewindBytes    READ rewindBytes    NOTIFY rewindChanged FINAL)
+    Q_PROPERTY(int rewindOldest   READ rewindOldest   NOTIFY rewindChanged FINAL)
 public:
     explicit Computer(QObject *parent = nullptr);
 
     static void RegisterType();
 
+    /** Why the last loadImage() failed, or empty if it didn't.
+     *
+     */
+    QString loadError() const { return _load_error; }
+
+    int cycle() const { return static_cast<int>(_cpu.clockTicks()); } ///< Clock ticks since the start
+
+    /** The rewind history: how many bytes it may take up, how many clock
+     *  ticks apart its snapshots are, how many bytes it does take up and
+     *  the oldest tick it can go back to (-1 when it's empty).
+     *
+     *  How far back it reaches is down to the budget, and how well the
+     *  program's memory compresses.
+     */
+    ///@{
+    int  rewindBudget() const { return static_cast<int>(_rewind.budget()); }
+    void setRewindBudget(int bytes);
+    int  rewindInterval() const { return static_cast<int>(_rewind.interval()); }
+    void setRewindInterval(int cycles);
+    int  rewindBytes() const { return static_cast<int>(_rewind.bytes()); }
+    int  rewindOldest() const { return _rewind.oldestCycle() ? static_cast<int>(*_rewind.oldestCycle()) : -1; }
+    ///@}
+
+    /** Captures, or puts back, the CPU and RAM, including an instruction
+     *  that is only part way through its cycles.
+     *
+     *  These are the quick way, for rewinding and the like.  The slots of the
+     *  same name do the same with a QByteArray for QML.
+     */
+    ///@{
+    void saveState(MachineSnapshot &snapshot) const;
+    void restoreState(const MachineSnapshot &snapshot);
+    ///@}
+
 public slots:
     void startClock();
     void stopClock();
     void stepClock();
 
+    /** Resets or interrupts the CPU, logging it so going back in time and
+     *  running forward again does the same.
+     */
+    ///@{
+    void reset();
+    void irq();
+    void nmi();
+    ///@}
+
     olc6502      *cpu() { return &_cpu; }
     RamBusDevice *ram() { return &_memory; }
 
+    /** Loads a program image into memory and resets the CPU to run it.
+     *
+     *  @param file    The image to load
+     *  @param format  raw, ihex, srec, ines, or auto to work it out
+     *  @param address Where a raw image goes
+     *
+     *  @return false, with the reason in loadError, if the image couldn't be
+     *          loaded.  Memory is left alone in that case.
+     */
+    bool loadImage(const QUrl &file, const QString &format = QStringLiteral("auto"), int address = 0);
+
+    QByteArray saveState() const;
+
+    /** @return false if @p state didn't come from saveState(), or from a
+     *          version that saved something different
+     */
+    bool restoreState(const QByteArray &state);
+
+    /** Goes back to the last snapshot in the rewind history before now.
+     *
+     *  Anything after it is forgotten; running on records it afresh.
+     *
+     *  @return false if there's nothing older to go back to
+     */
+    bool stepBack();
+
+    /** Goes back to clock tick @p cycle: to the last snapshot at or before it,
+     *  then runs forward the rest of the way.
+     *
+     *  @return false if @p cycle is in the future, or older than the history
+     *          goes back
+     */
+    bool rewindTo(int cycle);
+
+    /** Goes back to the start of the instruction before the one now running,
+     *  or about to run.
+     *
+     *  The nearest snapshot before it is restored and run forward to it,
+     *  with any resets and interrupts that came in along the way.
+     *
+     *  @return false if the rewind history doesn't reach back that far
+     */
+    bool stepInstructionBack();
+
+    /** Goes back to the last time the instruction at @p address was about to
+     *  run, like running backwards to a breakpoint.
+     *
+     *  @return false if it didn't run within the rewind history
+     */
+    bool runBackTo(int address);
+
 signals:
+    void loadErrorChanged();
+    void cycleChanged();
+    void rewindChanged();
 
 private slots:
     void timerTimeout();
@@ -37,8 +148,19 @@ private:
     Bus     _bus;
     RamBusDevice _memory;
     QTimer       _clock;
+    QString      _load_error;
+    RewindBuffer _rewind;
+    InputLog     _inputs;
+    std::unique_ptr<MachineSnapshot> _rewind_snapshot;
 
+    void logInput(InputLog::Input input);
+    void recordRewind();
+    bool goBackTo(uint32_t cycle);
+    bool goBackToLast(const std::function<bool ()> &matches, size_t skipping = 0);
+    void replayTo(uint32_t cycle, const std::function<void ()> &at_instruction_start = nullptr);
     void loadProgram();
+    void boot(const ProgramImage &image);
+    void setLoadError(const QString &error);
 
     Q_DISABLE_COPY(Computer)
 };
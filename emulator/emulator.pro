@@ -18,30 +18,34 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    accessheatmapview.cpp \
     bus.cpp \
     computer.cpp \
+    executionstatisticsmodel.cpp \
     ibusdevice.cpp \
-    instructionexecutor.cpp \
     olc6502.cpp \
     rambusdevice.cpp \
     rambusdevicedisassemblymodel.cpp \
     rambusdevicetablemodel.cpp \
-    rambusdeviceview.cpp
+    rambusdeviceview.cpp \
+    tracelistmodel.cpp
 
 HEADERS += \
+    accessheatmapview.hpp \
     bus.hpp \
     computer.hpp \
-    flags.hpp \
+    executionstatisticsmodel.hpp \
     ibusdevice.hpp \
-    instructionexecutor.hpp \
-    instructions.hpp \
     olc6502.hpp \
-    opcodes.hpp \
     rambusdevice.hpp \
     rambusdevicedisassemblymodel.hpp \
     rambusdevicetablemodel.hpp \
     rambusdeviceview.hpp \
-    registers.hpp
+    tracelistmodel.hpp
+
+# The Qt classes here are adapters over the Qt-free core library.
+INCLUDEPATH += $$PWD/../core
+DEPENDPATH += $$PWD/../core
 
 # Default rules for deployment.
 unix {
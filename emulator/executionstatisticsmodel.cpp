@@ -0,0 +1,151 @@
+#include "executionstatisticsmodel.hpp"
+#include "opcodes.hpp"
+#include <QtQml>
+#include <algorithm>
+
+
+namespace
+{
+constexpr AddressMode_e address_modes[] {
+    AddressMode_e::Accumulator,
+    AddressMode_e::Absolute,
+    AddressMode_e::AbsoluteXIndexed,
+    AddressMode_e::AbsoluteYIndexed,
+    AddressMode_e::Immediate,
+    AddressMode_e::Implied,
+    AddressMode_e::Indirect,
+    AddressMode_e::XIndexedIndirect,
+    AddressMode_e::IndirectYIndexed,
+    AddressMode_e::Relative,
+    AddressMode_e::ZeroPage,
+    AddressMode_e::ZeroPageXIndexed,
+    AddressMode_e::ZeroPageYIndexed
+};
+
+// Named as the disassembly tags them, apart from the accumulator
+const char *NameOf(AddressMode_e mode)
+{
+    switch (mode)
+    {
+    case AddressMode_e::Accumulator:      return "ACC";
+    case AddressMode_e::Absolute:         return "ABS";
+    case AddressMode_e::AbsoluteXIndexed: return "ABX";
+    case AddressMode_e::AbsoluteYIndexed: return "ABY";
+    case AddressMode_e::Immediate:        return "IMM";
+    case AddressMode_e::Implied:          return "IMP";
+    case AddressMode_e::Indirect:         return "IND";
+    case AddressMode_e::XIndexedIndirect: return "IZX";
+    case AddressMode_e::IndirectYIndexed: return "IZY";
+    case AddressMode_e::Relative:         return "REL";
+    case AddressMode_e::ZeroPage:         return "ZP0";
+    case AddressMode_e::ZeroPageXIndexed: return "ZPX";
+    case AddressMode_e::ZeroPageYIndexed: return "ZPY";
+    }
+    return "";
+}
+}
+
+
+ExecutionStatisticsModel::ExecutionStatisticsModel(QObject *parent)
+    :
+    QAbstractListModel(parent)
+{
+}
+
+void ExecutionStatisticsModel::RegisterType()
+{
+    qmlRegisterType<ExecutionStatisticsModel>("Qt.example.executionstatisticsmodel",
+                                              1,
+                                              0,
+                                              "ExecutionStatisticsModel");
+}
+
+int ExecutionStatisticsModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return static_cast<int>(_rows.size());
+}
+
+QVariant ExecutionStatisticsModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || (index.row() >= rowCount()))
+        return QVariant();
+
+    const Row &row = _rows[static_cast<size_t>(index.row())];
+
+    switch (role)
+    {
+    case NameRole:
+        return QVariant(row.name);
+    case OpcodeRole:
+        return QVariant(row.opcode);
+    case CountRole:
+        return QVariant(static_cast<qulonglong>(row.count));
+    case ShareRole:
+        return QVariant(_total ? 100.0 * static_cast<double>(row.count) / static_cast<double>(_total) : 0.0);
+    default:
+        return QVariant();
+    }
+}
+
+void ExecutionStatisticsModel::setCpuModel(olc6502 *new_cpu_model)
+{
+    if (new_cpu_model == _cpu_model)
+        return;
+    _cpu_model = new_cpu_model;
+    emit cpuModelChanged();
+    refresh();
+}
+
+void ExecutionStatisticsModel::setByAddressMode(bool value)
+{
+    if (value == _by_address_mode)
+        return;
+    _by_address_mode = value;
+    emit byAddressModeChanged();
+    updateRows();
+}
+
+void ExecutionStatisticsModel::refresh()
+{
+    _statistics = _cpu_model ? _cpu_model->statistics() : ExecutionStatistics();
+    updateRows();
+    emit refreshed();
+}
+
+void ExecutionStatisticsModel::reset()
+{
+    if (_cpu_model)
+        _cpu_model->resetStatistics();
+    refresh();
+}
+
+void ExecutionStatisticsModel::updateRows()
+{
+    beginResetModel();
+    _rows.clear();
+    _total = _statistics.instructions();
+    if (_by_address_mode)
+    {
+        for (AddressMode_e mode : address_modes)
+        {
+            const uint64_t count = _statistics.addressModeCount(mode);
+
+            if (count)
+                _rows.push_back({ QString::fromLatin1(NameOf(mode)), -1, count });
+        }
+        std::stable_sort(_rows.begin(), _rows.end(), [](const Row &left, const Row &right) { return left.count > right.count; });
+    }
+    else
+    {
+        for (const ExecutionStatistics::OpcodeCount &count : _statistics.mostFrequent())
+        {
+            const QString name = QString::asprintf("$%02X %s {%s}", count.opcode, MnemonicOf(count.opcode),
+                                                   NameOf(AddressModeOf(count.opcode)));
+
+            _rows.push_back({ name, count.opcode, count.count });
+        }
+    }
+    endResetModel();
+}
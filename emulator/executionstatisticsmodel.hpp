@@ -0,0 +1,106 @@
+#ifndef EXECUTIONSTATISTICSMODEL_HPP
+#define EXECUTIONSTATISTICSMODEL_HPP
+
+#include <QAbstractListModel>
+#include <QString>
+#include "executionstatistics.hpp"
+#include "olc6502.hpp"
+#include <vector>
+
+
+/** The execution statistics of a CPU, a row per opcode that has run, or per
+ *  addressing mode, most frequent first.
+ *
+ *  The counts are copied from the CPU by refresh() rather than followed as
+ *  they change, so a panel can update at whatever rate suits it, while the
+ *  CPU runs flat out.
+ */
+class ExecutionStatisticsModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    Q_PROPERTY(olc6502 *cpu                 READ cpuModel            WRITE setCpuModel      NOTIFY cpuModelChanged)
+    Q_PROPERTY(bool    byAddressMode        READ byAddressMode       WRITE setByAddressMode NOTIFY byAddressModeChanged)
+    Q_PROPERTY(qint64  instructions         READ instructions        NOTIFY refreshed)
+    Q_PROPERTY(qint64  pageCrossings        READ pageCrossings       NOTIFY refreshed)
+    Q_PROPERTY(qint64  branchesTaken        READ branchesTaken       NOTIFY refreshed)
+    Q_PROPERTY(qint64  branchesNotTaken     READ branchesNotTaken    NOTIFY refreshed)
+    Q_PROPERTY(qint64  branchPageCrossings  READ branchPageCrossings NOTIFY refreshed)
+    Q_PROPERTY(qint64  decimalAdditions     READ decimalAdditions    NOTIFY refreshed)
+    Q_PROPERTY(qint64  decimalSubtractions  READ decimalSubtractions NOTIFY refreshed)
+public:
+    explicit ExecutionStatisticsModel(QObject *parent = nullptr);
+
+    enum Roles {
+        NameRole = Qt::UserRole + 1,
+        OpcodeRole,
+        CountRole,
+        ShareRole
+    };
+    Q_ENUM(Roles)
+
+    QHash<int, QByteArray> roleNames() const override {
+        return {
+            { NameRole,   "name" },
+            { OpcodeRole, "opcode" },
+            { CountRole,  "count" },
+            { ShareRole,  "share" }
+        };
+    }
+
+    static void RegisterType();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    olc6502 *cpuModel() const { return _cpu_model; }
+    void     setCpuModel(olc6502 *new_cpu_model);
+
+    /** Rows per addressing mode instead of per opcode.  The opcode of such a
+     *  row is -1.
+     */
+    bool byAddressMode() const { return _by_address_mode; }
+    void setByAddressMode(bool value);
+
+    qint64 instructions() const { return static_cast<qint64>(_statistics.instructions()); }
+    qint64 pageCrossings() const { return static_cast<qint64>(_statistics.pageCrossings()); }
+    qint64 branchesTaken() const { return static_cast<qint64>(_statistics.branchesTaken()); }
+    qint64 branchesNotTaken() const { return static_cast<qint64>(_statistics.branchesNotTaken()); }
+    qint64 branchPageCrossings() const { return static_cast<qint64>(_statistics.branchPageCrossings()); }
+    qint64 decimalAdditions() const { return static_cast<qint64>(_statistics.decimalAdditions()); }
+    qint64 decimalSubtractions() const { return static_cast<qint64>(_statistics.decimalSubtractions()); }
+
+    /** Copies the counts from the CPU as they are now.
+     *
+     */
+    Q_INVOKABLE void refresh();
+
+    /** Starts counting again from zero.
+     *
+     */
+    Q_INVOKABLE void reset();
+
+signals:
+    void cpuModelChanged();
+    void byAddressModeChanged();
+    void refreshed();
+
+private:
+    struct Row
+    {
+        QString  name;
+        int      opcode;
+        uint64_t count;
+    };
+
+    olc6502            *_cpu_model = nullptr;
+    bool                _by_address_mode = false;
+    ExecutionStatistics _statistics;
+    std::vector<Row>    _rows;
+    uint64_t            _total = 0;
+
+    void updateRows();
+};
+
+#endif // EXECUTIONSTATISTICSMODEL_HPP
@@ -1,18 +0,0 @@
-#ifndef FLAGS_HPP
-#define FLAGS_HPP
-
-#include <cstdint>
-
-enum FLAGS6502 : uint8_t
-{
-    C = (1 << 0),	// Carry Bit
-    Z = (1 << 1),	// Zero
-    I = (1 << 2),	// Disable Interrupts
-    D = (1 << 3),	// Decimal Mode (unused in this implementation)
-    B = (1 << 4),	// Break
-    U = (1 << 5),	// Unused
-    V = (1 << 6),	// Overflow
-    N = (1 << 7),	// Negative
-};
-
-#endif // FLAGS_HPP
@@ -2,27 +2,42 @@
 #define IBUSDEVICE_HPP
 
 #include <QObject>
+#include "busdevice.hpp"
 
+/** Makes a BusDevice from the core library available to Qt and QML.
+ *
+ *  The device itself does the work, this only forwards to it.
+ */
 class IBusDevice : public QObject
 {
     Q_OBJECT
 public:
-    using addressType = uint16_t;
+    using addressType = BusDevice::addressType;
 
-    explicit IBusDevice(addressType lower_address,
-                        addressType upper_address,
-                        bool     writable,
-                        bool     readable,
-                        QObject *parent = nullptr);
+    explicit IBusDevice(BusDevice &device, QObject *parent = nullptr);
     virtual ~IBusDevice() = 0;
 
-    bool writable() const { return _writable; }
-    bool readable() const { return _readable; }
+    bool writable() const { return _device.writable(); }
+    bool readable() const { return _device.readable(); }
 
-    addressType lowerAddress() const { return _lower_address_range; }
-    addressType upperAddress() const { return _upper_address_range; }
+    addressType lowerAddress() const { return _device.lowerAddress(); }
+    addressType upperAddress() const { return _device.upperAddress(); }
 
-    bool handlesAddress(addressType address) const;
+    bool handlesAddress(addressType address) const { return _device.handlesAddress(address); }
+
+    /** The device this represents, for attaching to a SystemBus.
+     *
+     */
+    BusDevice &device() { return _device; }
+
+    /** Accesses @p length bytes at once, starting at @p address.
+     *
+     *  @see BusDevice::writeBlock
+     */
+    ///@{
+    void writeBlock(addressType address, const uint8_t *data, size_t length) { _device.writeBlock(address, data, length); }
+    void readBlock(addressType address, uint8_t *data, size_t length, bool read_only) { _device.readBlock(address, data, length, read_only); }
+    ///@}
 
 signals:
 
@@ -30,15 +45,8 @@ public slots:
     void    write(addressType address, uint8_t data);
     uint8_t read(addressType address, bool read_only);
 
-protected:
-    virtual void    writeImplementation(addressType address, uint8_t data) = 0;
-    virtual uint8_t readImplementation(addressType address, bool read_only) = 0;
-
 private:
-    addressType _lower_address_range = 0;
-    addressType _upper_address_range = 0;
-    bool        _writable = false;
-    bool        _readable = false;
+    BusDevice &_device;
 };
 
 #endif // IBUSDEVICE_HPP
@@ -1,6 +1,7 @@
 #include "olc6502.hpp"
 #include <QtQml>
 #include <QDebug>
+#include <QDir>
 #include <ostream>
 
 /*
@@ -80,8 +81,7 @@
 olc6502::olc6502(QObject *parent)
     :
     QObject(parent),
-    _executor{ _registers,
-             [this](InstructionExecutor::addressType address, bool read_only)
+    _executor{ [this](InstructionExecutor::addressType address, bool read_only)
              {
                  return read(address, read_only);
              },
@@ -113,7 +113,8 @@ olc6502::olc6502(QObject *parent)
              {
                  emit statusChanged(new_value);
              }
-           }
+           },
+    _log_path(QDir::temp().filePath(QStringLiteral("6502.trace")))
 {
 }
 
@@ -124,12 +125,17 @@ void olc6502::RegisterType()
 
 uint8_t olc6502::read(addressType address, bool read_only)
 {
+    if (_bus)
+        return _bus->read(address, read_only);
     return emit readSignal(address, read_only);
 }
 
 void olc6502::write(addressType address, uint8_t data)
 {
-    emit writeSignal(address, data);
+    if (_bus)
+        _bus->write(address, data);
+    else
+        emit writeSignal(address, data);
 }
 
 // Forces the 6502 into a known state. This is hard-wired inside the CPU. The
@@ -184,14 +190,83 @@ bool olc6502::complete() const
 
 void olc6502::setLog(bool value)
 {
-    if (value != _log)
+    if (value == _log)
+        return;
+
+    std::string error;
+
+    if (value)
+    {
+        if (!_trace.start(_log_path.toStdString(), error))
+        {
+            qWarning("Cannot trace: %s", error.c_str());
+            return;
+        }
+        _executor.setTraceRecorder(&_trace);
+    }
+    else
+    {
+        _executor.setTraceRecorder(nullptr);
+        if (!_trace.stop(error))
+            qWarning("%s", error.c_str());
+    }
+    _log = value;
+    emit logChanged();
+}
+
+void olc6502::setLogPath(const QString &path)
+{
+    if (path != _log_path)
+    {
+        _log_path = path;
+        emit logPathChanged();
+    }
+}
+
+void olc6502::setCoverage(bool value)
+{
+    if (value == _coverage_enabled)
+        return;
+
+    _executor.setCoverageMap(value ? &_coverage : nullptr);
+    _coverage_enabled = value;
+    emit coverageChanged();
+}
+
+bool olc6502::saveCoverage(const QUrl &file) const
+{
+    const QString path = file.isLocalFile() ? file.toLocalFile() : file.toString();
+    std::string   error;
+
+    if (!_coverage.save(path.toStdString(), error, CoverageMap::formatOf(path.toStdString())))
+    {
+        qWarning("%s", error.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool olc6502::loadCoverage(const QUrl &file)
+{
+    const QString path = file.isLocalFile() ? file.toLocalFile() : file.toString();
+    std::string   error;
+
+    if (!_coverage.load(path.toStdString(), error, CoverageMap::formatOf(path.toStdString())))
     {
-        _log = value;
-        emit logChanged();
+        qWarning("%s", error.c_str());
+        return false;
     }
+    emit coverageMapChanged();
+    return true;
+}
+
+void olc6502::clearCoverage()
+{
+    _coverage.clear();
+    emit coverageMapChanged();
 }
 
 auto olc6502::disassemble(addressType start, addressType stop) -> disassemblyType
 {
-    return _executor.disassemble(start, stop);
+    return _executor.disassemble(start, stop, &_coverage);
 }
@@ -79,10 +79,16 @@
 
 #include <QObject>
 #include <QPointer>
+#include <QString>
+#include <QUrl>
 #include <string>
 #include <map>
+#include "accesscounters.hpp"
+#include "coveragemap.hpp"
 #include "registers.hpp"
 #include "instructionexecutor.hpp"
+#include "systembus.hpp"
+#include "tracerecorder.hpp"
 
 
 class olc6502 : public QObject
@@ -97,6 +103,8 @@ class olc6502 : public QObject
     Q_PROPERTY(int status       READ property_status NOTIFY statusChanged)
 
     Q_PROPERTY(bool log         READ log             WRITE setLog NOTIFY logChanged)
+    Q_PROPERTY(QString logPath  READ logPath         WRITE setLogPath NOTIFY logPathChanged)
+    Q_PROPERTY(bool coverage    READ coverage        WRITE setCoverage NOTIFY coverageChanged)
 public:
     using addressType = uint16_t;
     using disassemblyType = std::map<addressType, std::string>;
@@ -117,23 +125,75 @@ public:
     // clocking every cycle
     bool complete() const;
 
-    uint8_t a() const { return _registers.a; }
-    uint8_t x() const { return _registers.x; }
-    uint8_t y() const { return _registers.y; }
+    uint8_t a() const { return _executor.registers().a; }
+    uint8_t x() const { return _executor.registers().x; }
+    uint8_t y() const { return _executor.registers().y; }
 
-    uint16_t pc() const { return _registers.program_counter; }
-    uint8_t  stackPointer() const { return _registers.stack_pointer; }
-    uint8_t  status() const { return _registers.status; }
+    uint16_t pc() const { return _executor.registers().program_counter; }
+    uint8_t  stackPointer() const { return _executor.registers().stack_pointer; }
+    uint8_t  status() const { return _executor.status(); }
 
-    const Registers &registers() const { return _registers; }
-          Registers &registers()       { return _registers; }
+    const Registers &registers() const { return _executor.registers(); }
+          Registers &registers()       { return _executor.registers(); }
+
+    // See InstructionExecutor::setLazyFlags()
+    bool lazyFlags() const { return _executor.lazyFlags(); }
+    void setLazyFlags(bool enabled) { _executor.setLazyFlags(enabled); }
 
     uint32_t clockTicks() const { return _executor.clock_ticks; }
 
+    // See InstructionExecutor::statistics()
+    const ExecutionStatistics &statistics() const { return _executor.statistics(); }
+    void resetStatistics() { _executor.resetStatistics(); }
+
+    // See InstructionExecutor::setAccessCounters()
+    void setAccessCounters(AccessCounters *counters) { _executor.setAccessCounters(counters); }
+    AccessCounters *accessCounters() const { return _executor.accessCounters(); }
+
+    // See InstructionExecutor::saveState()
+    void saveState(InstructionExecutor::Snapshot &snapshot) const { _executor.saveState(snapshot); }
+    void restoreState(const InstructionExecutor::Snapshot &snapshot) { _executor.restoreState(snapshot); }
+
+    /** Tracing every instruction executed to the file at logPath(), see
+     *  TraceRecorder.  Switching it on again starts a new trace.
+     */
+    ///@{
     bool log() const { return _log; }
     void setLog(bool value);
 
+    QString logPath() const { return _log_path; }
+    void    setLogPath(const QString &path); ///< Takes effect when log is next switched on
+    ///@}
+
+    /** Marking every byte executed, read or written in coverageMap(), see
+     *  CoverageMap.  Switching it off keeps what has been marked.
+     */
+    ///@{
+    bool coverage() const { return _coverage_enabled; }
+    void setCoverage(bool value);
+
+    const CoverageMap &coverageMap() const { return _coverage; }
+    ///@}
+
+    /** Saves coverageMap() to @p file, or replaces it with the one in
+     *  @p file, or empties it.  A file ending in .cdl is a code/data log,
+     *  see CoverageMap::formatOf().
+     *
+     *  @return false if the file couldn't be written or read
+     */
+    ///@{
+    Q_INVOKABLE bool saveCoverage(const QUrl &file) const;
+    Q_INVOKABLE bool loadCoverage(const QUrl &file);
+    Q_INVOKABLE void clearCoverage();
+    ///@}
+
+    // Bytes coverageMap() has only seen used as data come out as data
     auto disassemble(addressType start, addressType stop) -> disassemblyType;
+
+    /** Connects the CPU directly to @p bus, bypassing readSignal() and
+     *  writeSignal().  Pass nullptr to go back to the signals.
+     */
+    void setBus(SystemBus *bus) { _bus = bus; }
 public slots:
     void clock(); ///< Executes one clock tick
 
@@ -152,12 +212,20 @@ signals:
     void statusChanged(uint8_t new_value);
 
     void logChanged();
+    void logPathChanged();
+
+    void coverageChanged();
+    void coverageMapChanged(); ///< Loaded or cleared, rather than marked as the CPU runs
 
 private:
-    // Assisstive variables to facilitate emulation
-    Registers _registers;
+    // Assisstive variables to facilitate emulation.  The executor owns the registers.
     InstructionExecutor _executor;
+    SystemBus          *_bus = nullptr;
     bool     _log = false;
+    QString  _log_path;
+    TraceRecorder _trace;
+    CoverageMap   _coverage;
+    bool          _coverage_enabled = false;
 
     // These only exist to get around the QML type system.  It only really knows about
     // int, which is OK because in this case, all unsigned 8-bit values exist within the
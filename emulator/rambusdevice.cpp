@@ -1,36 +1,44 @@
 #include "rambusdevice.hpp"
 #include <QtQml>
-#include <algorithm>
 
 
+// The base class only keeps a reference to _ram, so it doesn't matter
+// that the memory is constructed after it.
 RamBusDevice::RamBusDevice()
     :
-    IBusDevice(0x0000, 0xFFFF, true, true)
+    IBusDevice(_ram)
 {
-    std::fill( std::begin(_data), std::end(_data), 0);
+    _ram.setWriteObserver([this](addressType address, uint8_t data)
+                          {
+                              emit memoryChanged(address, data);
+                          });
+    _ram.setBlockWriteObserver([this](addressType, size_t)
+                               {
+                                   emit memoryLoaded();
+                               });
 }
 
 RamBusDevice::~RamBusDevice()
 {
 }
 
-void RamBusDevice::RegisterType()
+void RamBusDevice::load(const ProgramImage &image)
 {
-    // We won't be creating any of these in QML, so let's
-    // prevent the user from creating any by using this version
-    // of qmlRegisterType.
-    qmlRegisterType<RamBusDevice>();
+    for (const ProgramImage::Segment &segment : image.segments())
+        _ram.load(segment.address, segment.data, segment.length);
+    emit memoryLoaded();
 }
 
-void RamBusDevice::writeImplementation(uint16_t address, uint8_t data)
+void RamBusDevice::load(addressType address, const uint8_t *data, size_t length)
 {
-    _data[address] = data;
-    emit memoryChanged(address, data);
+    _ram.load(address, data, length);
+    emit memoryLoaded();
 }
 
-uint8_t RamBusDevice::readImplementation(uint16_t address, bool read_only)
+void RamBusDevice::RegisterType()
 {
-    Q_UNUSED(read_only);
-
-    return _data[address];
+    // We won't be creating any of these in QML, so let's
+    // prevent the user from creating any by using this version
+    // of qmlRegisterType.
+    qmlRegisterType<RamBusDevice>();
 }
@@ -2,17 +2,20 @@
 #define RAMBUSDEVICE_HPP
 
 #include "ibusdevice.hpp"
-#include <array>
+#include "programimage.hpp"
+#include "ramdevice.hpp"
 
 
 /** Represents a contiguous block of RAM.
  *
+ *  The memory itself is a RamDevice, this adds the memoryChanged() and
+ *  memoryLoaded() signals for the views.
  */
 class RamBusDevice : public IBusDevice
 {
     Q_OBJECT
 public:
-    using memory_type = std::array<uint8_t, 64 * 1024>;
+    using memory_type = RamDevice::memory_type;
 
     RamBusDevice();
    ~RamBusDevice() override;
@@ -26,7 +29,20 @@ public:
     *
     *  @return A reference to the underlying memory
     */
-   const memory_type &memory() const { return _data; }
+   const memory_type &memory() const { return _ram.memory(); }
+
+   /** Copies every segment of @p image into memory.
+    *
+    *  The bytes are copied a segment at a time rather than written one by
+    *  one, and memoryLoaded() is emitted once at the end instead of
+    *  memoryChanged() for each of them.
+    */
+   void load(const ProgramImage &image);
+
+   /** Copies @p length bytes of @p data into memory, starting at @p address,
+    *  and emits memoryLoaded().
+    */
+   void load(addressType address, const uint8_t *data, size_t length);
 
 public slots:
 
@@ -44,12 +60,18 @@ signals:
      */
     void memoryChanged(addressType address, uint8_t data);
 
-protected:
-    void    writeImplementation(addressType address, uint8_t data) override;
-    uint8_t readImplementation(addressType address, bool read_only) override;
+    /** A signal saying that a lot of the memory may have changed at once.
+     *
+     *  Anything showing the memory should look at all of it again.  This
+     *  is emitted once for each load() and each block written through the
+     *  bus.
+     *
+     *  @see load
+     */
+    void memoryLoaded();
 
 private:
-    memory_type _data;
+    RamDevice _ram;
 };
 
 #endif // RAMBUSDEVICE_HPP
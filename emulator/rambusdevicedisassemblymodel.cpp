@@ -48,6 +48,8 @@ void RamBusDeviceDisassemblyModel::setCpuModel(olc6502 *new_cpu_model)
         {
             new_cpu_model->disconnect(new_cpu_model, &olc6502::pcChanged,
                                       this,          &RamBusDeviceDisassemblyModel::onCpuProgramCounterChanged);
+            _cpu_model->disconnect(_cpu_model, &olc6502::coverageMapChanged,
+                                   this,       &RamBusDeviceDisassemblyModel::onCpuCoverageMapChanged);
         }
         _cpu_model = new_cpu_model;
 
@@ -56,6 +58,8 @@ void RamBusDeviceDisassemblyModel::setCpuModel(olc6502 *new_cpu_model)
         {
             new_cpu_model->connect(new_cpu_model, &olc6502::pcChanged,
                                    this,          &RamBusDeviceDisassemblyModel::onCpuProgramCounterChanged);
+            new_cpu_model->connect(new_cpu_model, &olc6502::coverageMapChanged,
+                                   this,          &RamBusDeviceDisassemblyModel::onCpuCoverageMapChanged);
         }
         emit cpuModelChanged();
 
@@ -110,6 +114,11 @@ void RamBusDeviceDisassemblyModel::onCpuProgramCounterChanged(uint16_t address)
     calculateVisibleDisassembly();
 }
 
+void RamBusDeviceDisassemblyModel::onCpuCoverageMapChanged()
+{
+    calculateVisibleDisassemblyIfNecessary();
+}
+
 void RamBusDeviceDisassemblyModel::retrieveDisassembly()
 {
     if (memoryModel() && cpuModel())
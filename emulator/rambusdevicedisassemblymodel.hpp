@@ -101,6 +101,7 @@ public slots:
 
 private slots:
     void onCpuProgramCounterChanged(uint16_t address);
+    void onCpuCoverageMapChanged(); ///< A code/data log was loaded, so the data can be told from the code
 
 private:
     RamBusDevice             *_memory_model = nullptr;
@@ -106,6 +106,8 @@ void RamBusDeviceTableModel::setMemoryModel(RamBusDevice *new_model)
         {
             _model->disconnect(_model, &RamBusDevice::memoryChanged,
                                this,   &RamBusDeviceTableModel::onMemoryChanged);
+            _model->disconnect(_model, &RamBusDevice::memoryLoaded,
+                               this,   &RamBusDeviceTableModel::onMemoryLoaded);
         }
         _model = new_model;
 
@@ -114,6 +116,8 @@ void RamBusDeviceTableModel::setMemoryModel(RamBusDevice *new_model)
         {
             new_model->connect(new_model, &RamBusDevice::memoryChanged,
                                this,      &RamBusDeviceTableModel::onMemoryChanged);
+            new_model->connect(new_model, &RamBusDevice::memoryLoaded,
+                               this,      &RamBusDeviceTableModel::onMemoryLoaded);
         }
         fill();
         emit memoryModelChanged();
@@ -135,6 +139,11 @@ void RamBusDeviceTableModel::onMemoryChanged(RamBusDevice::addressType address,
     }
 }
 
+void RamBusDeviceTableModel::onMemoryLoaded()
+{
+    fill();
+}
+
 uint16_t RamBusDeviceTableModel::rowToAddress(int row) const
 {
     return static_cast<uint16_t>((page() << 8) + (row * 16));
@@ -95,6 +95,11 @@ private slots:
      */
     void onMemoryChanged(RamBusDevice::addressType address, uint8_t value);
 
+    /** Catches the memoryLoaded signal from @c RamBusDevice
+     *
+     */
+    void onMemoryLoaded();
+
 private:
     /** Converts a view's row number to an address within the underlying model.
      *
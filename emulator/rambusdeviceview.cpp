@@ -1,4 +1,5 @@
 #include "rambusdeviceview.hpp"
+#include <QColor>
 #include <QPainter>
 #include <QtQml>
 #include <QTextStream>
@@ -59,6 +60,22 @@ QString generatePageOfText(const RamBusDevice::memory_type &memory, int page)
     }
     return text;
 }
+
+// Behind a byte, by what the CPU has done with it.  Invalid if nothing.
+QColor coverageColor(uint8_t flags)
+{
+    if (flags & CoverageMap::Opcode)
+        return QColor(0x00, 0x80, 0x00);
+    if (flags & CoverageMap::Operand)
+        return QColor(0x00, 0x50, 0x00);
+    if (flags & CoverageMap::IndirectPointer)
+        return QColor(0x80, 0x00, 0x80);
+    if (flags & CoverageMap::Written)
+        return QColor(0x90, 0x00, 0x00);
+    if (flags & CoverageMap::Read)
+        return QColor(0x80, 0x60, 0x00);
+    return QColor();
+}
 }
 
 RamBusDeviceView::RamBusDeviceView(QQuickItem *parent)
@@ -90,6 +107,8 @@ void RamBusDeviceView::setModel(RamBusDevice *new_model)
         {
             _model->disconnect(_model, &RamBusDevice::memoryChanged,
                                this,   &RamBusDeviceView::onMemoryChanged);
+            _model->disconnect(_model, &RamBusDevice::memoryLoaded,
+                               this,   &RamBusDeviceView::onMemoryLoaded);
         }
         _model = new_model;
 
@@ -97,6 +116,8 @@ void RamBusDeviceView::setModel(RamBusDevice *new_model)
         {
             new_model->connect(new_model, &RamBusDevice::memoryChanged,
                                this,      &RamBusDeviceView::onMemoryChanged);
+            new_model->connect(new_model, &RamBusDevice::memoryLoaded,
+                               this,      &RamBusDeviceView::onMemoryLoaded);
 
             // Let's go ahead and fill in the content to display...
             _content = generatePageOfText(model()->memory(), page());
@@ -114,6 +135,36 @@ void RamBusDeviceView::setPage(int new_page)
     }
 }
 
+void RamBusDeviceView::setCpu(olc6502 *new_cpu)
+{
+    if (new_cpu != _cpu)
+    {
+        if (_cpu)
+        {
+            _cpu->disconnect(_cpu, &olc6502::pcChanged,          this, &RamBusDeviceView::onCpuCoverageChanged);
+            _cpu->disconnect(_cpu, &olc6502::coverageMapChanged, this, &RamBusDeviceView::onCpuCoverageChanged);
+        }
+        _cpu = new_cpu;
+        if (new_cpu)
+        {
+            new_cpu->connect(new_cpu, &olc6502::pcChanged,          this, &RamBusDeviceView::onCpuCoverageChanged);
+            new_cpu->connect(new_cpu, &olc6502::coverageMapChanged, this, &RamBusDeviceView::onCpuCoverageChanged);
+        }
+        emit cpuChanged();
+        QQuickPaintedItem::update();
+    }
+}
+
+void RamBusDeviceView::setShowCoverage(bool show)
+{
+    if (show != _show_coverage)
+    {
+        _show_coverage = show;
+        emit showCoverageChanged();
+        QQuickPaintedItem::update();
+    }
+}
+
 void RamBusDeviceView::onMemoryChanged(RamBusDevice::addressType address, uint8_t value)
 {
     Q_UNUSED(address);
@@ -123,11 +174,49 @@ void RamBusDeviceView::onMemoryChanged(RamBusDevice::addressType address, uint8_
     QQuickPaintedItem::update();
 }
 
+void RamBusDeviceView::onMemoryLoaded()
+{
+    _content = generatePageOfText(model()->memory(), page());
+    QQuickPaintedItem::update();
+}
+
+void RamBusDeviceView::onCpuCoverageChanged()
+{
+    // Reads don't signal anything, so every instruction might have added some
+    if (showCoverage())
+        QQuickPaintedItem::update();
+}
+
 void RamBusDeviceView::paint(QPainter *painter)
 {
     if (!model())
         return;
+    if (showCoverage() && cpu())
+        paintCoverage(painter);
     painter->setPen(_pen);
     painter->setFont(_font);
     painter->drawText(boundingRect(), _content);
 }
+
+void RamBusDeviceView::paintCoverage(QPainter *painter)
+{
+    const QFontMetrics metrics(_font);
+    const int          char_width = metrics.averageCharWidth();
+    const int          line_height = metrics.lineSpacing();
+    const CoverageMap &coverage = cpu()->coverageMap();
+
+    // Each line is "$0000: " and then the bytes, three characters apiece
+    for (int linenumber = 0; linenumber < 16; ++linenumber)
+    {
+        const uint16_t line_address = addressOfLine(page(), linenumber);
+
+        for (int column = 0; column < 16; ++column)
+        {
+            const QColor color = coverageColor(coverage.flags(static_cast<uint16_t>(line_address + column)));
+
+            if (color.isValid())
+                painter->fillRect((DisplayCellsOfAddress + 3 + column * DisplayCellsOfByte) * char_width, linenumber * line_height,
+                                  2 * char_width, line_height, color);
+        }
+    }
+}
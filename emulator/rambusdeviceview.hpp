@@ -4,6 +4,7 @@
 #include <QQuickPaintedItem>
 #include <QPen>
 #include <QFont>
+#include "olc6502.hpp"
 #include "rambusdevice.hpp"
 
 
@@ -13,6 +14,8 @@ class RamBusDeviceView : public QQuickPaintedItem
 
     Q_PROPERTY(RamBusDevice *model READ model WRITE setModel NOTIFY modelChanged)
     Q_PROPERTY(int           page  READ page  WRITE setPage  NOTIFY pageChanged)
+    Q_PROPERTY(olc6502      *cpu   READ cpu   WRITE setCpu   NOTIFY cpuChanged)
+    Q_PROPERTY(bool          showCoverage READ showCoverage WRITE setShowCoverage NOTIFY showCoverageChanged)
 public:
     RamBusDeviceView(QQuickItem *parent = nullptr);
 
@@ -48,6 +51,18 @@ public:
      */
     void setPage(int new_page);
 
+    /** The CPU whose coverage map colours the bytes, when showCoverage()
+     *  is on: executed as opcodes or operands, used as pointers, written
+     *  and read, in that order of precedence.
+     */
+    ///@{
+    olc6502 *cpu() const { return _cpu; }
+    void     setCpu(olc6502 *new_cpu);
+
+    bool showCoverage() const { return _show_coverage; }
+    void setShowCoverage(bool show);
+    ///@}
+
     void paint(QPainter *painter) override;
 signals:
     /** Emitted when the underlying model is set or reset.
@@ -64,12 +79,19 @@ signals:
      */
     void pageChanged();
 
+    void cpuChanged();
+    void showCoverageChanged();
+
 private:
     RamBusDevice *_model = nullptr;
     int           _page  = 0x00;
     QPen          _pen   { Qt::GlobalColor::white };
     QFont         _font  { "Lucida Console", 12 };
     QString       _content;
+    olc6502      *_cpu   = nullptr;
+    bool          _show_coverage = false;
+
+    void paintCoverage(QPainter *painter);
 
 private slots:
     /** Catched the memoryChanged signal from @c RamBusDevice
@@ -78,6 +100,17 @@ private slots:
      *  @param value   The value it was changed to
      */
     void onMemoryChanged(RamBusDevice::addressType address, uint8_t value);
+
+    /** Catches the memoryLoaded signal from @c RamBusDevice
+     *
+     */
+    void onMemoryLoaded();
+
+    /** Repaints as the CPU runs, or a code/data log is loaded, when
+     *  showing coverage
+     *
+     */
+    void onCpuCoverageChanged();
 };
 
 #endif // RAMBUSDEVICEVIEW_HPP
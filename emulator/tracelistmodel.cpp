@@ -0,0 +1,220 @@
+#include "tracelistmodel.hpp"
+#include "opcodes.hpp"
+#include <QtQml>
+#include <algorithm>
+#include <limits>
+#include <string>
+
+
+namespace
+{
+// The instruction as InstructionExecutor::disassemble() shows it, but from
+// the bytes in the trace rather than whatever is in memory now
+QString Disassemble(const TraceRecord &record)
+{
+    const unsigned operand = record.operands[0] | (record.operands[1] << 8);
+    const QString  name = QString::fromLatin1(MnemonicOf(record.opcode)) + ' ';
+
+    switch (AddressModeOf(record.opcode))
+    {
+    case AddressMode_e::Implied:
+    case AddressMode_e::Accumulator:
+        return name + " {IMP}";
+    case AddressMode_e::Immediate:
+        return name + QString::asprintf("#$%02X {IMM}", record.operands[0]);
+    case AddressMode_e::ZeroPage:
+        return name + QString::asprintf("$%02X {ZP0}", record.operands[0]);
+    case AddressMode_e::ZeroPageXIndexed:
+        return name + QString::asprintf("$%02X, X {ZPX}", record.operands[0]);
+    case AddressMode_e::ZeroPageYIndexed:
+        return name + QString::asprintf("$%02X, Y {ZPY}", record.operands[0]);
+    case AddressMode_e::XIndexedIndirect:
+        return name + QString::asprintf("($%02X, X) {IZX}", record.operands[0]);
+    case AddressMode_e::IndirectYIndexed:
+        return name + QString::asprintf("($%02X), Y {IZY}", record.operands[0]);
+    case AddressMode_e::Absolute:
+        return name + QString::asprintf("$%04X {ABS}", operand);
+    case AddressMode_e::AbsoluteXIndexed:
+        return name + QString::asprintf("$%04X, X {ABX}", operand);
+    case AddressMode_e::AbsoluteYIndexed:
+        return name + QString::asprintf("$%04X, Y {ABY}", operand);
+    case AddressMode_e::Indirect:
+        return name + QString::asprintf("($%04X) {IND}", operand);
+    case AddressMode_e::Relative:
+        return name + QString::asprintf("$%02X [$%04X] {REL}", record.operands[0], record.effective_address);
+    }
+    return name;
+}
+
+QString BytesOf(const TraceRecord &record)
+{
+    QString bytes = QString::asprintf("%02X", record.opcode);
+
+    for (uint8_t i = 0; i + 1 < record.length; ++i)
+        bytes += QString::asprintf(" %02X", record.operands[i]);
+    return bytes;
+}
+}
+
+
+TraceListModel::TraceListModel(QObject *parent)
+    :
+    QAbstractListModel(parent)
+{
+}
+
+TraceListModel::~TraceListModel()
+{
+    stopFiltering();
+}
+
+void TraceListModel::RegisterType()
+{
+    qmlRegisterType<TraceListModel>("Qt.example.tracelistmodel",
+                                    1,
+                                    0,
+                                    "TraceListModel");
+}
+
+int TraceListModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return 0;
+
+    // A view can't have more rows than an int counts, however long the trace
+    const uint64_t rows = _filtered ? _rows.size() : _view.records();
+
+    return static_cast<int>(std::min<uint64_t>(rows, std::numeric_limits<int>::max()));
+}
+
+QVariant TraceListModel::data(const QModelIndex &index, int role) const
+{
+    TraceRecord record;
+
+    if (!index.isValid() || (index.row() >= rowCount()) || !_view.record(recordOfRow(index.row()), record))
+        return QVariant();
+
+    switch (role)
+    {
+    case CycleRole:
+        return QVariant(static_cast<qulonglong>(record.cycle));
+    case AddressRole:
+        return QVariant(QString::asprintf("$%04X", record.program_counter));
+    case BytesRole:
+        return QVariant(BytesOf(record));
+    case DisassemblyRole:
+        return QVariant(Disassemble(record));
+    case RegistersRole:
+        return QVariant(QString::asprintf("A:%02X X:%02X Y:%02X P:%02X SP:%02X", record.a, record.x, record.y,
+                                          record.status, record.stack_pointer));
+    case EffectiveAddressRole:
+        return QVariant(QString::asprintf("$%04X", record.effective_address));
+    default:
+        return QVariant();
+    }
+}
+
+void TraceListModel::setFile(const QUrl &file)
+{
+    if (file == _file)
+        return;
+
+    const bool  was_filtering = filtering();
+    std::string error;
+
+    stopFiltering();
+    beginResetModel();
+    _file = file;
+    _error.clear();
+    _filtered = false;
+    _rows.clear();
+    _view.close();
+    if (!file.isEmpty() && !_view.open(file.toLocalFile().toStdString(), error))
+        _error = QString::fromStdString(error);
+    endResetModel();
+    emit fileChanged();
+    emit countChanged();
+    if (was_filtering)
+        emit filteringChanged();
+}
+
+void TraceListModel::setFilter(int lowest_address, int highest_address, int opcode, int effective_address)
+{
+    TraceFilter filter;
+
+    filter.lowest_program_counter = static_cast<uint16_t>(qBound(0, lowest_address, 0xFFFF));
+    filter.highest_program_counter = static_cast<uint16_t>(qBound(0, highest_address, 0xFFFF));
+    if (opcode >= 0)
+        filter.opcode = static_cast<uint8_t>(opcode);
+    if (effective_address >= 0)
+        filter.effective_address = static_cast<uint16_t>(effective_address);
+    if (filter.keepsEverything())
+    {
+        clearFilter();
+        return;
+    }
+
+    stopFiltering();
+    _cancel_filter.store(false);
+
+    const quint64 generation = ++_filter_generation;
+
+    _filter_thread = std::thread([this, filter, generation]
+    {
+        _view.filter(filter, _filtered_rows, &_cancel_filter);
+        QMetaObject::invokeMethod(this, "onFilterFinished", Qt::QueuedConnection, Q_ARG(quint64, generation));
+    });
+    emit filteringChanged();
+}
+
+void TraceListModel::clearFilter()
+{
+    const bool was_filtering = filtering();
+
+    stopFiltering();
+    if (_filtered)
+    {
+        beginResetModel();
+        _filtered = false;
+        _rows.clear();
+        endResetModel();
+        emit countChanged();
+    }
+    if (was_filtering)
+        emit filteringChanged();
+}
+
+int TraceListModel::rowOfCycle(qulonglong cycle)
+{
+    const uint64_t record = _view.recordOfCycle(cycle);
+    uint64_t       row = record;
+
+    if (_filtered)
+        row = static_cast<uint64_t>(std::lower_bound(_rows.begin(), _rows.end(), record) - _rows.begin());
+    return static_cast<int>(std::min<uint64_t>(row, static_cast<uint64_t>(std::max(rowCount() - 1, 0))));
+}
+
+void TraceListModel::stopFiltering()
+{
+    if (!_filter_thread.joinable())
+        return;
+    _cancel_filter.store(true);
+    _filter_thread.join();
+    // Whatever it posted is now out of date
+    ++_filter_generation;
+}
+
+void TraceListModel::onFilterFinished(quint64 generation)
+{
+    if ((generation != _filter_generation) || !_filter_thread.joinable())
+        return;
+
+    _filter_thread.join();
+    beginResetModel();
+    _filtered = true;
+    _rows.swap(_filtered_rows);
+    _filtered_rows.clear();
+    endResetModel();
+    emit countChanged();
+    emit filteringChanged();
+}
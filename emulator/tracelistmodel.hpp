@@ -0,0 +1,113 @@
+#ifndef TRACELISTMODEL_HPP
+#define TRACELISTMODEL_HPP
+
+#include <QAbstractListModel>
+#include <QString>
+#include <QUrl>
+#include "traceview.hpp"
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+
+/** A row per record of a trace file, for a ListView to scroll through.
+ *
+ *  The file is mapped rather than read, and a record is only decoded when
+ *  its row is asked for, so traces of any length open straight away and
+ *  only what is on screen is ever decoded.
+ *
+ *  Filtering scans the whole trace on a thread of its own for the records
+ *  to keep, and the rows become those once it has finished.  Until then
+ *  the rows stay as they were, and filtering is true.
+ */
+class TraceListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+    Q_PROPERTY(QUrl    file      READ file      WRITE setFile NOTIFY fileChanged)
+    Q_PROPERTY(QString error     READ error                   NOTIFY fileChanged)
+    Q_PROPERTY(qint64  records   READ records                 NOTIFY fileChanged)
+    Q_PROPERTY(int     count     READ count                   NOTIFY countChanged)
+    Q_PROPERTY(bool    filtering READ filtering               NOTIFY filteringChanged)
+public:
+    explicit TraceListModel(QObject *parent = nullptr);
+    ~TraceListModel() override;
+
+    enum Roles {
+        CycleRole = Qt::UserRole + 1,
+        AddressRole,
+        BytesRole,
+        DisassemblyRole,
+        RegistersRole,
+        EffectiveAddressRole
+    };
+    Q_ENUM(Roles)
+
+    QHash<int, QByteArray> roleNames() const override {
+        return {
+            { CycleRole,            "cycle" },
+            { AddressRole,          "address" },
+            { BytesRole,            "bytes" },
+            { DisassemblyRole,      "disassembly" },
+            { RegistersRole,        "registers" },
+            { EffectiveAddressRole, "effectiveAddress" }
+        };
+    }
+
+    static void RegisterType();
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    QUrl file() const { return _file; }
+
+    /** Opens the trace file at @p file, or closes the one that is open if
+     *  it is empty.  error says why, if it couldn't be opened.
+     *
+     */
+    void setFile(const QUrl &file);
+
+    QString error() const { return _error; }
+    qint64  records() const { return static_cast<qint64>(_view.records()); }
+    int     count() const { return rowCount(); }
+    bool    filtering() const { return _filter_thread.joinable(); }
+
+    /** Keeps only the records within a range of PCs, and optionally with one
+     *  opcode or effective address, which are ignored if -1.
+     *
+     */
+    Q_INVOKABLE void setFilter(int lowest_address, int highest_address, int opcode, int effective_address);
+    Q_INVOKABLE void clearFilter();
+
+    /** The row of the first record at or after @p cycle, for scrolling to.
+     *
+     */
+    Q_INVOKABLE int rowOfCycle(qulonglong cycle);
+
+signals:
+    void fileChanged();
+    void countChanged();
+    void filteringChanged();
+
+private:
+    QUrl                  _file;
+    QString               _error;
+    mutable TraceView     _view; // Keeps the chunks that were last on screen
+    bool                  _filtered = false;
+    std::vector<uint64_t> _rows; // Record numbers, while filtered
+    std::thread           _filter_thread;
+    std::atomic<bool>     _cancel_filter{ false };
+    std::vector<uint64_t> _filtered_rows; // Only touched by _filter_thread until it is joined
+    quint64               _filter_generation = 0; // Tells a finished filter from one that was replaced
+
+    uint64_t recordOfRow(int row) const { return _filtered ? _rows[static_cast<size_t>(row)] : static_cast<uint64_t>(row); }
+
+    void stopFiltering();
+
+private slots:
+    void onFilterFinished(quint64 generation);
+};
+
+#endif // TRACELISTMODEL_HPP
@@ -1,9 +1,18 @@
 TEMPLATE = subdirs
 
 SUBDIRS += \
+    core \
     emulator \
     app \
-    unit_tests
+    unit_tests \
+    benchmarks \
+    runner
+
+emulator.depends = core
+app.depends = emulator
+unit_tests.depends = emulator
+benchmarks.depends = core
+runner.depends = core
 
 DISTFILES += \
     README.md \
@@ -0,0 +1,30 @@
+#include "haltdevice.hpp"
+
+
+HaltDevice::HaltDevice(addressType address, const RamDevice &ram, Scheduler &scheduler)
+    :
+    BusDevice(address, address, false, true),
+    _ram(ram),
+    _scheduler(scheduler)
+{
+}
+
+HaltDevice::~HaltDevice()
+{
+}
+
+void HaltDevice::writeImplementation(addressType, uint8_t)
+{
+    // Not writable, writes go to the RAM alone
+}
+
+uint8_t HaltDevice::readImplementation(addressType address, bool read_only)
+{
+    // Disassembly and the like peek without side effects
+    if (!read_only)
+    {
+        _reached = true;
+        _scheduler.stop();
+    }
+    return _ram.memory()[address];
+}
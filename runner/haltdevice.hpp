@@ -0,0 +1,35 @@
+#ifndef HALTDEVICE_HPP
+#define HALTDEVICE_HPP
+
+#include "busdevice.hpp"
+#include "ramdevice.hpp"
+#include "scheduler.hpp"
+
+
+/** Stops the scheduler when the CPU reads a particular address.
+ *
+ *  Attached after the RAM, it answers reads of its address with whatever
+ *  the RAM holds there, so the program can't tell it is there.  The
+ *  instruction doing the read is finished before the run actually stops.
+ *  Normally the read is an opcode fetch, but a data read of the address
+ *  stops the run just the same.
+ */
+class HaltDevice : public BusDevice
+{
+public:
+    HaltDevice(addressType address, const RamDevice &ram, Scheduler &scheduler);
+   ~HaltDevice() override;
+
+    bool reached() const { return _reached; }
+
+protected:
+    void    writeImplementation(addressType address, uint8_t data) override;
+    uint8_t readImplementation(addressType address, bool read_only) override;
+
+private:
+    const RamDevice &_ram;
+    Scheduler       &_scheduler;
+    bool             _reached = false;
+};
+
+#endif // HALTDEVICE_HPP
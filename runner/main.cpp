@@ -0,0 +1,342 @@
+#include "computercore.hpp"
+#include "coveragemap.hpp"
+#include "cycleprofiler.hpp"
+#include "haltdevice.hpp"
+#include "options.hpp"
+#include "tracecomparer.hpp"
+#include "tracerecorder.hpp"
+#include "trapdevice.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+namespace
+{
+// How long to run between checks for the comparison being done.  A halt or
+// a trap stops the run right away.
+constexpr uint32_t batch_cycles = 100000;
+
+// How many subroutines and instructions a profile lists
+constexpr size_t profile_lines = 30;
+
+enum class StopReason
+{
+    CycleLimit,
+    Halted,
+    Trapped,
+    Compared
+};
+
+const char *Describe(StopReason reason)
+{
+    switch (reason)
+    {
+    case StopReason::CycleLimit:
+        return "ran every cycle";
+    case StopReason::Halted:
+        return "reached the halt address";
+    case StopReason::Trapped:
+        return "trapped";
+    case StopReason::Compared:
+        return "finished comparing";
+    }
+    return "";
+}
+
+void PrintHex(std::ostream &output, const char *name, unsigned value, int digits)
+{
+    output << name << ":$" << std::hex << std::uppercase << std::setfill('0') << std::setw(digits) << value
+           << std::dec << std::setfill(' ') << ' ';
+}
+
+void PrintRegisters(std::ostream &output, const Registers &registers)
+{
+    PrintHex(output, "A", registers.a, 2);
+    PrintHex(output, "X", registers.x, 2);
+    PrintHex(output, "Y", registers.y, 2);
+    PrintHex(output, "SP", registers.stack_pointer, 2);
+    PrintHex(output, "PC", registers.program_counter, 4);
+    PrintHex(output, "P", registers.status, 2);
+
+    const char *names = "NV-BDIZC";
+
+    for (int bit = 7; bit >= 0; --bit)
+        output << ((registers.status & (1 << bit)) ? names[7 - bit] : '.');
+    output << '\n';
+}
+
+// A line in the style of a nestest log, without the disassembly
+void PrintTraceRecord(std::ostream &output, const TraceRecord &record)
+{
+    output << std::hex << std::uppercase << std::setfill('0') << std::setw(4) << record.program_counter << "  "
+           << std::setw(2) << unsigned(record.opcode) << ' ';
+    for (uint8_t i = 0; i < 2; ++i)
+    {
+        if (i + 1 < record.length)
+            output << std::setw(2) << unsigned(record.operands[i]) << ' ';
+        else
+            output << "   ";
+    }
+    output << " A:" << std::setw(2) << unsigned(record.a) << " X:" << std::setw(2) << unsigned(record.x)
+           << " Y:" << std::setw(2) << unsigned(record.y) << " P:" << std::setw(2) << unsigned(record.status)
+           << " SP:" << std::setw(2) << unsigned(record.stack_pointer) << " EA:" << std::setw(4) << record.effective_address
+           << std::dec << std::setfill(' ') << " CYC:" << record.cycle << '\n';
+}
+
+void PrintComparison(std::ostream &output, const TraceComparer &comparer, const std::string &path)
+{
+    switch (comparer.result())
+    {
+    case TraceComparer::Result::Matching:
+        output << "Compared:       " << comparer.compared() << " instructions with " << path << ", all the same\n";
+        break;
+    case TraceComparer::Result::ReferenceEnded:
+        output << "Compared:       " << comparer.compared() << " instructions with " << path << ", all the same up to its end\n";
+        break;
+    case TraceComparer::Result::ReferenceDamaged:
+        output << "Compared:       " << comparer.compared() << " instructions with " << path << ", then: " << comparer.error() << '\n';
+        break;
+    case TraceComparer::Result::Diverged:
+    {
+        const TraceComparer::Divergence &divergence = comparer.divergence();
+
+        output << "Diverged:       at instruction " << divergence.index;
+        if (divergence.line)
+            output << " (line " << divergence.line << " of " << path << ")";
+        output << ", in";
+        for (uint16_t field = 1; field <= ReferenceTrace::all_fields; field <<= 1)
+        {
+            if (divergence.fields & field)
+                output << ' ' << TraceComparer::fieldName(field);
+        }
+        output << '\n';
+        for (const TraceRecord &record : divergence.before)
+        {
+            output << "                ";
+            PrintTraceRecord(output, record);
+        }
+        output << "Expected:       ";
+        PrintTraceRecord(output, divergence.expected);
+        output << "Actual:         ";
+        PrintTraceRecord(output, divergence.actual);
+        break;
+    }
+    }
+}
+
+bool WriteProfile(ComputerCore &computer, const CycleProfiler &profiler, const std::string &path, std::string &error)
+{
+    std::ofstream                  output(path);
+    CycleProfiler::disassemblyType disassembly;
+
+    if (!output)
+    {
+        error = "Couldn't write the profile to " + path;
+        return false;
+    }
+    for (CycleProfiler::addressType address : profiler.reportedAddresses(profile_lines))
+        disassembly.merge(computer.cpu().disassemble(address, address));
+    profiler.writeReport(output, disassembly, profile_lines);
+    return true;
+}
+
+bool WriteFlameGraph(const CycleProfiler &profiler, const SymbolTable &symbols, const std::string &path, std::string &error)
+{
+    std::ofstream output(path);
+
+    if (!output)
+    {
+        error = "Couldn't write the call stacks to " + path;
+        return false;
+    }
+    profiler.writeCollapsedStacks(output, symbols);
+    return true;
+}
+}
+
+
+int main(int argc, char *argv[])
+{
+    RunnerOptions options;
+    std::string   error;
+
+    if (!ParseOptions(argc, argv, options, error))
+    {
+        std::cerr << error << "\n\n";
+        PrintUsage(std::cerr, argv[0]);
+        return 1;
+    }
+    if (options.help)
+    {
+        PrintUsage(std::cout, argv[0]);
+        return 0;
+    }
+
+    ProgramImage image;
+
+    if (!image.load(options.image, options.format, options.load_address, error))
+    {
+        std::cerr << error << '\n';
+        return 1;
+    }
+
+    ComputerCore                computer;
+    std::unique_ptr<TrapDevice> trap;
+    std::unique_ptr<HaltDevice> halt;
+
+    computer.cpu().setEngine(options.engine);
+    computer.cpu().setLazyFlags(options.lazy_flags);
+    computer.boot(image);
+    if (options.start_address)
+        computer.resetTo(*options.start_address);
+    // Attached after the reset, so reading the vector can't count as a halt.
+    // The halt goes on top, so it sees its address even inside a trap.
+    if (options.stop_at_trap)
+    {
+        trap = std::make_unique<TrapDevice>(computer.ram(), computer.cpu(), computer.scheduler());
+        computer.bus().attach(*trap);
+    }
+    if (options.halt_address)
+    {
+        halt = std::make_unique<HaltDevice>(*options.halt_address, computer.ram(), computer.scheduler());
+        computer.bus().attach(*halt);
+    }
+
+    TraceRecorder trace;
+
+    if (!options.trace.empty())
+    {
+        if (!trace.start(options.trace, error, options.trace_format))
+        {
+            std::cerr << error << '\n';
+            return 1;
+        }
+        computer.cpu().setTraceRecorder(&trace);
+    }
+
+    TraceComparer comparer;
+
+    if (!options.compare.empty())
+    {
+        if (!comparer.open(options.compare, error) ||
+            !trace.start([&comparer](const TraceRecord *records, size_t count) { comparer.compare(records, count); }, error))
+        {
+            std::cerr << error << '\n';
+            return 1;
+        }
+        computer.cpu().setTraceRecorder(&trace);
+    }
+
+    SymbolTable symbols;
+
+    if (!options.symbols.empty() && !symbols.load(options.symbols, error))
+    {
+        std::cerr << error << '\n';
+        return 1;
+    }
+
+    CycleProfiler profiler;
+
+    if (!options.flame.empty())
+        profiler.setSampleInterval(options.sample_cycles);
+    if (!options.profile.empty() || !options.flame.empty())
+        computer.cpu().setCycleProfiler(&profiler);
+
+    CoverageMap coverage;
+
+    if (!options.coverage.empty())
+        computer.cpu().setCoverageMap(&coverage);
+
+    StopReason reason = StopReason::CycleLimit;
+    const auto started = std::chrono::steady_clock::now();
+
+    while (computer.scheduler().now() < options.cycles)
+    {
+        computer.scheduler().run(static_cast<uint32_t>(std::min<uint64_t>(batch_cycles, options.cycles - computer.scheduler().now())));
+
+        if (halt && halt->reached())
+        {
+            reason = StopReason::Halted;
+            break;
+        }
+        if (trap && trap->reached())
+        {
+            reason = StopReason::Trapped;
+            break;
+        }
+        // Noticed a batch or so late, as comparing runs behind
+        if (comparer.done())
+        {
+            reason = StopReason::Compared;
+            break;
+        }
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    const uint64_t cycles = computer.scheduler().now();
+    const uint64_t instructions = computer.cpu().instructionCount();
+
+    std::cout << "Stopped:        " << Describe(reason) << '\n'
+              << "Cycles:         " << cycles << '\n'
+              << "Instructions:   " << instructions << '\n'
+              << std::fixed << std::setprecision(3)
+              << "Time:           " << seconds << " s\n"
+              << "Emulated clock: " << ((seconds > 0) ? cycles / seconds / 1e6 : 0.0) << " MHz\n"
+              << std::setprecision(0)
+              << "Instructions/s: " << ((seconds > 0) ? instructions / seconds : 0.0) << '\n'
+              << "Registers:      ";
+    PrintRegisters(std::cout, computer.cpu().registers());
+    if (!options.coverage.empty())
+    {
+        std::cout << "Coverage:       " << coverage.count(CoverageMap::Opcode) << " opcodes and "
+                  << coverage.count(CoverageMap::Operand) << " operands executed, "
+                  << coverage.count(CoverageMap::Read) << " bytes read, "
+                  << coverage.count(CoverageMap::Written) << " written\n";
+    }
+
+    computer.cpu().setTraceRecorder(nullptr);
+    if (!trace.stop(error))
+    {
+        std::cerr << error << '\n';
+        return 1;
+    }
+
+    int status = (reason == StopReason::Trapped) ? 2 : 0;
+
+    computer.cpu().setCycleProfiler(nullptr);
+    if (!options.profile.empty() && !WriteProfile(computer, profiler, options.profile, error))
+    {
+        std::cerr << error << '\n';
+        status = 1;
+    }
+    if (!options.flame.empty() && !WriteFlameGraph(profiler, symbols, options.flame, error))
+    {
+        std::cerr << error << '\n';
+        status = 1;
+    }
+    computer.cpu().setCoverageMap(nullptr);
+    if (!options.coverage.empty() && !coverage.save(options.coverage, error, CoverageMap::formatOf(options.coverage)))
+    {
+        std::cerr << error << '\n';
+        status = 1;
+    }
+
+    if (!options.compare.empty())
+    {
+        PrintComparison(std::cout, comparer, options.compare);
+        if (comparer.result() == TraceComparer::Result::Diverged)
+            status = 3;
+        else if (comparer.result() == TraceComparer::Result::ReferenceDamaged)
+            status = 1;
+    }
+
+    // Detached before they go, although nothing runs any more
+    if (halt)
+        computer.bus().detach(*halt);
+    if (trap)
+        computer.bus().detach(*trap);
+    return status;
+}
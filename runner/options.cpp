@@ -0,0 +1,242 @@
+#include "options.hpp"
+#include <stdexcept>
+
+
+namespace
+{
+// Addresses and counts can be given in decimal, or in hex as $FFFC or 0xFFFC.
+bool ParseNumber(std::string text, uint64_t &value)
+{
+    if (!text.empty() && (text[0] == '$'))
+        text = "0x" + text.substr(1);
+
+    try
+    {
+        size_t used = 0;
+
+        value = std::stoull(text, &used, 0);
+        return (used == text.size());
+    }
+    catch (const std::exception &)
+    {
+        return false;
+    }
+}
+
+bool ParseAddress(const std::string &text, InstructionExecutor::addressType &address)
+{
+    uint64_t value = 0;
+
+    if (!ParseNumber(text, value) || (value > 0xFFFF))
+        return false;
+    address = static_cast<InstructionExecutor::addressType>(value);
+    return true;
+}
+
+bool ParseTraceFormat(const std::string &text, TraceRecorder::Format &format)
+{
+    if (text == "raw")
+        format = TraceRecorder::Format::Raw;
+    else if (text == "compact")
+        format = TraceRecorder::Format::Compact;
+    else
+        return false;
+    return true;
+}
+
+bool ParseEngine(const std::string &text, InstructionExecutor::Engine &engine)
+{
+    using Engine = InstructionExecutor::Engine;
+
+    if (text == "table")
+        engine = Engine::Table;
+    else if (text == "threaded")
+        engine = Engine::Threaded;
+    else if (text == "tailcall")
+        engine = Engine::TailCall;
+    else
+        return false;
+    return true;
+}
+}
+
+
+bool ParseOptions(int argc, char *argv[], RunnerOptions &options, std::string &error)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+
+        // Options without a value
+        if ((argument == "--help") || (argument == "-h"))
+        {
+            options.help = true;
+            return true;
+        }
+        if (argument == "--trap")
+        {
+            options.stop_at_trap = true;
+            continue;
+        }
+        if (argument == "--lazy-flags")
+        {
+            options.lazy_flags = true;
+            continue;
+        }
+        if ((argument.size() < 2) || (argument.compare(0, 2, "--") != 0))
+        {
+            if (!options.image.empty())
+            {
+                error = "Only one image can be run at a time";
+                return false;
+            }
+            options.image = argument;
+            continue;
+        }
+
+        // Everything else takes a value
+        if (i + 1 >= argc)
+        {
+            error = argument + " needs a value";
+            return false;
+        }
+
+        const std::string value = argv[++i];
+        bool              valid = false;
+
+        if (argument == "--format")
+            valid = ProgramImage::formatFromName(value, options.format);
+        else if (argument == "--load")
+            valid = ParseAddress(value, options.load_address);
+        else if (argument == "--start")
+        {
+            RunnerOptions::addressType address = 0;
+
+            valid = ParseAddress(value, address);
+            options.start_address = address;
+        }
+        else if (argument == "--halt")
+        {
+            RunnerOptions::addressType address = 0;
+
+            valid = ParseAddress(value, address);
+            options.halt_address = address;
+        }
+        else if (argument == "--trace")
+        {
+            options.trace = value;
+            valid = !value.empty();
+        }
+        else if (argument == "--compare")
+        {
+            options.compare = value;
+            valid = !value.empty();
+        }
+        else if (argument == "--profile")
+        {
+            options.profile = value;
+            valid = !value.empty();
+        }
+        else if (argument == "--flame")
+        {
+            options.flame = value;
+            valid = !value.empty();
+        }
+        else if (argument == "--sample-cycles")
+        {
+            uint64_t cycles = 0;
+
+            valid = ParseNumber(value, cycles) && (cycles > 0) && (cycles <= UINT32_MAX);
+            options.sample_cycles = static_cast<uint32_t>(cycles);
+        }
+        else if (argument == "--coverage")
+        {
+            options.coverage = value;
+            valid = !value.empty();
+        }
+        else if (argument == "--symbols")
+        {
+            options.symbols = value;
+            valid = !value.empty();
+        }
+        else if (argument == "--trace-format")
+            valid = ParseTraceFormat(value, options.trace_format);
+        else if (argument == "--cycles")
+            valid = ParseNumber(value, options.cycles) && (options.cycles > 0);
+        else if (argument == "--engine")
+        {
+            valid = ParseEngine(value, options.engine);
+            if (valid && !InstructionExecutor::engineAvailable(options.engine))
+            {
+                error = "The " + value + " engine was not built with this compiler";
+                return false;
+            }
+        }
+        else
+        {
+            error = "Unknown option " + argument;
+            return false;
+        }
+
+        if (!valid)
+        {
+            error = "Invalid value for " + argument + ": " + value;
+            return false;
+        }
+    }
+
+    if (options.image.empty())
+    {
+        error = "No image to run";
+        return false;
+    }
+    if (!options.trace.empty() && !options.compare.empty())
+    {
+        error = "A run can be traced or compared, but not both";
+        return false;
+    }
+    return true;
+}
+
+void PrintUsage(std::ostream &output, const char *program)
+{
+    output << "Usage: " << program << " [options] image\n"
+              "\n"
+              "Loads a program image into RAM, points the reset vector at it and runs\n"
+              "it without any user interface, then reports how fast it ran.\n"
+              "\n"
+              "  --help, -h       Print this and exit\n"
+              "  --format NAME    raw, ihex, srec, ines or auto (the default)\n"
+              "  --load ADDRESS   Where to load a raw image (default $0000)\n"
+              "  --start ADDRESS  Where to start running (default the image's start\n"
+              "                   address, or where it loads)\n"
+              "  --cycles N       The most clock ticks to run for (default 100000000)\n"
+              "  --halt ADDRESS   Stop when the CPU reads from ADDRESS\n"
+              "  --trap           Stop at an instruction that jumps or branches to itself\n"
+              "  --engine NAME    table, threaded or tailcall\n"
+              "  --lazy-flags     Evaluate the status flags lazily\n"
+              "  --trace FILE     Write a binary trace of every instruction to FILE\n"
+              "  --trace-format NAME\n"
+              "                   compact (the default, delta encoded) or raw\n"
+              "  --compare FILE   Check every instruction against the trace in FILE,\n"
+              "                   either a binary trace or a nestest style text log,\n"
+              "                   and stop where they first differ\n"
+              "  --profile FILE   Write the cycles taken by each subroutine and by the\n"
+              "                   hottest instructions to FILE\n"
+              "  --flame FILE     Write the call stack every so often to FILE, as\n"
+              "                   collapsed stacks for flamegraph.pl\n"
+              "  --sample-cycles N\n"
+              "                   How many clock ticks apart the samples are (default 997)\n"
+              "  --coverage FILE  Write which bytes were executed, read, written or used\n"
+              "                   as pointers to FILE: a code/data log as FCEUX writes\n"
+              "                   them if it ends in .cdl, otherwise every flag\n"
+              "  --symbols FILE   Name subroutines in the flame graph from FILE, a VICE\n"
+              "                   label file or name = $ADDRESS lines\n"
+              "\n"
+              "Addresses and counts are decimal, or hex written as $0400 or 0x0400.\n"
+              "An image that covers the reset vector, as iNES images do, starts\n"
+              "wherever its vector points unless --start is given.\n"
+              "The exit status is 0 after a halt or running all the cycles, 2 when\n"
+              "stopped at a trap, 3 when the run differs from --compare's trace,\n"
+              "and 1 if the image couldn't be run at all.\n";
+}
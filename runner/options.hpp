@@ -0,0 +1,52 @@
+#ifndef OPTIONS_HPP
+#define OPTIONS_HPP
+
+#include "instructionexecutor.hpp"
+#include "programimage.hpp"
+#include "tracerecorder.hpp"
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+
+
+/** What the runner was asked to do, from its command line.
+ *
+ */
+struct RunnerOptions
+{
+    using addressType = InstructionExecutor::addressType;
+    using Engine = InstructionExecutor::Engine;
+
+    std::string                image;                   ///< The file to load
+    ProgramImage::Format       format = ProgramImage::Format::Detect;
+    addressType                load_address = 0x0000;   ///< Where a raw binary goes
+    std::optional<addressType> start_address;           ///< Where the reset vector points, the load address if not given
+    uint64_t                   cycles = 100000000;      ///< The most clock ticks to run for
+    std::optional<addressType> halt_address;            ///< Stop once the CPU reads from here
+    bool                       stop_at_trap = false;    ///< Stop at an instruction jumping to itself
+    Engine                     engine = InstructionExecutor::defaultEngine();
+    bool                       lazy_flags = false;
+    std::string                trace;                   ///< Where to write a trace of every instruction, if anywhere
+    TraceRecorder::Format      trace_format = TraceRecorder::Format::Compact;
+    std::string                compare;                 ///< A reference trace to check every instruction against, if any
+    std::string                profile;                 ///< Where to write where the cycles went, if anywhere
+    std::string                flame;                   ///< Where to write sampled call stacks, if anywhere
+    uint32_t                   sample_cycles = 997;     ///< How often to sample them, prime so loops don't beat with it
+    std::string                symbols;                 ///< Names for the profile's subroutines, if any
+    std::string                coverage;                ///< Where to write the coverage of the run, if anywhere
+    bool                       help = false;            ///< Only print the usage, nothing else is looked at
+};
+
+/** Fills in @p options from the command line.
+ *
+ *  Once --help or -h turns up the rest is ignored, so it works whatever
+ *  else is given, or missing.
+ *
+ *  @return false, with the reason in @p error, if the arguments make no sense
+ */
+bool ParseOptions(int argc, char *argv[], RunnerOptions &options, std::string &error);
+
+void PrintUsage(std::ostream &output, const char *program);
+
+#endif // OPTIONS_HPP
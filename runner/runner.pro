@@ -0,0 +1,39 @@
+# Runs a program without any user interface, for batch jobs and for
+# measuring the interpreter.  Only the Qt-free core library is needed.
+TEMPLATE = app
+CONFIG += console c++17
+CONFIG -= app_bundle
+CONFIG -= qt
+CONFIG += thread
+
+TARGET = emulator-runner
+
+HEADERS += \
+    haltdevice.hpp \
+    options.hpp \
+    trapdevice.hpp
+
+SOURCES += \
+    haltdevice.cpp \
+    main.cpp \
+    options.cpp \
+    trapdevice.cpp
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
+
+# Generated by the "Add Library..." right mouse menu option.
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../core/release/ -lemulatorcore
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../core/debug/ -lemulatorcore
+else:unix: LIBS += -L$$OUT_PWD/../core/ -lemulatorcore
+
+INCLUDEPATH += $$PWD/../core
+DEPENDPATH += $$PWD/../core
+
+win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../core/release/libemulatorcore.a
+else:win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../core/debug/libemulatorcore.a
+else:win32:!win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../core/release/emulatorcore.lib
+else:win32:!win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../core/debug/emulatorcore.lib
+else:unix: PRE_TARGETDEPS += $$OUT_PWD/../core/libemulatorcore.a
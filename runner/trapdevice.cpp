@@ -0,0 +1,118 @@
+#include "trapdevice.hpp"
+#include "flags.hpp"
+#include "opcodes.hpp"
+
+
+namespace
+{
+constexpr uint8_t jmp_absolute = OpcodeFor(AbstractInstruction_e::JMP, AddressMode_e::Absolute);
+
+// A branch tests the flag picked by the top two bits of its opcode, and bit
+// 5 says whether it branches with the flag set or clear
+bool BranchTaken(uint8_t opcode, uint8_t status)
+{
+    static constexpr uint8_t tested[4] = { N, V, C, Z };
+
+    return ((status & tested[opcode >> 6]) != 0) == ((opcode & 0x20) != 0);
+}
+}
+
+
+TrapDevice::TrapDevice(const RamDevice &ram, const InstructionExecutor &cpu, Scheduler &scheduler)
+    :
+    BusDevice(0x0000, 0xFFFF, true, true),
+    _ram(ram),
+    _cpu(cpu),
+    _scheduler(scheduler)
+{
+    for (uint32_t address = 0; address < _traps.size(); ++address)
+        _traps[address] = isTrap(static_cast<addressType>(address));
+    for (uint32_t address = 0; address < _traps.size(); ++address)
+    {
+        if (_traps[address])
+        {
+            _watched[address] = true;
+            _watched[lastOperand(static_cast<addressType>(address))] = true;
+        }
+    }
+}
+
+TrapDevice::~TrapDevice()
+{
+}
+
+bool TrapDevice::isTrap(addressType address) const
+{
+    const RamDevice::memory_type &memory = _ram.memory();
+    const uint8_t                 opcode = memory[address];
+    const uint8_t                 low = memory[static_cast<addressType>(address + 1)];
+
+    if (opcode == jmp_absolute)
+        return (low | (memory[static_cast<addressType>(address + 2)] << 8)) == address;
+    return (AddressModeOf(opcode) == AddressMode_e::Relative) && (low == 0xFE);
+}
+
+TrapDevice::addressType TrapDevice::lastOperand(addressType trap) const
+{
+    return static_cast<addressType>(trap + ((_ram.memory()[trap] == jmp_absolute) ? 2 : 1));
+}
+
+void TrapDevice::writeImplementation(addressType address, uint8_t)
+{
+    // The RAM has the byte already.  It can make or break a trap starting
+    // at most two bytes before it, whose last operand byte is at most two
+    // bytes after it.
+    for (int offset = -2; offset <= 0; ++offset)
+    {
+        const addressType start = static_cast<addressType>(address + offset);
+
+        _traps[start] = isTrap(start);
+    }
+    for (int offset = -2; offset <= 2; ++offset)
+    {
+        const addressType watched = static_cast<addressType>(address + offset);
+
+        _watched[watched] = _traps[watched];
+        for (int before = 1; before <= 2; ++before)
+        {
+            const addressType start = static_cast<addressType>(watched - before);
+
+            if (_traps[start] && (lastOperand(start) == watched))
+                _watched[watched] = true;
+        }
+    }
+}
+
+uint8_t TrapDevice::readImplementation(addressType address, bool read_only)
+{
+    // Disassembly and the like peek without side effects.  Everything else
+    // only costs looking the address up, unless it is part of a trap.
+    if (!read_only && _watched[address])
+        watch(address);
+    return _ram.memory()[address];
+}
+
+void TrapDevice::watch(addressType address)
+{
+    const uint64_t instruction = _cpu.instructionCount();
+
+    // The opcode is read before the instruction is counted, its operand
+    // after and from where the PC is, which tells the last byte of the
+    // trap's operand apart from anything else reading it
+    if ((instruction == _opcode_read + 1) && _traps[_opcode_address] && (address == lastOperand(_opcode_address)) &&
+        (_cpu.registers().program_counter == address))
+    {
+        const uint8_t opcode = _ram.memory()[_opcode_address];
+
+        if ((opcode == jmp_absolute) || BranchTaken(opcode, _cpu.status()))
+        {
+            _reached = true;
+            _scheduler.stop();
+        }
+    }
+    if (_traps[address])
+    {
+        _opcode_address = address;
+        _opcode_read = instruction;
+    }
+}
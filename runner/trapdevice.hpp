@@ -0,0 +1,50 @@
+#ifndef TRAPDEVICE_HPP
+#define TRAPDEVICE_HPP
+
+#include "busdevice.hpp"
+#include "instructionexecutor.hpp"
+#include "ramdevice.hpp"
+#include "scheduler.hpp"
+#include <bitset>
+
+
+/** Stops the scheduler as soon as the CPU enters a trap: a JMP to itself,
+ *  or a branch to itself that is taken, which is how test suites usually
+ *  report success or failure.
+ *
+ *  It covers the whole address space and is attached after the RAM.  Reads
+ *  are answered with whatever the RAM holds, so the program can't tell it
+ *  is there, and writes are watched to keep track of where the traps are,
+ *  so traps the program writes or copies itself are found too.  A trap is
+ *  recognized as its operand is read, when a branch already knows whether
+ *  it is going to be taken, so the run stops with the trap executed once
+ *  and the CPU back on it.  Other reads cost no more than a bit looked up.
+ */
+class TrapDevice : public BusDevice
+{
+public:
+    TrapDevice(const RamDevice &ram, const InstructionExecutor &cpu, Scheduler &scheduler);
+   ~TrapDevice() override;
+
+    bool reached() const { return _reached; }
+
+protected:
+    void    writeImplementation(addressType address, uint8_t data) override;
+    uint8_t readImplementation(addressType address, bool read_only) override;
+
+private:
+    bool        isTrap(addressType address) const; // As the RAM stands now
+    addressType lastOperand(addressType trap) const;
+    void        watch(addressType address);        // Reading a byte of a trap
+
+    const RamDevice           &_ram;
+    const InstructionExecutor &_cpu;
+    Scheduler                 &_scheduler;
+    std::bitset<64 * 1024>     _traps;              // Where a trap's opcode is
+    std::bitset<64 * 1024>     _watched;            // That, and where its operand ends
+    addressType                _opcode_address = 0; // The trap whose opcode was read last
+    uint64_t                   _opcode_read = 0;    // The instruction count when it was
+    bool                       _reached = false;
+};
+
+#endif // TRAPDEVICE_HPP
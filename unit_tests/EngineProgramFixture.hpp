@@ -0,0 +1,70 @@
+#ifndef ENGINEPROGRAMFIXTURE_HPP
+#define ENGINEPROGRAMFIXTURE_HPP
+
+#include <gmock/gmock.h>
+#include "computercore.hpp"
+#include <tuple>
+#include <vector>
+
+
+/** Runs @p computer an instruction at a time until it reaches @p end, for
+ *  at most 100 instructions.
+ *
+ */
+inline void RunTo(ComputerCore &computer, uint16_t end)
+{
+    for (int i = 0; (i < 100) && (computer.cpu().registers().program_counter != end); ++i)
+        computer.cpu().run(1);
+    ASSERT_THAT(computer.cpu().registers().program_counter, ::testing::Eq(end));
+}
+
+/** Runs a little program on each engine, with and without every
+ *  superinstruction, to show something comes out the same on all of them.
+ *
+ *  The parameter is the engine, and whether to fuse; instantiate with
+ *  everyEngine().  Engines the compiler can't build are skipped.  Fixtures
+ *  derived from this one hook whatever they look at into computer.cpu()
+ *  in their constructor, and unhook it in their destructor.
+ */
+class EngineProgramFixture : public ::testing::TestWithParam<std::tuple<InstructionExecutor::Engine, bool>>
+{
+public:
+    using Engine = InstructionExecutor::Engine;
+
+    static constexpr uint16_t program_start = 0x0400;
+
+    static auto everyEngine()
+    {
+        return ::testing::Combine(::testing::Values(Engine::Table, Engine::Threaded, Engine::TailCall), ::testing::Bool());
+    }
+
+    /** Loads @p program at program_start and resets the CPU to run it.
+     *
+     */
+    void loadProgram(const std::vector<uint8_t> &program)
+    {
+        computer.load(program_start, program.data(), program.size());
+        computer.resetTo(program_start);
+    }
+
+    void runTo(uint16_t end) { RunTo(computer, end); }
+
+    ComputerCore computer;
+
+protected:
+    void SetUp() override
+    {
+        const Engine engine = std::get<0>(GetParam());
+
+        if (!InstructionExecutor::engineAvailable(engine))
+            GTEST_SKIP() << "Engine not compiled in";
+        ASSERT_TRUE(computer.cpu().setEngine(engine));
+        if (std::get<1>(GetParam()))
+        {
+            for (const InstructionExecutor::opcodePairType &pair : InstructionExecutor::fusiblePairs())
+                computer.cpu().enableSuperinstruction(pair.first, pair.second);
+        }
+    }
+};
+
+#endif // ENGINEPROGRAMFIXTURE_HPP
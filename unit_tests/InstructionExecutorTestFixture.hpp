@@ -77,9 +77,7 @@ public:
 
     uint16_t addressUsingStackPointer(uint8_t stack_offset) const { return baseStackAddress() + stack_offset; }
 
-    Registers r;
-    InstructionExecutor executor{ r,
-                                  std::bind(&InstructionExecutorTestFixture::addressBusReadSignaled,        this, _1, _2),
+    InstructionExecutor executor{ std::bind(&InstructionExecutorTestFixture::addressBusReadSignaled,        this, _1, _2),
                                   std::bind(&InstructionExecutorTestFixture::addressBusWriteSignaled,       this, _1, _2),
                                   std::bind(&InstructionExecutorTestFixture::accumulatorChangedSignaled,    this, _1),
                                   std::bind(&InstructionExecutorTestFixture::xChangedSignaled,              this, _1),
@@ -88,6 +86,7 @@ public:
                                   std::bind(&InstructionExecutorTestFixture::stackPointerChangedSignaled,   this, _1),
                                   std::bind(&InstructionExecutorTestFixture::statusChangedSignaled,         this, _1)
                                 };
+    Registers &r = executor.registers(); // The executor owns the registers
 
     // Here is where we store the results of the signals.
     std::vector<ReadSignalValues>  readSignalsCaught;
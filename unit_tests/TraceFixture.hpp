@@ -0,0 +1,80 @@
+#ifndef TRACEFIXTURE_HPP
+#define TRACEFIXTURE_HPP
+
+#include <gmock/gmock.h>
+#include "computercore.hpp"
+#include "tracereader.hpp"
+#include "tracerecorder.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+
+/** Every record in the trace file at @p path, raw or compact.
+ *
+ */
+inline std::vector<TraceRecord> ReadTrace(const std::string &path)
+{
+    std::vector<TraceRecord> records;
+    TraceReader              reader;
+    TraceRecord              record;
+    std::string              error;
+
+    EXPECT_TRUE(reader.open(path, error)) << error;
+    while (reader.next(record))
+        records.push_back(record);
+    return records;
+}
+
+/** Traces a little program as it runs, into a file that is read back.
+ *
+ *  The program is loaded at program_start and the CPU reset to run it.
+ *  Fixtures derived from this one load whatever else it needs into
+ *  computer in their constructor.  The trace file, named in the temporary
+ *  directory, is removed when the test is done.
+ */
+class TraceFixture : public ::testing::Test
+{
+public:
+    static constexpr uint16_t program_start = 0x0400;
+
+    TraceFixture(const std::vector<uint8_t> &program, const std::string &file_name)
+        :
+        path(std::string(::testing::TempDir()) + file_name)
+    {
+        computer.load(program_start, program.data(), program.size());
+        computer.resetTo(program_start);
+    }
+
+    ~TraceFixture() override
+    {
+        std::remove(path.c_str());
+    }
+
+    std::vector<TraceRecord> readTrace() const { return ReadTrace(path); }
+
+    /** Traces computer running for at least @p cycles clock ticks, with
+     *  run(), into path.
+     *
+     *  @return What was recorded
+     */
+    std::vector<TraceRecord> traceRun(uint32_t              cycles,
+                                      TraceRecorder::Format format = TraceRecorder::Format::Compact,
+                                      size_t                capacity = TraceRecorder::default_capacity)
+    {
+        TraceRecorder recorder(capacity);
+        std::string   error;
+
+        EXPECT_TRUE(recorder.start(path, error, format)) << error;
+        computer.cpu().setTraceRecorder(&recorder);
+        computer.scheduler().run(cycles);
+        computer.cpu().setTraceRecorder(nullptr);
+        EXPECT_TRUE(recorder.stop(error)) << error;
+        return readTrace();
+    }
+
+    ComputerCore computer;
+    std::string  path;
+};
+
+#endif // TRACEFIXTURE_HPP
@@ -0,0 +1,108 @@
+#include <gmock/gmock.h>
+#include "EngineProgramFixture.hpp"
+#include "accesscounters.hpp"
+#include "accessheatmap.hpp"
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+// DEX and BNE make a fused pair, when fusion is on:
+//
+//       LDX #$03
+// loop  STA $0600
+//       DEX
+//       BNE loop
+// end   JMP end
+const std::vector<uint8_t> program {
+    0xA2, 0x03, 0x8D, 0x00, 0x06, 0xCA, 0xD0, 0xFA, 0x4C, 0x08, 0x04
+};
+constexpr uint16_t program_end = 0x0408;
+
+class AccessCountersTests : public EngineProgramFixture
+{
+public:
+    AccessCountersTests()
+    {
+        computer.cpu().setAccessCounters(&counters);
+        loadProgram(program);
+    }
+
+    ~AccessCountersTests() override
+    {
+        computer.cpu().setAccessCounters(nullptr);
+    }
+
+    AccessCounters counters;
+};
+}
+
+TEST_P(AccessCountersTests, CountsTheSameOnEveryEngine)
+{
+    runTo(program_end);
+
+    EXPECT_THAT(counters.count(AccessCounters::Execute, 0x0400), Eq(1u));
+    EXPECT_THAT(counters.count(AccessCounters::Execute, 0x0402), Eq(3u));
+    EXPECT_THAT(counters.count(AccessCounters::Execute, 0x0404), Eq(3u));
+    EXPECT_THAT(counters.count(AccessCounters::Execute, 0x0405), Eq(3u));
+    EXPECT_THAT(counters.count(AccessCounters::Execute, 0x0406), Eq(3u));
+    EXPECT_THAT(counters.count(AccessCounters::Execute, 0x0407), Eq(3u));
+    EXPECT_THAT(counters.count(AccessCounters::Write, 0x0600), Eq(3u));
+    EXPECT_THAT(counters.count(AccessCounters::Read, 0x0600), Eq(0u));
+    // An immediate operand is read as well as executed
+    EXPECT_THAT(counters.count(AccessCounters::Read, 0x0401), Eq(1u));
+    EXPECT_THAT(counters.count(AccessCounters::Read, 0x0403), Eq(0u));
+}
+
+INSTANTIATE_TEST_SUITE_P(AccessCounters, AccessCountersTests, EngineProgramFixture::everyEngine());
+
+TEST(AccessHeatmap, CoolsByHalfLife)
+{
+    AccessCounters counters;
+    AccessHeatmap  heatmap(0.5);
+
+    // Whatever was counted before the first update doesn't show
+    counters.record(AccessCounters::Read, 0x1234);
+    EXPECT_FALSE(heatmap.update(counters, 0.0));
+
+    for (int i = 0; i < 8; ++i)
+        counters.record(AccessCounters::Read, 0x1234);
+    counters.record(AccessCounters::Write, 0x00FF);
+    ASSERT_TRUE(heatmap.update(counters, 0.0));
+    EXPECT_THAT(heatmap.heat(AccessCounters::Read, 0x1234), FloatEq(8.0f));
+    EXPECT_THAT(heatmap.heat(AccessCounters::Write, 0x00FF), FloatEq(1.0f));
+    EXPECT_THAT(heatmap.pixel(0x1234) & 0xFF000000, Eq(0xFF000000u));
+    EXPECT_THAT(heatmap.pixel(0x1234) & 0x00FF00FF, Eq(0u));
+    EXPECT_THAT(heatmap.pixel(0x00FF) & 0x00FF0000, Ne(0u));
+    // A row for each page
+    EXPECT_THAT(heatmap.pixels()[0x12 * AccessHeatmap::width + 0x34], Eq(heatmap.pixel(0x1234)));
+
+    const uint32_t hot = heatmap.pixel(0x1234);
+
+    ASSERT_TRUE(heatmap.update(counters, 0.5));
+    EXPECT_THAT(heatmap.heat(AccessCounters::Read, 0x1234), FloatEq(4.0f));
+    EXPECT_THAT(heatmap.pixel(0x1234), Lt(hot));
+
+    EXPECT_FALSE(heatmap.update(counters, 10.0));
+    EXPECT_THAT(heatmap.pixel(0x1234), Eq(0xFF000000u));
+}
+
+TEST(AccessHeatmap, SaturatesAndClears)
+{
+    AccessCounters counters;
+    AccessHeatmap  heatmap;
+
+    heatmap.update(counters, 0.0);
+    for (int i = 0; i < 1000; ++i)
+        counters.recordInstruction(0xFFFF, 1);
+    heatmap.update(counters, 0.0);
+    EXPECT_THAT(heatmap.pixel(0xFFFF), Eq(0xFF0000FFu));
+    // The operand wraps round to the bottom of memory
+    EXPECT_THAT(heatmap.pixel(0x0000), Eq(0xFF0000FFu));
+
+    heatmap.clear();
+    EXPECT_THAT(heatmap.pixel(0xFFFF), Eq(0xFF000000u));
+    // Starting again, it takes note of the counters without heating up
+    EXPECT_FALSE(heatmap.update(counters, 0.0));
+}
@@ -0,0 +1,288 @@
+#include <gmock/gmock.h>
+#include "TraceFixture.hpp"
+#include "compacttrace.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+// Walks through memory through a pointer, calling a subroutine on every
+// byte and moving the pointer on a page each time round:
+//
+// start LDX #$00
+// loop  LDA ($10),Y
+//       JSR sub
+//       STA $0300,X
+//       INX
+//       BNE loop
+//       INC $11
+//       JMP start
+//
+// $0420 PHA
+// sub   ADC #$07
+//       PLA
+//       TAY
+//       RTS
+const std::vector<uint8_t> program {
+    0xA2, 0x00, 0xB1, 0x10, 0x20, 0x20, 0x04, 0x9D, 0x00, 0x03, 0xE8, 0xD0, 0xF5, 0xE6, 0x11, 0x4C, 0x00, 0x04
+};
+const std::vector<uint8_t> subroutine { 0x48, 0x69, 0x07, 0x68, 0xA8, 0x60 };
+const std::vector<uint8_t> pointer { 0x00, 0x10 };
+
+constexpr uint32_t block_records = 256;
+
+class CompactTraceTests : public TraceFixture
+{
+public:
+    CompactTraceTests()
+        :
+        TraceFixture(program, "compact_trace_test.raw")
+    {
+        std::vector<uint8_t> data(0x4000);
+        uint32_t             seed = 4321;
+
+        for (uint8_t &value : data)
+        {
+            seed = seed * 1103515245 + 12345;
+            value = static_cast<uint8_t>(seed >> 16);
+        }
+        computer.load(0x0420, subroutine.data(), subroutine.size());
+        computer.load(0x0010, pointer.data(), pointer.size());
+        computer.load(0x1000, data.data(), data.size());
+        raw = traceRun(200000, TraceRecorder::Format::Raw);
+    }
+
+    ~CompactTraceTests() override
+    {
+        std::remove(compact_path.c_str());
+    }
+
+    void writeCompact(const std::vector<TraceRecord> &records)
+    {
+        CompactTraceWriter writer;
+        std::string        error;
+
+        ASSERT_TRUE(writer.open(compact_path, error, block_records)) << error;
+        writer.write(records.data(), records.size());
+        ASSERT_TRUE(writer.close(error)) << error;
+    }
+
+    long fileSize(const std::string &name)
+    {
+        std::FILE *file = std::fopen(name.c_str(), "rb");
+
+        std::fseek(file, 0, SEEK_END);
+
+        const long size = std::ftell(file);
+
+        std::fclose(file);
+        return size;
+    }
+
+    std::string              compact_path = std::string(TempDir()) + "compact_trace_test.trace";
+    std::vector<TraceRecord> raw;
+};
+
+bool Same(const TraceRecord &a, const TraceRecord &b)
+{
+    return std::memcmp(&a, &b, sizeof(TraceRecord)) == 0;
+}
+}
+
+TEST_F(CompactTraceTests, DecodesEveryRecordExactly)
+{
+    CompactTraceFile         file;
+    std::vector<TraceRecord> decoded;
+    std::vector<TraceRecord> block;
+    std::string              error;
+
+    writeCompact(raw);
+    ASSERT_TRUE(file.open(compact_path, error)) << error;
+    ASSERT_THAT(file.records(), Eq(raw.size()));
+    EXPECT_THAT(file.blocks(), Eq((raw.size() + block_records - 1) / block_records));
+    for (size_t i = 0; i < file.blocks(); ++i)
+    {
+        ASSERT_TRUE(file.decodeBlock(i, block));
+        decoded.insert(decoded.end(), block.begin(), block.end());
+    }
+
+    ASSERT_THAT(decoded.size(), Eq(raw.size()));
+    for (size_t i = 0; i < raw.size(); ++i)
+        ASSERT_TRUE(Same(decoded[i], raw[i])) << "Record " << i;
+}
+
+TEST_F(CompactTraceTests, KeepsWhatTheDeltasCannotPredict)
+{
+    std::vector<TraceRecord> records(raw.begin(), raw.begin() + 10);
+    CompactTraceFile         file;
+    TraceRecord              decoded;
+    std::string              error;
+
+    // Cycles going backwards, as they do when the counter wraps, a jump to
+    // the other end of memory and self modifying code
+    const auto with_operand = std::find_if(records.begin() + 6, records.end(),
+                                           [](const TraceRecord &record) { return record.length > 1; });
+
+    ASSERT_THAT(with_operand, Ne(records.end()));
+    records[3].cycle = 5;
+    records[5].program_counter = 0xFFF0;
+    with_operand->operands[0] ^= 0xFF;
+    records[4].effective_address = 0x1234;
+    writeCompact(records);
+
+    ASSERT_TRUE(file.open(compact_path, error)) << error;
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        ASSERT_TRUE(file.record(i, decoded));
+        EXPECT_TRUE(Same(decoded, records[i])) << "Record " << i;
+    }
+}
+
+TEST_F(CompactTraceTests, IsAFractionOfTheSizeOfARawTrace)
+{
+    writeCompact(raw);
+
+    EXPECT_THAT(fileSize(compact_path) * 5, Lt(fileSize(path)));
+}
+
+TEST_F(CompactTraceTests, SeeksToAnyRecordOrCycleWithinASingleBlock)
+{
+    CompactTraceFile         file;
+    std::vector<TraceRecord> block;
+    TraceRecord              record;
+    std::string              error;
+
+    writeCompact(raw);
+    ASSERT_TRUE(file.open(compact_path, error)) << error;
+    for (size_t i : { size_t(0), size_t(1), size_t(block_records), raw.size() / 2 + 7, raw.size() - 1 })
+    {
+        ASSERT_TRUE(file.record(i, record));
+        EXPECT_TRUE(Same(record, raw[i])) << "Record " << i;
+
+        const size_t found = file.blockOfCycle(raw[i].cycle);
+
+        ASSERT_TRUE(file.decodeBlock(found, block));
+        EXPECT_THAT(found, Eq(file.blockOfRecord(i)));
+        EXPECT_THAT(file.firstCycleOf(found), Le(raw[i].cycle));
+    }
+    EXPECT_FALSE(file.record(raw.size(), record));
+}
+
+TEST_F(CompactTraceTests, FindsTheWholeBlocksOfATraceThatWasNeverClosed)
+{
+    CompactTraceFile file;
+    std::string      error;
+
+    writeCompact(raw);
+
+    // Cut off the index, and part of the last block
+    std::vector<char> contents(static_cast<size_t>(fileSize(compact_path)));
+    std::FILE        *in = std::fopen(compact_path.c_str(), "rb");
+
+    ASSERT_THAT(std::fread(contents.data(), 1, contents.size(), in), Eq(contents.size()));
+    std::fclose(in);
+
+    CompactTraceTrailer trailer;
+
+    std::memcpy(&trailer, contents.data() + contents.size() - sizeof(trailer), sizeof(trailer));
+
+    std::FILE *out = std::fopen(compact_path.c_str(), "wb");
+
+    std::fwrite(contents.data(), 1, static_cast<size_t>(trailer.index_offset) - 3, out);
+    std::fclose(out);
+
+    ASSERT_TRUE(file.open(compact_path, error)) << error;
+    EXPECT_THAT(file.blocks(), Eq(trailer.blocks - 1));
+    EXPECT_THAT(file.records(), Eq((trailer.blocks - 1) * block_records));
+    EXPECT_THAT(file.blockRecords(), Eq(block_records));
+}
+
+TEST_F(CompactTraceTests, RejectsRecordsABlockDoesNotHave)
+{
+    CompactTraceFile file;
+    TraceRecord      record;
+    std::string      error;
+
+    writeCompact(std::vector<TraceRecord>(raw.begin(), raw.begin() + 2 * block_records + 10));
+
+    std::vector<char> contents(static_cast<size_t>(fileSize(compact_path)));
+    std::FILE        *in = std::fopen(compact_path.c_str(), "rb");
+
+    ASSERT_THAT(std::fread(contents.data(), 1, contents.size(), in), Eq(contents.size()));
+    std::fclose(in);
+
+    // Claim the last block is full, and that the middle one is enormous
+    CompactTraceTrailer     trailer;
+    CompactTraceIndexEntry  middle;
+    CompactTraceBlockHeader header;
+    char                   *trailer_bytes = contents.data() + contents.size() - sizeof(trailer);
+
+    std::memcpy(&trailer, trailer_bytes, sizeof(trailer));
+    ASSERT_THAT(trailer.blocks, Eq(3u));
+    trailer.records = 3 * block_records;
+    std::memcpy(trailer_bytes, &trailer, sizeof(trailer));
+    std::memcpy(&middle, contents.data() + trailer.index_offset + sizeof(middle), sizeof(middle));
+    std::memcpy(&header, contents.data() + middle.offset, sizeof(header));
+    header.records = 0xFFFFFFFF;
+    std::memcpy(contents.data() + middle.offset, &header, sizeof(header));
+
+    std::FILE *out = std::fopen(compact_path.c_str(), "wb");
+
+    std::fwrite(contents.data(), 1, contents.size(), out);
+    std::fclose(out);
+
+    ASSERT_TRUE(file.open(compact_path, error)) << error;
+    EXPECT_TRUE(file.record(0, record));
+    EXPECT_FALSE(file.record(block_records, record));
+    EXPECT_TRUE(file.record(2 * block_records + 9, record));
+    EXPECT_FALSE(file.record(2 * block_records + 10, record));
+    EXPECT_FALSE(file.record(3 * block_records - 1, record));
+}
+
+TEST_F(CompactTraceTests, TheRecorderWritesTheSameTraceInEitherFormat)
+{
+    ComputerCore  computer;
+    TraceRecorder recorder;
+    TraceReader   reader;
+    TraceRecord   record;
+    std::string   error;
+    size_t        count = 0;
+
+    computer.load(0x0400, program.data(), program.size());
+    computer.load(0x0420, subroutine.data(), subroutine.size());
+    computer.load(0x0010, pointer.data(), pointer.size());
+    computer.resetTo(0x0400);
+    ASSERT_TRUE(recorder.start(compact_path, error)) << error;
+    computer.cpu().setTraceRecorder(&recorder);
+    computer.scheduler().run(50000);
+    ASSERT_TRUE(recorder.stop(error)) << error;
+
+    ASSERT_TRUE(reader.open(compact_path, error)) << error;
+    while (reader.next(record))
+    {
+        // Memory past the program is all 0 this time, so only the code matches
+        ASSERT_THAT(record.program_counter, Eq(raw[count].program_counter)) << "Record " << count;
+        ASSERT_THAT(record.cycle, Eq(raw[count].cycle)) << "Record " << count;
+        ++count;
+    }
+    EXPECT_THAT(count, Eq(recorder.recorded()));
+}
+
+TEST(CompactTraceFile, RejectsARawTrace)
+{
+    const std::string path = std::string(TempDir()) + "compact_trace_test.raw";
+    TraceRecorder     recorder;
+    CompactTraceFile  file;
+    std::string       error;
+
+    ASSERT_TRUE(recorder.start(path, error, TraceRecorder::Format::Raw)) << error;
+    ASSERT_TRUE(recorder.stop(error)) << error;
+    EXPECT_FALSE(file.open(path, error));
+    EXPECT_THAT(error, HasSubstr("not a compact trace"));
+    std::remove(path.c_str());
+}
@@ -0,0 +1,53 @@
+#include <gmock/gmock.h>
+#include "computer.hpp"
+
+using namespace testing;
+
+// The built in program adds 3 to A ten times, from $8010
+TEST(ComputerRewind, StepInstructionBackTellsTheViews)
+{
+    Computer computer;
+    olc6502 &cpu = *computer.cpu();
+
+    computer.setRewindInterval(16);
+    for (int i = 0; (i < 1000) && !((cpu.a() == 6) && cpu.complete()); ++i)
+        computer.stepClock();
+    ASSERT_THAT(cpu.a(), Eq(6));
+    ASSERT_TRUE(cpu.complete());
+
+    const uint16_t pc = cpu.pc();
+    int            pc_changes = 0;
+    int            a_changes = 0;
+
+    QObject::connect(&cpu, &olc6502::pcChanged, [&pc_changes](uint16_t) { ++pc_changes; });
+    QObject::connect(&cpu, &olc6502::aChanged,  [&a_changes](uint8_t) { ++a_changes; });
+
+    // Back to the start of the second ADC, once, however far it replays
+    ASSERT_TRUE(computer.stepInstructionBack());
+    EXPECT_THAT(cpu.a(), Eq(3));
+    EXPECT_THAT(cpu.pc(), Eq(0x8010));
+    EXPECT_THAT(cpu.pc(), Ne(pc));
+    EXPECT_THAT(pc_changes, Eq(1));
+    EXPECT_THAT(a_changes, Eq(1));
+}
+
+TEST(ComputerRewind, StepInstructionBackSkipsTheInstructionRunning)
+{
+    Computer computer;
+    olc6502 &cpu = *computer.cpu();
+
+    computer.setRewindInterval(16);
+    for (int i = 0; (i < 1000) && !((cpu.a() == 6) && cpu.complete()); ++i)
+        computer.stepClock();
+    ASSERT_THAT(cpu.pc(), Eq(0x8013));
+
+    // Into the DEY after the second ADC, which has a cycle still to go
+    computer.stepClock();
+    ASSERT_FALSE(cpu.complete());
+
+    // Back past the start of the DEY, to the start of the ADC
+    ASSERT_TRUE(computer.stepInstructionBack());
+    EXPECT_TRUE(cpu.complete());
+    EXPECT_THAT(cpu.a(), Eq(3));
+    EXPECT_THAT(cpu.pc(), Eq(0x8010));
+}
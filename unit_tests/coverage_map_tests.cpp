@@ -0,0 +1,216 @@
+#include <gmock/gmock.h>
+#include "EngineProgramFixture.hpp"
+#include "coveragemap.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+// Every kind of access, with a byte of data after the code:
+//
+//       LDA #$34
+//       STA $10
+//       LDA #$05
+//       STA $11
+//       LDY #$00
+//       LDA ($10),Y
+//       STA $0600
+//       LDX data
+// end   JMP end
+// data  .byte $20
+const std::vector<uint8_t> program {
+    0xA9, 0x34, 0x85, 0x10, 0xA9, 0x05, 0x85, 0x11, 0xA0, 0x00, 0xB1, 0x10, 0x8D, 0x00, 0x06,
+    0xAE, 0x15, 0x04, 0x4C, 0x12, 0x04, 0x20
+};
+constexpr uint16_t program_end = 0x0412;
+
+class CoverageMapTests : public EngineProgramFixture
+{
+public:
+    CoverageMapTests()
+    {
+        computer.cpu().setCoverageMap(&coverage);
+        loadProgram(program);
+    }
+
+    ~CoverageMapTests() override
+    {
+        computer.cpu().setCoverageMap(nullptr);
+    }
+
+    CoverageMap coverage;
+};
+}
+
+TEST_P(CoverageMapTests, MarksTheSameOnEveryEngine)
+{
+    runTo(program_end);
+
+    EXPECT_THAT(coverage.flags(0x0400), Eq(CoverageMap::Opcode));
+    // An immediate operand is data to the instruction
+    EXPECT_THAT(coverage.flags(0x0401), Eq(CoverageMap::Operand | CoverageMap::Read));
+    EXPECT_THAT(coverage.flags(0x040C), Eq(CoverageMap::Opcode));
+    EXPECT_THAT(coverage.flags(0x040D), Eq(CoverageMap::Operand));
+    EXPECT_THAT(coverage.flags(0x040E), Eq(CoverageMap::Operand));
+    EXPECT_THAT(coverage.flags(0x0010), Eq(CoverageMap::Written | CoverageMap::Read | CoverageMap::IndirectPointer));
+    EXPECT_THAT(coverage.flags(0x0011), Eq(CoverageMap::Written | CoverageMap::Read | CoverageMap::IndirectPointer));
+    EXPECT_THAT(coverage.flags(0x0534), Eq(CoverageMap::Read));
+    EXPECT_THAT(coverage.flags(0x0600), Eq(CoverageMap::Written));
+    EXPECT_THAT(coverage.flags(0x0415), Eq(CoverageMap::Read));
+    EXPECT_THAT(coverage.flags(0xFFFC), Eq(CoverageMap::Read | CoverageMap::IndirectPointer));
+    EXPECT_THAT(coverage.count(CoverageMap::Opcode), Eq(8u));
+    EXPECT_THAT(coverage.count(CoverageMap::Written), Eq(3u));
+}
+
+TEST_P(CoverageMapTests, DisassemblesDataAsData)
+{
+    runTo(program_end);
+    computer.cpu().run(10);
+
+    const InstructionExecutor::disassemblyType lines = computer.cpu().disassemble(0x0410, 0x0416, &coverage);
+
+    // Starting on an operand, it finds its way back to the instructions
+    EXPECT_THAT(lines.at(0x0410), Eq("$0410: .byte $15 {DATA}"));
+    EXPECT_THAT(lines.at(0x0411), Eq("$0411: .byte $04 {DATA}"));
+    EXPECT_THAT(lines.at(0x0412), Eq("$0412: JMP $0412 {ABS}"));
+    EXPECT_THAT(lines.at(0x0415), Eq("$0415: .byte $20 {DATA}"));
+    // Disassembling isn't reading
+    EXPECT_THAT(coverage.flags(0x0416), Eq(0u));
+    // Without the map, the data looks like a JSR
+    EXPECT_THAT(computer.cpu().disassemble(0x0415, 0x0415).at(0x0415), HasSubstr("JSR"));
+}
+
+INSTANTIATE_TEST_SUITE_P(CoverageMap, CoverageMapTests, EngineProgramFixture::everyEngine());
+
+namespace
+{
+std::vector<uint8_t> ReadFile(const std::string &path)
+{
+    std::vector<uint8_t> bytes(CoverageMap::size + 1);
+    std::FILE           *file = std::fopen(path.c_str(), "rb");
+
+    if (!file)
+        return {};
+    bytes.resize(std::fread(bytes.data(), 1, bytes.size(), file));
+    std::fclose(file);
+    return bytes;
+}
+}
+
+TEST(CoverageMap, SavesAndLoadsACodeDataLog)
+{
+    const std::string path = std::string(TempDir()) + "coverage_map_test.cdl";
+    CoverageMap       saved;
+    CoverageMap       loaded;
+    std::string       error;
+
+    saved.recordInstruction(0xFFFE, 2);
+    saved.record(0x1234, CoverageMap::Written);
+    saved.record(0x1235, CoverageMap::Read);
+    saved.record(0x0010, CoverageMap::IndirectPointer | CoverageMap::Read);
+    ASSERT_THAT(CoverageMap::formatOf(path), Eq(CoverageMap::Format::CodeDataLog));
+    ASSERT_TRUE(saved.save(path, error)) << error;
+
+    // Code and data where FCEUX has them, with opcodes in the bit it leaves
+    // unused, and nothing for writes
+    const std::vector<uint8_t> logged = ReadFile(path);
+
+    ASSERT_THAT(logged.size(), Eq(CoverageMap::size));
+    EXPECT_THAT(logged[0xFFFE], Eq(0x81));
+    EXPECT_THAT(logged[0xFFFF], Eq(0x01));
+    EXPECT_THAT(logged[0x0000], Eq(0x01));
+    EXPECT_THAT(logged[0x1234], Eq(0x00));
+    EXPECT_THAT(logged[0x1235], Eq(0x02));
+    EXPECT_THAT(logged[0x0010], Eq(0x02));
+    EXPECT_THAT(std::count(logged.begin(), logged.end(), 0), Eq(static_cast<long>(CoverageMap::size - 5)));
+
+    ASSERT_TRUE(loaded.load(path, error)) << error;
+    EXPECT_THAT(loaded.flags(0xFFFE), Eq(CoverageMap::Opcode));
+    EXPECT_THAT(loaded.flags(0xFFFF), Eq(CoverageMap::Operand));
+    EXPECT_THAT(loaded.flags(0x0000), Eq(CoverageMap::Operand));
+    EXPECT_THAT(loaded.flags(0x1234), Eq(0u));
+    EXPECT_THAT(loaded.flags(0x1235), Eq(CoverageMap::Read));
+
+    // Too short, which leaves what was there
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+
+    ASSERT_THAT(file, NotNull());
+    std::fputs("CDL", file);
+    std::fclose(file);
+    EXPECT_FALSE(loaded.load(path, error));
+    EXPECT_THAT(loaded.flags(0xFFFE), Eq(CoverageMap::Opcode));
+    std::remove(path.c_str());
+}
+
+TEST(CoverageMap, LoadsACodeDataLogFromFceux)
+{
+    const std::string    path = std::string(TempDir()) + "coverage_map_test_fceux.cdl";
+    std::vector<uint8_t> logged(CoverageMap::size, 0);
+    CoverageMap          loaded;
+    std::string          error;
+
+    // Code and data, with the PRG bank bits that FCEUX sets too
+    logged[0x8000] = 0x01 | 0x04;
+    logged[0x8001] = 0x01 | 0x04;
+    logged[0x9000] = 0x02 | 0x08;
+
+    std::FILE *file = std::fopen(path.c_str(), "wb");
+
+    ASSERT_THAT(file, NotNull());
+    std::fwrite(logged.data(), 1, logged.size(), file);
+    std::fclose(file);
+
+    // Without opcodes marked, code could be either
+    ASSERT_TRUE(loaded.load(path, error)) << error;
+    EXPECT_THAT(loaded.flags(0x8000), Eq(CoverageMap::Executed));
+    EXPECT_THAT(loaded.flags(0x8001), Eq(CoverageMap::Executed));
+    EXPECT_THAT(loaded.flags(0x9000), Eq(CoverageMap::Read));
+    EXPECT_THAT(loaded.count(CoverageMap::All), Eq(3u));
+    std::remove(path.c_str());
+}
+
+TEST(CoverageMap, SavesAndLoadsEveryFlag)
+{
+    const std::string path = std::string(TempDir()) + "coverage_map_test.flags";
+    CoverageMap       saved;
+    CoverageMap       loaded;
+    std::string       error;
+
+    saved.recordInstruction(0x0400, 1);
+    saved.record(0x0400, CoverageMap::Operand);
+    saved.record(0x0010, CoverageMap::IndirectPointer | CoverageMap::Read | CoverageMap::Written);
+    ASSERT_THAT(CoverageMap::formatOf(path), Eq(CoverageMap::Format::Flags));
+    ASSERT_TRUE(saved.save(path, error, CoverageMap::Format::Flags)) << error;
+
+    const std::vector<uint8_t> logged = ReadFile(path);
+
+    ASSERT_THAT(logged.size(), Eq(CoverageMap::size));
+    EXPECT_THAT(logged[0x0400], Eq(CoverageMap::Opcode | CoverageMap::Operand));
+    EXPECT_THAT(logged[0x0010], Eq(CoverageMap::IndirectPointer | CoverageMap::Read | CoverageMap::Written));
+
+    ASSERT_TRUE(loaded.load(path, error, CoverageMap::Format::Flags)) << error;
+    EXPECT_THAT(loaded.flags(0x0400), Eq(CoverageMap::Opcode | CoverageMap::Operand));
+    EXPECT_THAT(loaded.flags(0x0401), Eq(CoverageMap::Operand));
+    EXPECT_THAT(loaded.flags(0x0010), Eq(CoverageMap::IndirectPointer | CoverageMap::Read | CoverageMap::Written));
+    std::remove(path.c_str());
+}
+
+TEST(CoverageMap, MergesAnotherRun)
+{
+    CoverageMap first;
+    CoverageMap second;
+
+    first.record(0x0400, CoverageMap::Read);
+    second.record(0x0400, CoverageMap::Written);
+    second.record(0x0500, CoverageMap::Opcode);
+    first.merge(second);
+    EXPECT_THAT(first.flags(0x0400), Eq(CoverageMap::Read | CoverageMap::Written));
+    EXPECT_THAT(first.flags(0x0500), Eq(CoverageMap::Opcode));
+
+    first.clear();
+    EXPECT_THAT(first.count(CoverageMap::All), Eq(0u));
+}
@@ -0,0 +1,281 @@
+#include <gmock/gmock.h>
+#include "computercore.hpp"
+#include "cycleprofiler.hpp"
+#include "symboltable.hpp"
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+class CycleProfilerTests : public Test
+{
+public:
+    CycleProfilerTests()
+    {
+        computer.cpu().setCycleProfiler(&profiler);
+    }
+
+    ~CycleProfilerTests() override
+    {
+        computer.cpu().setCycleProfiler(nullptr);
+    }
+
+    void load(uint16_t address, const std::vector<uint8_t> &bytes)
+    {
+        computer.load(address, bytes.data(), bytes.size());
+    }
+
+    // Runs an instruction at a time until the CPU gets to @p end
+    void runTo(uint16_t end)
+    {
+        for (int i = 0; (i < 1000) && (computer.cpu().registers().program_counter != end); ++i)
+            computer.cpu().run(1);
+        ASSERT_THAT(computer.cpu().registers().program_counter, Eq(end));
+    }
+
+    CycleProfiler::SubroutineCost subroutine(uint16_t address) const
+    {
+        const std::vector<CycleProfiler::SubroutineCost> costs = profiler.subroutines();
+        const auto found = std::find_if(costs.begin(), costs.end(),
+                                        [address](const CycleProfiler::SubroutineCost &cost) { return cost.address == address; });
+
+        return (found != costs.end()) ? *found : CycleProfiler::SubroutineCost{ address, 0, 0, 0 };
+    }
+
+    ComputerCore  computer;
+    CycleProfiler profiler;
+};
+}
+
+TEST_F(CycleProfilerTests, AttributesEveryCycleToAnAddress)
+{
+    // LDX #$00; loop LDA $0500,X; STA $0300,X; INX; BNE loop; JMP to the start
+    load(0x0400, { 0xA2, 0x00, 0xBD, 0x00, 0x05, 0x9D, 0x00, 0x03, 0xE8, 0xD0, 0xF7, 0x4C, 0x00, 0x04 });
+    computer.resetTo(0x0400);
+    computer.scheduler().run(100000);
+
+    uint64_t sum = 0;
+
+    for (uint32_t address = 0; address < 0x10000; ++address)
+        sum += profiler.cycles(static_cast<uint16_t>(address));
+    EXPECT_THAT(sum, Eq(profiler.total()));
+    // All of it, bar the reset
+    EXPECT_THAT(profiler.total(), Eq(computer.cpu().clock_ticks - 8));
+    // The store takes the most, at 5 cycles a go
+    EXPECT_THAT(profiler.hottestAddresses(1).front().address, Eq(0x0405));
+    EXPECT_THAT(profiler.topLevelCycles(), Eq(profiler.total()));
+}
+
+TEST_F(CycleProfilerTests, SeparatesInclusiveFromExclusiveCycles)
+{
+    // start JSR outer; JMP start
+    load(0x0400, { 0x20, 0x10, 0x04, 0x4C, 0x00, 0x04 });
+    // outer JSR inner; JSR inner; RTS
+    load(0x0410, { 0x20, 0x20, 0x04, 0x20, 0x20, 0x04, 0x60 });
+    // inner NOP; RTS
+    load(0x0420, { 0xEA, 0x60 });
+    computer.resetTo(0x0400);
+    for (int i = 0; i < 10; ++i)
+    {
+        runTo(0x0403);
+        runTo(0x0400);
+    }
+
+    const CycleProfiler::SubroutineCost outer = subroutine(0x0410);
+    const CycleProfiler::SubroutineCost inner = subroutine(0x0420);
+
+    EXPECT_THAT(inner.calls, Eq(20u));
+    EXPECT_THAT(inner.inclusive, Eq(20u * (2 + 6)));
+    EXPECT_THAT(inner.exclusive, Eq(inner.inclusive));
+    EXPECT_THAT(outer.calls, Eq(10u));
+    EXPECT_THAT(outer.exclusive, Eq(10u * (6 + 6 + 6)));
+    EXPECT_THAT(outer.inclusive, Eq(outer.exclusive + inner.inclusive));
+    EXPECT_THAT(profiler.topLevelCycles(), Eq(10u * (6 + 3)));
+    EXPECT_THAT(profiler.total(), Eq(profiler.topLevelCycles() + outer.inclusive));
+    EXPECT_THAT(profiler.subroutines().front().address, Eq(0x0410));
+    EXPECT_THAT(profiler.depth(), Eq(0u));
+}
+
+TEST_F(CycleProfilerTests, CountsRecursiveCallsOnce)
+{
+    // LDX #$03; JSR count; JMP to itself
+    load(0x0400, { 0xA2, 0x03, 0x20, 0x10, 0x04, 0x4C, 0x05, 0x04 });
+    // count DEX; BEQ done; JSR count; done RTS
+    load(0x0410, { 0xCA, 0xF0, 0x03, 0x20, 0x10, 0x04, 0x60 });
+    computer.resetTo(0x0400);
+    runTo(0x0405);
+
+    const CycleProfiler::SubroutineCost count = subroutine(0x0410);
+
+    EXPECT_THAT(count.calls, Eq(3u));
+    EXPECT_THAT(count.exclusive, Eq(2u * (2 + 2 + 6 + 6) + (2 + 3 + 6)));
+    EXPECT_THAT(count.inclusive, Eq(count.exclusive));
+    EXPECT_THAT(profiler.topLevelCycles(), Eq(2u + 6u));
+    EXPECT_THAT(profiler.depth(), Eq(0u));
+}
+
+TEST_F(CycleProfilerTests, ForgetsFramesWhoseReturnAddressWasDropped)
+{
+    // JSR drop
+    load(0x0400, { 0x20, 0x10, 0x04 });
+    // drop PLA; PLA; JMP $0430
+    load(0x0410, { 0x68, 0x68, 0x4C, 0x30, 0x04 });
+    // JSR $0440, which reuses the dropped return address's place
+    load(0x0430, { 0x20, 0x40, 0x04 });
+    load(0x0440, { 0x4C, 0x40, 0x04 });
+    computer.resetTo(0x0400);
+    runTo(0x0440);
+
+    EXPECT_THAT(profiler.depth(), Eq(1u));
+    EXPECT_THAT(subroutine(0x0410).inclusive, Eq(4u + 4u + 3u));
+    EXPECT_THAT(subroutine(0x0440).calls, Eq(1u));
+    EXPECT_THAT(profiler.topLevelCycles(), Eq(6u + 6u));
+}
+
+TEST_F(CycleProfilerTests, DoesNotReturnOnAnRtsUsedAsAJump)
+{
+    // JSR jump; JMP to itself
+    load(0x0400, { 0x20, 0x10, 0x04, 0x4C, 0x03, 0x04 });
+    // jump LDA #$04; PHA; LDA #$1F; PHA; RTS, on to $0420
+    load(0x0410, { 0xA9, 0x04, 0x48, 0xA9, 0x1F, 0x48, 0x60 });
+    // NOP; RTS, the real return
+    load(0x0420, { 0xEA, 0x60 });
+    computer.resetTo(0x0400);
+    runTo(0x0420);
+    EXPECT_THAT(profiler.depth(), Eq(1u));
+
+    runTo(0x0403);
+    EXPECT_THAT(profiler.depth(), Eq(0u));
+    EXPECT_THAT(subroutine(0x0410).inclusive, Eq(2u + 3u + 2u + 3u + 6u + 2u + 6u));
+}
+
+TEST_F(CycleProfilerTests, ReportsWithTheDisassembly)
+{
+    load(0x0400, { 0x20, 0x10, 0x04, 0x4C, 0x00, 0x04 });
+    load(0x0410, { 0xEA, 0x60 });
+    computer.resetTo(0x0400);
+    computer.scheduler().run(1000);
+
+    CycleProfiler::disassemblyType disassembly;
+    std::ostringstream             report;
+
+    for (uint16_t address : profiler.reportedAddresses(10))
+        disassembly.merge(computer.cpu().disassemble(address, address));
+    EXPECT_THAT(disassembly, SizeIs(4));
+    profiler.writeReport(report, disassembly, 10);
+    EXPECT_THAT(report.str(), HasSubstr("$0410: NOP  {IMP}"));
+    EXPECT_THAT(report.str(), HasSubstr("$0400: JSR $0410 {ABS}"));
+    EXPECT_THAT(report.str(), HasSubstr("(top level)"));
+}
+
+TEST_F(CycleProfilerTests, FollowsBreakAndInterruptHandlers)
+{
+    // NOP; BRK, which returns past two bytes here; JMP to itself
+    load(0x0400, { 0xEA, 0x00, 0xEA, 0xEA, 0x4C, 0x04, 0x04 });
+    // handler NOP; RTI
+    load(0x0500, { 0xEA, 0x40 });
+    load(0xFFFE, { 0x00, 0x05 });
+    computer.resetTo(0x0400);
+    runTo(0x0401);
+
+    // First the interrupt, as the handler returns with I set
+    computer.cpu().irq();
+    EXPECT_THAT(profiler.depth(), Eq(1u));
+    runTo(0x0401);
+    EXPECT_THAT(profiler.depth(), Eq(0u));
+
+    runTo(0x0500);
+    EXPECT_THAT(profiler.depth(), Eq(1u));
+    runTo(0x0404);
+    EXPECT_THAT(profiler.depth(), Eq(0u));
+
+    const CycleProfiler::SubroutineCost handler = subroutine(0x0500);
+
+    EXPECT_THAT(handler.calls, Eq(2u));
+    // The interrupt's own 7 cycles are the handler's, BRK's are its caller's
+    EXPECT_THAT(handler.inclusive, Eq((2u + 6u) + (7u + 2u + 6u)));
+    EXPECT_THAT(profiler.cycles(0x0500), Eq(2u + 7u + 2u));
+    EXPECT_THAT(profiler.total(), Eq(computer.cpu().clock_ticks - 8));
+}
+
+TEST_F(CycleProfilerTests, ForgetsEveryFrameOnAReset)
+{
+    // JSR spin; spin JMP spin
+    load(0x0400, { 0x20, 0x10, 0x04 });
+    load(0x0410, { 0x4C, 0x10, 0x04 });
+    computer.resetTo(0x0400);
+    runTo(0x0410);
+    ASSERT_THAT(profiler.depth(), Eq(1u));
+
+    computer.resetTo(0x0400);
+    EXPECT_THAT(profiler.depth(), Eq(0u));
+    EXPECT_THAT(subroutine(0x0410).calls, Eq(1u));
+}
+
+TEST_F(CycleProfilerTests, SamplesTheCallPathRunning)
+{
+    // As in SeparatesInclusiveFromExclusiveCycles
+    load(0x0400, { 0x20, 0x10, 0x04, 0x4C, 0x00, 0x04 });
+    load(0x0410, { 0x20, 0x20, 0x04, 0x20, 0x20, 0x04, 0x60 });
+    load(0x0420, { 0xEA, 0x60 });
+    profiler.setSampleInterval(1);
+    computer.resetTo(0x0400);
+    for (int i = 0; i < 10; ++i)
+    {
+        runTo(0x0403);
+        runTo(0x0400);
+    }
+
+    SymbolTable        symbols;
+    std::ostringstream stacks;
+
+    symbols.add(0x0410, "outer");
+    profiler.writeCollapsedStacks(stacks, symbols);
+    // A sample a cycle, so each path gets its exclusive cycles
+    EXPECT_THAT(stacks.str(), Eq("(top level) 90\n"
+                                 "(top level);outer 180\n"
+                                 "(top level);outer;$0420 160\n"));
+    EXPECT_THAT(profiler.samples(), Eq(profiler.total()));
+}
+
+TEST_F(CycleProfilerTests, SamplesOncePerInterval)
+{
+    // JSR sub; JMP to the start
+    load(0x0400, { 0x20, 0x10, 0x04, 0x4C, 0x00, 0x04 });
+    // sub BRK, which returns past two bytes here; RTS
+    load(0x0410, { 0x00, 0xEA, 0xEA, 0x60 });
+    // handler RTI
+    load(0x0500, { 0x40 });
+    load(0xFFFE, { 0x00, 0x05 });
+    profiler.setSampleInterval(5);
+    computer.resetTo(0x0400);
+    computer.scheduler().run(10000);
+
+    std::ostringstream stacks;
+
+    EXPECT_THAT(profiler.samples(), Eq(profiler.total() / 5));
+    profiler.writeCollapsedStacks(stacks, SymbolTable());
+    EXPECT_THAT(stacks.str(), HasSubstr("(top level);$0410;$0500 (BRK) "));
+
+    profiler.setSampleInterval(0);
+    computer.scheduler().run(10000);
+    EXPECT_THAT(profiler.samples(), Lt(profiler.total() / 5));
+}
+
+TEST(CycleProfiler, StartsAgainWhenCleared)
+{
+    CycleProfiler profiler;
+
+    profiler.setSampleInterval(1);
+    profiler.record(0x0400, 0x20, 0xFD, 0x0410, 6);
+    profiler.record(0x0410, 0xEA, 0xFB, 0x0411, 2);
+    profiler.clear();
+    EXPECT_THAT(profiler.total(), Eq(0u));
+    EXPECT_THAT(profiler.cycles(0x0400), Eq(0u));
+    EXPECT_THAT(profiler.depth(), Eq(0u));
+    EXPECT_THAT(profiler.subroutines(), IsEmpty());
+    EXPECT_THAT(profiler.samples(), Eq(0u));
+}
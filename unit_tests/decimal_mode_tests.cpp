@@ -0,0 +1,186 @@
+#include <gmock/gmock.h>
+#include "InstructionExecutorTestFixture.hpp"
+#include "decimaltables.hpp"
+
+using namespace testing;
+
+namespace
+{
+// This is the nibble-by-nibble decimal mode arithmetic as the executor
+// originally did it.  It is the reference the precomputed tables must match.
+struct ReferenceResult
+{
+    uint8_t a;
+    uint8_t status;
+};
+
+std::pair<uint8_t, bool> ReferenceAddBCD(uint8_t left, uint8_t right)
+{
+    uint16_t low_nybble_result = ((uint16_t)left  & 0x000F) +
+                                 ((uint16_t)right & 0x000F);
+    uint16_t low_nybble_carry = (low_nybble_result > 0x09) ? 0x0001 : 0x0000;
+
+    if (low_nybble_carry)
+        low_nybble_result -= 10;
+
+    uint16_t hi_nybble_result = ((uint16_t)left  >> 4) +
+                                ((uint16_t)right >> 4) +
+                                low_nybble_carry;
+    uint16_t hi_nybble_carry = (hi_nybble_result > 0x09) ? 0x0001 : 0x0000;
+
+    if (hi_nybble_carry)
+        hi_nybble_result -= 10;
+
+    return { static_cast<uint8_t>(low_nybble_result | (hi_nybble_result << 4)), static_cast<bool>(hi_nybble_carry) };
+}
+
+ReferenceResult ReferenceADC(Registers registers, uint8_t fetched)
+{
+    auto     result = ReferenceAddBCD(registers.a, fetched);
+    uint16_t temp = result.first;
+
+    registers.SetFlag(C, result.second);
+    registers.SetFlag(Z, (temp & 0x00FF) == 0);
+    registers.SetFlag(V, (~((uint16_t)registers.a ^ (uint16_t)fetched) & ((uint16_t)registers.a ^ (uint16_t)temp)) & 0x0080);
+    registers.SetFlag(N, temp & 0x80);
+    registers.a = temp & 0x00FF;
+    return { registers.a, registers.status };
+}
+
+ReferenceResult ReferenceSBC(Registers registers, uint8_t fetched)
+{
+    uint16_t value = 0x99 - fetched;
+    auto     result = ReferenceAddBCD(registers.a, value + (uint16_t)registers.GetFlag(C));
+    uint16_t temp = result.first;
+
+    registers.SetFlag(C, result.second);
+    registers.SetFlag(Z, ((temp & 0x00FF) == 0));
+    registers.SetFlag(V, (temp ^ (uint16_t)registers.a) & (temp ^ value) & 0x0080);
+    registers.SetFlag(N, temp & 0x0080);
+    registers.a = temp & 0x00FF;
+    return { registers.a, registers.status };
+}
+
+Registers DecimalModeRegisters(uint8_t a, bool carry)
+{
+    Registers registers;
+
+    registers.a = a;
+    registers.status = U | D;
+    registers.SetFlag(C, carry);
+    return registers;
+}
+}
+
+/** Every possible (accumulator, operand, carry) input of a decimal mode ADC matches the reference.
+ *
+ */
+TEST(DecimalTables, AddMatchesReferenceForAllInputs)
+{
+    const DecimalTables &tables = DecimalTables::instance();
+
+    for (int carry = 0; carry < 2; ++carry)
+        for (int a = 0; a < 256; ++a)
+            for (int m = 0; m < 256; ++m)
+            {
+                Registers             registers = DecimalModeRegisters(a, carry);
+                ReferenceResult       expected = ReferenceADC(registers, m);
+                DecimalTables::Entry  entry = tables.add(a, m, carry);
+                uint8_t               status = (registers.status & ~DecimalTables::affectedFlags()) | entry.flags;
+
+                ASSERT_THAT(entry.result, Eq(expected.a)) << "A=" << a << " M=" << m << " C=" << carry;
+                ASSERT_THAT(status, Eq(expected.status)) << "A=" << a << " M=" << m << " C=" << carry;
+            }
+}
+
+/** Every possible (accumulator, operand, carry) input of a decimal mode SBC matches the reference.
+ *
+ */
+TEST(DecimalTables, SubtractMatchesReferenceForAllInputs)
+{
+    const DecimalTables &tables = DecimalTables::instance();
+
+    for (int carry = 0; carry < 2; ++carry)
+        for (int a = 0; a < 256; ++a)
+            for (int m = 0; m < 256; ++m)
+            {
+                Registers             registers = DecimalModeRegisters(a, carry);
+                ReferenceResult       expected = ReferenceSBC(registers, m);
+                DecimalTables::Entry  entry = tables.subtract(a, m, carry);
+                uint8_t               status = (registers.status & ~DecimalTables::affectedFlags()) | entry.flags;
+
+                ASSERT_THAT(entry.result, Eq(expected.a)) << "A=" << a << " M=" << m << " C=" << carry;
+                ASSERT_THAT(status, Eq(expected.status)) << "A=" << a << " M=" << m << " C=" << carry;
+            }
+}
+
+TEST(DecimalTables, EntriesOnlyContainAffectedFlags)
+{
+    const DecimalTables &tables = DecimalTables::instance();
+
+    for (int carry = 0; carry < 2; ++carry)
+        for (int a = 0; a < 256; ++a)
+            for (int m = 0; m < 256; ++m)
+            {
+                ASSERT_THAT(tables.add(a, m, carry).flags & ~DecimalTables::affectedFlags(), Eq(0));
+                ASSERT_THAT(tables.subtract(a, m, carry).flags & ~DecimalTables::affectedFlags(), Eq(0));
+            }
+}
+
+/** Runs the actual instructions through the executor, in decimal mode, for every input.
+ *
+ */
+TEST_F(InstructionExecutorTestFixture, DecimalModeADCImmediateMatchesReferenceForAllInputs)
+{
+    for (int carry = 0; carry < 2; ++carry)
+        for (int a = 0; a < 256; ++a)
+            for (int m = 0; m < 256; ++m)
+            {
+                Registers       initial = DecimalModeRegisters(a, carry);
+                ReferenceResult expected = ReferenceADC(initial, m);
+
+                r = initial;
+                loadOpcodeIntoMemory(AbstractInstruction_e::ADC, AddressMode_e::Immediate, 0x8000);
+                fakeMemory[0x8001] = m;
+                readSignalsCaught.clear();
+                executeInstruction();
+
+                ASSERT_THAT(r.a, Eq(expected.a)) << "A=" << a << " M=" << m << " C=" << carry;
+                ASSERT_THAT(r.status, Eq(expected.status)) << "A=" << a << " M=" << m << " C=" << carry;
+            }
+}
+
+TEST_F(InstructionExecutorTestFixture, DecimalModeSBCImmediateMatchesReferenceForAllInputs)
+{
+    for (int carry = 0; carry < 2; ++carry)
+        for (int a = 0; a < 256; ++a)
+            for (int m = 0; m < 256; ++m)
+            {
+                Registers       initial = DecimalModeRegisters(a, carry);
+                ReferenceResult expected = ReferenceSBC(initial, m);
+
+                r = initial;
+                loadOpcodeIntoMemory(AbstractInstruction_e::SBC, AddressMode_e::Immediate, 0x8000);
+                fakeMemory[0x8001] = m;
+                readSignalsCaught.clear();
+                executeInstruction();
+
+                ASSERT_THAT(r.a, Eq(expected.a)) << "A=" << a << " M=" << m << " C=" << carry;
+                ASSERT_THAT(r.status, Eq(expected.status)) << "A=" << a << " M=" << m << " C=" << carry;
+            }
+}
+
+/** Decimal mode ADC/SBC take one more cycle than their binary counterparts.
+ *
+ */
+TEST_F(InstructionExecutorTestFixture, DecimalModeADCImmediateTakesAnExtraCycle)
+{
+    r = DecimalModeRegisters(0x15, false);
+    loadOpcodeIntoMemory(AbstractInstruction_e::ADC, AddressMode_e::Immediate, 0x8000);
+    fakeMemory[0x8001] = 0x27;
+
+    executor.clock();
+
+    EXPECT_THAT(executor.remainingCyclesForInstruction(), Eq(2));
+    EXPECT_THAT(r.a, Eq(0x42));
+}
@@ -0,0 +1,118 @@
+#include <gmock/gmock.h>
+#include "EngineProgramFixture.hpp"
+#include "executionstatistics.hpp"
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+// A little of everything the statistics count:
+//
+//       LDX #$03
+// loop  DEX
+//       BNE loop
+//       SED
+//       LDA #$09
+//       CLC
+//       ADC #$01
+//       SEC
+//       SBC #$01
+//       CLD
+//       LDY #$01
+//       LDA $04FF,Y
+// end   JMP end
+const std::vector<uint8_t> program {
+    0xA2, 0x03, 0xCA, 0xD0, 0xFD, 0xF8, 0xA9, 0x09, 0x18, 0x69, 0x01, 0x38, 0xE9, 0x01, 0xD8, 0xA0, 0x01,
+    0xB9, 0xFF, 0x04, 0x4C, 0x14, 0x04
+};
+constexpr uint16_t program_end = 0x0414;
+
+class ExecutionStatisticsTests : public EngineProgramFixture
+{
+public:
+    ExecutionStatisticsTests()
+    {
+        loadProgram(program);
+    }
+};
+}
+
+TEST_P(ExecutionStatisticsTests, CountsTheSameOnEveryEngine)
+{
+    runTo(program_end);
+
+    const ExecutionStatistics &statistics = computer.cpu().statistics();
+
+    EXPECT_THAT(statistics.opcodeCount(0xCA), Eq(3u));
+    EXPECT_THAT(statistics.opcodeCount(0xD0), Eq(3u));
+    EXPECT_THAT(statistics.opcodeCount(0xA9), Eq(1u));
+    EXPECT_THAT(statistics.instructions(), Eq(16u));
+    EXPECT_THAT(statistics.instructions(), Eq(computer.cpu().instructionCount()));
+    EXPECT_THAT(statistics.addressModeCount(AddressMode_e::Immediate), Eq(5u));
+    EXPECT_THAT(statistics.addressModeCount(AddressMode_e::Implied), Eq(7u));
+    EXPECT_THAT(statistics.addressModeCount(AddressMode_e::AbsoluteYIndexed), Eq(1u));
+    EXPECT_THAT(statistics.addressModeCount(AddressMode_e::Relative), Eq(3u));
+    EXPECT_THAT(statistics.pageCrossings(), Eq(1u));
+    EXPECT_THAT(statistics.branchesTaken(), Eq(2u));
+    EXPECT_THAT(statistics.branchesNotTaken(), Eq(1u));
+    EXPECT_THAT(statistics.branchPageCrossings(), Eq(0u));
+    EXPECT_THAT(statistics.decimalAdditions(), Eq(1u));
+    EXPECT_THAT(statistics.decimalSubtractions(), Eq(1u));
+}
+
+INSTANTIATE_TEST_SUITE_P(ExecutionStatistics, ExecutionStatisticsTests, EngineProgramFixture::everyEngine());
+
+TEST(ExecutionStatistics, CountsBranchesToAnotherPage)
+{
+    // LDX #$02; DEX; BNE back over the page boundary; JMP to itself
+    const std::vector<uint8_t> loop { 0xA2, 0x02, 0xCA, 0xD0, 0xFD, 0x4C, 0x02, 0x05 };
+    ComputerCore               computer;
+
+    computer.load(0x04FD, loop.data(), loop.size());
+    computer.resetTo(0x04FD);
+    RunTo(computer, 0x0502);
+
+    const ExecutionStatistics &statistics = computer.cpu().statistics();
+
+    EXPECT_THAT(statistics.branchesTaken(), Eq(1u));
+    EXPECT_THAT(statistics.branchPageCrossings(), Eq(1u));
+    EXPECT_THAT(statistics.branchesNotTaken(), Eq(1u));
+    EXPECT_THAT(statistics.pageCrossings(), Eq(0u));
+}
+
+TEST(ExecutionStatistics, ListsTheMostFrequentOpcodesFirst)
+{
+    ExecutionStatistics statistics;
+
+    for (uint8_t opcode : { 0xEA, 0xA9, 0xEA, 0x18, 0xEA, 0xA9 })
+        statistics.recordOpcode(opcode);
+
+    const std::vector<ExecutionStatistics::OpcodeCount> counts = statistics.mostFrequent(2);
+
+    ASSERT_THAT(counts, SizeIs(2));
+    EXPECT_THAT(counts[0].opcode, Eq(0xEA));
+    EXPECT_THAT(counts[0].count, Eq(3u));
+    EXPECT_THAT(counts[1].opcode, Eq(0xA9));
+    EXPECT_THAT(statistics.mostFrequent(), SizeIs(3));
+}
+
+TEST(ExecutionStatistics, StartsAgainWhenReset)
+{
+    ComputerCore computer;
+
+    computer.load(EngineProgramFixture::program_start, program.data(), program.size());
+    computer.resetTo(EngineProgramFixture::program_start);
+    RunTo(computer, program_end);
+    ASSERT_THAT(computer.cpu().statistics().instructions(), Gt(0u));
+
+    computer.cpu().resetStatistics();
+
+    const ExecutionStatistics &statistics = computer.cpu().statistics();
+
+    EXPECT_THAT(statistics.instructions(), Eq(0u));
+    EXPECT_THAT(statistics.pageCrossings(), Eq(0u));
+    EXPECT_THAT(statistics.branchesTaken(), Eq(0u));
+    EXPECT_THAT(statistics.decimalAdditions(), Eq(0u));
+    EXPECT_THAT(statistics.mostFrequent(), IsEmpty());
+}
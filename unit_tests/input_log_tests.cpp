@@ -0,0 +1,164 @@
+#include <gmock/gmock.h>
+#include "computercore.hpp"
+#include "inputlog.hpp"
+#include <memory>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+// Counts in $10 with interrupts enabled; the IRQ handler counts in $11 and
+// the NMI handler in $12:
+//
+// loop CLI
+//      INC $10
+//      JMP loop
+//
+// $0500 INC $11
+//       RTI
+//
+// $0600 INC $12
+//       RTI
+const std::vector<uint8_t> main_loop { 0x58, 0xE6, 0x10, 0x4C, 0x00, 0x04 };
+const std::vector<uint8_t> irq_handler { 0xE6, 0x11, 0x40 };
+const std::vector<uint8_t> nmi_handler { 0xE6, 0x12, 0x40 };
+const std::vector<uint8_t> vectors { 0x00, 0x06, 0x00, 0x04, 0x00, 0x05 };
+
+class InputLogTests : public Test
+{
+public:
+    InputLogTests()
+    {
+        computer.load(0x0400, main_loop.data(), main_loop.size());
+        computer.load(0x0500, irq_handler.data(), irq_handler.size());
+        computer.load(0x0600, nmi_handler.data(), nmi_handler.size());
+        computer.load(0xFFFA, vectors.data(), vectors.size());
+        computer.cpu().reset();
+    }
+
+    /** Clocks on to tick @p cycle, feeding in the logged inputs on the way.
+     *
+     */
+    void replayTo(uint64_t cycle)
+    {
+        InstructionExecutor &cpu = computer.cpu();
+        size_t               next = log.firstAt(cpu.clock_ticks);
+
+        while (cpu.clock_ticks < cycle)
+        {
+            for (; (next < log.events().size()) && (log.events()[next].cycle == cpu.clock_ticks); ++next)
+                InputLog::apply(cpu, log.events()[next].input);
+            cpu.clock();
+        }
+    }
+
+    ComputerCore computer;
+    InputLog     log;
+};
+
+std::vector<uint64_t> CyclesOf(const InputLog &log)
+{
+    std::vector<uint64_t> cycles;
+
+    for (const InputLog::Event &event : log.events())
+        cycles.push_back(event.cycle);
+    return cycles;
+}
+}
+
+TEST(InputLog, KeepsInputsInOrderAndForgetsTheFutureWhenRecordingInThePast)
+{
+    InputLog log;
+
+    log.record(10, InputLog::Input::Irq);
+    log.record(10, InputLog::Input::Nmi);
+    log.record(20, InputLog::Input::Irq);
+    log.record(30, InputLog::Input::Reset);
+    EXPECT_THAT(CyclesOf(log), ElementsAre(10, 10, 20, 30));
+
+    log.record(20, InputLog::Input::Nmi);
+    EXPECT_THAT(CyclesOf(log), ElementsAre(10, 10, 20, 20));
+    EXPECT_THAT(log.events()[3].input, Eq(InputLog::Input::Nmi));
+
+    log.record(15, InputLog::Input::Reset);
+    EXPECT_THAT(CyclesOf(log), ElementsAre(10, 10, 15));
+}
+
+TEST(InputLog, DiscardsFromEitherEnd)
+{
+    InputLog log;
+
+    for (uint64_t cycle : { 5, 10, 15, 20, 25 })
+        log.record(cycle, InputLog::Input::Irq);
+
+    EXPECT_THAT(log.firstAt(0), Eq(0u));
+    EXPECT_THAT(log.firstAt(11), Eq(2u));
+    EXPECT_THAT(log.firstAt(26), Eq(5u));
+
+    log.discardBefore(10);
+    EXPECT_THAT(CyclesOf(log), ElementsAre(10, 15, 20, 25));
+    log.discardFrom(20);
+    EXPECT_THAT(CyclesOf(log), ElementsAre(10, 15));
+    log.clear();
+    EXPECT_THAT(log.events(), IsEmpty());
+}
+
+TEST_F(InputLogTests, ASnapshotAndTheLogReplayToExactlyTheSameState)
+{
+    auto                 start = std::make_unique<MachineSnapshot>();
+    InstructionExecutor &cpu = computer.cpu();
+
+    replayTo(50);
+    computer.saveState(*start);
+
+    // Interrupts at odd moments, part way through instructions too
+    while (cpu.clock_ticks < 5000)
+    {
+        if ((cpu.clock_ticks % 397 == 0) || (cpu.clock_ticks == 1234))
+        {
+            const InputLog::Input input = (cpu.clock_ticks == 1234) ? InputLog::Input::Nmi : InputLog::Input::Irq;
+
+            log.record(cpu.clock_ticks, input);
+            InputLog::apply(cpu, input);
+        }
+        cpu.clock();
+    }
+
+    const Registers              registers = cpu.registers();
+    const uint8_t                remaining = cpu.remainingCyclesForInstruction();
+    const RamDevice::memory_type ram = computer.ram().memory();
+
+    ASSERT_THAT(ram[0x11], Gt(1));
+    ASSERT_THAT(ram[0x12], Eq(1));
+
+    computer.restoreState(*start);
+    replayTo(5000);
+
+    EXPECT_THAT(cpu.registers().a, Eq(registers.a));
+    EXPECT_THAT(cpu.registers().stack_pointer, Eq(registers.stack_pointer));
+    EXPECT_THAT(cpu.registers().program_counter, Eq(registers.program_counter));
+    EXPECT_THAT(cpu.status(), Eq(registers.status));
+    EXPECT_THAT(cpu.remainingCyclesForInstruction(), Eq(remaining));
+    EXPECT_THAT(computer.ram().memory(), Eq(ram));
+}
+
+TEST_F(InputLogTests, ReplayingWithoutTheLogGoesSomewhereElse)
+{
+    auto                 start = std::make_unique<MachineSnapshot>();
+    InstructionExecutor &cpu = computer.cpu();
+
+    computer.saveState(*start);
+    log.record(100, InputLog::Input::Irq);
+    replayTo(1000);
+
+    const uint8_t interrupts = computer.ram().memory()[0x11];
+
+    computer.restoreState(*start);
+    log.clear();
+    replayTo(1000);
+
+    EXPECT_THAT(interrupts, Eq(1));
+    EXPECT_THAT(computer.ram().memory()[0x11], Eq(0));
+    EXPECT_THAT(cpu.clock_ticks, Eq(1000u));
+}
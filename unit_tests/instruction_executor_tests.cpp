@@ -44,3 +44,66 @@ TEST_F(InstructionExecutorTestFixture, ClockTickIncrementsClockCount)
 
     EXPECT_THAT(executor.clock_ticks, Eq(std::numeric_limits<decltype(executor.clock_ticks)>::min()));
 }
+
+TEST_F(InstructionExecutorTestFixture, RegistersAreAlignedToACacheLine)
+{
+    EXPECT_THAT(reinterpret_cast<uintptr_t>(&executor.registers()) % 64, Eq(0U));
+}
+
+/** run() executes whole instructions, and reports only the final state.
+ *
+ */
+TEST_F(InstructionExecutorTestFixture, RunExecutesWholeInstructionsAndNotifiesOnce)
+{
+    // LDX #$03; loop: DEX; BNE loop
+    loadOpcodeIntoMemory(AbstractInstruction_e::LDX, AddressMode_e::Immediate, 0x8000);
+    fakeMemory[0x8001] = 0x03;
+    fakeMemory[0x8002] = OpcodeFor(AbstractInstruction_e::DEX, AddressMode_e::Implied);
+    fakeMemory[0x8003] = OpcodeFor(AbstractInstruction_e::BNE, AddressMode_e::Relative);
+    fakeMemory[0x8004] = 0xFD;
+    r.x = 0x55;
+    r.status = U;
+
+    // LDX (2) + DEX/BNE taken twice (2 + 3 each) + DEX/BNE not taken (2 + 2)
+    uint32_t elapsed = executor.run(16);
+
+    EXPECT_THAT(elapsed, Eq(16U));
+    EXPECT_THAT(executor.clock_ticks, Eq(16U));
+    EXPECT_TRUE(executor.complete());
+    EXPECT_THAT(r.x, Eq(0x00));
+    EXPECT_THAT(r.program_counter, Eq(0x8005));
+    EXPECT_THAT(r.status, Eq(U | Z));
+    EXPECT_THAT(xChangedSignalsCaught, ElementsAre(0x00));
+    EXPECT_THAT(programCounterChangedSignalsCaught, ElementsAre(0x8005));
+    EXPECT_THAT(statusChangedSignalsCaught, ElementsAre(U | Z));
+}
+
+TEST_F(InstructionExecutorTestFixture, RunMayOvershootToFinishAnInstruction)
+{
+    loadOpcodeIntoMemory(AbstractInstruction_e::LDA, AddressMode_e::Absolute, 0x8000);
+    fakeMemory[0x8001] = 0x00;
+    fakeMemory[0x8002] = 0x02;
+
+    EXPECT_THAT(executor.run(1), Eq(4U));
+    EXPECT_THAT(r.program_counter, Eq(0x8003));
+}
+
+TEST_F(InstructionExecutorTestFixture, CountsInstructions)
+{
+    // LDX #$03; loop: DEX; BNE loop
+    loadOpcodeIntoMemory(AbstractInstruction_e::LDX, AddressMode_e::Immediate, 0x8000);
+    fakeMemory[0x8001] = 0x03;
+    fakeMemory[0x8002] = OpcodeFor(AbstractInstruction_e::DEX, AddressMode_e::Implied);
+    fakeMemory[0x8003] = OpcodeFor(AbstractInstruction_e::BNE, AddressMode_e::Relative);
+    fakeMemory[0x8004] = 0xFD;
+
+    EXPECT_THAT(executor.instructionCount(), Eq(0U));
+
+    executor.clock();
+
+    EXPECT_THAT(executor.instructionCount(), Eq(1U));
+
+    executor.run(14);
+
+    EXPECT_THAT(executor.instructionCount(), Eq(7U));
+}
@@ -0,0 +1,283 @@
+#include <gmock/gmock.h>
+#include "instructionexecutor.hpp"
+#include "opcodes.hpp"
+#include <algorithm>
+#include <array>
+
+using namespace testing;
+
+namespace
+{
+using Engine = InstructionExecutor::Engine;
+
+/** A CPU with its own 64K of memory, running on a particular engine.
+ *
+ */
+struct Machine
+{
+    using addressType = InstructionExecutor::addressType;
+
+    explicit Machine(Engine engine)
+    {
+        memory.fill(0x00);
+        executor.setEngine(engine);
+    }
+
+    std::array<uint8_t, 64 * 1024> memory;
+    InstructionExecutor            executor{ [this](addressType address, bool) { return memory[address]; },
+                                             [this](addressType address, uint8_t data) { memory[address] = data; },
+                                             [](InstructionExecutor::registerType) { },
+                                             [](InstructionExecutor::registerType) { },
+                                             [](InstructionExecutor::registerType) { },
+                                             [](addressType) { },
+                                             [](InstructionExecutor::registerType) { },
+                                             [](InstructionExecutor::registerType) { }
+                                           };
+    Registers                     &registers = executor.registers();
+};
+
+constexpr Machine::addressType program_start = 0x0400;
+constexpr Machine::addressType data_address  = 0x0300;
+constexpr uint8_t              zp_address    = 0x10;
+constexpr uint8_t              pointer_address = 0x20;
+
+// A mix of every kind of addressing, arithmetic in both modes, stack
+// operations and branches.  Branches are given an offset of zero, so
+// execution always carries straight on.
+const std::vector<std::pair<AbstractInstruction_e, AddressMode_e>> mixed_instructions {
+    { AbstractInstruction_e::ADC, AddressMode_e::Immediate },
+    { AbstractInstruction_e::ADC, AddressMode_e::AbsoluteYIndexed },
+    { AbstractInstruction_e::SBC, AddressMode_e::XIndexedIndirect },
+    { AbstractInstruction_e::SBC, AddressMode_e::ZeroPage },
+    { AbstractInstruction_e::AND, AddressMode_e::ZeroPageXIndexed },
+    { AbstractInstruction_e::ORA, AddressMode_e::Absolute },
+    { AbstractInstruction_e::EOR, AddressMode_e::IndirectYIndexed },
+    { AbstractInstruction_e::CMP, AddressMode_e::AbsoluteXIndexed },
+    { AbstractInstruction_e::CPX, AddressMode_e::Immediate },
+    { AbstractInstruction_e::CPY, AddressMode_e::ZeroPage },
+    { AbstractInstruction_e::LDA, AddressMode_e::Immediate },
+    { AbstractInstruction_e::LDA, AddressMode_e::IndirectYIndexed },
+    { AbstractInstruction_e::LDX, AddressMode_e::ZeroPageYIndexed },
+    { AbstractInstruction_e::LDY, AddressMode_e::AbsoluteXIndexed },
+    { AbstractInstruction_e::STA, AddressMode_e::AbsoluteXIndexed },
+    { AbstractInstruction_e::STA, AddressMode_e::ZeroPage },
+    { AbstractInstruction_e::STX, AddressMode_e::Absolute },
+    { AbstractInstruction_e::STY, AddressMode_e::ZeroPageXIndexed },
+    { AbstractInstruction_e::BIT, AddressMode_e::Absolute },
+    { AbstractInstruction_e::INC, AddressMode_e::AbsoluteXIndexed },
+    { AbstractInstruction_e::DEC, AddressMode_e::ZeroPage },
+    { AbstractInstruction_e::ASL, AddressMode_e::Accumulator },
+    { AbstractInstruction_e::LSR, AddressMode_e::ZeroPage },
+    { AbstractInstruction_e::ROL, AddressMode_e::Absolute },
+    { AbstractInstruction_e::ROR, AddressMode_e::Accumulator },
+    { AbstractInstruction_e::INX, AddressMode_e::Implied },
+    { AbstractInstruction_e::DEY, AddressMode_e::Implied },
+    { AbstractInstruction_e::TAX, AddressMode_e::Implied },
+    { AbstractInstruction_e::TYA, AddressMode_e::Implied },
+    { AbstractInstruction_e::PHA, AddressMode_e::Implied },
+    { AbstractInstruction_e::PLA, AddressMode_e::Implied },
+    { AbstractInstruction_e::PHP, AddressMode_e::Implied },
+    { AbstractInstruction_e::CLC, AddressMode_e::Implied },
+    { AbstractInstruction_e::SEC, AddressMode_e::Implied },
+    { AbstractInstruction_e::SED, AddressMode_e::Implied },
+    { AbstractInstruction_e::CLD, AddressMode_e::Implied },
+    { AbstractInstruction_e::BNE, AddressMode_e::Relative },
+    { AbstractInstruction_e::BEQ, AddressMode_e::Relative },
+    { AbstractInstruction_e::BCC, AddressMode_e::Relative },
+    { AbstractInstruction_e::BMI, AddressMode_e::Relative },
+};
+
+// Fills memory with a pseudo-random mix of the instructions above.
+void LoadMixedProgram(Machine &machine, int instruction_count)
+{
+    Machine::addressType address = program_start;
+    uint32_t             seed = 0x6502;
+    auto                 next = [&seed]() { seed = seed * 1103515245 + 12345; return (seed >> 16) & 0x7FFF; };
+
+    machine.memory[pointer_address] = data_address & 0xFF;
+    machine.memory[pointer_address + 1] = data_address >> 8;
+    for (int i = 0; i < instruction_count; ++i)
+    {
+        auto [instruction, mode] = mixed_instructions[next() % mixed_instructions.size()];
+
+        machine.memory[address++] = OpcodeFor(instruction, mode);
+        switch (mode)
+        {
+        case AddressMode_e::Immediate:
+            machine.memory[address++] = next() & 0xFF;
+            break;
+        case AddressMode_e::ZeroPage:
+        case AddressMode_e::ZeroPageXIndexed:
+        case AddressMode_e::ZeroPageYIndexed:
+            machine.memory[address++] = zp_address + (next() & 0x07);
+            break;
+        case AddressMode_e::XIndexedIndirect:
+        case AddressMode_e::IndirectYIndexed:
+            // Keeps the pointer in reach whatever X is
+            machine.memory[address++] = pointer_address;
+            break;
+        case AddressMode_e::Absolute:
+        case AddressMode_e::AbsoluteXIndexed:
+        case AddressMode_e::AbsoluteYIndexed:
+            // Sometimes close enough to the end of the page to cross it
+            machine.memory[address++] = (data_address + (next() & 0xFF)) & 0xFF;
+            machine.memory[address++] = data_address >> 8;
+            break;
+        case AddressMode_e::Relative:
+            machine.memory[address++] = 0x00;
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void ExpectSameState(const Machine &actual, const Machine &expected)
+{
+    EXPECT_THAT(actual.executor.registers().a,               Eq(expected.executor.registers().a));
+    EXPECT_THAT(actual.executor.registers().x,               Eq(expected.executor.registers().x));
+    EXPECT_THAT(actual.executor.registers().y,               Eq(expected.executor.registers().y));
+    EXPECT_THAT(actual.executor.registers().stack_pointer,   Eq(expected.executor.registers().stack_pointer));
+    EXPECT_THAT(actual.executor.registers().program_counter, Eq(expected.executor.registers().program_counter));
+    EXPECT_THAT(actual.executor.status(),                    Eq(expected.executor.status()));
+    EXPECT_THAT(actual.executor.clock_ticks,                 Eq(expected.executor.clock_ticks));
+    EXPECT_TRUE(actual.memory == expected.memory) << "The memory contents differ";
+}
+
+class InterpreterEngine : public TestWithParam<Engine>
+{
+protected:
+    void SetUp() override
+    {
+        if (!InstructionExecutor::engineAvailable(GetParam()))
+            GTEST_SKIP() << "This engine was not built with this compiler";
+    }
+};
+}
+
+TEST(InterpreterEngines, TheTableEngineIsAlwaysAvailable)
+{
+    Machine machine(Engine::Table);
+
+    EXPECT_TRUE(InstructionExecutor::engineAvailable(Engine::Table));
+    EXPECT_TRUE(machine.executor.setEngine(Engine::Table));
+    EXPECT_THAT(machine.executor.engine(), Eq(Engine::Table));
+}
+
+TEST(InterpreterEngines, StartsWithTheDefaultEngine)
+{
+    InstructionExecutor executor{ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
+
+    EXPECT_THAT(executor.engine(), Eq(InstructionExecutor::defaultEngine()));
+    EXPECT_TRUE(InstructionExecutor::engineAvailable(InstructionExecutor::defaultEngine()));
+}
+
+TEST(InterpreterEngines, UnavailableEnginesCannotBeSelected)
+{
+    Machine machine(Engine::Table);
+
+    for (Engine engine : { Engine::Threaded, Engine::TailCall })
+        EXPECT_THAT(machine.executor.setEngine(engine), Eq(InstructionExecutor::engineAvailable(engine)));
+}
+
+/** Every engine has to end up exactly where the table engine does, after
+ *  every batch, whatever the batch size.
+ */
+TEST_P(InterpreterEngine, MatchesTheTableEngine)
+{
+    constexpr int instruction_count = 5000;
+
+    Machine expected(Engine::Table);
+    Machine actual(GetParam());
+
+    for (Machine *machine : { &expected, &actual })
+    {
+        LoadMixedProgram(*machine, instruction_count);
+        machine->registers.program_counter = program_start;
+        machine->registers.stack_pointer = 0xFD;
+        machine->registers.status = U;
+    }
+
+    // Odd batch sizes, so batches end part way through loops and instructions alike.
+    for (uint32_t batch : { 1U, 7U, 3U, 100U, 13U, 2000U })
+        for (int i = 0; i < 5; ++i)
+        {
+            EXPECT_THAT(actual.executor.run(batch), Eq(expected.executor.run(batch)));
+            ExpectSameState(actual, expected);
+        }
+}
+
+TEST_P(InterpreterEngine, RunsSuperinstructions)
+{
+    Machine expected(Engine::Table);
+    Machine actual(GetParam());
+
+    for (auto [first, second] : InstructionExecutor::fusiblePairs())
+        actual.executor.enableSuperinstruction(first, second);
+
+    // LDX #$20; loop: CLC; ADC #$03; LDA #$01; STA $0300,X; DEX; BNE loop; done: JMP done
+    for (Machine *machine : { &expected, &actual })
+    {
+        uint8_t program[] = { 0xA2, 0x20, 0x18, 0x69, 0x03, 0xA9, 0x01, 0x9D, 0x00, 0x03, 0xCA, 0xD0, 0xF6, 0x4C, 0x0D, 0x04 };
+
+        std::copy(std::begin(program), std::end(program), machine->memory.begin() + program_start);
+        machine->registers.program_counter = program_start;
+        machine->executor.run(1000);
+    }
+
+    ExpectSameState(actual, expected);
+    EXPECT_THAT(actual.executor.instructionCount(), Eq(expected.executor.instructionCount()));
+    EXPECT_THAT(actual.memory[0x0301], Eq(0x01));
+}
+
+/** Engines may keep their dispatch tables from one run to the next, so
+ *  they have to notice superinstructions changing in between.
+ */
+TEST_P(InterpreterEngine, FollowsSuperinstructionsChangingBetweenRuns)
+{
+    Machine machine(GetParam());
+
+    // loop: DEX; BNE loop
+    machine.memory[program_start] = 0xCA;
+    machine.memory[program_start + 1] = 0xD0;
+    machine.memory[program_start + 2] = 0xFD;
+    machine.registers.program_counter = program_start;
+    machine.registers.x = 0x03;
+
+    // A single dispatch is one instruction, or both halves of a fused pair
+    machine.executor.run(1);
+    EXPECT_THAT(machine.registers.program_counter, Eq(program_start + 1));
+
+    machine.registers.program_counter = program_start;
+    ASSERT_TRUE(machine.executor.enableSuperinstruction(0xCA, 0xD0));
+    machine.executor.run(1);
+    EXPECT_THAT(machine.registers.program_counter, Eq(program_start));
+    EXPECT_THAT(machine.registers.x, Eq(0x01));
+
+    machine.executor.disableSuperinstructions();
+    machine.executor.run(1);
+    EXPECT_THAT(machine.registers.program_counter, Eq(program_start + 1));
+    EXPECT_THAT(machine.registers.x, Eq(0x00));
+}
+
+TEST_P(InterpreterEngine, CountsOpcodePairs)
+{
+    Machine             machine(GetParam());
+    OpcodePairHistogram histogram;
+
+    machine.executor.setOpcodePairHistogram(&histogram);
+    // loop: DEX; BNE loop
+    machine.memory[program_start] = 0xCA;
+    machine.memory[program_start + 1] = 0xD0;
+    machine.memory[program_start + 2] = 0xFD;
+    machine.registers.program_counter = program_start;
+    machine.registers.x = 0x03;
+    machine.executor.run(2 + 3 + 2 + 3 + 2 + 2);
+
+    EXPECT_THAT(histogram.count(0xCA, 0xD0), Eq(3U));
+    EXPECT_THAT(histogram.count(0xD0, 0xCA), Eq(2U));
+}
+
+INSTANTIATE_TEST_SUITE_P(AllEngines,
+                         InterpreterEngine,
+                         Values(Engine::Table, Engine::Threaded, Engine::TailCall));
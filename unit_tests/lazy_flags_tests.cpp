@@ -0,0 +1,252 @@
+#include <gmock/gmock.h>
+#include "InstructionExecutorTestFixture.hpp"
+#include <array>
+
+using namespace testing;
+
+namespace
+{
+/** A CPU with its own 64K of memory, and no status observer.
+ *
+ *  Without a status changed delegate, the executor never has to materialize
+ *  lazily evaluated flags on its own, so this is where deferred flags
+ *  actually stay deferred.
+ */
+struct Machine
+{
+    using addressType = InstructionExecutor::addressType;
+
+    explicit Machine(bool lazy_flags)
+    {
+        memory.fill(0x00);
+        executor.setLazyFlags(lazy_flags);
+    }
+
+    std::array<uint8_t, 64 * 1024> memory;
+    InstructionExecutor            executor{ [this](addressType address, bool) { return memory[address]; },
+                                             [this](addressType address, uint8_t data) { memory[address] = data; },
+                                             [](InstructionExecutor::registerType) { },
+                                             [](InstructionExecutor::registerType) { },
+                                             [](InstructionExecutor::registerType) { },
+                                             [](addressType) { },
+                                             [](InstructionExecutor::registerType) { },
+                                             nullptr
+                                           };
+    Registers                     &registers = executor.registers();
+
+    void executeInstruction()
+    {
+        do {
+            executor.clock();
+        } while (!executor.complete());
+    }
+};
+
+// Instructions that either produce flags, or consume them in some way.
+// Branches are given an offset of zero, so taken or not, execution
+// simply continues with the next instruction.
+const std::vector<std::pair<AbstractInstruction_e, AddressMode_e>> mixed_instructions {
+    { AbstractInstruction_e::ADC, AddressMode_e::Immediate },
+    { AbstractInstruction_e::SBC, AddressMode_e::Immediate },
+    { AbstractInstruction_e::AND, AddressMode_e::Immediate },
+    { AbstractInstruction_e::ORA, AddressMode_e::Immediate },
+    { AbstractInstruction_e::EOR, AddressMode_e::Immediate },
+    { AbstractInstruction_e::CMP, AddressMode_e::Immediate },
+    { AbstractInstruction_e::CPX, AddressMode_e::Immediate },
+    { AbstractInstruction_e::CPY, AddressMode_e::Immediate },
+    { AbstractInstruction_e::LDA, AddressMode_e::Immediate },
+    { AbstractInstruction_e::LDX, AddressMode_e::Immediate },
+    { AbstractInstruction_e::LDY, AddressMode_e::Immediate },
+    { AbstractInstruction_e::BIT, AddressMode_e::ZeroPage },
+    { AbstractInstruction_e::INC, AddressMode_e::ZeroPage },
+    { AbstractInstruction_e::DEC, AddressMode_e::ZeroPage },
+    { AbstractInstruction_e::ASL, AddressMode_e::Accumulator },
+    { AbstractInstruction_e::LSR, AddressMode_e::Accumulator },
+    { AbstractInstruction_e::ROL, AddressMode_e::Accumulator },
+    { AbstractInstruction_e::ROR, AddressMode_e::Accumulator },
+    { AbstractInstruction_e::INX, AddressMode_e::Implied },
+    { AbstractInstruction_e::DEY, AddressMode_e::Implied },
+    { AbstractInstruction_e::TAX, AddressMode_e::Implied },
+    { AbstractInstruction_e::CLC, AddressMode_e::Implied },
+    { AbstractInstruction_e::SEC, AddressMode_e::Implied },
+    { AbstractInstruction_e::CLV, AddressMode_e::Implied },
+    { AbstractInstruction_e::PHP, AddressMode_e::Implied },
+    { AbstractInstruction_e::PLP, AddressMode_e::Implied },
+    { AbstractInstruction_e::BCC, AddressMode_e::Relative },
+    { AbstractInstruction_e::BCS, AddressMode_e::Relative },
+    { AbstractInstruction_e::BEQ, AddressMode_e::Relative },
+    { AbstractInstruction_e::BNE, AddressMode_e::Relative },
+    { AbstractInstruction_e::BMI, AddressMode_e::Relative },
+    { AbstractInstruction_e::BPL, AddressMode_e::Relative },
+    { AbstractInstruction_e::BVC, AddressMode_e::Relative },
+    { AbstractInstruction_e::BVS, AddressMode_e::Relative },
+};
+
+// Fills memory with a pseudo-random mix of the instructions above.
+Machine::addressType LoadMixedProgram(Machine &machine, Machine::addressType address, int instruction_count)
+{
+    uint32_t seed = 0x6502;
+    auto     next = [&seed]() { seed = seed * 1103515245 + 12345; return (seed >> 16) & 0x7FFF; };
+
+    for (int i = 0; i < instruction_count; ++i)
+    {
+        auto [instruction, mode] = mixed_instructions[next() % mixed_instructions.size()];
+
+        machine.memory[address++] = OpcodeFor(instruction, mode);
+        if (mode == AddressMode_e::Immediate)
+            machine.memory[address++] = next() & 0xFF;
+        else if (mode == AddressMode_e::ZeroPage)
+            machine.memory[address++] = 0x10 + (next() & 0x07);
+        else if (mode == AddressMode_e::Relative)
+            machine.memory[address++] = 0x00;
+    }
+    return address;
+}
+}
+
+TEST(LazyFlags, IsOffByDefault)
+{
+    InstructionExecutor executor{ nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
+
+    EXPECT_FALSE(executor.lazyFlags());
+}
+
+/** The same program, run with eager and with lazy flags, must agree after every instruction.
+ *
+ */
+TEST(LazyFlags, StatusMatchesEagerEvaluationAfterEveryInstruction)
+{
+    constexpr Machine::addressType start = 0x0400;
+    constexpr int                  instruction_count = 20000;
+
+    Machine eager(false);
+    Machine lazy(true);
+
+    LoadMixedProgram(eager, start, instruction_count);
+    LoadMixedProgram(lazy,  start, instruction_count);
+    for (Machine *machine : { &eager, &lazy })
+    {
+        machine->registers.program_counter = start;
+        machine->registers.stack_pointer = 0xFD;
+        machine->registers.status = U;
+    }
+
+    for (int i = 0; i < instruction_count; ++i)
+    {
+        eager.executeInstruction();
+        lazy.executeInstruction();
+
+        const Registers &expected = eager.executor.registers();
+        const Registers &actual   = lazy.executor.registers();
+
+        ASSERT_THAT(actual.status,          Eq(expected.status))          << "after instruction " << i;
+        ASSERT_THAT(actual.a,               Eq(expected.a))               << "after instruction " << i;
+        ASSERT_THAT(actual.x,               Eq(expected.x))               << "after instruction " << i;
+        ASSERT_THAT(actual.y,               Eq(expected.y))               << "after instruction " << i;
+        ASSERT_THAT(actual.stack_pointer,   Eq(expected.stack_pointer))   << "after instruction " << i;
+        ASSERT_THAT(actual.program_counter, Eq(expected.program_counter)) << "after instruction " << i;
+    }
+
+    // Every status byte that was pushed by PHP has to match as well.
+    EXPECT_TRUE(eager.memory == lazy.memory);
+}
+
+TEST(LazyFlags, FlagsAreOnlyComputedWhenRead)
+{
+    Machine machine(true);
+
+    machine.registers.status = U;
+    machine.registers.program_counter = 0x0400;
+    machine.memory[0x0400] = OpcodeFor(AbstractInstruction_e::LDA, AddressMode_e::Immediate);
+    machine.memory[0x0401] = 0x00;
+    machine.executeInstruction();
+
+    // Nothing has looked at the flags yet, so Z has not been set...
+    EXPECT_THAT(machine.registers.status, Eq(U));
+    // ...but asking for the status brings it up to date.
+    EXPECT_THAT(machine.executor.status(), Eq(U | Z));
+    EXPECT_THAT(machine.registers.status, Eq(U | Z));
+}
+
+TEST(LazyFlags, TurningLazyFlagsOffMaterializesPendingFlags)
+{
+    Machine machine(true);
+
+    machine.registers.status = U;
+    machine.registers.a = 0x40;
+    machine.registers.program_counter = 0x0400;
+    machine.memory[0x0400] = OpcodeFor(AbstractInstruction_e::CMP, AddressMode_e::Immediate);
+    machine.memory[0x0401] = 0x40;
+    machine.executeInstruction();
+
+    machine.executor.setLazyFlags(false);
+
+    EXPECT_FALSE(machine.executor.lazyFlags());
+    EXPECT_THAT(machine.registers.status, Eq(U | Z | C));
+}
+
+TEST(LazyFlags, BranchSeesDeferredFlags)
+{
+    Machine machine(true);
+
+    machine.registers.status = U;
+    machine.registers.x = 0x01;
+    machine.registers.program_counter = 0x0400;
+    machine.memory[0x0400] = OpcodeFor(AbstractInstruction_e::DEX, AddressMode_e::Implied);
+    machine.memory[0x0401] = OpcodeFor(AbstractInstruction_e::BEQ, AddressMode_e::Relative);
+    machine.memory[0x0402] = 0x10;
+    machine.executeInstruction();
+    machine.executeInstruction();
+
+    EXPECT_THAT(machine.registers.program_counter, Eq(0x0413));
+}
+
+TEST(LazyFlags, PHPPushesDeferredFlags)
+{
+    Machine machine(true);
+
+    machine.registers.status = U;
+    machine.registers.stack_pointer = 0xFF;
+    machine.registers.program_counter = 0x0400;
+    machine.memory[0x0400] = OpcodeFor(AbstractInstruction_e::LDA, AddressMode_e::Immediate);
+    machine.memory[0x0401] = 0x80;
+    machine.memory[0x0402] = OpcodeFor(AbstractInstruction_e::PHP, AddressMode_e::Implied);
+    machine.executeInstruction();
+    machine.executeInstruction();
+
+    EXPECT_THAT(machine.memory[0x01FF], Eq(N | B | U));
+}
+
+TEST(LazyFlags, PLPReplacesDeferredFlags)
+{
+    Machine machine(true);
+
+    machine.registers.status = U;
+    machine.registers.stack_pointer = 0xFE;
+    machine.registers.program_counter = 0x0400;
+    machine.memory[0x01FF] = C;
+    machine.memory[0x0400] = OpcodeFor(AbstractInstruction_e::LDA, AddressMode_e::Immediate);
+    machine.memory[0x0401] = 0x00;
+    machine.memory[0x0402] = OpcodeFor(AbstractInstruction_e::PLP, AddressMode_e::Implied);
+    machine.executeInstruction();
+    machine.executeInstruction();
+
+    EXPECT_THAT(machine.executor.status(), Eq(C | U));
+}
+
+/** With a status observer, every reported status is already up to date.
+ *
+ */
+TEST_F(InstructionExecutorTestFixture, LazyFlagsStillReportCorrectStatusChanges)
+{
+    executor.setLazyFlags(true);
+    r.status = U;
+    loadOpcodeIntoMemory(AbstractInstruction_e::LDA, AddressMode_e::Immediate, 0x8000);
+    fakeMemory[0x8001] = 0x00;
+
+    executeInstruction();
+
+    EXPECT_THAT(r.status, Eq(U | Z));
+    EXPECT_THAT(statusChangedSignalsCaught.size(), Eq(1));
+    EXPECT_THAT(statusChangedSignalsCaught[0], Eq(U | Z));
+}
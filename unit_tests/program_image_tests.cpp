@@ -0,0 +1,294 @@
+#include <gmock/gmock.h>
+#include "computercore.hpp"
+#include "programimage.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+using Format = ProgramImage::Format;
+
+const uint8_t *Bytes(const std::string &text) { return reinterpret_cast<const uint8_t *>(text.data()); }
+
+std::vector<uint8_t> INesImage(uint8_t prg_units, bool trainer)
+{
+    std::vector<uint8_t> image { 'N', 'E', 'S', 0x1A, prg_units, 1, static_cast<uint8_t>(trainer ? 0x04 : 0x00), 0,
+                                 0, 0, 0, 0, 0, 0, 0, 0 };
+
+    image.resize(image.size() + (trainer ? 512 : 0), 0xEE);
+    for (size_t i = 0; i < prg_units * 16u * 1024u; ++i)
+        image.push_back(static_cast<uint8_t>(i));
+    image.resize(image.size() + 8 * 1024, 0xCC); // CHR ROM
+    return image;
+}
+
+std::vector<uint8_t> SegmentBytes(const ProgramImage::Segment &segment)
+{
+    return std::vector<uint8_t>(segment.data, segment.data + segment.length);
+}
+}
+
+TEST(ProgramImage, DetectsTheFormatFromTheContents)
+{
+    const std::string    hex = ":0300000002000CEF\n";
+    const std::string    srec = "S1070000A9008520AA\n";
+    const std::string    text = "LDA #$00\n";
+    std::vector<uint8_t> ines = INesImage(1, false);
+
+    EXPECT_THAT(ProgramImage::detectFormat(Bytes(hex), hex.size()), Eq(Format::IntelHex));
+    EXPECT_THAT(ProgramImage::detectFormat(Bytes(srec), srec.size()), Eq(Format::SRecord));
+    EXPECT_THAT(ProgramImage::detectFormat(Bytes(text), text.size()), Eq(Format::Raw));
+    EXPECT_THAT(ProgramImage::detectFormat(ines.data(), ines.size()), Eq(Format::INes));
+}
+
+TEST(ProgramImage, UsesARawImageWhereItLies)
+{
+    const uint8_t data[] = { 0xA9, 0x01, 0x00 };
+    ProgramImage  image;
+    std::string   error;
+
+    ASSERT_TRUE(image.decode(data, sizeof(data), Format::Raw, 0x0400, error)) << error;
+    ASSERT_THAT(image.segments(), SizeIs(1));
+    EXPECT_THAT(image.segments()[0].address, Eq(0x0400));
+    EXPECT_THAT(image.segments()[0].data, Eq(data));
+    EXPECT_THAT(image.segments()[0].length, Eq(sizeof(data)));
+    EXPECT_THAT(image.entryPoint(), Optional(0x0400));
+}
+
+TEST(ProgramImage, ARawImageCoveringTheResetVectorHasNoEntryPoint)
+{
+    std::vector<uint8_t> data(32 * 1024, 0xEA);
+    ProgramImage         image;
+    std::string          error;
+
+    ASSERT_TRUE(image.decode(data.data(), data.size(), Format::Raw, 0x8000, error)) << error;
+    EXPECT_THAT(image.entryPoint(), Eq(std::nullopt));
+}
+
+TEST(ProgramImage, RejectsARawImageBiggerThanTheAddressSpace)
+{
+    std::vector<uint8_t> data(64 * 1024 + 1, 0xEA);
+    ProgramImage         image;
+    std::string          error;
+
+    EXPECT_FALSE(image.decode(data.data(), data.size(), Format::Raw, 0x0000, error));
+    EXPECT_THAT(error, HasSubstr("64K"));
+}
+
+TEST(ProgramImage, DecodesIntelHexIntoContiguousSegments)
+{
+    const std::string hex = ":0400000001020304F2\r\n"
+                            ":02000400050AEB\n"      // Follows on, so it is part of the same segment
+                            "\n"
+                            ":02100000AABB89\n"
+                            ":0400000500001000E7\n"  // Start linear address $1000
+                            ":00000001FF\n";
+    ProgramImage      image;
+    std::string       error;
+
+    ASSERT_TRUE(image.decode(Bytes(hex), hex.size(), Format::Detect, 0, error)) << error;
+    EXPECT_THAT(image.format(), Eq(Format::IntelHex));
+    ASSERT_THAT(image.segments(), SizeIs(2));
+    EXPECT_THAT(image.segments()[0].address, Eq(0x0000));
+    EXPECT_THAT(SegmentBytes(image.segments()[0]), ElementsAre(0x01, 0x02, 0x03, 0x04, 0x05, 0x0A));
+    EXPECT_THAT(image.segments()[1].address, Eq(0x1000));
+    EXPECT_THAT(SegmentBytes(image.segments()[1]), ElementsAre(0xAA, 0xBB));
+    EXPECT_THAT(image.entryPoint(), Optional(0x1000));
+    EXPECT_THAT(image.size(), Eq(8u));
+}
+
+TEST(ProgramImage, IntelHexExtendedAddressesMoveTheData)
+{
+    const std::string hex = ":020000020800F4\n"     // Segment $0800, so a base of $8000
+                            ":01001000EA05\n"
+                            ":00000001FF\n";
+    ProgramImage      image;
+    std::string       error;
+
+    ASSERT_TRUE(image.decode(Bytes(hex), hex.size(), Format::IntelHex, 0, error)) << error;
+    ASSERT_THAT(image.segments(), SizeIs(1));
+    EXPECT_THAT(image.segments()[0].address, Eq(0x8010));
+}
+
+TEST(ProgramImage, IntelHexStopsAtTheEndOfFileRecord)
+{
+    const std::string hex = ":01000000EA15\n"
+                            ":00000001FF\n"
+                            "Anything at all\n";
+    ProgramImage      image;
+    std::string       error;
+
+    ASSERT_TRUE(image.decode(Bytes(hex), hex.size(), Format::IntelHex, 0, error)) << error;
+    EXPECT_THAT(image.segments(), SizeIs(1));
+}
+
+TEST(ProgramImage, RejectsIntelHexWithABadChecksum)
+{
+    const std::string hex = ":01000000EA16\n";
+    ProgramImage      image;
+    std::string       error;
+
+    EXPECT_FALSE(image.decode(Bytes(hex), hex.size(), Format::IntelHex, 0, error));
+    EXPECT_THAT(error, StartsWith("Line 1: checksum"));
+}
+
+TEST(ProgramImage, RejectsIntelHexOutsideTheAddressSpace)
+{
+    const std::string hex = ":020000040001F9\n"     // Linear base $10000
+                            ":01000000EA15\n";
+    ProgramImage      image;
+    std::string       error;
+
+    EXPECT_FALSE(image.decode(Bytes(hex), hex.size(), Format::IntelHex, 0, error));
+    EXPECT_THAT(error, HasSubstr("Line 2"));
+}
+
+TEST(ProgramImage, DecodesSRecords)
+{
+    const std::string srec = "S00600004844521B\n"   // Header
+                             "S1070400A9008520A6\n"
+                             "S1050404EA0008\n"
+                             "S5030002FA\n"         // Record count
+                             "S9030400F8\n";
+    ProgramImage      image;
+    std::string       error;
+
+    ASSERT_TRUE(image.decode(Bytes(srec), srec.size(), Format::Detect, 0, error)) << error;
+    EXPECT_THAT(image.format(), Eq(Format::SRecord));
+    ASSERT_THAT(image.segments(), SizeIs(1));
+    EXPECT_THAT(image.segments()[0].address, Eq(0x0400));
+    EXPECT_THAT(SegmentBytes(image.segments()[0]), ElementsAre(0xA9, 0x00, 0x85, 0x20, 0xEA, 0x00));
+    EXPECT_THAT(image.entryPoint(), Optional(0x0400));
+}
+
+TEST(ProgramImage, DecodesThreeAndFourByteAddressSRecords)
+{
+    const std::string srec = "S2050080004238\n"
+                             "S306000090004326\n";
+    ProgramImage      image;
+    std::string       error;
+
+    ASSERT_TRUE(image.decode(Bytes(srec), srec.size(), Format::SRecord, 0, error)) << error;
+    ASSERT_THAT(image.segments(), SizeIs(2));
+    EXPECT_THAT(image.segments()[0].address, Eq(0x8000));
+    EXPECT_THAT(image.segments()[1].address, Eq(0x9000));
+}
+
+TEST(ProgramImage, RejectsSRecordsWithABadChecksum)
+{
+    const std::string srec = "S1070400A9008520A7\n";
+    ProgramImage      image;
+    std::string       error;
+
+    EXPECT_FALSE(image.decode(Bytes(srec), srec.size(), Format::SRecord, 0, error));
+    EXPECT_THAT(error, StartsWith("Line 1: checksum"));
+}
+
+TEST(ProgramImage, MirrorsSixteenKOfINesPrgRom)
+{
+    std::vector<uint8_t> ines = INesImage(1, false);
+    ProgramImage         image;
+    std::string          error;
+
+    ASSERT_TRUE(image.decode(ines.data(), ines.size(), Format::Detect, 0, error)) << error;
+    ASSERT_THAT(image.segments(), SizeIs(2));
+    EXPECT_THAT(image.segments()[0].address, Eq(0x8000));
+    EXPECT_THAT(image.segments()[1].address, Eq(0xC000));
+    EXPECT_THAT(image.segments()[0].data, Eq(ines.data() + 16));
+    EXPECT_THAT(image.segments()[1].data, Eq(ines.data() + 16));
+    EXPECT_THAT(image.entryPoint(), Eq(std::nullopt));
+}
+
+TEST(ProgramImage, SkipsTheINesTrainer)
+{
+    std::vector<uint8_t> ines = INesImage(2, true);
+    ProgramImage         image;
+    std::string          error;
+
+    ASSERT_TRUE(image.decode(ines.data(), ines.size(), Format::INes, 0, error)) << error;
+    ASSERT_THAT(image.segments(), SizeIs(1));
+    EXPECT_THAT(image.segments()[0].data, Eq(ines.data() + 16 + 512));
+    EXPECT_THAT(image.segments()[0].length, Eq(32u * 1024u));
+}
+
+TEST(ProgramImage, RejectsINesImagesThatNeedAMapper)
+{
+    std::vector<uint8_t> ines = INesImage(4, false);
+    ProgramImage         image;
+    std::string          error;
+
+    EXPECT_FALSE(image.decode(ines.data(), ines.size(), Format::INes, 0, error));
+    EXPECT_THAT(error, HasSubstr("mapper"));
+}
+
+TEST(ProgramImage, LoadsAFile)
+{
+    const std::string path = std::string(testing::TempDir()) + "program_image_test.hex";
+    ProgramImage      image;
+    std::string       error;
+
+    std::ofstream(path) << ":01000000EA15\n:00000001FF\n";
+    ASSERT_TRUE(image.load(path, Format::Detect, 0, error)) << error;
+    EXPECT_THAT(image.format(), Eq(Format::IntelHex));
+    EXPECT_THAT(image.size(), Eq(1u));
+    std::remove(path.c_str());
+
+    EXPECT_FALSE(image.load(path, Format::Detect, 0, error));
+    EXPECT_THAT(error, HasSubstr(path));
+}
+
+TEST(ProgramImage, BootingCopiesTheImageAndStartsAtItsEntryPoint)
+{
+    const std::string srec = "S1070400A9008520A6\n"
+                             "S9030400F8\n";
+    ProgramImage      image;
+    ComputerCore      computer;
+    std::string       error;
+
+    ASSERT_TRUE(image.decode(Bytes(srec), srec.size(), Format::SRecord, 0, error)) << error;
+    computer.boot(image);
+    computer.scheduler().run(8 + 2 + 3);
+
+    EXPECT_THAT(computer.ram().memory()[0x0400], Eq(0xA9));
+    EXPECT_THAT(computer.ram().memory()[0x0020], Eq(0x00));
+    EXPECT_THAT(computer.cpu().registers().program_counter, Eq(0x0404));
+}
+
+TEST(ProgramImage, BootingAnINesImageUsesItsResetVector)
+{
+    std::vector<uint8_t> ines = INesImage(1, false);
+    ProgramImage         image;
+    ComputerCore         computer;
+    std::string          error;
+
+    // The vector is at the end of the 16K, which shows up at $FFFC
+    ines[16 + 0x3FFC] = 0x34;
+    ines[16 + 0x3FFD] = 0x92;
+    ASSERT_TRUE(image.decode(ines.data(), ines.size(), Format::INes, 0, error)) << error;
+    computer.boot(image);
+    computer.scheduler().run(8);
+
+    EXPECT_THAT(computer.ram().memory()[0x8000], Eq(0x00));
+    EXPECT_THAT(computer.ram().memory()[0xC001], Eq(0x01));
+    EXPECT_THAT(computer.cpu().registers().program_counter, Eq(0x9234));
+}
+
+TEST(RamDevice, LoadWrapsAroundTheEndOfMemory)
+{
+    RamDevice     ram;
+    const uint8_t data[] = { 1, 2, 3, 4 };
+    int           observed = 0;
+
+    ram.setWriteObserver([&](RamDevice::addressType, uint8_t) { ++observed; });
+    ram.load(0xFFFE, data, sizeof(data));
+
+    EXPECT_THAT(ram.memory()[0xFFFE], Eq(1));
+    EXPECT_THAT(ram.memory()[0xFFFF], Eq(2));
+    EXPECT_THAT(ram.memory()[0x0000], Eq(3));
+    EXPECT_THAT(ram.memory()[0x0001], Eq(4));
+    EXPECT_THAT(observed, Eq(0));
+}
@@ -438,3 +438,39 @@ TEST(Registers, GetFlagAndSetFlagAreRelated)
     registers.SetFlag(N, 0);
     EXPECT_THAT(registers.GetFlag(N), Eq(false));
 }
+
+/** Demonstrate that SetFlags only replaces the flags within the mask.
+ *
+ */
+TEST(Registers, SetFlagsOnlyAffectsMaskedFlags)
+{
+    Registers registers;
+
+    registers.status = I | D | U;
+    registers.SetFlags(C | Z | V | N, C | N | I);
+    EXPECT_THAT(registers.status, Eq(I | D | U | C | N)) << "Unmasked flags must be left untouched";
+
+    registers.SetFlags(C | Z | V | N, Z | V);
+    EXPECT_THAT(registers.status, Eq(I | D | U | Z | V)) << "Masked flags must all be replaced";
+
+    registers.SetFlags(I | D | U, 0x00);
+    EXPECT_THAT(registers.status, Eq(Z | V));
+}
+
+/** Demonstrate that SetNZ sets N and Z from a value for every possible value, leaving other flags alone.
+ *
+ */
+TEST(Registers, SetNZMatchesValueForAllValues)
+{
+    for (int value = 0; value < 256; ++value)
+    {
+        Registers registers;
+
+        registers.status = C | I | D | B | U | V;
+        registers.SetNZ(value);
+
+        EXPECT_THAT(registers.GetFlag(Z), Eq(value == 0x00)) << "value = " << value;
+        EXPECT_THAT(registers.GetFlag(N), Eq((value & 0x80) != 0)) << "value = " << value;
+        EXPECT_THAT(registers.status & ~(N | Z), Eq(C | I | D | B | U | V)) << "value = " << value;
+    }
+}
@@ -0,0 +1,210 @@
+#include <gmock/gmock.h>
+#include "computercore.hpp"
+#include "lzcodec.hpp"
+#include "rewindbuffer.hpp"
+#include <memory>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+// Adds to memory a page at a time, moving up a page each time round:
+//
+//      LDX #$00
+// loop LDA $1000,X
+//      ADC #$03
+// st   STA $1000,X
+//      INX
+//      BNE loop
+//      INC loop+2
+//      INC st+2
+//      JMP $0400
+const std::vector<uint8_t> program {
+    0xA2, 0x00, 0xBD, 0x00, 0x10, 0x69, 0x03, 0x9D, 0x00, 0x10, 0xE8, 0xD0, 0xF5, 0xEE, 0x04, 0x04, 0xEE, 0x09, 0x04,
+    0x4C, 0x00, 0x04
+};
+
+class RewindBufferTests : public Test
+{
+public:
+    RewindBufferTests()
+    {
+        computer.load(0x0400, program.data(), program.size());
+        computer.resetTo(0x0400);
+        rewind.setInterval(1000);
+        rewind.setKeyframeInterval(4);
+    }
+
+    /** Runs an interval at a time, pushing a snapshot after each and keeping
+     *  a copy to compare with.
+     */
+    void record(int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            computer.scheduler().run(rewind.interval());
+            saved.push_back(std::make_unique<MachineSnapshot>());
+            computer.saveState(*saved.back());
+            rewind.push(*saved.back());
+        }
+    }
+
+    ComputerCore computer;
+    RewindBuffer rewind;
+    std::vector<std::unique_ptr<MachineSnapshot>> saved;
+};
+
+void ExpectSame(const MachineSnapshot &actual, const MachineSnapshot &expected)
+{
+    EXPECT_THAT(actual.cycle, Eq(expected.cycle));
+    EXPECT_THAT(actual.cpu.clock_ticks, Eq(expected.cpu.clock_ticks));
+    EXPECT_THAT(actual.cpu.state.registers.program_counter, Eq(expected.cpu.state.registers.program_counter));
+    EXPECT_THAT(actual.cpu.state.registers.a, Eq(expected.cpu.state.registers.a));
+    EXPECT_THAT(actual.ram, Eq(expected.ram));
+}
+
+std::vector<uint8_t> RoundTrip(const std::vector<uint8_t> &data, size_t &compressed_size)
+{
+    std::vector<uint8_t> compressed(LzCodec::maxCompressedSize(data.size()));
+    std::vector<uint8_t> decompressed(data.size(), 0xAA);
+
+    compressed_size = LzCodec::compress(data.data(), data.size(), compressed.data());
+    EXPECT_TRUE(LzCodec::decompress(compressed.data(), compressed_size, decompressed.data(), decompressed.size()));
+    return decompressed;
+}
+}
+
+TEST(LzCodec, RoundTripsRunsTextAndNoise)
+{
+    std::vector<uint8_t> zeroes(64 * 1024, 0x00);
+    std::vector<uint8_t> text;
+    std::vector<uint8_t> noise(5000);
+    uint32_t             seed = 12345;
+    size_t               size;
+
+    for (int i = 0; i < 200; ++i)
+        for (char c : std::string("LDA $0300,X ADC #$03 STA $0300,X "))
+            text.push_back(static_cast<uint8_t>(c + i % 3));
+    for (uint8_t &value : noise)
+    {
+        seed = seed * 1103515245 + 12345;
+        value = static_cast<uint8_t>(seed >> 16);
+    }
+
+    EXPECT_THAT(RoundTrip(zeroes, size), Eq(zeroes));
+    EXPECT_THAT(size, Lt(300u));
+    EXPECT_THAT(RoundTrip(text, size), Eq(text));
+    EXPECT_THAT(size, Lt(text.size() / 4));
+    EXPECT_THAT(RoundTrip(noise, size), Eq(noise));
+    EXPECT_THAT(size, Le(LzCodec::maxCompressedSize(noise.size())));
+    EXPECT_THAT(RoundTrip({ }, size), IsEmpty());
+    EXPECT_THAT(RoundTrip({ 1, 2, 3 }, size), ElementsAre(1, 2, 3));
+}
+
+TEST(LzCodec, RejectsWhatDoesNotDecompressToTheRightLength)
+{
+    std::vector<uint8_t> data(1000, 0x55);
+    std::vector<uint8_t> compressed(LzCodec::maxCompressedSize(data.size()));
+    std::vector<uint8_t> decompressed(data.size() + 1);
+
+    const size_t size = LzCodec::compress(data.data(), data.size(), compressed.data());
+
+    // Cut off part way through the run's length
+    EXPECT_FALSE(LzCodec::decompress(compressed.data(), size - 2, decompressed.data(), data.size()));
+    EXPECT_FALSE(LzCodec::decompress(compressed.data(), size, decompressed.data(), data.size() - 1));
+    EXPECT_FALSE(LzCodec::decompress(compressed.data(), size, decompressed.data(), data.size() + 1));
+
+    // A match reaching back before the start
+    const uint8_t bad_offset[] = { 0x10, 0x55, 0x02, 0x00 };
+
+    EXPECT_FALSE(LzCodec::decompress(bad_offset, sizeof(bad_offset), decompressed.data(), 5));
+}
+
+TEST_F(RewindBufferTests, RestoresEverySnapshotExactly)
+{
+    auto restored = std::make_unique<MachineSnapshot>();
+
+    record(10);
+
+    ASSERT_THAT(rewind.count(), Eq(10u));
+    for (const auto &expected : saved)
+    {
+        ASSERT_TRUE(rewind.restore(expected->cycle, *restored));
+        ExpectSame(*restored, *expected);
+    }
+}
+
+TEST_F(RewindBufferTests, RestoresTheNewestSnapshotAtOrBeforeACycle)
+{
+    auto restored = std::make_unique<MachineSnapshot>();
+
+    record(5);
+
+    EXPECT_FALSE(rewind.restore(saved[0]->cycle - 1, *restored));
+    ASSERT_TRUE(rewind.restore(saved[2]->cycle + 999, *restored));
+    ExpectSame(*restored, *saved[2]);
+    ASSERT_TRUE(rewind.restore(saved[4]->cycle + 1000000, *restored));
+    ExpectSame(*restored, *saved[4]);
+}
+
+TEST_F(RewindBufferTests, SnapshotsAreDueAnIntervalApart)
+{
+    EXPECT_TRUE(rewind.due(0));
+    record(1);
+    EXPECT_FALSE(rewind.due(saved[0]->cycle + 999));
+    EXPECT_TRUE(rewind.due(saved[0]->cycle + 1000));
+}
+
+TEST_F(RewindBufferTests, StaysWithinItsBudgetByDroppingTheOldestGroups)
+{
+    auto restored = std::make_unique<MachineSnapshot>();
+
+    record(8);
+
+    const size_t two_groups = rewind.bytes();
+
+    rewind.setBudget(two_groups);
+    record(8);
+
+    const size_t oldest = saved.size() - rewind.count();
+
+    EXPECT_THAT(rewind.bytes(), Le(two_groups));
+    EXPECT_THAT(oldest % 4, Eq(0u));
+    EXPECT_THAT(*rewind.oldestCycle(), Eq(saved[oldest]->cycle));
+    EXPECT_FALSE(rewind.restore(saved[3]->cycle, *restored));
+    for (size_t i = oldest; i < saved.size(); ++i)
+    {
+        ASSERT_TRUE(rewind.restore(saved[i]->cycle, *restored));
+        ExpectSame(*restored, *saved[i]);
+    }
+}
+
+TEST_F(RewindBufferTests, GoingBackForgetsWhatCameAfter)
+{
+    auto restored = std::make_unique<MachineSnapshot>();
+
+    record(10);
+    ASSERT_TRUE(rewind.restore(saved[5]->cycle, *restored));
+    computer.restoreState(*restored);
+    rewind.discardAfter(restored->cycle);
+
+    EXPECT_THAT(rewind.count(), Eq(6u));
+    EXPECT_THAT(*rewind.newestCycle(), Eq(saved[5]->cycle));
+
+    // Deltas carry on from the keyframe that's still there
+    saved.resize(6);
+    record(6);
+    for (const auto &expected : saved)
+    {
+        ASSERT_TRUE(rewind.restore(expected->cycle, *restored));
+        ExpectSame(*restored, *expected);
+    }
+}
+
+TEST_F(RewindBufferTests, CompressesSnapshotsFarBelowTheirSize)
+{
+    record(20);
+
+    EXPECT_THAT(rewind.bytes() / rewind.count(), Lt(sizeof(MachineSnapshot) / 10));
+}
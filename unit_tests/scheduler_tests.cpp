@@ -0,0 +1,192 @@
+#include <gmock/gmock.h>
+#include "computercore.hpp"
+#include "opcodes.hpp"
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+constexpr ComputerCore::addressType program_start = 0x0400;
+
+// loop: NOP; JMP loop - five cycles a time around
+const uint8_t nop_loop[] = { 0xEA, 0x4C, 0x00, 0x04 };
+
+void LoadNopLoop(ComputerCore &computer)
+{
+    computer.load(program_start, nop_loop, sizeof(nop_loop));
+    computer.resetTo(program_start);
+}
+
+/** Stops the scheduler the first time its address is read, like a breakpoint.
+ *
+ */
+class StoppingDevice : public BusDevice
+{
+public:
+    StoppingDevice(addressType address, ComputerCore &computer)
+        :
+        BusDevice(address, address, false, true),
+        _computer(computer)
+    {
+    }
+
+    int reads = 0;
+
+protected:
+    void writeImplementation(addressType, uint8_t) override { }
+
+    uint8_t readImplementation(addressType address, bool) override
+    {
+        if (reads++ == 0)
+            _computer.scheduler().stop();
+        return _computer.ram().memory()[address];
+    }
+
+private:
+    ComputerCore &_computer;
+};
+}
+
+TEST(ComputerCore, ResetStartsAtTheGivenAddress)
+{
+    ComputerCore computer;
+
+    LoadNopLoop(computer);
+
+    EXPECT_THAT(computer.cpu().registers().program_counter, Eq(program_start));
+    EXPECT_THAT(computer.ram().memory()[0xFFFC], Eq(0x00));
+    EXPECT_THAT(computer.ram().memory()[0xFFFD], Eq(0x04));
+}
+
+TEST(ComputerCore, LoadWrapsAroundTheAddressSpace)
+{
+    ComputerCore  computer;
+    const uint8_t data[] = { 0x01, 0x02, 0x03 };
+
+    computer.load(0xFFFE, data, sizeof(data));
+
+    EXPECT_THAT(computer.ram().memory()[0xFFFF], Eq(0x02));
+    EXPECT_THAT(computer.ram().memory()[0x0000], Eq(0x03));
+}
+
+TEST(ComputerCore, RunsAProgram)
+{
+    ComputerCore  computer;
+    // LDA #$42; STA $10; loop: JMP loop
+    const uint8_t program[] = { 0xA9, 0x42, 0x85, 0x10, 0x4C, 0x04, 0x04 };
+
+    computer.load(program_start, program, sizeof(program));
+    computer.resetTo(program_start);
+    computer.scheduler().run(100);
+
+    EXPECT_THAT(computer.ram().memory()[0x0010], Eq(0x42));
+}
+
+TEST(Scheduler, RunsForAtLeastTheCyclesAskedFor)
+{
+    ComputerCore computer;
+
+    LoadNopLoop(computer);
+
+    uint32_t elapsed = computer.scheduler().run(1000);
+
+    EXPECT_THAT(elapsed, Ge(1000U));
+    EXPECT_THAT(elapsed, Lt(1000U + 7));
+    EXPECT_THAT(computer.scheduler().now(), Eq(elapsed));
+}
+
+TEST(Scheduler, FiresEventsInOrder)
+{
+    ComputerCore     computer;
+    std::vector<int> fired;
+
+    LoadNopLoop(computer);
+    computer.scheduler().schedule(300, [&fired]() { fired.push_back(3); });
+    computer.scheduler().schedule(100, [&fired]() { fired.push_back(1); });
+    computer.scheduler().schedule(200, [&fired]() { fired.push_back(2); });
+    computer.scheduler().schedule(200, [&fired]() { fired.push_back(22); });
+    computer.scheduler().schedule(5000, [&fired]() { fired.push_back(5); });
+    computer.scheduler().run(1000);
+
+    EXPECT_THAT(fired, ElementsAre(1, 2, 22, 3));
+    EXPECT_THAT(computer.scheduler().pending(), Eq(1U));
+}
+
+TEST(Scheduler, FiresEventsOnceTheyAreDue)
+{
+    ComputerCore computer;
+    uint64_t     fired_at = 0;
+
+    LoadNopLoop(computer);
+    computer.scheduler().schedule(100, [&computer, &fired_at]() { fired_at = computer.scheduler().now(); });
+    computer.scheduler().run(1000);
+
+    // The instruction running when it fell due is allowed to finish
+    EXPECT_THAT(fired_at, Ge(100U));
+    EXPECT_THAT(fired_at, Lt(100U + 7));
+}
+
+TEST(Scheduler, EventsCanRescheduleThemselves)
+{
+    ComputerCore          computer;
+    int                   ticks = 0;
+    std::function<void()> tick;
+
+    tick = [&]()
+    {
+        ++ticks;
+        computer.scheduler().schedule(100, tick);
+    };
+    LoadNopLoop(computer);
+    computer.scheduler().schedule(100, tick);
+    computer.scheduler().run(1000);
+
+    EXPECT_THAT(ticks, AllOf(Ge(9), Le(10)));
+}
+
+TEST(Scheduler, StopEndsTheRunEarly)
+{
+    ComputerCore computer;
+
+    LoadNopLoop(computer);
+    computer.scheduler().schedule(100, [&computer]() { computer.scheduler().stop(); });
+
+    EXPECT_THAT(computer.scheduler().run(1000), Lt(200U));
+}
+
+TEST(Scheduler, BusDevicesCanStopTheRunPartWayThroughTheCPUsTurn)
+{
+    ComputerCore   computer;
+    StoppingDevice jump(program_start + 1, computer);
+
+    LoadNopLoop(computer);
+    computer.bus().attach(jump);
+
+    // The reset (8) and the NOP (2), then the JMP being read finishes too (3)
+    EXPECT_THAT(computer.scheduler().run(1000), Eq(8U + 2 + 3));
+    EXPECT_THAT(computer.cpu().registers().program_counter, Eq(program_start));
+
+    // The next run carries on as normal
+    EXPECT_THAT(computer.scheduler().run(1000), Ge(1000U));
+    EXPECT_THAT(jump.reads, Gt(1));
+    computer.bus().detach(jump);
+}
+
+TEST(Scheduler, DeliversInterrupts)
+{
+    ComputerCore computer;
+
+    LoadNopLoop(computer);
+    // The handler is at $0500: INC $20; RTI
+    computer.ram().memory()[0x0500] = OpcodeFor(AbstractInstruction_e::INC, AddressMode_e::ZeroPage);
+    computer.ram().memory()[0x0501] = 0x20;
+    computer.ram().memory()[0x0502] = OpcodeFor(AbstractInstruction_e::RTI, AddressMode_e::Implied);
+    computer.ram().memory()[0xFFFE] = 0x00;
+    computer.ram().memory()[0xFFFF] = 0x05;
+    computer.scheduler().schedule(100, [&computer]() { computer.cpu().irq(); });
+    computer.scheduler().run(1000);
+
+    EXPECT_THAT(computer.ram().memory()[0x0020], Eq(1));
+    EXPECT_THAT(computer.cpu().registers().program_counter, AllOf(Ge(program_start), Lt(program_start + 4)));
+}
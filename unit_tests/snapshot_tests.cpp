@@ -0,0 +1,281 @@
+#include <gmock/gmock.h>
+#include "computercore.hpp"
+#include "machinesnapshot.hpp"
+#include <cstring>
+#include <memory>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+// Counts down through memory, adding as it goes:
+//
+//      LDX #$40
+// loop LDA $0300,X
+//      ADC #$07
+//      STA $0300,X
+//      PHA
+//      PLA
+//      DEX
+//      BNE loop
+//      JMP $0400
+const std::vector<uint8_t> program {
+    0xA2, 0x40, 0xBD, 0x00, 0x03, 0x69, 0x07, 0x9D, 0x00, 0x03, 0x48, 0x68, 0xCA, 0xD0, 0xF3, 0x4C, 0x00, 0x04
+};
+
+class SnapshotTests : public Test
+{
+public:
+    SnapshotTests()
+    {
+        computer.load(0x0400, program.data(), program.size());
+        computer.resetTo(0x0400);
+    }
+
+    ComputerCore computer;
+};
+
+struct Observed
+{
+    Registers registers;
+    uint32_t  clock_ticks;
+    uint64_t  instructions;
+    uint8_t   remaining_cycles;
+    std::vector<uint8_t> data;
+};
+
+Observed Observe(InstructionExecutor &cpu, const RamDevice &ram)
+{
+    return { cpu.registers(), cpu.clock_ticks, cpu.instructionCount(), cpu.remainingCyclesForInstruction(),
+             std::vector<uint8_t>(ram.memory().begin() + 0x0100, ram.memory().begin() + 0x0400) };
+}
+
+void ExpectSame(const Observed &actual, const Observed &expected)
+{
+    EXPECT_THAT(actual.registers.a, Eq(expected.registers.a));
+    EXPECT_THAT(actual.registers.x, Eq(expected.registers.x));
+    EXPECT_THAT(actual.registers.y, Eq(expected.registers.y));
+    EXPECT_THAT(actual.registers.stack_pointer, Eq(expected.registers.stack_pointer));
+    EXPECT_THAT(actual.registers.program_counter, Eq(expected.registers.program_counter));
+    EXPECT_THAT(actual.registers.status, Eq(expected.registers.status));
+    EXPECT_THAT(actual.clock_ticks, Eq(expected.clock_ticks));
+    EXPECT_THAT(actual.instructions, Eq(expected.instructions));
+    EXPECT_THAT(actual.remaining_cycles, Eq(expected.remaining_cycles));
+    EXPECT_THAT(actual.data, Eq(expected.data));
+}
+}
+
+TEST_F(SnapshotTests, CarriesOnExactlyAsBeforeAfterARestore)
+{
+    auto snapshot = std::make_unique<MachineSnapshot>();
+
+    computer.scheduler().run(500);
+    computer.saveState(*snapshot);
+    computer.scheduler().run(3000);
+
+    const Observed expected = Observe(computer.cpu(), computer.ram());
+
+    computer.restoreState(*snapshot);
+    EXPECT_THAT(computer.scheduler().now(), Eq(snapshot->cycle));
+    computer.scheduler().run(3000);
+
+    ExpectSame(Observe(computer.cpu(), computer.ram()), expected);
+}
+
+TEST_F(SnapshotTests, RoundTripsPartWayThroughAnInstruction)
+{
+    auto snapshot = std::make_unique<MachineSnapshot>();
+
+    // Reset, LDX and then into the LDA abs,X
+    for (int i = 0; i < 8 + 2 + 1; ++i)
+        computer.cpu().clock();
+    ASSERT_THAT(computer.cpu().remainingCyclesForInstruction(), Gt(0));
+    computer.saveState(*snapshot);
+    for (int i = 0; i < 1000; ++i)
+        computer.cpu().clock();
+
+    const Observed expected = Observe(computer.cpu(), computer.ram());
+
+    computer.restoreState(*snapshot);
+    EXPECT_THAT(computer.cpu().remainingCyclesForInstruction(), Eq(snapshot->cpu.state.cycles));
+    for (int i = 0; i < 1000; ++i)
+        computer.cpu().clock();
+
+    ExpectSame(Observe(computer.cpu(), computer.ram()), expected);
+}
+
+TEST_F(SnapshotTests, KeepsFlagsThatAreStillPending)
+{
+    auto snapshot = std::make_unique<MachineSnapshot>();
+
+    computer.cpu().setLazyFlags(true);
+    computer.scheduler().run(777);
+    computer.saveState(*snapshot);
+
+    const uint8_t status = computer.cpu().status();
+
+    computer.scheduler().run(1234);
+    computer.restoreState(*snapshot);
+
+    EXPECT_THAT(computer.cpu().status(), Eq(status));
+}
+
+TEST_F(SnapshotTests, RestoringIntoAnEagerExecutorComputesPendingFlags)
+{
+    auto snapshot = std::make_unique<MachineSnapshot>();
+
+    computer.cpu().setLazyFlags(true);
+    computer.scheduler().run(777);
+    computer.saveState(*snapshot);
+
+    const uint8_t status = computer.cpu().status();
+
+    computer.cpu().setLazyFlags(false);
+    computer.restoreState(*snapshot);
+
+    EXPECT_FALSE(computer.cpu().lazyFlags());
+    EXPECT_THAT(computer.cpu().status(), Eq(status));
+}
+
+TEST_F(SnapshotTests, ASnapshotCanBeCopiedAsBytes)
+{
+    auto snapshot = std::make_unique<MachineSnapshot>();
+    auto copy = std::make_unique<MachineSnapshot>();
+
+    computer.scheduler().run(500);
+    computer.saveState(*snapshot);
+    std::memcpy(copy.get(), snapshot.get(), sizeof(MachineSnapshot));
+    computer.scheduler().run(500);
+
+    const Observed expected = Observe(computer.cpu(), computer.ram());
+
+    computer.restoreState(*copy);
+    computer.scheduler().run(500);
+
+    ExpectSame(Observe(computer.cpu(), computer.ram()), expected);
+}
+
+TEST(InstructionExecutorSnapshot, RestoringTellsTheObserversWhatChanged)
+{
+    std::vector<uint8_t> a_values;
+    std::vector<uint16_t> pc_values;
+    InstructionExecutor  cpu { [](InstructionExecutor::addressType, bool) -> uint8_t { return 0xEA; },
+                               [](InstructionExecutor::addressType, uint8_t) { },
+                               [&a_values](uint8_t value) { a_values.push_back(value); }, nullptr, nullptr,
+                               [&pc_values](uint16_t value) { pc_values.push_back(value); }, nullptr, nullptr };
+    InstructionExecutor::Snapshot snapshot;
+
+    cpu.saveState(snapshot);
+    cpu.registers().a = 0x42;
+    cpu.registers().program_counter = 0x1234;
+    cpu.restoreState(snapshot);
+
+    EXPECT_THAT(a_values, ElementsAre(0x00));
+    EXPECT_THAT(pc_values, ElementsAre(0x0000));
+}
+
+TEST(RamDevice, TracksThePagesWrittenTo)
+{
+    RamDevice     ram;
+    const uint8_t block[] = { 1, 2, 3 };
+
+    ram.write(0x0234, 0x01);
+    ram.writeBlock(0x05FF, block, sizeof(block));
+    ram.load(0xFFFF, block, 2);
+
+    EXPECT_THAT(ram.dirtyPages().count(), Eq(5u));
+    EXPECT_TRUE(ram.dirtyPages()[0x02]);
+    EXPECT_TRUE(ram.dirtyPages()[0x05]);
+    EXPECT_TRUE(ram.dirtyPages()[0x06]);
+    EXPECT_TRUE(ram.dirtyPages()[0xFF]);
+    EXPECT_TRUE(ram.dirtyPages()[0x00]);
+
+    ram.clearDirtyPages();
+    ram.read(0x0234, false);
+    EXPECT_TRUE(ram.dirtyPages().none());
+}
+
+TEST_F(SnapshotTests, ADeltaOnlyHoldsThePagesWrittenTo)
+{
+    auto          base = std::make_unique<MachineSnapshot>();
+    DeltaSnapshot delta;
+
+    computer.scheduler().run(100);
+    computer.saveState(*base);
+    computer.scheduler().run(2000);
+    computer.saveDelta(delta);
+
+    // The stack and the table being added to
+    EXPECT_THAT(delta.pages.count(), Eq(2u));
+    EXPECT_TRUE(delta.pages[0x01]);
+    EXPECT_TRUE(delta.pages[0x03]);
+    EXPECT_THAT(delta.data.size(), Eq(2 * DeltaSnapshot::page_size));
+    EXPECT_THAT(delta.size(), Lt(1024u));
+    EXPECT_TRUE(computer.ram().dirtyPages().none());
+}
+
+TEST_F(SnapshotTests, ABaseAndItsDeltasRebuildEveryStateAlongTheWay)
+{
+    auto                       base = std::make_unique<MachineSnapshot>();
+    std::vector<DeltaSnapshot> deltas(5);
+    std::vector<Observed>      expected;
+
+    computer.scheduler().run(100);
+    computer.saveState(*base);
+    for (DeltaSnapshot &delta : deltas)
+    {
+        computer.scheduler().run(1500);
+        computer.saveDelta(delta);
+        expected.push_back(Observe(computer.cpu(), computer.ram()));
+    }
+    computer.scheduler().run(5000);
+
+    for (size_t count = 1; count <= deltas.size(); ++count)
+    {
+        computer.restoreState(*base, std::vector<DeltaSnapshot>(deltas.begin(), deltas.begin() + count));
+        ExpectSame(Observe(computer.cpu(), computer.ram()), expected[count - 1]);
+        EXPECT_THAT(computer.scheduler().now(), Eq(deltas[count - 1].cycle));
+    }
+}
+
+TEST_F(SnapshotTests, ADeltaKeepsTheResetVector)
+{
+    auto          base = std::make_unique<MachineSnapshot>();
+    DeltaSnapshot delta;
+
+    computer.saveState(*base);
+    computer.resetTo(0x0402);
+    computer.saveDelta(delta);
+    EXPECT_TRUE(delta.pages[0xFF]);
+
+    const Observed expected = Observe(computer.cpu(), computer.ram());
+
+    computer.resetTo(0x0400);
+    computer.restoreState(*base, { delta });
+
+    ExpectSame(Observe(computer.cpu(), computer.ram()), expected);
+    EXPECT_THAT(computer.ram().memory()[0xFFFC], Eq(0x02));
+    EXPECT_THAT(computer.ram().memory()[0xFFFD], Eq(0x04));
+}
+
+TEST_F(SnapshotTests, DeltasCanBeAppliedToASnapshot)
+{
+    auto          base = std::make_unique<MachineSnapshot>();
+    auto          later = std::make_unique<MachineSnapshot>();
+    DeltaSnapshot delta;
+
+    computer.saveState(*base);
+    computer.scheduler().run(3000);
+    computer.saveDelta(delta);
+
+    const Observed expected = Observe(computer.cpu(), computer.ram());
+
+    *later = *base;
+    delta.applyTo(*later);
+    computer.scheduler().run(3000);
+    computer.restoreState(*later);
+
+    ExpectSame(Observe(computer.cpu(), computer.ram()), expected);
+    EXPECT_THAT(later->ram, Eq(computer.ram().memory()));
+}
@@ -0,0 +1,251 @@
+#include <gmock/gmock.h>
+#include "instructionexecutor.hpp"
+#include "opcodes.hpp"
+#include <array>
+#include <initializer_list>
+
+using namespace testing;
+
+namespace
+{
+/** A CPU with its own 64K of memory, recording every access.
+ *
+ */
+struct Machine
+{
+    using addressType = InstructionExecutor::addressType;
+
+    struct Access
+    {
+        bool        write;
+        addressType address;
+        uint8_t     data;
+
+        bool operator ==(const Access &other) const
+        {
+            return (write == other.write) && (address == other.address) && (data == other.data);
+        }
+    };
+
+    Machine() { memory.fill(0x00); }
+
+    std::array<uint8_t, 64 * 1024> memory;
+    std::vector<Access>            accesses;
+    InstructionExecutor            executor{ [this](addressType address, bool)
+                                             {
+                                                 accesses.push_back({ false, address, memory[address] });
+                                                 return memory[address];
+                                             },
+                                             [this](addressType address, uint8_t data)
+                                             {
+                                                 accesses.push_back({ true, address, data });
+                                                 memory[address] = data;
+                                             },
+                                             [](InstructionExecutor::registerType) { },
+                                             [](InstructionExecutor::registerType) { },
+                                             [](InstructionExecutor::registerType) { },
+                                             [](addressType) { },
+                                             [](InstructionExecutor::registerType) { },
+                                             [](InstructionExecutor::registerType) { }
+                                           };
+    Registers                     &registers = executor.registers();
+
+    void load(addressType address, std::initializer_list<uint8_t> bytes)
+    {
+        for (uint8_t b : bytes)
+            memory[address++] = b;
+    }
+
+    // Runs from start until the program counter reaches stop, one dispatch at a time.
+    void runUntil(addressType start, addressType stop)
+    {
+        registers.program_counter = start;
+        registers.stack_pointer = 0xFD;
+        for (int guard = 0; (registers.program_counter != stop) && (guard < 100000); ++guard)
+            executor.run(1);
+    }
+};
+
+constexpr Machine::addressType program_start = 0x0400;
+
+/** Loads the same program into two machines, one fusing every possible pair
+ *  and one not fusing at all, and checks they end up in the same state.
+ */
+void ExpectFusionMatchesSeparateExecution(std::initializer_list<uint8_t> program, Machine::addressType stop, uint8_t initial_status = U)
+{
+    Machine separate;
+    Machine fused;
+
+    for (auto [first, second] : InstructionExecutor::fusiblePairs())
+        EXPECT_TRUE(fused.executor.enableSuperinstruction(first, second));
+
+    for (Machine *machine : { &separate, &fused })
+    {
+        machine->load(program_start, program);
+        machine->memory[0x0010] = 0xFC;
+        machine->registers.status = initial_status;
+        machine->registers.a = 0x7F;
+        machine->registers.x = 0x04;
+        machine->registers.y = 0x03;
+        machine->runUntil(program_start, stop);
+    }
+
+    EXPECT_THAT(fused.registers.a,               Eq(separate.registers.a));
+    EXPECT_THAT(fused.registers.x,               Eq(separate.registers.x));
+    EXPECT_THAT(fused.registers.y,               Eq(separate.registers.y));
+    EXPECT_THAT(fused.registers.stack_pointer,   Eq(separate.registers.stack_pointer));
+    EXPECT_THAT(fused.registers.program_counter, Eq(separate.registers.program_counter));
+    EXPECT_THAT(fused.executor.status(),         Eq(separate.executor.status()));
+    EXPECT_THAT(fused.executor.clock_ticks,      Eq(separate.executor.clock_ticks));
+    EXPECT_TRUE(fused.accesses == separate.accesses) << "The memory accesses differ";
+}
+}
+
+TEST(Superinstructions, NoneAreEnabledByDefault)
+{
+    Machine machine;
+
+    EXPECT_THAT(machine.executor.enabledSuperinstructions(), IsEmpty());
+}
+
+TEST(Superinstructions, OnlyFusiblePairsCanBeEnabled)
+{
+    Machine machine;
+
+    EXPECT_TRUE(machine.executor.enableSuperinstruction(OpcodeFor(AbstractInstruction_e::DEX, AddressMode_e::Implied),
+                                                        OpcodeFor(AbstractInstruction_e::BNE, AddressMode_e::Relative)));
+    EXPECT_FALSE(machine.executor.enableSuperinstruction(OpcodeFor(AbstractInstruction_e::NOP, AddressMode_e::Implied),
+                                                         OpcodeFor(AbstractInstruction_e::NOP, AddressMode_e::Implied)));
+    EXPECT_THAT(machine.executor.enabledSuperinstructions().size(), Eq(1U));
+
+    machine.executor.disableSuperinstructions();
+
+    EXPECT_THAT(machine.executor.enabledSuperinstructions(), IsEmpty());
+}
+
+TEST(Superinstructions, DEYBNELoop)
+{
+    // loop: DEY; BNE loop
+    ExpectFusionMatchesSeparateExecution({ 0x88, 0xD0, 0xFD }, 0x0403);
+}
+
+TEST(Superinstructions, DEXBNELoopAcrossAPage)
+{
+    // Branching back across the page boundary takes an extra cycle.
+    Machine::addressType start = 0x04FE;
+    Machine separate;
+    Machine fused;
+
+    fused.executor.enableSuperinstruction(0xCA, 0xD0);
+    for (Machine *machine : { &separate, &fused })
+    {
+        machine->load(start, { 0xCA, 0xD0, 0xFD });
+        machine->registers.x = 0x05;
+        machine->runUntil(start, start + 3);
+    }
+
+    EXPECT_THAT(fused.registers.x, Eq(0x00));
+    EXPECT_THAT(fused.executor.status(), Eq(separate.executor.status()));
+    EXPECT_THAT(fused.executor.clock_ticks, Eq(separate.executor.clock_ticks));
+    EXPECT_TRUE(fused.accesses == separate.accesses);
+}
+
+TEST(Superinstructions, LDASTA)
+{
+    // LDA #$80; STA $10; LDA #$00; STA $0300,X; LDA #$01; STA $0300,Y; LDA #$02; STA $20,X; LDA #$03; STA $0301
+    ExpectFusionMatchesSeparateExecution({ 0xA9, 0x80, 0x85, 0x10,
+                                           0xA9, 0x00, 0x9D, 0x00, 0x03,
+                                           0xA9, 0x01, 0x99, 0x00, 0x03,
+                                           0xA9, 0x02, 0x95, 0x20,
+                                           0xA9, 0x03, 0x8D, 0x01, 0x03 }, 0x0417);
+}
+
+TEST(Superinstructions, CMPBEQ)
+{
+    // CMP #$7F; BEQ +2; NOP; NOP; CMP #$10; BEQ +1; NOP
+    ExpectFusionMatchesSeparateExecution({ 0xC9, 0x7F, 0xF0, 0x02, 0xEA, 0xEA,
+                                           0xC9, 0x10, 0xF0, 0x01, 0xEA }, 0x040B);
+}
+
+TEST(Superinstructions, INCBNE)
+{
+    // loop: INC $10; BNE loop  (counts $FC up to $00)
+    ExpectFusionMatchesSeparateExecution({ 0xE6, 0x10, 0xD0, 0xFC }, 0x0404);
+}
+
+TEST(Superinstructions, CLCADC)
+{
+    // CLC; ADC #$01; CLC; ADC $10; CLC; ADC $0010
+    ExpectFusionMatchesSeparateExecution({ 0x18, 0x69, 0x01, 0x18, 0x65, 0x10, 0x18, 0x6D, 0x10, 0x00 }, 0x040A, U | C);
+}
+
+TEST(Superinstructions, CLCADCInDecimalMode)
+{
+    ExpectFusionMatchesSeparateExecution({ 0x18, 0x69, 0x01, 0x18, 0x65, 0x10 }, 0x0406, U | C | D);
+}
+
+TEST(Superinstructions, FirstHalfWithoutItsPartner)
+{
+    // DEX; INX; DEY; NOP; CLC; SEC; LDA #$00; LDX #$01 - none of these pairs can fuse.
+    ExpectFusionMatchesSeparateExecution({ 0xCA, 0xE8, 0x88, 0xEA, 0x18, 0x38, 0xA9, 0x00, 0xA2, 0x01 }, 0x040A);
+}
+
+TEST(Superinstructions, FlagsStayExactWithLazyFlags)
+{
+    Machine eager;
+    Machine lazy;
+
+    lazy.executor.setLazyFlags(true);
+    for (auto [first, second] : InstructionExecutor::fusiblePairs())
+        lazy.executor.enableSuperinstruction(first, second);
+
+    for (Machine *machine : { &eager, &lazy })
+    {
+        // LDX #$03; loop: CLC; ADC #$40; CMP #$C0; BEQ +0; DEX; BNE loop
+        machine->load(program_start, { 0xA2, 0x03, 0x18, 0x69, 0x40, 0xC9, 0xC0, 0xF0, 0x00, 0xCA, 0xD0, 0xF6 });
+        machine->registers.status = U;
+        machine->runUntil(program_start, 0x040C);
+    }
+
+    EXPECT_THAT(lazy.executor.status(), Eq(eager.executor.status()));
+    EXPECT_THAT(lazy.registers.a, Eq(eager.registers.a));
+    EXPECT_THAT(lazy.executor.clock_ticks, Eq(eager.executor.clock_ticks));
+}
+
+TEST(OpcodePairHistogram, CountsExecutedPairs)
+{
+    Machine             machine;
+    OpcodePairHistogram histogram;
+
+    machine.executor.setOpcodePairHistogram(&histogram);
+    // LDX #$05; loop: DEX; BNE loop
+    machine.load(program_start, { 0xA2, 0x05, 0xCA, 0xD0, 0xFD });
+    machine.runUntil(program_start, 0x0405);
+
+    EXPECT_THAT(histogram.count(0xA2, 0xCA), Eq(1U));
+    EXPECT_THAT(histogram.count(0xCA, 0xD0), Eq(5U));
+    EXPECT_THAT(histogram.count(0xD0, 0xCA), Eq(4U));
+
+    auto top = histogram.mostFrequent(1);
+
+    ASSERT_THAT(top.size(), Eq(1U));
+    EXPECT_THAT(top[0].first, Eq(0xCA));
+    EXPECT_THAT(top[0].second, Eq(0xD0));
+}
+
+TEST(OpcodePairHistogram, SelectsFrequentFusiblePairs)
+{
+    Machine             machine;
+    OpcodePairHistogram histogram;
+
+    histogram.record(0xCA, 0xD0);
+    histogram.record(0xCA, 0xD0);
+    histogram.record(0x88, 0xD0);
+    for (int i = 0; i < 7; ++i)
+        histogram.record(0xEA, 0xEA);
+
+    EXPECT_THAT(machine.executor.selectSuperinstructions(histogram, 0.15), Eq(1U));
+    EXPECT_THAT(machine.executor.enabledSuperinstructions(), ElementsAre(InstructionExecutor::opcodePairType(0xCA, 0xD0)));
+
+    EXPECT_THAT(machine.executor.selectSuperinstructions(histogram, 0.0), Eq(2U));
+}
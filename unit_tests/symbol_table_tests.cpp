@@ -0,0 +1,48 @@
+#include <gmock/gmock.h>
+#include "symboltable.hpp"
+#include <string>
+
+using namespace testing;
+
+TEST(SymbolTable, ReadsViceLabels)
+{
+    SymbolTable symbols;
+    std::string error;
+
+    ASSERT_TRUE(symbols.decode("al C:C000 .reset\n"
+                               "al 00E123 .draw_sprite\n"
+                               "\n"
+                               "al C:C000 .also_reset\n", error)) << error;
+    EXPECT_THAT(symbols.size(), Eq(2u));
+    EXPECT_THAT(symbols.nameOf(0xC000), Eq("reset"));
+    EXPECT_THAT(symbols.nameOf(0xE123), Eq("draw_sprite"));
+}
+
+TEST(SymbolTable, ReadsAssignments)
+{
+    SymbolTable symbols;
+    std::string error;
+
+    ASSERT_TRUE(symbols.decode("; equates\n"
+                               "reset = $C000\n"
+                               "nmi := 0xC100   ; the handler\n"
+                               "irq=49664\n"
+                               "# done\n", error)) << error;
+    EXPECT_THAT(symbols.nameOf(0xC000), Eq("reset"));
+    EXPECT_THAT(symbols.nameOf(0xC100), Eq("nmi"));
+    EXPECT_THAT(symbols.nameOf(0xC200), Eq("irq"));
+    EXPECT_THAT(symbols.find(0x0400), IsNull());
+    EXPECT_THAT(symbols.nameOf(0x0400), Eq("$0400"));
+}
+
+TEST(SymbolTable, RejectsWhatIsNotASymbol)
+{
+    SymbolTable symbols;
+    std::string error;
+
+    EXPECT_FALSE(symbols.decode("reset = $C000\nLDA #$00\n", error));
+    EXPECT_THAT(error, HasSubstr("Line 2"));
+    EXPECT_FALSE(symbols.decode("big = $10000\n", error));
+    EXPECT_FALSE(symbols.decode("al C:C000\n", error));
+    EXPECT_FALSE(symbols.load("/nonexistent/symbols.lbl", error));
+}
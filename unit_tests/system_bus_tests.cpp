@@ -0,0 +1,236 @@
+#include <gmock/gmock.h>
+#include "ramdevice.hpp"
+#include "systembus.hpp"
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+/** A device that remembers what it was asked, and answers with a fixed value.
+ *
+ */
+class RecordingDevice : public BusDevice
+{
+public:
+    RecordingDevice(addressType lower, addressType upper, uint8_t answer, bool writable = true, bool readable = true)
+        :
+        BusDevice(lower, upper, writable, readable),
+        _answer(answer)
+    {
+    }
+
+    std::vector<std::pair<addressType, uint8_t>> writes;
+    std::vector<addressType>                     reads;
+
+protected:
+    void writeImplementation(addressType address, uint8_t data) override
+    {
+        writes.emplace_back(address, data);
+    }
+
+    uint8_t readImplementation(addressType address, bool) override
+    {
+        reads.push_back(address);
+        return _answer;
+    }
+
+private:
+    uint8_t _answer;
+};
+}
+
+TEST(SystemBus, ReadsFromRam)
+{
+    SystemBus bus;
+    RamDevice ram;
+
+    bus.attach(ram);
+    ram.memory()[0x1234] = 0x56;
+
+    EXPECT_THAT(bus.read(0x1234), Eq(0x56));
+}
+
+TEST(SystemBus, WritesToRam)
+{
+    SystemBus bus;
+    RamDevice ram;
+
+    bus.attach(ram);
+    bus.write(0xFFFF, 0x42);
+
+    EXPECT_THAT(ram.memory()[0xFFFF], Eq(0x42));
+}
+
+TEST(SystemBus, ReadsNothingWithoutADevice)
+{
+    SystemBus bus;
+
+    EXPECT_THAT(bus.read(0x0000), Eq(0x00));
+}
+
+TEST(SystemBus, OnlyDevicesHandlingTheAddressAreAccessed)
+{
+    SystemBus       bus;
+    RecordingDevice low(0x0000, 0x7FFF, 0x11);
+    RecordingDevice high(0x8000, 0xFFFF, 0x22);
+
+    bus.attach(low);
+    bus.attach(high);
+
+    EXPECT_THAT(bus.read(0x7FFF), Eq(0x11));
+    EXPECT_THAT(bus.read(0x8000), Eq(0x22));
+    bus.write(0x9000, 0x33);
+
+    EXPECT_THAT(low.writes, IsEmpty());
+    ASSERT_THAT(high.writes.size(), Eq(1U));
+    EXPECT_THAT(high.writes[0].first, Eq(0x9000));
+}
+
+TEST(SystemBus, TheLastAttachedDeviceAnswersReads)
+{
+    SystemBus       bus;
+    RamDevice       ram;
+    RecordingDevice rom(0xF000, 0xFFFF, 0xEA, false, true);
+
+    bus.attach(ram);
+    bus.attach(rom);
+    ram.memory()[0xF000] = 0x00;
+    ram.memory()[0x1000] = 0x01;
+
+    EXPECT_THAT(bus.read(0xF000), Eq(0xEA));
+    EXPECT_THAT(bus.read(0x1000), Eq(0x01));
+}
+
+TEST(SystemBus, WritesGoToEveryDeviceHandlingTheAddress)
+{
+    SystemBus       bus;
+    RamDevice       ram;
+    RecordingDevice mirror(0x0000, 0x00FF, 0x00);
+
+    bus.attach(ram);
+    bus.attach(mirror);
+    bus.write(0x0010, 0x99);
+
+    EXPECT_THAT(ram.memory()[0x0010], Eq(0x99));
+    EXPECT_THAT(mirror.writes.size(), Eq(1U));
+}
+
+TEST(SystemBus, DetachedDevicesAreNoLongerAccessed)
+{
+    SystemBus       bus;
+    RecordingDevice device(0x0000, 0xFFFF, 0x77);
+
+    bus.attach(device);
+    bus.attach(device);
+    EXPECT_THAT(bus.devices().size(), Eq(1U));
+
+    bus.detach(device);
+
+    EXPECT_THAT(bus.read(0x0000), Eq(0x00));
+    EXPECT_THAT(device.reads, IsEmpty());
+}
+
+TEST(RamDevice, ReportsWritesToItsObserver)
+{
+    RamDevice                                              ram;
+    std::vector<std::pair<RamDevice::addressType, uint8_t>> observed;
+
+    ram.setWriteObserver([&observed](RamDevice::addressType address, uint8_t data) { observed.emplace_back(address, data); });
+    ram.write(0x0200, 0x12);
+
+    ASSERT_THAT(observed.size(), Eq(1U));
+    EXPECT_THAT(observed[0].first, Eq(0x0200));
+    EXPECT_THAT(observed[0].second, Eq(0x12));
+}
+
+TEST(SystemBus, BlockReadsAreSplitWhereTheAnsweringDeviceChanges)
+{
+    SystemBus       bus;
+    RamDevice       ram;
+    RecordingDevice io(0x2000, 0x2001, 0x55, true, true);
+    uint8_t         block[6];
+
+    bus.attach(ram);
+    bus.attach(io);
+    for (int i = 0; i < 6; ++i)
+        ram.memory()[0x1FFE + i] = static_cast<uint8_t>(i);
+    bus.readBlock(0x1FFE, block, sizeof(block));
+
+    EXPECT_THAT(block, ElementsAre(0x00, 0x01, 0x55, 0x55, 0x04, 0x05));
+    EXPECT_THAT(io.reads, ElementsAre(0x2000, 0x2001));
+}
+
+TEST(SystemBus, BlockReadsGiveZeroWhereNothingAnswers)
+{
+    SystemBus       bus;
+    RecordingDevice device(0x0002, 0x0003, 0x66);
+    uint8_t         block[6];
+
+    bus.attach(device);
+    bus.readBlock(0xFFFE, block, sizeof(block));
+
+    EXPECT_THAT(block, ElementsAre(0x00, 0x00, 0x00, 0x00, 0x66, 0x66));
+}
+
+TEST(SystemBus, BlockWritesGoToEveryDeviceHandlingTheirPart)
+{
+    SystemBus       bus;
+    RamDevice       ram;
+    RecordingDevice mirror(0x0100, 0x0101, 0x00);
+    const uint8_t   block[] = { 1, 2, 3, 4 };
+
+    bus.attach(ram);
+    bus.attach(mirror);
+    bus.writeBlock(0x00FF, block, sizeof(block));
+
+    EXPECT_THAT(ram.memory()[0x00FF], Eq(1));
+    EXPECT_THAT(ram.memory()[0x0102], Eq(4));
+    EXPECT_THAT(mirror.writes, ElementsAre(std::make_pair(0x0100, 2), std::make_pair(0x0101, 3)));
+}
+
+TEST(SystemBus, BlocksWrapAroundTheEndOfTheAddressSpace)
+{
+    SystemBus     bus;
+    RamDevice     ram;
+    const uint8_t block[] = { 1, 2, 3 };
+    uint8_t       copy[3];
+
+    bus.attach(ram);
+    bus.writeBlock(0xFFFF, block, sizeof(block));
+    bus.readBlock(0xFFFF, copy, sizeof(copy));
+
+    EXPECT_THAT(ram.memory()[0xFFFF], Eq(1));
+    EXPECT_THAT(ram.memory()[0x0001], Eq(3));
+    EXPECT_THAT(copy, ElementsAre(1, 2, 3));
+}
+
+TEST(SystemBus, ReadOnlyDevicesIgnoreBlockWrites)
+{
+    SystemBus       bus;
+    RecordingDevice rom(0x0000, 0xFFFF, 0xEA, false, true);
+    const uint8_t   block[] = { 1, 2 };
+
+    bus.attach(rom);
+    bus.writeBlock(0x1000, block, sizeof(block));
+
+    EXPECT_THAT(rom.writes, IsEmpty());
+}
+
+TEST(RamDevice, ReportsBlockWritesOnceToItsBlockObserver)
+{
+    RamDevice                                              ram;
+    std::vector<std::pair<RamDevice::addressType, size_t>> blocks;
+    int                                                    bytes = 0;
+    const uint8_t                                          block[] = { 1, 2, 3 };
+
+    ram.setWriteObserver([&bytes](RamDevice::addressType, uint8_t) { ++bytes; });
+    ram.writeBlock(0x0300, block, sizeof(block));
+    EXPECT_THAT(bytes, Eq(3));
+
+    ram.setBlockWriteObserver([&blocks](RamDevice::addressType address, size_t length) { blocks.emplace_back(address, length); });
+    ram.writeBlock(0x0300, block, sizeof(block));
+
+    EXPECT_THAT(bytes, Eq(3));
+    EXPECT_THAT(blocks, ElementsAre(std::make_pair(0x0300, 3u)));
+}
@@ -0,0 +1,254 @@
+#include <gmock/gmock.h>
+#include "TraceFixture.hpp"
+#include "compacttrace.hpp"
+#include "tracecomparer.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+// Counts X down from $20, keeping a running sum in A, then traps:
+//
+//      LDX #$20
+//      LDA #$00
+// loop CLC
+//      ADC #$03
+//      PHA
+//      PLA
+//      DEX
+//      BNE loop
+// trap JMP trap
+const std::vector<uint8_t> program {
+    0xA2, 0x20, 0xA9, 0x00, 0x18, 0x69, 0x03, 0x48, 0x68, 0xCA, 0xD0, 0xF8, 0x4C, 0x0C, 0x04
+};
+
+constexpr uint32_t run_cycles = 1000;
+
+class TraceComparerTests : public TraceFixture
+{
+public:
+    TraceComparerTests()
+        :
+        TraceFixture(program, "trace_comparer_test.trace")
+    {
+        computer.saveState(start);
+        golden = traceRun(run_cycles, TraceRecorder::Format::Raw);
+    }
+
+    ~TraceComparerTests() override
+    {
+        std::remove(reference_path.c_str());
+    }
+
+    // Compares the same run again with reference_path
+    void compareWithReference()
+    {
+        TraceRecorder recorder;
+        std::string   error;
+
+        ASSERT_TRUE(comparer.open(reference_path, error)) << error;
+        ASSERT_TRUE(recorder.start([this](const TraceRecord *records, size_t count) { comparer.compare(records, count); }, error)) << error;
+        computer.restoreState(start);
+        computer.cpu().setTraceRecorder(&recorder);
+        computer.scheduler().run(run_cycles);
+        computer.cpu().setTraceRecorder(nullptr);
+        ASSERT_TRUE(recorder.stop(error)) << error;
+    }
+
+    void writeBinaryReference(const std::vector<TraceRecord> &records)
+    {
+        std::ofstream   file(reference_path, std::ios::binary);
+        TraceFileHeader header{};
+
+        std::copy(std::begin(TraceFileHeader::magic_value), std::end(TraceFileHeader::magic_value), header.magic);
+        header.version = TraceFileHeader::current_version;
+        header.record_size = sizeof(TraceRecord);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char *>(records.data()), std::streamsize(records.size() * sizeof(TraceRecord)));
+    }
+
+    // As nestest.log has it, counting cycles from 7 and with P's unused bit set
+    static std::string NestestLine(const TraceRecord &record)
+    {
+        std::ostringstream line;
+
+        line << std::hex << std::uppercase << std::setfill('0') << std::setw(4) << record.program_counter << "  ";
+        for (uint8_t i = 0; i < 3; ++i)
+        {
+            if (i < record.length)
+                line << std::setw(2) << unsigned(i == 0 ? record.opcode : record.operands[i - 1]) << ' ';
+            else
+                line << "   ";
+        }
+        line << " XXX                             A:" << std::setw(2) << unsigned(record.a)
+             << " X:" << std::setw(2) << unsigned(record.x) << " Y:" << std::setw(2) << unsigned(record.y)
+             << " P:" << std::setw(2) << unsigned(record.status | 0x20) << " SP:" << std::setw(2) << unsigned(record.stack_pointer)
+             << std::dec << std::setfill(' ') << " PPU:  0, 21 CYC:" << record.cycle + 7;
+        return line.str();
+    }
+
+    void writeTextReference(const std::vector<std::string> &lines)
+    {
+        std::ofstream file(reference_path);
+
+        for (const std::string &line : lines)
+            file << line << "\r\n";
+    }
+
+    std::vector<std::string> nestestLines() const
+    {
+        std::vector<std::string> lines;
+
+        for (const TraceRecord &record : golden)
+            lines.push_back(NestestLine(record));
+        return lines;
+    }
+
+    std::string              reference_path = std::string(TempDir()) + "trace_comparer_test.log";
+    MachineSnapshot          start;
+    std::vector<TraceRecord> golden;
+    TraceComparer            comparer;
+};
+}
+
+TEST_F(TraceComparerTests, MatchesARunAgainstItsOwnTrace)
+{
+    ASSERT_THAT(golden.size(), Gt(100u));
+    writeBinaryReference(golden);
+
+    compareWithReference();
+
+    EXPECT_THAT(comparer.result(), Eq(TraceComparer::Result::Matching));
+    EXPECT_THAT(comparer.compared(), Eq(golden.size()));
+}
+
+TEST_F(TraceComparerTests, StopsAtTheEndOfAShorterReference)
+{
+    writeBinaryReference(std::vector<TraceRecord>(golden.begin(), golden.begin() + 50));
+
+    compareWithReference();
+
+    EXPECT_TRUE(comparer.done());
+    EXPECT_THAT(comparer.result(), Eq(TraceComparer::Result::ReferenceEnded));
+    EXPECT_THAT(comparer.compared(), Eq(50u));
+}
+
+TEST_F(TraceComparerTests, ReportsTheFirstDifferenceWithTheRecordsBeforeIt)
+{
+    std::vector<TraceRecord> reference = golden;
+
+    reference[40].a ^= 0x01;
+    reference[40].effective_address ^= 0x0100;
+    reference[60].x ^= 0x01;
+    writeBinaryReference(reference);
+
+    compareWithReference();
+
+    const TraceComparer::Divergence &divergence = comparer.divergence();
+
+    EXPECT_TRUE(comparer.done());
+    ASSERT_THAT(comparer.result(), Eq(TraceComparer::Result::Diverged));
+    EXPECT_THAT(comparer.compared(), Eq(40u));
+    EXPECT_THAT(divergence.index, Eq(40u));
+    EXPECT_THAT(divergence.fields, Eq(ReferenceTrace::a_field | ReferenceTrace::effective_address_field));
+    EXPECT_THAT(divergence.expected.a, Eq(reference[40].a));
+    EXPECT_THAT(divergence.actual.a, Eq(golden[40].a));
+    ASSERT_THAT(divergence.before.size(), Eq(TraceComparer::context_records));
+    EXPECT_THAT(divergence.before.back().cycle, Eq(golden[39].cycle));
+    EXPECT_THAT(divergence.before.front().cycle, Eq(golden[40 - TraceComparer::context_records].cycle));
+}
+
+TEST_F(TraceComparerTests, MatchesANestestStyleLog)
+{
+    writeTextReference(nestestLines());
+
+    compareWithReference();
+
+    EXPECT_THAT(comparer.result(), Eq(TraceComparer::Result::Matching));
+    EXPECT_THAT(comparer.compared(), Eq(golden.size()));
+}
+
+TEST_F(TraceComparerTests, ReportsTheLineOfTheLogThatDiffers)
+{
+    std::vector<std::string> lines = nestestLines();
+    TraceRecord              wrong = golden[30];
+
+    wrong.cycle += 1;
+    lines[30] = NestestLine(wrong);
+    lines.insert(lines.begin() + 10, "");
+    writeTextReference(lines);
+
+    compareWithReference();
+
+    ASSERT_THAT(comparer.result(), Eq(TraceComparer::Result::Diverged));
+    EXPECT_THAT(comparer.divergence().index, Eq(30u));
+    EXPECT_THAT(comparer.divergence().line, Eq(32u));
+    EXPECT_THAT(comparer.divergence().fields, Eq(ReferenceTrace::cycle_field));
+}
+
+TEST_F(TraceComparerTests, SaysWhereALogStopsMakingSense)
+{
+    std::vector<std::string> lines = nestestLines();
+
+    lines[20] = "Hello";
+    writeTextReference(lines);
+
+    compareWithReference();
+
+    EXPECT_THAT(comparer.result(), Eq(TraceComparer::Result::ReferenceDamaged));
+    EXPECT_THAT(comparer.compared(), Eq(20u));
+    EXPECT_THAT(comparer.error(), HasSubstr("Line 21"));
+}
+
+TEST_F(TraceComparerTests, SaysWhereACompactTraceIsDamaged)
+{
+    CompactTraceWriter writer;
+    std::string        error;
+
+    ASSERT_TRUE(writer.open(reference_path, error, 64)) << error;
+    writer.write(golden.data(), golden.size());
+    ASSERT_TRUE(writer.close(error)) << error;
+
+    // Cut the second block short, leaving the index to it as it was
+    std::vector<char> contents;
+    std::ifstream     in(reference_path, std::ios::binary);
+
+    contents.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    in.close();
+
+    CompactTraceTrailer     trailer;
+    CompactTraceIndexEntry  second;
+    CompactTraceBlockHeader header;
+
+    std::memcpy(&trailer, contents.data() + contents.size() - sizeof(trailer), sizeof(trailer));
+    ASSERT_THAT(trailer.blocks, Gt(2u));
+    std::memcpy(&second, contents.data() + trailer.index_offset + sizeof(second), sizeof(second));
+    std::memcpy(&header, contents.data() + second.offset, sizeof(header));
+    header.bytes -= 8;
+    std::memcpy(contents.data() + second.offset, &header, sizeof(header));
+    std::ofstream(reference_path, std::ios::binary).write(contents.data(), std::streamsize(contents.size()));
+
+    compareWithReference();
+
+    EXPECT_THAT(comparer.result(), Eq(TraceComparer::Result::ReferenceDamaged));
+    EXPECT_THAT(comparer.compared(), Eq(64u));
+    EXPECT_THAT(comparer.error(), HasSubstr("Block 1"));
+}
+
+TEST_F(TraceComparerTests, WillNotOpenSomethingThatIsNotATrace)
+{
+    std::string error;
+
+    writeTextReference({ "Hello" });
+
+    EXPECT_FALSE(comparer.open(reference_path, error));
+    EXPECT_THAT(error, HasSubstr("nestest"));
+}
@@ -0,0 +1,176 @@
+#include <gmock/gmock.h>
+#include "TraceFixture.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+// Stores $12 at $0302 and $0301, then traps:
+//
+//      LDX #$02
+// loop LDA #$12
+//      STA $0300,X
+//      DEX
+//      BNE loop
+// trap JMP trap
+const std::vector<uint8_t> program { 0xA2, 0x02, 0xA9, 0x12, 0x9D, 0x00, 0x03, 0xCA, 0xD0, 0xF8, 0x4C, 0x0A, 0x04 };
+
+class TraceRecorderTests : public TraceFixture
+{
+public:
+    TraceRecorderTests() : TraceFixture(program, "trace_recorder_test.trace") {}
+};
+
+std::vector<uint16_t> ProgramCountersOf(const std::vector<TraceRecord> &records)
+{
+    std::vector<uint16_t> program_counters;
+
+    for (const TraceRecord &record : records)
+        program_counters.push_back(record.program_counter);
+    return program_counters;
+}
+}
+
+TEST_F(TraceRecorderTests, RecordsEachInstructionWithTheRegistersItStartedWith)
+{
+    const std::vector<TraceRecord> records = traceRun(40);
+    std::vector<uint16_t>          program_counters = ProgramCountersOf(records);
+
+    ASSERT_THAT(program_counters.size(), Ge(10u));
+    program_counters.resize(10);
+    EXPECT_THAT(program_counters, ElementsAre(0x0400, 0x0402, 0x0404, 0x0407, 0x0408, 0x0402, 0x0404, 0x0407, 0x0408, 0x040A));
+
+    const TraceRecord &store = records[2];
+
+    EXPECT_THAT(store.opcode, Eq(0x9D));
+    EXPECT_THAT(store.length, Eq(3));
+    EXPECT_THAT(store.operands[0], Eq(0x00));
+    EXPECT_THAT(store.operands[1], Eq(0x03));
+    EXPECT_THAT(store.effective_address, Eq(0x0302));
+    EXPECT_THAT(store.a, Eq(0x12));
+    EXPECT_THAT(store.x, Eq(0x02));
+
+    // Registers from before DEX, and no effective address for implied mode
+    EXPECT_THAT(records[3].x, Eq(0x02));
+    EXPECT_THAT(records[3].length, Eq(1));
+    EXPECT_THAT(records[3].effective_address, Eq(0x0000));
+    EXPECT_THAT(records[4].x, Eq(0x01));
+
+    // Branches record their target, taken or not
+    EXPECT_THAT(records[4].effective_address, Eq(0x0402));
+    EXPECT_THAT(records[8].effective_address, Eq(0x0402));
+    EXPECT_THAT(records[8].status & Z, Ne(0));
+    EXPECT_THAT(records[9].effective_address, Eq(0x040A));
+
+    // LDX, LDA, STA abs,X, DEX and a taken branch take 2, 2, 5, 2 and 3 cycles
+    EXPECT_THAT(records[1].cycle - records[0].cycle, Eq(2u));
+    EXPECT_THAT(records[3].cycle - records[2].cycle, Eq(5u));
+    EXPECT_THAT(records[5].cycle - records[4].cycle, Eq(3u));
+}
+
+TEST_F(TraceRecorderTests, ClockAndRunRecordTheSameTrace)
+{
+    ComputerCore  clocked;
+    TraceRecorder recorder;
+    std::string   error;
+
+    clocked.load(0x0400, program.data(), program.size());
+    clocked.resetTo(0x0400);
+    ASSERT_TRUE(recorder.start(path, error)) << error;
+    clocked.cpu().setTraceRecorder(&recorder);
+    while (clocked.cpu().clock_ticks < computer.cpu().clock_ticks + 100)
+        clocked.cpu().clock();
+    ASSERT_TRUE(recorder.stop(error)) << error;
+
+    const std::vector<TraceRecord> clocked_records = readTrace();
+    const std::vector<TraceRecord> run_records = traceRun(100);
+
+    ASSERT_THAT(run_records.size(), Eq(clocked_records.size()));
+    for (size_t i = 0; i < run_records.size(); ++i)
+    {
+        EXPECT_THAT(run_records[i].cycle, Eq(clocked_records[i].cycle));
+        EXPECT_THAT(run_records[i].program_counter, Eq(clocked_records[i].program_counter));
+        EXPECT_THAT(run_records[i].x, Eq(clocked_records[i].x));
+    }
+}
+
+TEST_F(TraceRecorderTests, CountsCyclesPastFourBillion)
+{
+    InstructionExecutor::Snapshot snapshot;
+    TraceRecorder                 recorder;
+    std::string                   error;
+
+    // Just short of where 32 bits wrap round
+    computer.cpu().saveState(snapshot);
+    snapshot.clock_ticks = 0xFFFFFFF0;
+    snapshot.cycle_count = 0xFFFFFFF0;
+    computer.cpu().restoreState(snapshot);
+
+    ASSERT_TRUE(recorder.start(path, error)) << error;
+    computer.cpu().setTraceRecorder(&recorder);
+    computer.scheduler().run(20);
+    computer.scheduler().run(20);
+    computer.cpu().setTraceRecorder(nullptr);
+    ASSERT_TRUE(recorder.stop(error)) << error;
+
+    const std::vector<TraceRecord> records = readTrace();
+
+    ASSERT_THAT(records.size(), Ge(6u));
+    EXPECT_THAT(records.front().cycle, Eq(0xFFFFFFF0u + 8));
+    for (size_t i = 1; i < records.size(); ++i)
+        EXPECT_THAT(records[i].cycle, Gt(records[i - 1].cycle));
+    EXPECT_THAT(records.back().cycle, Gt(0xFFFFFFFFu));
+    EXPECT_THAT(computer.cpu().cycleCount(), Eq(0xFFFFFFF0u + computer.scheduler().now()));
+}
+
+TEST_F(TraceRecorderTests, TracesEveryInstructionWhateverTheEngineAndFusion)
+{
+    computer.cpu().enableSuperinstruction(0xCA, 0xD0);
+    for (auto engine : { InstructionExecutor::Engine::Threaded, InstructionExecutor::Engine::TailCall })
+        if (computer.cpu().setEngine(engine))
+            break;
+
+    const uint64_t started = computer.cpu().instructionCount();
+    const std::vector<TraceRecord> records = traceRun(1000);
+
+    EXPECT_THAT(records.size(), Eq(computer.cpu().instructionCount() - started));
+    EXPECT_THAT(records[3].opcode, Eq(0xCA));
+    EXPECT_THAT(records[4].opcode, Eq(0xD0));
+}
+
+TEST_F(TraceRecorderTests, WaitsForRoomRatherThanDroppingRecords)
+{
+    const uint64_t started = computer.cpu().instructionCount();
+    const std::vector<TraceRecord> records = traceRun(200000, TraceRecorder::Format::Compact, 16);
+
+    ASSERT_THAT(records.size(), Eq(computer.cpu().instructionCount() - started));
+    for (size_t i = 1; i < records.size(); ++i)
+        ASSERT_THAT(records[i].cycle, Gt(records[i - 1].cycle));
+}
+
+TEST_F(TraceRecorderTests, SaysWhyItCannotStart)
+{
+    TraceRecorder recorder;
+    std::string   error;
+
+    EXPECT_FALSE(recorder.start(std::string(TempDir()) + "no/such/directory/test.trace", error));
+    EXPECT_THAT(error, HasSubstr("no/such/directory"));
+    EXPECT_FALSE(recorder.recording());
+}
+
+TEST_F(TraceRecorderTests, ReaderRejectsWhatIsNotATrace)
+{
+    TraceReader reader;
+    std::string error;
+    std::FILE  *file = std::fopen(path.c_str(), "wb");
+
+    ASSERT_THAT(file, NotNull());
+    std::fputs("LDA #$12 STA $0300,X", file);
+    std::fclose(file);
+
+    EXPECT_FALSE(reader.open(path, error));
+    EXPECT_THAT(error, HasSubstr("not a trace file"));
+}
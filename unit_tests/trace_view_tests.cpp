@@ -0,0 +1,161 @@
+#include <gmock/gmock.h>
+#include "TraceFixture.hpp"
+#include "compacttrace.hpp"
+#include "traceview.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace testing;
+
+namespace
+{
+// Copies a page a byte at a time, through a subroutine, forever:
+//
+// start LDX #$00
+// loop  LDA $0500,X
+//       JSR copy
+//       INX
+//       BNE loop
+//       JMP start
+//
+// copy  STA $0300,X
+//       RTS
+const std::vector<uint8_t> program {
+    0xA2, 0x00, 0xBD, 0x00, 0x05, 0x20, 0x20, 0x04, 0xE8, 0xD0, 0xF7, 0x4C, 0x00, 0x04
+};
+const std::vector<uint8_t> subroutine { 0x9D, 0x00, 0x03, 0x60 };
+
+class TraceViewTests : public TraceFixture
+{
+public:
+    TraceViewTests()
+        :
+        TraceFixture(program, "trace_view_test.raw")
+    {
+        CompactTraceWriter writer;
+        std::string        error;
+
+        computer.load(0x0420, subroutine.data(), subroutine.size());
+        records = traceRun(100000, TraceRecorder::Format::Raw);
+
+        EXPECT_TRUE(writer.open(compact_path, error, 256)) << error;
+        writer.write(records.data(), records.size());
+        EXPECT_TRUE(writer.close(error)) << error;
+    }
+
+    ~TraceViewTests() override
+    {
+        std::remove(compact_path.c_str());
+    }
+
+    std::string              compact_path = std::string(TempDir()) + "trace_view_test.trace";
+    std::vector<TraceRecord> records;
+};
+
+class EitherFormat : public TraceViewTests, public WithParamInterface<bool>
+{
+public:
+    const std::string &file() const { return GetParam() ? compact_path : path; }
+};
+}
+
+TEST_P(EitherFormat, ReadsAnyRecordInAnyOrder)
+{
+    TraceView   view;
+    TraceRecord record;
+    std::string error;
+
+    ASSERT_TRUE(view.open(file(), error)) << error;
+    ASSERT_THAT(view.records(), Eq(records.size()));
+
+    // Back and forth, as scrolling does, and a jump to the far end
+    for (uint64_t i : { 0, 1, 300, 299, 700, 2, 1000 })
+    {
+        ASSERT_TRUE(view.record(i, record));
+        EXPECT_THAT(std::memcmp(&record, &records[i], sizeof(record)), Eq(0)) << "Record " << i;
+    }
+    ASSERT_TRUE(view.record(records.size() - 1, record));
+    EXPECT_THAT(record.cycle, Eq(records.back().cycle));
+    EXPECT_FALSE(view.record(records.size(), record));
+}
+
+TEST_P(EitherFormat, FindsTheRecordOfACycle)
+{
+    TraceView   view;
+    std::string error;
+
+    ASSERT_TRUE(view.open(file(), error)) << error;
+    for (size_t i : { size_t(0), size_t(255), size_t(256), size_t(5000), records.size() - 1 })
+    {
+        EXPECT_THAT(view.recordOfCycle(records[i].cycle), Eq(i));
+        // Part way through an instruction, so the next one
+        EXPECT_THAT(view.recordOfCycle(records[i].cycle + 1), Eq(i + 1));
+    }
+    EXPECT_THAT(view.recordOfCycle(0), Eq(0u));
+}
+
+TEST_P(EitherFormat, FiltersOnTheWholeTrace)
+{
+    TraceView             view;
+    TraceFilter           filter;
+    std::vector<uint64_t> rows;
+    std::vector<uint64_t> expected;
+    std::string           error;
+
+    // Stores to the middle of the destination page
+    filter.lowest_program_counter = 0x0420;
+    filter.highest_program_counter = 0x042F;
+    filter.opcode = 0x9D;
+    filter.effective_address = 0x0380;
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        if (filter.matches(records[i]))
+            expected.push_back(i);
+    }
+    ASSERT_THAT(expected, Not(IsEmpty()));
+
+    ASSERT_TRUE(view.open(file(), error)) << error;
+    EXPECT_TRUE(view.filter(filter, rows));
+    EXPECT_THAT(rows, ContainerEq(expected));
+}
+
+INSTANTIATE_TEST_SUITE_P(TraceView, EitherFormat, Values(false, true));
+
+TEST_F(TraceViewTests, StopsFilteringWhenCancelled)
+{
+    TraceView             view;
+    std::vector<uint64_t> rows;
+    std::atomic<bool>     cancel{ true };
+    std::string           error;
+
+    ASSERT_TRUE(view.open(compact_path, error)) << error;
+    EXPECT_FALSE(view.filter(TraceFilter(), rows, &cancel));
+    EXPECT_THAT(rows, IsEmpty());
+}
+
+TEST_F(TraceViewTests, KeepsEverythingWithAnEmptyFilter)
+{
+    TraceFilter filter;
+
+    EXPECT_TRUE(filter.keepsEverything());
+    filter.highest_program_counter = 0x7FFF;
+    EXPECT_FALSE(filter.keepsEverything());
+}
+
+TEST(TraceView, RejectsAFileThatIsNotATrace)
+{
+    const std::string path = std::string(TempDir()) + "trace_view_test.txt";
+    std::FILE        *file = std::fopen(path.c_str(), "w");
+    TraceView         view;
+    std::string       error;
+
+    std::fputs("Not a trace, but long enough to have a header", file);
+    std::fclose(file);
+    EXPECT_FALSE(view.open(path, error));
+    EXPECT_THAT(error, HasSubstr("not a trace file"));
+    EXPECT_FALSE(view.isOpen());
+    std::remove(path.c_str());
+}
@@ -12,7 +12,9 @@ CONFIG += qt
 QT += quick
 
 HEADERS += \
+    EngineProgramFixture.hpp \
     InstructionExecutorTestFixture.hpp \
+    TraceFixture.hpp \
     addressing_mode_helpers.hpp \
     instruction_checks.hpp \
     instruction_definitions.hpp \
@@ -64,11 +66,18 @@ SOURCES += \
         absolute_mode_STA.cpp \
         absolute_mode_STX.cpp \
         absolute_mode_STY.cpp \
+        access_heatmap_tests.cpp \
         accumulator_mode_ASL.cpp \
         accumulator_mode_LSR.cpp \
         accumulator_mode_ROL.cpp \
         accumulator_mode_ROR.cpp \
         addressing_mode_helpers.cpp \
+        compact_trace_tests.cpp \
+        computer_rewind_tests.cpp \
+        coverage_map_tests.cpp \
+        cycle_profiler_tests.cpp \
+        decimal_mode_tests.cpp \
+        execution_statistics_tests.cpp \
         immediate_mode_ADC.cpp \
         immediate_mode_AND.cpp \
         immediate_mode_CMP.cpp \
@@ -111,7 +120,11 @@ SOURCES += \
         indirect_y_indexed_LDA.cpp \
         indirect_y_indexed_SBC.cpp \
         indirect_y_indexed_STA.cpp \
+        input_log_tests.cpp \
         instruction_executor_tests.cpp \
+        interpreter_engine_tests.cpp \
+        lazy_flags_tests.cpp \
+        program_image_tests.cpp \
         registers_tests.cpp \
         relative_mode_BCC.cpp \
         relative_mode_BCS.cpp \
@@ -121,6 +134,15 @@ SOURCES += \
         relative_mode_BPL.cpp \
         relative_mode_BVC.cpp \
         relative_mode_BVS.cpp \
+        rewind_buffer_tests.cpp \
+        scheduler_tests.cpp \
+        snapshot_tests.cpp \
+        superinstruction_tests.cpp \
+        symbol_table_tests.cpp \
+        system_bus_tests.cpp \
+        trace_comparer_tests.cpp \
+        trace_recorder_tests.cpp \
+        trace_view_tests.cpp \
         x_indexed_indirect_ADC.cpp \
         x_indexed_indirect_AND.cpp \
         x_indexed_indirect_CMP.cpp \
@@ -181,5 +203,18 @@ else:win32:!win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PW
 else:win32:!win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../emulator/debug/emulator.lib
 else:unix: PRE_TARGETDEPS += $$OUT_PWD/../emulator/libemulator.a
 
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../core/release/ -lemulatorcore
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../core/debug/ -lemulatorcore
+else:unix: LIBS += -L$$OUT_PWD/../core/ -lemulatorcore
+
+INCLUDEPATH += $$PWD/../core
+DEPENDPATH += $$PWD/../core
+
+win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../core/release/libemulatorcore.a
+else:win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../core/debug/libemulatorcore.a
+else:win32:!win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../core/release/emulatorcore.lib
+else:win32:!win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../core/debug/emulatorcore.lib
+else:unix: PRE_TARGETDEPS += $$OUT_PWD/../core/libemulatorcore.a
+
 DISTFILES += \
     PLAN.md